@@ -0,0 +1,236 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
+#include <QtCore/QFile>
+#include <QtCore/QMap>
+#include <QtCore/QPointer>
+#include <QtCore/QQueue>
+#include <QtCore/QStringList>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+
+#include <zlib.h>
+
+#include <openssl/aes.h>
+#include <openssl/bio.h>
+#include <openssl/bn.h>
+#include <openssl/pem.h>
+#include <openssl/rand.h>
+#include <openssl/rsa.h>
+#include <openssl/sha.h>
+
+#include <string>
+#include <iostream>
+using std::string;
+using std::cout;
+
+// Local stand-in for a Telegram data center.
+//
+// Creates auth keys with the clients (the client must be built with
+// -Dfake_dc=1 and started with -fakedc <port>, so that it trusts the key
+// below), speaks the abridged
+// obfuscated TCP and the HTTP transports on the same port and answers
+// the requests used by the transport benchmark with synthetic data:
+// updates bursts, history slices of a large chat and file parts.
+namespace FakeDc {
+
+struct Options {
+	quint16 port = 0;
+	int updates = 10000; // updates pushed after each updates.getState
+	int history = 100000; // messages count in the synthetic chat
+	qint64 fileSize = 1024 * 1024 * 1024; // size of the synthetic file
+	int delay = 0; // ms, added to each packet sent to the client
+	QString replay; // file with recorded server messages pushed instead of synthetic updates
+};
+
+struct AuthKey {
+	uchar key[256];
+	quint64 id = 0;
+};
+
+class Server;
+class Connection;
+
+// State of one client session, it lives while the server runs, so that
+// the client may reconnect or use several HTTP connections.
+class Session : public QObject {
+	Q_OBJECT
+
+public:
+	Session(Server *server, const AuthKey &key, quint64 id, quint64 salt);
+
+	void attach(Connection *connection, bool http);
+	void queue(const QByteArray &body, bool contentRelated, bool response);
+	void pushUpdates();
+
+	bool hasQueued() const {
+		return !_queued.isEmpty() || _updatesLeft > 0;
+	}
+	QByteArray takePacket(); // encrypted packet with the queued messages
+	void flush();
+
+	quint64 nextMsgId(bool response);
+	const AuthKey &key() const {
+		return _key;
+	}
+	quint64 salt() const {
+		return _salt;
+	}
+
+private slots:
+	void onFlush();
+
+private:
+	void queueUpdates(int count);
+
+	struct Message {
+		QByteArray body;
+		quint64 msgId;
+		qint32 seqNo;
+	};
+
+	Server *_server;
+	AuthKey _key;
+	quint64 _id, _salt;
+	quint64 _lastMsgId = 0;
+	qint32 _seqNo = 0;
+	QQueue<Message> _queued;
+	int _updatesLeft = 0, _updatesSent = 0;
+	QPointer<Connection> _connection;
+	bool _http = false;
+	bool _flushQueued = false;
+
+};
+
+class Connection : public QObject {
+	Q_OBJECT
+
+public:
+	Connection(Server *server, QTcpSocket *socket);
+
+	void sendPacket(const QByteArray &packet);
+	void sendError(qint32 code);
+	bool waitingHttp() const {
+		return _httpWaiting;
+	}
+
+private slots:
+	void onReadyRead();
+	void onDisconnected();
+	void onDelayed();
+	void onHttpWait();
+
+private:
+	enum class Transport {
+		Unknown,
+		Tcp,
+		Http,
+	};
+	bool readTcp();
+	bool readHttp();
+	void handlePacket(const char *data, int size);
+	void handlePlain(const char *data, int size);
+	void handleEncrypted(const char *data, int size);
+	void handleMessage(Session *session, quint64 msgId, const char *data, int size);
+	void handleRpc(Session *session, quint64 msgId, const char *data, int size);
+	void sendPlain(const QByteArray &body);
+	void write(const QByteArray &data);
+
+	Server *_server;
+	QTcpSocket *_socket;
+	Transport _transport = Transport::Unknown;
+	QByteArray _buffer;
+
+	// obfuscated abridged tcp
+	AES_KEY _receiveKey, _sendKey;
+	uchar _receiveIvec[16], _receiveEcount[16], _sendIvec[16], _sendEcount[16];
+	unsigned int _receiveNum = 0, _sendNum = 0;
+
+	// http transport, a request is answered when the session has messages
+	bool _httpWaiting = false;
+	QPointer<Session> _httpSession;
+	QTimer _httpWaitTimer;
+
+	// auth key creation
+	uchar _nonce[16], _serverNonce[16], _newNonce[32];
+	BIGNUM *_a = nullptr;
+
+	struct Delayed {
+		qint64 when;
+		QByteArray data;
+	};
+	QQueue<Delayed> _delayed;
+	QTimer _delayTimer;
+
+};
+
+class Server : public QObject {
+	Q_OBJECT
+
+public:
+	explicit Server(const Options &options);
+	~Server();
+
+	bool start();
+
+	const Options &options() const {
+		return _options;
+	}
+	RSA *rsa() const {
+		return _rsa;
+	}
+	quint64 fingerprint() const {
+		return _fingerprint;
+	}
+	const QVector<QByteArray> &replay() const {
+		return _replay;
+	}
+
+	void addKey(const AuthKey &key);
+	const AuthKey *findKey(quint64 id) const;
+	Session *session(const AuthKey &key, quint64 id, quint64 salt, bool *created);
+
+	void addStat(qint64 received, qint64 sent);
+
+private slots:
+	void onNewConnection();
+	void onStats();
+
+private:
+	Options _options;
+	QTcpServer _server;
+	RSA *_rsa = nullptr;
+	quint64 _fingerprint = 0;
+	QVector<QByteArray> _replay;
+	QMap<quint64, AuthKey> _keys;
+	QMap<quint64, Session*> _sessions;
+
+	qint64 _received = 0, _sent = 0;
+	QTimer _statsTimer;
+
+};
+
+} // namespace FakeDc
@@ -615,7 +615,7 @@ namespace {
 				}
 				if (!channel->access) {
 					channel->input = MTP_inputPeerChannel(c.vchannel_id, c.vaccess_hash);
-					channel->inputChannel = d.vmigrated_to;
+					channel->inputChannel = mtpEscape(d.vmigrated_to);
 					channel->access = d.vmigrated_to.c_inputChannel().vaccess_hash.v;
 				}
 				bool updatedTo = (cdata->migrateToPtr != channel), updatedFrom = (channel->mgInfo->migrateFromPtr != cdata);
@@ -31,6 +31,9 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 #include "ui/popupmenu.h"
 #include "langloaderplain.h"
 #include "localstorage.h"
+#ifdef TDESKTOP_FAKE_DC
+#include "mtproto/benchmark.h"
+#endif // TDESKTOP_FAKE_DC
 #include "autoupdater.h"
 #include "core/observer.h"
 #include "observer_peer.h"
@@ -771,6 +774,9 @@ AppClass::AppClass() : QObject()
 	} else {
 		DEBUG_LOG(("Application Info: local map read..."));
 		MTP::start();
+#ifdef TDESKTOP_FAKE_DC
+		MTP::Benchmark::start();
+#endif // TDESKTOP_FAKE_DC
 	}
 
 	MTP::setStateChangedHandler(mtpStateChanged);
@@ -960,7 +966,8 @@ void AppClass::killDownloadSessions() {
 	uint64 ms = getms(), left = MTPAckSendWaiting + MTPKillFileSessionTimeout;
 	for (QMap<int32, uint64>::iterator i = killDownloadSessionTimes.begin(); i != killDownloadSessionTimes.end(); ) {
 		if (i.value() <= ms) {
-			for (int j = 0; j < MTPDownloadSessionsCount; ++j) {
+			auto keepWarm = MTP::keepDownloadSessionWarm(i.key());
+			for (int j = keepWarm ? 1 : 0; j < MTPFileSessionsMaxCount; ++j) {
 				MTP::stopSession(MTP::dldDcId(i.key(), j));
 			}
 			i = killDownloadSessionTimes.erase(i);
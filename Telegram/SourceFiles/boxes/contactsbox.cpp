@@ -201,7 +201,7 @@ void ContactsBox::peopleReceived(const MTPcontacts_Found &result, mtpRequestId r
 	PeopleQueries::iterator i = _peopleQueries.find(req);
 	if (i != _peopleQueries.cend()) {
 		q = i.value();
-		_peopleCache[q] = result;
+		_peopleCache[q] = mtpEscape(result);
 		_peopleQueries.erase(i);
 	}
 
@@ -142,7 +142,7 @@ void ShareBox::peopleReceived(const MTPcontacts_Found &result, mtpRequestId requ
 	auto i = _peopleQueries.find(requestId);
 	if (i != _peopleQueries.cend()) {
 		query = i.value();
-		_peopleCache[query] = result;
+		_peopleCache[query] = mtpEscape(result);
 		_peopleQueries.erase(i);
 	}
 
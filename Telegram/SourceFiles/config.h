@@ -32,7 +32,7 @@ constexpr str_const AppFile = "Telegram";
 enum {
 	MTPShortBufferSize = 65535, // of ints, 256 kb
 	MTPPacketSizeMax = 67108864, // 64 mb
-	MTPIdsBufferSize = 400, // received msgIds and wereAcked msgIds count stored
+	MTPIdsBufferSize = 4096, // received msgIds and wereAcked msgIds count stored, power of two
 	MTPCheckResendTimeout = 10000, // how much time passed from send till we resend request or check it's state, in ms
 	MTPCheckResendWaiting = 1000, // how much time to wait for some more requests, when resending request or checking it's state, in ms
 	MTPAckSendWaiting = 10000, // how much time to wait for some more requests, when sending msg acks
@@ -47,9 +47,13 @@ enum {
 	MTPIPv4ConnectionWaitTimeout = 1000, // 1 seconds waiting for ipv4, until we accept ipv6
 	MTPMillerRabinIterCount = 30, // 30 Miller-Rabin iterations for dh_prime primality check
 
-	MTPUploadSessionsCount = 2, // max 2 upload sessions is created
-	MTPDownloadSessionsCount = 2, // max 2 download sessions is created
+	MTPUploadSessionsCount = 2, // 2 upload sessions are used at start, more are added while the bandwidth grows
+	MTPDownloadSessionsCount = 2, // 2 download sessions are used at start, more are added while the bandwidth grows
+	MTPFileSessionsMaxCount = 8, // max 8 upload or download sessions are created for one dc, the setting can only lower it
 	MTPKillFileSessionTimeout = 5000, // how much time without upload / download causes additional session kill
+	MTPWarmSessionsCount = 3, // first download sessions of 3 recently used dcs stay connected after the downloads stop
+	MTPWarmSessionsMemory = 1024, // 1 mb for the warm sessions, the settings can change both
+	MTPInteractiveReserve = 20, // 20% of the bandwidth (the cap or the measured throughput) is left by the file transfers to the chats while they are active
 
 	MTPEnumDCTimeout = 8000, // 8 seconds timeout for help_getConfig to work (then move to other dc)
 
@@ -62,6 +66,7 @@ enum {
 	MTPPingSendAfter = 45, // send new ping after 45 seconds without ping
 
 	MTPChannelGetDifferenceLimit = 100,
+	MTPChannelGetDifferenceMaxLimit = 1000, // the limit is doubled after each not final channel difference up to that
 
 	MaxSelectedItems = 100,
 
@@ -146,6 +151,7 @@ enum {
 	MaxHttpRedirects = 5, // when getting external data/images
 
 	WriteMapTimeout = 1000,
+	WriteSettingsTimeout = 30000, // frequent settings changes, like the dc endpoints statistics
 	SaveDraftTimeout = 1000, // save draft after 1 secs of not changing text
 	SaveDraftAnywayTimeout = 5000, // or save anyway each 5 secs
 	SaveCloudDraftIdleTimeout = 14000, // save draft to the cloud after 14 more seconds
@@ -202,7 +208,26 @@ inline const char *cGUIDStr() {
 	return gGuidStr;
 }
 
+#if defined TDESKTOP_FAKE_DC && defined CUSTOM_API_ID
+#error "The fake dc test key must never be trusted by the official builds."
+#endif // TDESKTOP_FAKE_DC && CUSTOM_API_ID
+
 inline const char **cPublicRSAKeys(int &keysCount) {
+#ifdef TDESKTOP_FAKE_DC
+	if (cFakeDcPort()) { // test key of the FakeDc server, see _other/fakedc.cpp
+		static const char *(fakeKeys[]) = {"\
+-----BEGIN RSA PUBLIC KEY-----\n\
+MIIBCgKCAQEAvo4apgAXmO4Cy5CrDB96qXPIxevykt6iA84psdyA0IVB0zdg8Rwj\n\
+Bib36llKxDXJ2BXkvPWQHV6PoPix+PLhn8Hdff60OeuQUWd8wFeeuFu1NgQW1PEe\n\
+cEUNUjfFEoNR180s7JHcXvER9uNN726011ln0vgznpe1rWsOxS7ksCn8bE35OLox\n\
+YkDaYxg/kgJcfKBCCI+PaSBlejmPgbnyx/jfEZJLnEFpfhar5YfAoiDOhT3r+Uup\n\
+6CamzmJWKjnbLDqT+LVqh4DMBpzIwIgVkZfWhOTXqau3kBEud5vStAf5fJqQV42k\n\
+EMhC9GOS2lqS3Pjp1pI1UmnpM6sN+r/7mwIDAQAB\n\
+-----END RSA PUBLIC KEY-----"};
+		keysCount = base::array_size(fakeKeys);
+		return fakeKeys;
+	}
+#endif // TDESKTOP_FAKE_DC
 	static const char *(keys[]) = {"\
 -----BEGIN RSA PUBLIC KEY-----\n\
 MIIBCgKCAQEAwVACPi9w23mF3tBkdZz+zwrzKOaaQdr01vAbU4E1pvkfj4sqDsm6\n\
@@ -251,10 +276,26 @@ static const BuiltInDc _builtInTestDcsIPv6[] = {
 };
 
 inline const BuiltInDc *builtInDcs() {
+#ifdef TDESKTOP_FAKE_DC
+	if (cFakeDcPort()) {
+		static BuiltInDc fakeDcs[] = {
+			{ 1, "127.0.0.1", 0 },
+			{ 2, "127.0.0.1", 0 },
+			{ 3, "127.0.0.1", 0 }
+		};
+		for (auto &dc : fakeDcs) {
+			dc.port = cFakeDcPort();
+		}
+		return fakeDcs;
+	}
+#endif // TDESKTOP_FAKE_DC
 	return cTestMode() ? _builtInTestDcs : _builtInDcs;
 }
 
 inline int builtInDcsCount() {
+#ifdef TDESKTOP_FAKE_DC
+	if (cFakeDcPort()) return 3;
+#endif // TDESKTOP_FAKE_DC
 	return (cTestMode() ? sizeof(_builtInTestDcs) : sizeof(_builtInDcs)) / sizeof(BuiltInDc);
 }
 
@@ -263,6 +304,9 @@ inline const BuiltInDc *builtInDcsIPv6() {
 }
 
 inline int builtInDcsCountIPv6() {
+#ifdef TDESKTOP_FAKE_DC
+	if (cFakeDcPort()) return 0;
+#endif // TDESKTOP_FAKE_DC
 	return (cTestMode() ? sizeof(_builtInTestDcsIPv6) : sizeof(_builtInDcsIPv6)) / sizeof(BuiltInDc);
 }
 
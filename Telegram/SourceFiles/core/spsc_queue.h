@@ -0,0 +1,78 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+#include <QtCore/QAtomicPointer>
+
+// unbounded lock-free queue for exactly one producer thread and one consumer thread
+// push() may be called only from the producer thread, tryPop() only from the consumer thread
+template <typename T>
+class SingleProducerQueue {
+	struct Node {
+		Node() : next(nullptr) {
+		}
+		Node(const T &value) : next(nullptr), value(value) {
+		}
+		QAtomicPointer<Node> next;
+		T value;
+	};
+
+public:
+	SingleProducerQueue() : _head(new Node()), _tail(_head) {
+	}
+	SingleProducerQueue(const SingleProducerQueue &other) = delete;
+	SingleProducerQueue &operator=(const SingleProducerQueue &other) = delete;
+
+	void push(const T &value) {
+		Node *node = new Node(value);
+		_tail->next.storeRelease(node);
+		_tail = node;
+	}
+
+	bool tryPop(T &value) {
+		Node *next = _head->next.loadAcquire();
+		if (!next) return false;
+
+		value = next->value;
+		next->value = T();
+		delete _head;
+		_head = next;
+		return true;
+	}
+
+	// may be called from the consumer thread only
+	bool isEmpty() const {
+		return !_head->next.loadAcquire();
+	}
+
+	~SingleProducerQueue() {
+		while (_head) {
+			Node *next = _head->next.load();
+			delete _head;
+			_head = next;
+		}
+	}
+
+private:
+	Node *_head; // owned by the consumer, dummy node before the first queued value
+	Node *_tail; // owned by the producer
+
+};
@@ -2172,7 +2172,7 @@ void DialogsWidget::searchReceived(DialogsSearchRequestType type, const MTPmessa
 		if (type == DialogsSearchFromStart || type == DialogsSearchPeerFromStart) {
 			SearchQueries::iterator i = _searchQueries.find(req);
 			if (i != _searchQueries.cend()) {
-				_searchCache[i.value()] = result;
+				_searchCache[i.value()] = mtpEscape(result);
 				_searchQueries.erase(i);
 			}
 		}
@@ -2240,7 +2240,7 @@ void DialogsWidget::peopleReceived(const MTPcontacts_Found &result, mtpRequestId
 		auto i = _peopleQueries.find(req);
 		if (i != _peopleQueries.cend()) {
 			q = i.value();
-			_peopleCache[q] = result;
+			_peopleCache[q] = mtpEscape(result);
 			_peopleQueries.erase(i);
 		}
 	}
@@ -21,8 +21,10 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 #include "stdafx.h"
 #include "fileuploader.h"
 
-FileUploader::FileUploader() : sentSize(0) {
-	memset(sentSizes, 0, sizeof(sentSizes));
+#include "mtproto/bandwidth_governor.h"
+#include "pspecific.h"
+
+FileUploader::FileUploader() : sentSize(0), sessions(MTP::FileSessionsPool::Kind::Upload) {
 	nextTimer.setSingleShot(true);
 	connect(&nextTimer, SIGNAL(timeout()), this, SLOT(sendNext()));
 	killSessionsTimer.setSingleShot(true);
@@ -86,29 +88,33 @@ void FileUploader::currentFailed() {
 			}
 			emit documentFailed(j.key());
 		}
+		MTP::BandwidthGovernor::finished(MTP::BandwidthGovernor::Direction::Upload, j->id());
 		queue.erase(j);
 	}
 
 	requestsSent.clear();
 	docRequestsSent.clear();
-	dcMap.clear();
 	uploading = FullMsgId();
 	sentSize = 0;
-	for (int i = 0; i < MTPUploadSessionsCount; ++i) {
-		sentSizes[i] = 0;
-	}
+	sessions.clear();
 
 	sendNext();
 }
 
+void FileUploader::logUploaded(const File &file) const {
+	uint64 time = file.startTime ? (getms() - file.startTime) : 0;
+	float64 speed = time ? (file.docSize / float64(time) / 1000.) : 0.; // bytes per ms / 1000 = MB per second
+	DEBUG_LOG(("Upload Info: document %1 uploaded, %2 bytes in %3 ms, %4 MB/s, peak in-flight %5 bytes, peak process memory %6 bytes").arg(file.id()).arg(file.docSize).arg(time).arg(speed).arg(file.peakSentSize).arg(psPeakMemoryUsage()));
+}
+
 void FileUploader::killSessions() {
-	for (int i = 0; i < MTPUploadSessionsCount; ++i) {
+	for (int i = 0; i < MTPFileSessionsMaxCount; ++i) {
 		MTP::stopSession(MTP::uplDcId(i));
 	}
 }
 
 void FileUploader::sendNext() {
-	if (sentSize >= MaxUploadFileParallelSize || _paused.msg) return;
+	if (!sessions.canSend() || _paused.msg) return;
 
 	bool killing = killSessionsTimer.isActive();
 	if (queue.isEmpty()) {
@@ -128,15 +134,17 @@ void FileUploader::sendNext() {
 		i = queue.begin();
 		uploading = i.key();
 	}
-	int todc = 0;
-	for (int dc = 1; dc < MTPUploadSessionsCount; ++dc) {
-		if (sentSizes[dc] < sentSizes[todc]) {
-			todc = dc;
-		}
-	}
+	int todc = sessions.chooseSession();
 
 	UploadFileParts &parts(i->file ? (i->type() == PreparePhoto ? i->file->fileparts : i->file->thumbparts) : i->media.parts);
 	uint64 partsOfId(i->file ? (i->type() == PreparePhoto ? i->file->id : i->file->thumbId) : i->media.thumbId);
+	int32 partSize = parts.isEmpty() ? ((i->docSentParts < i->docPartsCount) ? i->docPartSize : 0) : parts.begin().value().size();
+	if (partSize) {
+		if (auto wait = MTP::BandwidthGovernor::acquire(MTP::BandwidthGovernor::Direction::Upload, i->id(), partSize)) {
+			nextTimer.start(wait);
+			return;
+		}
+	}
 	if (parts.isEmpty()) {
 		if (i->docSentParts >= i->docPartsCount) {
 			if (requestsSent.isEmpty() && docRequestsSent.isEmpty()) {
@@ -144,6 +152,8 @@ void FileUploader::sendNext() {
 				if (i->type() == PreparePhoto) {
 					emit photoReady(uploading, silent, MTP_inputFile(MTP_long(i->id()), MTP_int(i->partsCount), MTP_string(i->filename()), MTP_bytes(i->file ? i->file->filemd5 : i->media.jpeg_md5)));
 				} else if (i->type() == PrepareDocument || i->type() == PrepareAudio) {
+					logUploaded(*i);
+
 					QByteArray docMd5(32, Qt::Uninitialized);
 					hashMd5Hex(i->md5Hash.result(), docMd5.data());
 
@@ -154,6 +164,7 @@ void FileUploader::sendNext() {
 						emit documentReady(uploading, silent, doc);
 					}
 				}
+				MTP::BandwidthGovernor::finished(MTP::BandwidthGovernor::Direction::Upload, i->id());
 				queue.remove(uploading);
 				uploading = FullMsgId();
 				sendNext();
@@ -163,6 +174,7 @@ void FileUploader::sendNext() {
 
 		QByteArray &content(i->file ? i->file->content : i->media.data);
 		QByteArray toSend;
+		uchar *mapped = nullptr;
 		if (content.isEmpty()) {
 			if (!i->docFile) {
 				i->docFile.reset(new QFile(i->file ? i->file->filepath : i->media.file));
@@ -171,44 +183,67 @@ void FileUploader::sendNext() {
 					return;
 				}
 			}
-			toSend = i->docFile->read(i->docPartSize);
+
+			// Map just this part instead of reading it into a buffer of our own:
+			// the request serialization copies the bytes, so after MTP::send()
+			// nothing but the in-flight requests hold the file contents.
+			qint64 offset = qint64(i->docSentParts) * i->docPartSize;
+			qint64 size = qMin(qint64(i->docPartSize), i->docFile->size() - offset);
+			if (size > 0) {
+				mapped = i->docFile->map(offset, size);
+			}
+			if (mapped) {
+				toSend = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), int(size));
+			} else if (i->docFile->seek(offset)) {
+				toSend = i->docFile->read(i->docPartSize);
+			}
 			if (i->docSize <= UseBigFilesFrom) {
 				i->md5Hash.feed(toSend.constData(), toSend.size());
 			}
 		} else {
 			toSend = content.mid(i->docSentParts * i->docPartSize, i->docPartSize);
-			if ((i->type() == PrepareDocument || i->type() == PrepareAudio) && i->docSentParts <= UseBigFilesFrom) {
+			if ((i->type() == PrepareDocument || i->type() == PrepareAudio) && i->docSize <= UseBigFilesFrom) {
 				i->md5Hash.feed(toSend.constData(), toSend.size());
 			}
 		}
 		if (toSend.size() > i->docPartSize || (toSend.size() < i->docPartSize && i->docSentParts + 1 != i->docPartsCount)) {
+			if (mapped) {
+				i->docFile->unmap(mapped);
+			}
 			currentFailed();
 			return;
 		}
+		if (!i->startTime) {
+			i->startTime = getms();
+		}
 		mtpRequestId requestId;
 		if (i->docSize > UseBigFilesFrom) {
-			requestId = MTP::send(MTPupload_SaveBigFilePart(MTP_long(i->id()), MTP_int(i->docSentParts), MTP_int(i->docPartsCount), MTP_bytes(toSend)), rpcDone(&FileUploader::partLoaded), rpcFail(&FileUploader::partFailed), MTP::uplDcId(todc));
+			requestId = MTP::send(MTPupload_SaveBigFilePart(MTP_long(i->id()), MTP_int(i->docSentParts), MTP_int(i->docPartsCount), MTP_bytes(toSend)), rpcDone(&FileUploader::partLoaded), rpcFail(&FileUploader::partFailed), MTP::uplDcId(todc), 0, 0, mtpRequestPriority::Background);
 		} else {
-			requestId = MTP::send(MTPupload_SaveFilePart(MTP_long(i->id()), MTP_int(i->docSentParts), MTP_bytes(toSend)), rpcDone(&FileUploader::partLoaded), rpcFail(&FileUploader::partFailed), MTP::uplDcId(todc));
+			requestId = MTP::send(MTPupload_SaveFilePart(MTP_long(i->id()), MTP_int(i->docSentParts), MTP_bytes(toSend)), rpcDone(&FileUploader::partLoaded), rpcFail(&FileUploader::partFailed), MTP::uplDcId(todc), 0, 0, mtpRequestPriority::Background);
+		}
+		if (mapped) {
+			i->docFile->unmap(mapped);
 		}
 		docRequestsSent.insert(requestId, i->docSentParts);
-		dcMap.insert(requestId, todc);
 		sentSize += i->docPartSize;
-		sentSizes[todc] += i->docPartSize;
+		sessions.sent(requestId, todc, i->docPartSize);
+		if (sentSize > i->peakSentSize) {
+			i->peakSentSize = sentSize;
+		}
 
 		i->docSentParts++;
 	} else {
 		UploadFileParts::iterator part = parts.begin();
 
-		mtpRequestId requestId = MTP::send(MTPupload_SaveFilePart(MTP_long(partsOfId), MTP_int(part.key()), MTP_bytes(part.value())), rpcDone(&FileUploader::partLoaded), rpcFail(&FileUploader::partFailed), MTP::uplDcId(todc));
+		mtpRequestId requestId = MTP::send(MTPupload_SaveFilePart(MTP_long(partsOfId), MTP_int(part.key()), MTP_bytes(part.value())), rpcDone(&FileUploader::partLoaded), rpcFail(&FileUploader::partFailed), MTP::uplDcId(todc), 0, 0, mtpRequestPriority::Background);
 		requestsSent.insert(requestId, part.value());
-		dcMap.insert(requestId, todc);
 		sentSize += part.value().size();
-		sentSizes[todc] += part.value().size();
+		sessions.sent(requestId, todc, part.value().size());
 
 		parts.erase(part);
 	}
-	nextTimer.start(UploadRequestInterval);
+	nextTimer.start(sessions.canSend() ? 0 : UploadRequestInterval); // fill the window without waiting for the responses
 }
 
 void FileUploader::cancel(const FullMsgId &msgId) {
@@ -243,11 +278,10 @@ void FileUploader::clear() {
 		MTP::cancel(i.key());
 	}
 	docRequestsSent.clear();
-	dcMap.clear();
 	sentSize = 0;
-	for (int32 i = 0; i < MTPUploadSessionsCount; ++i) {
+	sessions.clear();
+	for (int32 i = 0; i < MTPFileSessionsMaxCount; ++i) {
 		MTP::stopSession(MTP::uplDcId(i));
-		sentSizes[i] = 0;
 	}
 	killSessionsTimer.stop();
 }
@@ -263,13 +297,10 @@ void FileUploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
 			currentFailed();
 			return;
 		} else {
-			QMap<mtpRequestId, int32>::iterator dcIt = dcMap.find(requestId);
-			if (dcIt == dcMap.cend()) { // must not happen
+			if (sessions.done(requestId) < 0) { // must not happen
 				currentFailed();
 				return;
 			}
-			int32 dc = dcIt.value();
-			dcMap.erase(dcIt);
 
 			int32 sentPartSize = 0;
 			Queue::const_iterator k = queue.constFind(uploading);
@@ -281,7 +312,6 @@ void FileUploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
 				docRequestsSent.erase(j);
 			}
 			sentSize -= sentPartSize;
-			sentSizes[dc] -= sentPartSize;
 			if (k->type() == PreparePhoto) {
 				k->fileSentSize += sentPartSize;
 				PhotoData *photo = App::photo(k->id());
@@ -21,6 +21,7 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 #pragma once
 
 #include "localimageloader.h"
+#include "mtproto/file_sessions.h"
 
 class FileUploader : public QObject, public RPCSender {
 	Q_OBJECT
@@ -61,7 +62,7 @@ signals:
 private:
 
 	struct File {
-		File(const ReadyLocalMedia &media) : media(media), docSentParts(0) {
+		File(const ReadyLocalMedia &media) : media(media), docSentParts(0), startTime(0), peakSentSize(0) {
 			partsCount = media.parts.size();
 			if (type() == PrepareDocument || type() == PrepareAudio) {
 				setDocSize(media.file.isEmpty() ? media.data.size() : media.filesize);
@@ -69,7 +70,7 @@ private:
 				docSize = docPartSize = docPartsCount = 0;
 			}
 		}
-		File(const FileLoadResultPtr &file) : file(file), docSentParts(0) {
+		File(const FileLoadResultPtr &file) : file(file), docSentParts(0), startTime(0), peakSentSize(0) {
 			partsCount = (type() == PreparePhoto) ? file->fileparts.size() : file->thumbparts.size();
 			if (type() == PrepareDocument || type() == PrepareAudio) {
 				setDocSize(file->filesize);
@@ -117,11 +118,14 @@ private:
 
 		HashMd5 md5Hash;
 
-		QSharedPointer<QFile> docFile;
+		QSharedPointer<QFile> docFile; // parts are mapped on demand, only the in-flight ones are kept in memory
 		int32 docSentParts;
 		int32 docSize;
 		int32 docPartSize;
 		int32 docPartsCount;
+
+		uint64 startTime;
+		uint32 peakSentSize;
 	};
 	typedef QMap<FullMsgId, File> Queue;
 
@@ -129,12 +133,12 @@ private:
 	bool partFailed(const RPCError &err, mtpRequestId requestId);
 
 	void currentFailed();
+	void logUploaded(const File &file) const;
 
 	QMap<mtpRequestId, QByteArray> requestsSent;
 	QMap<mtpRequestId, int32> docRequestsSent;
-	QMap<mtpRequestId, int32> dcMap;
 	uint32 sentSize;
-	uint32 sentSizes[MTPUploadSessionsCount];
+	MTP::FileSessionsPool sessions;
 
 	FullMsgId uploading, _paused;
 	Queue queue;
@@ -99,6 +99,8 @@ public:
 	virtual DocumentData *getDocument() {
 		return nullptr;
 	}
+	virtual void markLoadersVisible() { // the media is in the visible area, its files are loaded first
+	}
 	virtual Media::Clip::Reader *getClipReader() {
 		return nullptr;
 	}
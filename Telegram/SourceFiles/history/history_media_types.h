@@ -142,6 +142,9 @@ public:
 	PhotoData *photo() const {
 		return _data;
 	}
+	void markLoadersVisible() override {
+		_data->markVisible();
+	}
 
 	void updateSentMedia(const MTPMessageMedia &media) override;
 	bool needReSetInlineResultMedia(const MTPMessageMedia &media) override;
@@ -226,6 +229,9 @@ public:
 	DocumentData *getDocument() override {
 		return _data;
 	}
+	void markLoadersVisible() override {
+		_data->markVisible();
+	}
 
 	bool uploading() const override {
 		return _data->uploading();
@@ -354,6 +360,9 @@ public:
 	DocumentData *getDocument() override {
 		return _data;
 	}
+	void markLoadersVisible() override {
+		_data->markVisible();
+	}
 
 	void attachToParent() override;
 	void detachFromParent() override;
@@ -448,6 +457,9 @@ public:
 	DocumentData *getDocument() override {
 		return _data;
 	}
+	void markLoadersVisible() override {
+		_data->markVisible();
+	}
 	Media::Clip::Reader *getClipReader() override {
 		return _gif.get();
 	}
@@ -540,6 +552,9 @@ public:
 	DocumentData *getDocument() override {
 		return _data;
 	}
+	void markLoadersVisible() override {
+		_data->markVisible();
+	}
 
 	void attachToParent() override;
 	void detachFromParent() override;
@@ -673,6 +688,9 @@ public:
 	DocumentData *getDocument() override {
 		return _attach ? _attach->getDocument() : 0;
 	}
+	void markLoadersVisible() override {
+		if (_attach) _attach->markLoadersVisible();
+	}
 	Media::Clip::Reader *getClipReader() override {
 		return _attach ? _attach->getClipReader() : 0;
 	}
@@ -775,6 +793,9 @@ public:
 	DocumentData *getDocument() override {
 		return _attach ? _attach->getDocument() : nullptr;
 	}
+	void markLoadersVisible() override {
+		if (_attach) _attach->markLoadersVisible();
+	}
 	Media::Clip::Reader *getClipReader() override {
 		return _attach ? _attach->getClipReader() : nullptr;
 	}
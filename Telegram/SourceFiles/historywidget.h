@@ -87,6 +87,7 @@ public:
 
 	// updates history->scrollTopItem/scrollTopOffset
 	void visibleAreaUpdated(int top, int bottom);
+	void prioritizeVisibleLoaders(); // the media loaders in the visible area go first
 
 	int historyHeight() const;
 	int historyScrollTop() const;
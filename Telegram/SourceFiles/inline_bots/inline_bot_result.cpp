@@ -131,7 +131,7 @@ std_::unique_ptr<Result> Result::create(uint64 queryId, const MTPBotInlineResult
 			result->sendData.reset(new internal::SendFile(result->_document, qs(r.vcaption)));
 		}
 		if (r.has_reply_markup()) {
-			result->_mtpKeyboard = std_::make_unique<MTPReplyMarkup>(r.vreply_markup);
+			result->_mtpKeyboard = std_::make_unique<MTPReplyMarkup>(mtpEscape(r.vreply_markup));
 		}
 	} break;
 
@@ -145,7 +145,7 @@ std_::unique_ptr<Result> Result::create(uint64 queryId, const MTPBotInlineResult
 			result->createDocument();
 		}
 		if (r.has_reply_markup()) {
-			result->_mtpKeyboard = std_::make_unique<MTPReplyMarkup>(r.vreply_markup);
+			result->_mtpKeyboard = std_::make_unique<MTPReplyMarkup>(mtpEscape(r.vreply_markup));
 		}
 	} break;
 
@@ -157,7 +157,7 @@ std_::unique_ptr<Result> Result::create(uint64 queryId, const MTPBotInlineResult
 			badAttachment = true;
 		}
 		if (r.has_reply_markup()) {
-			result->_mtpKeyboard = std_::make_unique<MTPReplyMarkup>(r.vreply_markup);
+			result->_mtpKeyboard = std_::make_unique<MTPReplyMarkup>(mtpEscape(r.vreply_markup));
 		}
 	} break;
 
@@ -169,7 +169,7 @@ std_::unique_ptr<Result> Result::create(uint64 queryId, const MTPBotInlineResult
 			badAttachment = true;
 		}
 		if (r.has_reply_markup()) {
-			result->_mtpKeyboard = std_::make_unique<MTPReplyMarkup>(r.vreply_markup);
+			result->_mtpKeyboard = std_::make_unique<MTPReplyMarkup>(mtpEscape(r.vreply_markup));
 		}
 	} break;
 
@@ -177,7 +177,7 @@ std_::unique_ptr<Result> Result::create(uint64 queryId, const MTPBotInlineResult
 		auto &r = message->c_botInlineMessageMediaContact();
 		result->sendData.reset(new internal::SendContact(qs(r.vfirst_name), qs(r.vlast_name), qs(r.vphone_number)));
 		if (r.has_reply_markup()) {
-			result->_mtpKeyboard = std_::make_unique<MTPReplyMarkup>(r.vreply_markup);
+			result->_mtpKeyboard = std_::make_unique<MTPReplyMarkup>(mtpEscape(r.vreply_markup));
 		}
 	} break;
 
@@ -490,6 +490,7 @@ enum { // Local Storage Keys
 	lskSavedGifs = 0x0f, // no data
 	lskStickersKeys = 0x10, // no data
 	lskTrustedBots = 0x11, // no data
+	lskPartialDownloads = 0x12, // no data
 };
 
 enum {
@@ -552,6 +553,8 @@ enum {
 	dbiNativeNotifications = 0x44,
 	dbiNotificationsCount  = 0x45,
 	dbiNotificationsCorner = 0x46,
+	dbiServerSalts = 0x47,
+	dbiDcEndpoints = 0x48,
 
 	dbiEncryptedWithSalt = 333,
 	dbiEncrypted = 444,
@@ -585,6 +588,11 @@ using TrustedBots = OrderedSet<uint64>;
 TrustedBots _trustedBots;
 bool _trustedBotsRead = false;
 
+typedef QMap<MediaKey, PartialDownload> PartialDownloads;
+PartialDownloads _partialDownloads;
+FileKey _partialDownloadsKey = 0;
+bool _partialDownloadsRead = false;
+
 FileKey _recentStickersKeyOld = 0;
 FileKey _installedStickersKey = 0, _featuredStickersKey = 0, _recentStickersKey = 0, _archivedStickersKey = 0;
 FileKey _savedGifsKey = 0;
@@ -836,6 +844,34 @@ bool _readSetting(quint32 blockId, QDataStream &stream, int version) {
 		if (_dcOpts) _dcOpts->insert(dcIdWithShift, MTP::DcOption(MTP::bareDcId(dcIdWithShift), MTPDdcOption::Flags(flags), ip.toUtf8().constData(), port));
 	} break;
 
+	case dbiDcEndpoints: {
+		quint32 count;
+		stream >> count;
+		if (!_checkStreamStatus(stream)) return false;
+
+		QVector<MTP::DcEndpointStats> endpoints;
+		endpoints.reserve(qMin(count, 256U));
+		for (quint32 i = 0; i < count; ++i) {
+			quint32 dcId, port;
+			qint32 flags, rtt, successes, failures, lastFailure;
+			QString ip;
+			stream >> dcId >> flags >> ip >> port >> rtt >> successes >> failures >> lastFailure;
+			if (!_checkStreamStatus(stream)) return false;
+
+			MTP::DcEndpointStats entry;
+			entry.endpoint.id = dcId;
+			entry.endpoint.flags = MTPDdcOption::Flags(flags);
+			entry.endpoint.ip = ip.toUtf8().constData();
+			entry.endpoint.port = port;
+			entry.rtt = rtt;
+			entry.successes = successes;
+			entry.failures = failures;
+			entry.lastFailure = lastFailure;
+			endpoints.push_back(entry);
+		}
+		MTP::setDcEndpointsStats(endpoints);
+	} break;
+
 	case dbiChatSizeMax: {
 		qint32 maxSize;
 		stream >> maxSize;
@@ -894,6 +930,34 @@ bool _readSetting(quint32 blockId, QDataStream &stream, int version) {
 		MTP::setKey(dcId, keyPtr);
 	} break;
 
+	case dbiServerSalts: {
+		quint32 dcId, count;
+		stream >> dcId >> count;
+		if (!_checkStreamStatus(stream)) return false;
+
+		MTP::ServerSalts salts;
+		salts.reserve(qMin(count, 64U));
+		for (quint32 i = 0; i < count; ++i) {
+			qint32 validSince, validUntil;
+			quint64 salt;
+			stream >> validSince >> validUntil >> salt;
+			if (!_checkStreamStatus(stream)) return false;
+
+			MTP::ServerSalt entry;
+			entry.validSince = validSince;
+			entry.validUntil = validUntil;
+			entry.salt = salt;
+			salts.push_back(entry);
+		}
+
+		DEBUG_LOG(("MTP Info: server salts found, dc %1, count %2").arg(dcId).arg(count));
+		for_const (const MTP::AuthKeyPtr &key, MTP::getKeys()) {
+			if (key->getDC() == MTP::bareDcId(dcId)) {
+				key->setServerSalts(salts);
+			}
+		}
+	} break;
+
 	case dbiAutoStart: {
 		qint32 v;
 		stream >> v;
@@ -1698,15 +1762,31 @@ void _writeMtpData() {
 	}
 
 	MTP::AuthKeysMap keys = MTP::getKeys();
+	QVector<MTP::ServerSalts> salts;
+	salts.reserve(keys.size());
 
 	quint32 size = sizeof(quint32) + sizeof(qint32) + sizeof(quint32);
 	size += keys.size() * (sizeof(quint32) + sizeof(quint32) + 256);
+	for_const (const MTP::AuthKeyPtr &key, keys) {
+		salts.push_back(key->serverSalts());
+		if (!salts.back().isEmpty()) {
+			size += sizeof(quint32) + sizeof(quint32) + sizeof(quint32);
+			size += salts.back().size() * (sizeof(qint32) + sizeof(qint32) + sizeof(quint64));
+		}
+	}
 
 	EncryptedDescriptor data(size);
 	data.stream << quint32(dbiUser) << qint32(MTP::authedId()) << quint32(MTP::maindc());
-	for_const (const MTP::AuthKeyPtr &key, keys) {
+	for (int i = 0, l = keys.size(); i != l; ++i) {
+		const MTP::AuthKeyPtr &key(keys.at(i));
 		data.stream << quint32(dbiKey) << quint32(key->getDC());
 		key->write(data.stream);
+		if (!salts.at(i).isEmpty()) {
+			data.stream << quint32(dbiServerSalts) << quint32(key->getDC()) << quint32(salts.at(i).size());
+			for_const (const MTP::ServerSalt &salt, salts.at(i)) {
+				data.stream << qint32(salt.validSince) << qint32(salt.validUntil) << quint64(salt.salt);
+			}
+		}
 	}
 
 	mtp.writeEncrypted(data, _localKey);
@@ -1787,7 +1867,7 @@ ReadMapState _readMap(const QByteArray &pass) {
 	DraftsNotReadMap draftsNotReadMap;
 	StorageMap imagesMap, stickerImagesMap, audiosMap;
 	qint64 storageImagesSize = 0, storageStickersSize = 0, storageAudiosSize = 0;
-	quint64 locationsKey = 0, reportSpamStatusesKey = 0, trustedBotsKey = 0;
+	quint64 locationsKey = 0, reportSpamStatusesKey = 0, trustedBotsKey = 0, partialDownloadsKey = 0;
 	quint64 recentStickersKeyOld = 0;
 	quint64 installedStickersKey = 0, featuredStickersKey = 0, recentStickersKey = 0, archivedStickersKey = 0;
 	quint64 savedGifsKey = 0;
@@ -1862,6 +1942,9 @@ ReadMapState _readMap(const QByteArray &pass) {
 		case lskTrustedBots: {
 			map.stream >> trustedBotsKey;
 		} break;
+		case lskPartialDownloads: {
+			map.stream >> partialDownloadsKey;
+		} break;
 		case lskRecentStickersOld: {
 			map.stream >> recentStickersKeyOld;
 		} break;
@@ -1913,6 +1996,7 @@ ReadMapState _readMap(const QByteArray &pass) {
 	_locationsKey = locationsKey;
 	_reportSpamStatusesKey = reportSpamStatusesKey;
 	_trustedBotsKey = trustedBotsKey;
+	_partialDownloadsKey = partialDownloadsKey;
 	_recentStickersKeyOld = recentStickersKeyOld;
 	_installedStickersKey = installedStickersKey;
 	_featuredStickersKey = featuredStickersKey;
@@ -1990,6 +2074,7 @@ void _writeMap(WriteMapWhen when) {
 	if (_locationsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_reportSpamStatusesKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_trustedBotsKey) mapSize += sizeof(quint32) + sizeof(quint64);
+	if (_partialDownloadsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_recentStickersKeyOld) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_installedStickersKey || _featuredStickersKey || _recentStickersKey || _archivedStickersKey) {
 		mapSize += sizeof(quint32) + 4 * sizeof(quint64);
@@ -2039,6 +2124,9 @@ void _writeMap(WriteMapWhen when) {
 	if (_trustedBotsKey) {
 		mapData.stream << quint32(lskTrustedBots) << quint64(_trustedBotsKey);
 	}
+	if (_partialDownloadsKey) {
+		mapData.stream << quint32(lskPartialDownloads) << quint64(_partialDownloadsKey);
+	}
 	if (_recentStickersKeyOld) {
 		mapData.stream << quint32(lskRecentStickersOld) << quint64(_recentStickersKeyOld);
 	}
@@ -2132,6 +2220,11 @@ void start() {
 			return writeSettings();
 		}
 	}
+#ifdef TDESKTOP_FAKE_DC
+	if (cFakeDcPort()) { // all dcs are on localhost, stored options are for the real servers
+		dcOpts.clear();
+	}
+#endif // TDESKTOP_FAKE_DC
 	if (dcOpts.isEmpty()) {
 		const BuiltInDc *bdcs = builtInDcs();
 		for (int i = 0, l = builtInDcsCount(); i < l; ++i) {
@@ -2163,17 +2256,10 @@ void writeSettings() {
 		LOG(("App Error: _basePath is empty in writeSettings()"));
 		return;
 	}
+	if (_manager) _manager->writingSettings();
 
 	if (!QDir().exists(_basePath)) QDir().mkpath(_basePath);
 
-	FileWriteDescriptor settings(cTestMode() ? qsl("settings_test") : qsl("settings"), SafePath);
-	if (_settingsSalt.isEmpty() || !_settingsKey.created()) {
-		_settingsSalt.resize(LocalEncryptSaltSize);
-		memset_rand(_settingsSalt.data(), _settingsSalt.size());
-		createLocalKey(QByteArray(), &_settingsSalt, &_settingsKey);
-	}
-	settings.writeData(_settingsSalt);
-
 	MTP::DcOptions dcOpts;
 	{
 		QReadLocker lock(MTP::dcOptionsMutex());
@@ -2199,12 +2285,31 @@ void writeSettings() {
 		QWriteLocker lock(MTP::dcOptionsMutex());
 		Global::SetDcOptions(dcOpts);
 	}
+#ifdef TDESKTOP_FAKE_DC
+	if (cFakeDcPort()) { // don't replace the real dc options with the localhost ones
+		return;
+	}
+#endif // TDESKTOP_FAKE_DC
+
+	FileWriteDescriptor settings(cTestMode() ? qsl("settings_test") : qsl("settings"), SafePath);
+	if (_settingsSalt.isEmpty() || !_settingsKey.created()) {
+		_settingsSalt.resize(LocalEncryptSaltSize);
+		memset_rand(_settingsSalt.data(), _settingsSalt.size());
+		createLocalKey(QByteArray(), &_settingsSalt, &_settingsKey);
+	}
+	settings.writeData(_settingsSalt);
 
 	quint32 size = 12 * (sizeof(quint32) + sizeof(qint32));
 	for (auto i = dcOpts.cbegin(), e = dcOpts.cend(); i != e; ++i) {
 		size += sizeof(quint32) + sizeof(quint32) + sizeof(quint32);
 		size += sizeof(quint32) + Serialize::stringSize(QString::fromUtf8(i->ip.data(), i->ip.size()));
 	}
+	auto endpoints = MTP::dcEndpointsStats();
+	size += sizeof(quint32) + sizeof(quint32);
+	for_const (auto &entry, endpoints) {
+		size += sizeof(quint32) + sizeof(qint32) + Serialize::stringSize(QString::fromUtf8(entry.endpoint.ip.data(), entry.endpoint.ip.size()));
+		size += sizeof(quint32) + sizeof(qint32) * 4;
+	}
 	size += sizeof(quint32) + Serialize::stringSize(cLangFile());
 
 	size += sizeof(quint32) + sizeof(qint32);
@@ -2234,6 +2339,11 @@ void writeSettings() {
 		data.stream << qint32(i->flags) << QString::fromUtf8(i->ip.data(), i->ip.size());
 		data.stream << quint32(i->port);
 	}
+	data.stream << quint32(dbiDcEndpoints) << quint32(endpoints.size());
+	for_const (auto &entry, endpoints) {
+		data.stream << quint32(entry.endpoint.id) << qint32(entry.endpoint.flags) << QString::fromUtf8(entry.endpoint.ip.data(), entry.endpoint.ip.size());
+		data.stream << quint32(entry.endpoint.port) << qint32(entry.rtt) << qint32(entry.successes) << qint32(entry.failures) << qint32(entry.lastFailure);
+	}
 	data.stream << quint32(dbiLangFile) << cLangFile();
 
 	data.stream << quint32(dbiConnectionType) << qint32(Global::ConnectionType());
@@ -2249,6 +2359,14 @@ void writeSettings() {
 	settings.writeEncrypted(data, _settingsKey);
 }
 
+void writeSettingsDelayed() {
+	if (_manager) {
+		_manager->writeSettings();
+	} else {
+		writeSettings();
+	}
+}
+
 void writeUserSettings() {
 	_writeUserSettings();
 }
@@ -2276,6 +2394,9 @@ void reset() {
 	_webFilesMap.clear();
 	_storageWebFilesSize = 0;
 	_locationsKey = _reportSpamStatusesKey = _trustedBotsKey = 0;
+	_partialDownloads.clear();
+	_partialDownloadsKey = 0;
+	_partialDownloadsRead = false;
 	_recentStickersKeyOld = 0;
 	_installedStickersKey = _featuredStickersKey = _recentStickersKey = _archivedStickersKey = 0;
 	_savedGifsKey = 0;
@@ -2555,6 +2676,96 @@ FileLocation readFileLocation(MediaKey location, bool check) {
 	return FileLocation();
 }
 
+void _writePartialDownloads() {
+	if (!_working()) return;
+
+	if (_partialDownloads.isEmpty()) {
+		if (_partialDownloadsKey) {
+			clearKey(_partialDownloadsKey);
+			_partialDownloadsKey = 0;
+			_mapChanged = true;
+			_writeMap();
+		}
+	} else {
+		if (!_partialDownloadsKey) {
+			_partialDownloadsKey = genKey();
+			_mapChanged = true;
+			_writeMap(WriteMapFast);
+		}
+		quint32 size = sizeof(qint32);
+		for_const (auto &download, _partialDownloads) {
+			size += sizeof(quint64) * 2 + Serialize::stringSize(download.path) + sizeof(qint32) * 2 + download.ranges.size() * sizeof(qint32) * 2;
+		}
+		EncryptedDescriptor data(size);
+		data.stream << qint32(_partialDownloads.size());
+		for (auto i = _partialDownloads.cbegin(), e = _partialDownloads.cend(); i != e; ++i) {
+			data.stream << quint64(i.key().first) << quint64(i.key().second) << i.value().path << qint32(i.value().size);
+			data.stream << qint32(i.value().ranges.size());
+			for (auto j = i.value().ranges.cbegin(), end = i.value().ranges.cend(); j != end; ++j) {
+				data.stream << qint32(j.key()) << qint32(j.value());
+			}
+		}
+
+		FileWriteDescriptor file(_partialDownloadsKey);
+		file.writeEncrypted(data);
+	}
+}
+
+void _readPartialDownloads() {
+	if (_partialDownloadsRead) return;
+	_partialDownloadsRead = true;
+
+	if (!_partialDownloadsKey) return;
+
+	FileReadDescriptor partial;
+	if (!readEncryptedFile(partial, _partialDownloadsKey)) {
+		clearKey(_partialDownloadsKey);
+		_partialDownloadsKey = 0;
+		_writeMap();
+		return;
+	}
+
+	qint32 count = 0;
+	partial.stream >> count;
+	for (qint32 i = 0; i < count; ++i) {
+		quint64 first = 0, second = 0;
+		PartialDownload download;
+		qint32 rangesCount = 0;
+		partial.stream >> first >> second >> download.path >> download.size >> rangesCount;
+		for (qint32 j = 0; j < rangesCount; ++j) {
+			qint32 start = 0, end = 0;
+			partial.stream >> start >> end;
+			download.ranges.insert(start, end);
+		}
+		if (!_checkStreamStatus(partial.stream)) {
+			_partialDownloads.clear();
+			return;
+		}
+		_partialDownloads.insert(MediaKey(first, second), download);
+	}
+}
+
+void writePartialDownload(MediaKey location, const PartialDownload &download) {
+	_readPartialDownloads();
+	if (download.path.isEmpty() || download.ranges.isEmpty()) {
+		return clearPartialDownload(location);
+	}
+	_partialDownloads.insert(location, download);
+	_writePartialDownloads();
+}
+
+PartialDownload readPartialDownload(MediaKey location) {
+	_readPartialDownloads();
+	return _partialDownloads.value(location);
+}
+
+void clearPartialDownload(MediaKey location) {
+	_readPartialDownloads();
+	if (_partialDownloads.remove(location)) {
+		_writePartialDownloads();
+	}
+}
+
 qint32 _storageImageSize(qint32 rawlen) {
 	// fulllen + storagekey + type + len + data
 	qint32 result = sizeof(uint32) + sizeof(quint64) * 2 + sizeof(quint32) + sizeof(quint32) + rawlen;
@@ -4165,6 +4376,11 @@ bool ClearManager::addTask(int task) {
 			_trustedBotsKey = 0;
 			_mapChanged = true;
 		}
+		if (_partialDownloadsKey) {
+			_partialDownloads.clear();
+			_partialDownloadsKey = 0;
+			_mapChanged = true;
+		}
 		if (_recentStickersKeyOld) {
 			_recentStickersKeyOld = 0;
 			_mapChanged = true;
@@ -4369,6 +4585,8 @@ Manager::Manager() {
 	connect(&_mapWriteTimer, SIGNAL(timeout()), this, SLOT(mapWriteTimeout()));
 	_locationsWriteTimer.setSingleShot(true);
 	connect(&_locationsWriteTimer, SIGNAL(timeout()), this, SLOT(locationsWriteTimeout()));
+	_settingsWriteTimer.setSingleShot(true);
+	connect(&_settingsWriteTimer, SIGNAL(timeout()), this, SLOT(settingsWriteTimeout()));
 }
 
 void Manager::writeMap(bool fast) {
@@ -4395,6 +4613,16 @@ void Manager::writingLocations() {
 	_locationsWriteTimer.stop();
 }
 
+void Manager::writeSettings() {
+	if (!_settingsWriteTimer.isActive()) {
+		_settingsWriteTimer.start(WriteSettingsTimeout);
+	}
+}
+
+void Manager::writingSettings() {
+	_settingsWriteTimer.stop();
+}
+
 void Manager::mapWriteTimeout() {
 	_writeMap(WriteMapNow);
 }
@@ -4403,6 +4631,10 @@ void Manager::locationsWriteTimeout() {
 	_writeLocations(WriteMapNow);
 }
 
+void Manager::settingsWriteTimeout() {
+	Local::writeSettings();
+}
+
 void Manager::finish() {
 	if (_mapWriteTimer.isActive()) {
 		mapWriteTimeout();
@@ -4410,6 +4642,9 @@ void Manager::finish() {
 	if (_locationsWriteTimer.isActive()) {
 		locationsWriteTimeout();
 	}
+	if (_settingsWriteTimer.isActive()) {
+		settingsWriteTimeout();
+	}
 }
 
 } // namespace internal
@@ -29,6 +29,7 @@ void finish();
 
 void readSettings();
 void writeSettings();
+void writeSettingsDelayed(); // written by timer or in finish()
 void writeUserSettings();
 void writeMtpData();
 
@@ -98,6 +99,17 @@ bool hasDraft(const PeerId &peer);
 void writeFileLocation(MediaKey location, const FileLocation &local);
 FileLocation readFileLocation(MediaKey location, bool check = true);
 
+// The document loaded to a file keeps the written ranges, so that the
+// download is resumed after the app is restarted.
+struct PartialDownload {
+	QString path;
+	qint32 size = 0;
+	QMap<qint32, qint32> ranges; // start -> end
+};
+void writePartialDownload(MediaKey location, const PartialDownload &download);
+PartialDownload readPartialDownload(MediaKey location);
+void clearPartialDownload(MediaKey location);
+
 void writeImage(const StorageKey &location, const ImagePtr &img);
 void writeImage(const StorageKey &location, const StorageImageSaved &jpeg, bool overwrite = true);
 TaskId startImageLoad(const StorageKey &location, mtpFileLoader *loader);
@@ -173,17 +185,21 @@ public:
 	void writingMap();
 	void writeLocations(bool fast);
 	void writingLocations();
+	void writeSettings();
+	void writingSettings();
 	void finish();
 
 	public slots:
 
 	void mapWriteTimeout();
 	void locationsWriteTimeout();
+	void settingsWriteTimeout();
 
 private:
 
 	QTimer _mapWriteTimer;
 	QTimer _locationsWriteTimer;
+	QTimer _settingsWriteTimer;
 
 };
 
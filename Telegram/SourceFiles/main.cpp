@@ -23,6 +23,7 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 #include "pspecific.h"
 
 #include "localstorage.h"
+#include "mtproto/traffic_recorder.h"
 
 int main(int argc, char *argv[]) {
 #ifndef Q_OS_MAC // Retina display support is working fine, others are not.
@@ -35,6 +36,8 @@ int main(int argc, char *argv[]) {
 		return psFixPrevious();
 	} else if (cLaunchMode() == LaunchModeCleanup) {
 		return psCleanup();
+	} else if (cLaunchMode() == LaunchModeMtpDump) {
+		return MTP::TrafficRecorder::dump(cMtpDumpPath(), cMtpDumpFilter(), cMtpDumpReplay());
 #ifndef TDESKTOP_DISABLE_CRASH_REPORTS
 	} else if (cLaunchMode() == LaunchModeShowCrash) {
 		return showCrashReportWindow(QFileInfo(cStartUrl()).absoluteFilePath());
@@ -1223,7 +1223,7 @@ void MainWidget::sendMessage(const MessageToSend &message) {
 			history->clearCloudDraft();
 		}
 		lastMessage = history->addNewMessage(MTP_message(MTP_flags(flags), MTP_int(newId.msg), MTP_int(showFromName ? MTP::authedId() : 0), peerToMTP(history->peer->id), MTPnullFwdHeader, MTPint(), MTP_int(replyTo), MTP_int(unixtime()), msgText, media, MTPnullMarkup, localEntities, MTP_int(1), MTPint()), NewMessageUnread);
-		history->sendRequestId = MTP::send(MTPmessages_SendMessage(MTP_flags(sendFlags), history->peer->input, MTP_int(replyTo), msgText, MTP_long(randomId), MTPnullMarkup, sentEntities), rpcDone(&MainWidget::sentUpdatesReceived, randomId), rpcFail(&MainWidget::sendMessageFail), 0, 0, history->sendRequestId);
+		history->sendRequestId = MTP::send(MTPmessages_SendMessage(MTP_flags(sendFlags), history->peer->input, MTP_int(replyTo), msgText, MTP_long(randomId), MTPnullMarkup, sentEntities), rpcDone(&MainWidget::sentUpdatesReceived, randomId), rpcFail(&MainWidget::sendMessageFail), 0, 0, history->sendRequestId, mtpRequestPriority::Interactive);
 	}
 
 	history->lastSentMsg = lastMessage;
@@ -1478,9 +1478,9 @@ void MainWidget::overviewLoaded(History *history, const MTPmessages_Messages &re
 void MainWidget::sendReadRequest(PeerData *peer, MsgId upTo) {
 	if (!MTP::authedId()) return;
 	if (peer->isChannel()) {
-		_readRequests.insert(peer, qMakePair(MTP::send(MTPchannels_ReadHistory(peer->asChannel()->inputChannel, MTP_int(upTo)), rpcDone(&MainWidget::channelReadDone, peer), rpcFail(&MainWidget::readRequestFail, peer)), upTo));
+		_readRequests.insert(peer, qMakePair(MTP::send(MTPchannels_ReadHistory(peer->asChannel()->inputChannel, MTP_int(upTo)), rpcDone(&MainWidget::channelReadDone, peer), rpcFail(&MainWidget::readRequestFail, peer), 0, 0, 0, mtpRequestPriority::Interactive), upTo));
 	} else {
-		_readRequests.insert(peer, qMakePair(MTP::send(MTPmessages_ReadHistory(peer->input, MTP_int(upTo)), rpcDone(&MainWidget::historyReadDone, peer), rpcFail(&MainWidget::readRequestFail, peer)), upTo));
+		_readRequests.insert(peer, qMakePair(MTP::send(MTPmessages_ReadHistory(peer->input, MTP_int(upTo)), rpcDone(&MainWidget::historyReadDone, peer), rpcFail(&MainWidget::readRequestFail, peer), 0, 0, 0, mtpRequestPriority::Interactive), upTo));
 	}
 }
 
@@ -3047,13 +3047,42 @@ void MainWidget::updSetState(int32 pts, int32 date, int32 qts, int32 seq) {
 void MainWidget::gotChannelDifference(ChannelData *channel, const MTPupdates_ChannelDifference &diff) {
 	_channelFailDifferenceTimeout.remove(channel);
 
-	int32 timeout = 0;
+	int32 timeout = 0, pts = 0;
 	bool isFinal = true;
 	switch (diff.type()) {
 	case mtpc_updates_channelDifferenceEmpty: {
 		auto &d = diff.c_updates_channelDifferenceEmpty();
-		if (d.has_timeout()) timeout = d.vtimeout.v;
 		isFinal = d.is_final();
+		pts = d.vpts.v;
+	} break;
+	case mtpc_updates_channelDifferenceTooLong: {
+		auto &d = diff.c_updates_channelDifferenceTooLong();
+		isFinal = d.is_final();
+		pts = d.vpts.v;
+	} break;
+	case mtpc_updates_channelDifference: {
+		auto &d = diff.c_updates_channelDifference();
+		isFinal = d.is_final();
+		pts = d.vpts.v;
+	} break;
+	}
+
+	// The next part is requested before this one is applied, the response
+	// will be handled only after we return, so the order is kept.
+	if (!isFinal) {
+		auto &limit = _channelDifferenceLimits[channel];
+		limit = qMin(qMax(limit, int32(MTPChannelGetDifferenceLimit)) * 2, int32(MTPChannelGetDifferenceMaxLimit));
+
+		MTP_LOG(0, ("getChannelDifference { good - after not final channelDifference was received, pipelined }%1").arg(cTestMode() ? " TESTMODE" : ""));
+		requestChannelDifference(channel, pts);
+	} else {
+		_channelDifferenceLimits.remove(channel);
+	}
+
+	switch (diff.type()) {
+	case mtpc_updates_channelDifferenceEmpty: {
+		auto &d = diff.c_updates_channelDifferenceEmpty();
+		if (d.has_timeout()) timeout = d.vtimeout.v;
 		channel->ptsInit(d.vpts.v);
 	} break;
 
@@ -3083,7 +3112,6 @@ void MainWidget::gotChannelDifference(ChannelData *channel, const MTPupdates_Cha
 		}
 
 		if (d.has_timeout()) timeout = d.vtimeout.v;
-		isFinal = d.is_final();
 		channel->ptsInit(d.vpts.v);
 	} break;
 
@@ -3130,18 +3158,15 @@ void MainWidget::gotChannelDifference(ChannelData *channel, const MTPupdates_Cha
 		_handlingChannelDifference = false;
 
 		if (d.has_timeout()) timeout = d.vtimeout.v;
-		isFinal = d.is_final();
 		channel->ptsInit(d.vpts.v);
 	} break;
 	}
 
-	channel->ptsSetRequesting(false);
-
-	if (!isFinal) {
-		MTP_LOG(0, ("getChannelDifference { good - after not final channelDifference was received }%1").arg(cTestMode() ? " TESTMODE" : ""));
-		getChannelDifference(channel);
-	} else if (activePeer() == channel) {
-		channel->ptsWaitingForShortPoll(timeout ? (timeout * 1000) : WaitForChannelGetDifference);
+	if (isFinal) { // otherwise the next part is already requested
+		channel->ptsSetRequesting(false);
+		if (activePeer() == channel) {
+			channel->ptsWaitingForShortPoll(timeout ? (timeout * 1000) : WaitForChannelGetDifference);
+		}
 	}
 }
 
@@ -3225,15 +3250,16 @@ void MainWidget::gotDifference(const MTPupdates_Difference &diff) {
 	} break;
 	case mtpc_updates_differenceSlice: {
 		const auto &d(diff.c_updates_differenceSlice());
-		feedDifference(d.vusers, d.vchats, d.vnew_messages, d.vother_updates);
-
 		const auto &s(d.vintermediate_state.c_updates_state());
-		updSetState(s.vpts.v, s.vdate.v, s.vqts.v, s.vseq.v);
 
-		_ptsWaiter.setRequesting(false);
+		// The next slice is requested from the intermediate state before this one
+		// is applied, its response will be handled only after we return.
+		// _ptsWaiter stays requesting until the last slice is received.
+		MTP_LOG(0, ("getDifference { good - after a slice of difference was received, pipelined }%1").arg(cTestMode() ? " TESTMODE" : ""));
+		requestDifference(s.vpts.v, s.vdate.v, s.vqts.v);
 
-		MTP_LOG(0, ("getDifference { good - after a slice of difference was received }%1").arg(cTestMode() ? " TESTMODE" : ""));
-		getDifference();
+		feedDifference(d.vusers, d.vchats, d.vnew_messages, d.vother_updates);
+		updSetState(s.vpts.v, s.vdate.v, s.vqts.v, s.vseq.v);
 	} break;
 	case mtpc_updates_difference: {
 		const auto &d(diff.c_updates_difference());
@@ -3392,6 +3418,7 @@ void MainWidget::onGetDifferenceTimeAfterFail() {
 			wait = wait ? qMin(wait, i.value() - now) : (i.value() - now);
 			++i;
 		} else {
+			i.key()->ptsSetRequesting(false); // the failed request could be a pipelined one
 			getChannelDifference(i.key(), GetChannelDifferenceFromFail);
 			i = _channelGetDifferenceTimeAfterFail.erase(i);
 		}
@@ -3411,15 +3438,19 @@ void MainWidget::getDifference() {
 	LOG(("Getting difference! no updates timer: %1, remains: %2").arg(noUpdatesTimer.isActive() ? 1 : 0).arg(noUpdatesTimer.remainingTime()));
 	if (requestingDifference()) return;
 
+	_ptsWaiter.setRequesting(true);
+	requestDifference(_ptsWaiter.current(), updDate, updQts);
+}
+
+void MainWidget::requestDifference(int32 pts, int32 date, int32 qts) {
 	_bySeqUpdates.clear();
 	_bySeqTimer.stop();
 
 	noUpdatesTimer.stop();
 	_getDifferenceTimeAfterFail = 0;
 
-	LOG(("Getting difference for %1, %2").arg(_ptsWaiter.current()).arg(updDate));
-	_ptsWaiter.setRequesting(true);
-	MTP::send(MTPupdates_GetDifference(MTP_int(_ptsWaiter.current()), MTP_int(updDate), MTP_int(updQts)), rpcDone(&MainWidget::gotDifference), rpcFail(&MainWidget::failDifference));
+	LOG(("Getting difference for %1, %2").arg(pts).arg(date));
+	MTP::send(MTPupdates_GetDifference(MTP_int(pts), MTP_int(date), MTP_int(qts)), rpcDone(&MainWidget::gotDifference), rpcFail(&MainWidget::failDifference));
 }
 
 void MainWidget::getChannelDifference(ChannelData *channel, GetChannelDifferenceFrom from) {
@@ -3436,11 +3467,16 @@ void MainWidget::getChannelDifference(ChannelData *channel, GetChannelDifference
 		_channelGetDifferenceTimeAfterFail.remove(channel);
 	}
 
-	LOG(("Getting channel difference for %1").arg(channel->pts()));
 	channel->ptsSetRequesting(true);
+	requestChannelDifference(channel, channel->pts());
+}
+
+void MainWidget::requestChannelDifference(ChannelData *channel, int32 pts) {
+	int32 limit = _channelDifferenceLimits.value(channel, MTPChannelGetDifferenceLimit);
+	LOG(("Getting channel difference for %1, limit %2").arg(pts).arg(limit));
 
 	auto filter = MTP_channelMessagesFilterEmpty();
-	MTP::send(MTPupdates_GetChannelDifference(channel->inputChannel, filter, MTP_int(channel->pts()), MTP_int(MTPChannelGetDifferenceLimit)), rpcDone(&MainWidget::gotChannelDifference, channel), rpcFail(&MainWidget::failChannelDifference, channel));
+	MTP::send(MTPupdates_GetChannelDifference(channel->inputChannel, filter, MTP_int(pts), MTP_int(limit)), rpcDone(&MainWidget::gotChannelDifference, channel), rpcFail(&MainWidget::failChannelDifference, channel));
 }
 
 void MainWidget::mtpPing() {
@@ -4224,7 +4260,7 @@ void MainWidget::feedUpdates(const MTPUpdates &updates, uint64 randomId) {
 		if (d.vseq.v) {
 			if (d.vseq.v <= updSeq) return;
 			if (d.vseq.v > updSeq + 1) {
-				_bySeqUpdates.insert(d.vseq.v, updates);
+				_bySeqUpdates.insert(d.vseq.v, mtpEscape(updates));
 				return _bySeqTimer.start(WaitForSkippedTimeout);
 			}
 		}
@@ -4241,7 +4277,7 @@ void MainWidget::feedUpdates(const MTPUpdates &updates, uint64 randomId) {
 		if (d.vseq_start.v) {
 			if (d.vseq_start.v <= updSeq) return;
 			if (d.vseq_start.v > updSeq + 1) {
-				_bySeqUpdates.insert(d.vseq_start.v, updates);
+				_bySeqUpdates.insert(d.vseq_start.v, mtpEscape(updates));
 				return _bySeqTimer.start(WaitForSkippedTimeout);
 			}
 		}
@@ -537,6 +537,8 @@ private:
 		GetChannelDifferenceFromFail,
 	};
 	void getChannelDifference(ChannelData *channel, GetChannelDifferenceFrom from = GetChannelDifferenceFromUnknown);
+	void requestDifference(int32 pts, int32 date, int32 qts);
+	void requestChannelDifference(ChannelData *channel, int32 pts);
 	void gotDifference(const MTPupdates_Difference &diff);
 	bool failDifference(const RPCError &e);
 	void feedDifference(const MTPVector<MTPUser> &users, const MTPVector<MTPChat> &chats, const MTPVector<MTPMessage> &msgs, const MTPVector<MTPUpdate> &other);
@@ -660,6 +662,8 @@ private:
 	int32 _failDifferenceTimeout = 1; // growing timeout for getDifference calls, if it fails
 	typedef QMap<ChannelData*, int32> ChannelFailDifferenceTimeout;
 	ChannelFailDifferenceTimeout _channelFailDifferenceTimeout; // growing timeout for getChannelDifference calls, if it fails
+	typedef QMap<ChannelData*, int32> ChannelDifferenceLimits;
+	ChannelDifferenceLimits _channelDifferenceLimits; // growing limit for getChannelDifference calls while catching up a large gap
 	SingleTimer _failDifferenceTimer;
 
 	uint64 _lastUpdateTime = 0;
@@ -360,7 +360,7 @@ void MainWindow::setupIntro(bool anim) {
 void MainWindow::serviceNotification(const QString &msg, const MTPMessageMedia &media, bool force) {
 	History *h = (main && App::userLoaded(ServiceUserId)) ? App::history(ServiceUserId) : 0;
 	if (!h || (!force && h->isEmpty())) {
-		_delayedServiceMsgs.push_back(DelayedServiceMsg(msg, media));
+		_delayedServiceMsgs.push_back(DelayedServiceMsg(msg, mtpEscape(media)));
 		return sendServiceHistoryRequest();
 	}
 
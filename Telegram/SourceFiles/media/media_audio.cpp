@@ -265,6 +265,7 @@ void AudioPlayer::AudioMsg::clear() {
 	audio = AudioMsgId();
 	file = FileLocation();
 	data = QByteArray();
+	streaming = Media::StreamingSourcePtr();
 	playbackState = defaultState();
 	skipStart = skipEnd = 0;
 	loading = false;
@@ -480,7 +481,11 @@ void AudioPlayer::play(const AudioMsgId &audio, int64 position) {
 		current->audio = audio;
 		current->file = audio.audio()->location(true);
 		current->data = audio.audio()->data();
-		if (current->file.isEmpty() && current->data.isEmpty()) {
+		current->streaming = Media::StreamingSourcePtr();
+		if (current->file.isEmpty() && current->data.isEmpty() && type == AudioMsgId::Type::Song) {
+			current->streaming = audio.audio()->streamingSource();
+		}
+		if (current->file.isEmpty() && current->data.isEmpty() && !current->streaming) {
 			notLoadedYet = true;
 			if (audio.type() == AudioMsgId::Type::Song) {
 				setStoppedState(current);
@@ -21,6 +21,7 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 #pragma once
 
 #include "core/basic_types.h"
+#include "media/media_streaming.h"
 
 void audioInit();
 bool audioWorks();
@@ -117,6 +118,7 @@ private:
 
 		FileLocation file;
 		QByteArray data;
+		Media::StreamingSourcePtr streaming; // the song is still loading
 		AudioPlaybackState playbackState = defaultState();
 		int64 skipStart = 0;
 		int64 skipEnd = 0;
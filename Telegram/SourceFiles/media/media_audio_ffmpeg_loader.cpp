@@ -34,7 +34,7 @@ bool AbstractFFMpegLoader::open(qint64 &position) {
 	char err[AV_ERROR_MAX_STRING_SIZE] = { 0 };
 
 	ioBuffer = (uchar*)av_malloc(AVBlockSize);
-	if (data.isEmpty()) {
+	if (fileDevice) {
 		ioContext = avio_alloc_context(ioBuffer, AVBlockSize, 0, reinterpret_cast<void*>(this), &AbstractFFMpegLoader::_read_file, 0, &AbstractFFMpegLoader::_seek_file);
 	} else {
 		ioContext = avio_alloc_context(ioBuffer, AVBlockSize, 0, reinterpret_cast<void*>(this), &AbstractFFMpegLoader::_read_data, 0, &AbstractFFMpegLoader::_seek_data);
@@ -119,16 +119,20 @@ int64_t AbstractFFMpegLoader::_seek_data(void *opaque, int64_t offset, int whenc
 
 int AbstractFFMpegLoader::_read_file(void *opaque, uint8_t *buf, int buf_size) {
 	AbstractFFMpegLoader *l = reinterpret_cast<AbstractFFMpegLoader*>(opaque);
-	return int(l->f.read((char*)(buf), buf_size));
+	auto result = int(l->fileDevice->read((char*)(buf), buf_size));
+	if (result < 0 && l->waitingForData()) {
+		return AVERROR(EAGAIN);
+	}
+	return result;
 }
 
 int64_t AbstractFFMpegLoader::_seek_file(void *opaque, int64_t offset, int whence) {
 	AbstractFFMpegLoader *l = reinterpret_cast<AbstractFFMpegLoader*>(opaque);
 
 	switch (whence) {
-	case SEEK_SET: return l->f.seek(offset) ? l->f.pos() : -1;
-	case SEEK_CUR: return l->f.seek(l->f.pos() + offset) ? l->f.pos() : -1;
-	case SEEK_END: return l->f.seek(l->f.size() + offset) ? l->f.pos() : -1;
+	case SEEK_SET: return l->fileDevice->seek(offset) ? l->fileDevice->pos() : -1;
+	case SEEK_CUR: return l->fileDevice->seek(l->fileDevice->pos() + offset) ? l->fileDevice->pos() : -1;
+	case SEEK_END: return l->fileDevice->seek(l->fileDevice->size() + offset) ? l->fileDevice->pos() : -1;
 	}
 	return -1;
 }
@@ -258,7 +262,15 @@ AudioPlayerLoader::ReadResult FFMpegLoader::readMore(QByteArray &result, int64 &
 		return ReadResult::Error;
 	}
 
+	if (streamingDevice && !streamingDevice->readyToRead()) {
+		return ReadResult::Wait; // the loaders retry when the next part is loaded
+	}
 	if ((res = av_read_frame(fmtContext, &avpkt)) < 0) {
+		if (res == AVERROR(EAGAIN) && waitingForData()) { // some not loaded offset was read
+			ioContext->eof_reached = 0;
+			ioContext->error = 0;
+			return ReadResult::Wait;
+		}
 		if (res != AVERROR_EOF) {
 			char err[AV_ERROR_MAX_STRING_SIZE] = { 0 };
 			LOG(("Audio Error: Unable to av_read_frame() file '%1', data size '%2', error %3, %4").arg(file.name()).arg(data.size()).arg(res).arg(av_make_error_string(err, sizeof(err), res)));
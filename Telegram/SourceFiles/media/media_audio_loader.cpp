@@ -60,7 +60,14 @@ bool AudioPlayerLoader::holdsSavedDecodedSamples() const {
 }
 
 bool AudioPlayerLoader::openFile() {
-	if (data.isEmpty()) {
+	if (streaming) {
+		streamingDevice = std_::make_unique<Media::StreamingDevice>(streaming);
+		if (!streamingDevice->open(QIODevice::ReadOnly)) {
+			LOG(("Audio Error: could not open loading file '%1'").arg(streaming->path()));
+			return false;
+		}
+		fileDevice = streamingDevice.get();
+	} else if (data.isEmpty()) {
 		if (f.isOpen()) f.close();
 		if (!access) {
 			if (!file.accessEnable()) {
@@ -74,6 +81,7 @@ bool AudioPlayerLoader::openFile() {
 			LOG(("Audio Error: could not open file '%1', data size '%2', error %3, %4").arg(file.name()).arg(data.size()).arg(f.error()).arg(f.errorString()));
 			return false;
 		}
+		fileDevice = &f;
 	}
 	dataPos = 0;
 	return true;
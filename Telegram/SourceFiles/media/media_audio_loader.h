@@ -20,6 +20,8 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 */
 #pragma once
 
+#include "media/media_streaming.h"
+
 class AudioPlayerLoader {
 public:
 	AudioPlayerLoader(const FileLocation &file, const QByteArray &data);
@@ -27,6 +29,19 @@ public:
 
 	virtual bool check(const FileLocation &file, const QByteArray &data);
 
+	// Read the file that is still loading, must be set before open().
+	void setStreaming(const Media::StreamingSourcePtr &streaming) {
+		this->streaming = streaming;
+	}
+	bool isStreaming() const {
+		return streaming != nullptr;
+	}
+
+	// The last read failed only because the loading file part is not written yet.
+	bool waitingForData() const {
+		return streamingDevice && streamingDevice->wouldBlock();
+	}
+
 	virtual bool open(qint64 &position) = 0;
 	virtual int64 duration() = 0;
 	virtual int32 frequency() = 0;
@@ -53,6 +68,10 @@ protected:
 	QFile f;
 	int32 dataPos = 0;
 
+	Media::StreamingSourcePtr streaming;
+	std_::unique_ptr<Media::StreamingDevice> streamingDevice;
+	QIODevice *fileDevice = nullptr; // f or streamingDevice
+
 	bool openFile();
 
 private:
@@ -71,6 +71,13 @@ void AudioPlayerLoaders::onVideoSoundAdded() {
 	}
 }
 
+void AudioPlayerLoaders::onStreamingLoaded() {
+	if (!_streamingWaiting) return;
+
+	auto audio = base::take(_streamingWaiting);
+	loadData(audio, base::take(_streamingWaitingPosition));
+}
+
 AudioPlayerLoaders::~AudioPlayerLoaders() {
 	QMutexLocker lock(&_fromVideoMutex);
 	clearFromVideoQueue();
@@ -173,6 +180,9 @@ void AudioPlayerLoaders::loadData(AudioMsgId audio, qint64 position) {
 			waiting = (samples.size() < AudioVoiceMsgBufferSize);
 			if (waiting) {
 				l->saveDecodedSamples(&samples, &samplesCount);
+				if (l->isStreaming()) {
+					_streamingWaiting = audio;
+				}
 			}
 			break;
 		}
@@ -370,9 +380,20 @@ AudioPlayerLoader *AudioPlayerLoaders::setupLoader(const AudioMsgId &audio, Setu
 		} else {
 			*loader = std_::make_unique<FFMpegLoader>(data->file, data->data);
 			l = loader->get();
+			l->setStreaming(data->streaming);
+			if (data->streaming) {
+				connect(data->streaming.data(), SIGNAL(loaded()), this, SLOT(onStreamingLoaded()), Qt::UniqueConnection);
+			}
 		}
 
 		if (!l->open(position)) {
+			if (l->waitingForData()) { // opened again when the next part is loaded
+				clear(audio.type());
+				_streamingWaiting = audio;
+				_streamingWaitingPosition = position;
+				err = SetupWaitingForData;
+				return nullptr;
+			}
 			data->playbackState.state = AudioPlayerStoppedAtStart;
 			return nullptr;
 		}
@@ -48,6 +48,7 @@ public slots:
 	void onCancel(const AudioMsgId &audio);
 
 	void onVideoSoundAdded();
+	void onStreamingLoaded();
 
 private:
 	void clearFromVideoQueue();
@@ -62,6 +63,10 @@ private:
 	QQueue<FFMpeg::AVPacketDataWrap> _fromVideoQueue;
 	SingleDelayedCall _fromVideoNotify;
 
+	// The song that waits for the loading file part, the reads never block.
+	AudioMsgId _streamingWaiting;
+	qint64 _streamingWaitingPosition = 0;
+
 	void emitError(AudioMsgId::Type type);
 	AudioMsgId clear(AudioMsgId::Type type);
 	void setStoppedState(AudioPlayer::AudioMsg *m, AudioPlayerState state = AudioPlayerStopped);
@@ -71,6 +76,7 @@ private:
 		SetupErrorNotPlaying = 1,
 		SetupErrorLoadedFull = 2,
 		SetupNoErrorStarted = 3,
+		SetupWaitingForData = 4,
 	};
 	void loadData(AudioMsgId audio, qint64 position);
 	AudioPlayerLoader *setupLoader(const AudioMsgId &audio, SetupError &err, qint64 &position);
@@ -28,7 +28,7 @@ namespace Media {
 namespace Clip {
 namespace internal {
 
-FFMpegReaderImplementation::FFMpegReaderImplementation(FileLocation *location, QByteArray *data, uint64 playId) : ReaderImplementation(location, data)
+FFMpegReaderImplementation::FFMpegReaderImplementation(FileLocation *location, QByteArray *data, uint64 playId, const StreamingSourcePtr &streaming) : ReaderImplementation(location, data, streaming)
 , _playId(playId) {
 	_frame = av_frame_alloc();
 	av_init_packet(&_packetNull);
@@ -82,6 +82,8 @@ ReaderImplementation::ReadResult FFMpegReaderImplementation::readNextFrame() {
 			auto packetResult = readAndProcessPacket();
 			if (packetResult == PacketResult::Error) {
 				return ReadResult::Error;
+			} else if (packetResult == PacketResult::Wait) {
+				return ReadResult::Wait; // resumed from avcodec_receive_frame() later
 			} else if (packetResult == PacketResult::EndOfFile) {
 				break;
 			}
@@ -411,7 +413,7 @@ bool FFMpegReaderImplementation::start(Mode mode, int64 &positionMs) {
 }
 
 QString FFMpegReaderImplementation::logData() const {
-	return qsl("for file '%1', data size '%2'").arg(_location ? _location->name() : QString()).arg(_data->size());
+	return qsl("for file '%1', data size '%2'").arg(_location ? _location->name() : (_streaming ? _streaming->path() : QString())).arg(_data->size());
 }
 
 FFMpegReaderImplementation::~FFMpegReaderImplementation() {
@@ -445,8 +447,17 @@ FFMpegReaderImplementation::PacketResult FFMpegReaderImplementation::readPacket(
 	packet->data = nullptr;
 	packet->size = 0;
 
+	if (_streamingDevice && !_streamingDevice->readyToRead()) {
+		return PacketResult::Wait; // the manager retries when the next part is loaded
+	}
+
 	int res = 0;
 	if ((res = av_read_frame(_fmtContext, packet)) < 0) {
+		if (res == AVERROR(EAGAIN) && waitingForData()) { // some not loaded offset was read
+			_ioContext->eof_reached = 0;
+			_ioContext->error = 0;
+			return PacketResult::Wait;
+		}
 		if (res == AVERROR_EOF) {
 			if (_audioStreamId >= 0) {
 				// queue terminating packet to audio player
@@ -535,7 +546,11 @@ void FFMpegReaderImplementation::clearPacketQueue() {
 
 int FFMpegReaderImplementation::_read(void *opaque, uint8_t *buf, int buf_size) {
 	FFMpegReaderImplementation *l = reinterpret_cast<FFMpegReaderImplementation*>(opaque);
-	return int(l->_device->read((char*)(buf), buf_size));
+	auto result = int(l->_device->read((char*)(buf), buf_size));
+	if (result < 0 && l->waitingForData()) {
+		return AVERROR(EAGAIN);
+	}
+	return result;
 }
 
 int64_t FFMpegReaderImplementation::_seek(void *opaque, int64_t offset, int whence) {
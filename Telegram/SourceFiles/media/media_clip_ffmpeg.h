@@ -35,7 +35,7 @@ namespace internal {
 
 class FFMpegReaderImplementation : public ReaderImplementation {
 public:
-	FFMpegReaderImplementation(FileLocation *location, QByteArray *data, uint64 playId);
+	FFMpegReaderImplementation(FileLocation *location, QByteArray *data, uint64 playId, const StreamingSourcePtr &streaming = StreamingSourcePtr());
 
 	ReadResult readFramesTill(int64 frameMs, uint64 systemMs) override;
 
@@ -65,6 +65,7 @@ private:
 		Ok,
 		EndOfFile,
 		Error,
+		Wait,
 	};
 	PacketResult readPacket(AVPacket *packet);
 	void processPacket(AVPacket *packet);
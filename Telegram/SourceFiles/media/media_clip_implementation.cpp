@@ -26,6 +26,16 @@ namespace Clip {
 namespace internal {
 
 void ReaderImplementation::initDevice() {
+	if (_streaming) {
+		if (!_streamingDevice) {
+			_streamingDevice = std_::make_unique<StreamingDevice>(_streaming);
+		} else if (_streamingDevice->isOpen()) {
+			_streamingDevice->close();
+		}
+		_dataSize = _streaming->size();
+		_device = _streamingDevice.get();
+		return;
+	}
 	if (_data->isEmpty()) {
 		if (_file.isOpen()) _file.close();
 		_file.setFileName(_location->name());
@@ -20,6 +20,8 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 */
 #pragma once
 
+#include "media/media_streaming.h"
+
 class FileLocation;
 
 namespace Media {
@@ -28,9 +30,10 @@ namespace internal {
 
 class ReaderImplementation {
 public:
-	ReaderImplementation(FileLocation *location, QByteArray *data)
+	ReaderImplementation(FileLocation *location, QByteArray *data, const StreamingSourcePtr &streaming = StreamingSourcePtr())
 		: _location(location)
-		, _data(data) {
+		, _data(data)
+		, _streaming(streaming) {
 	}
 	enum class Mode {
 		OnlyGifv,
@@ -42,6 +45,7 @@ public:
 		Success,
 		Error,
 		EndOfFile,
+		Wait, // the next bytes of the streaming file are not written yet
 	};
 	// Read frames till current frame will have presentation time > frameMs, systemMs = getms().
 	virtual ReadResult readFramesTill(int64 frameMs, uint64 systemMs) = 0;
@@ -65,11 +69,18 @@ public:
 		return _dataSize;
 	}
 
+	// The last read failed only because the loading file part is not written yet.
+	bool waitingForData() const {
+		return _streamingDevice && _streamingDevice->wouldBlock();
+	}
+
 protected:
 	FileLocation *_location;
 	QByteArray *_data;
 	QFile _file;
 	QBuffer _buffer;
+	StreamingSourcePtr _streaming; // the file is still loading
+	std_::unique_ptr<StreamingDevice> _streamingDevice;
 	QIODevice *_device = nullptr;
 	int64 _dataSize = 0;
 
@@ -85,7 +85,7 @@ QPixmap _prepareFrame(const FrameRequest &request, const QImage &original, bool
 
 } // namespace
 
-Reader::Reader(const FileLocation &location, const QByteArray &data, Callback &&callback, Mode mode, int64 seekMs)
+Reader::Reader(const FileLocation &location, const QByteArray &data, Callback &&callback, Mode mode, int64 seekMs, const StreamingSourcePtr &streaming)
 : _callback(std_::move(callback))
 , _mode(mode)
 , _playId(rand_value<uint64>())
@@ -106,7 +106,7 @@ Reader::Reader(const FileLocation &location, const QByteArray &data, Callback &&
 			}
 		}
 	}
-	managers.at(_threadIndex)->append(this, location, data);
+	managers.at(_threadIndex)->append(this, location, data, streaming);
 }
 
 Reader::Frame *Reader::frameToShow(int32 *index) const { // 0 means not ready
@@ -325,12 +325,13 @@ Reader::~Reader() {
 
 class ReaderPrivate {
 public:
-	ReaderPrivate(Reader *reader, const FileLocation &location, const QByteArray &data) : _interface(reader)
+	ReaderPrivate(Reader *reader, const FileLocation &location, const QByteArray &data, const StreamingSourcePtr &streaming) : _interface(reader)
 	, _mode(reader->mode())
 	, _playId(reader->playId())
 	, _seekPositionMs(reader->seekPositionMs())
-	, _data(data) {
-		if (_data.isEmpty()) {
+	, _data(data)
+	, _streaming(streaming) {
+		if (_data.isEmpty() && !_streaming) {
 			_location = std_::make_unique<FileLocation>(location);
 			if (!_location->accessEnable()) {
 				error();
@@ -341,18 +342,27 @@ public:
 	}
 
 	ProcessResult start(uint64 ms) {
+		_waitingForData = false;
 		if (!_implementation && !init()) {
+			if (_implementation && _implementation->waitingForData()) { // opened again when the next part is loaded
+				_implementation = nullptr;
+				_waitingForData = true;
+				return ProcessResult::Wait;
+			}
 			return error();
 		}
 		if (frame() && frame()->original.isNull()) {
 			auto readResult = _implementation->readFramesTill(-1, ms);
-			if (readResult == internal::ReaderImplementation::ReadResult::EndOfFile && _seekPositionMs > 0) {
+			if (readResult == internal::ReaderImplementation::ReadResult::Wait) {
+				_waitingForData = true;
+				return ProcessResult::Wait;
+			} else if (readResult == internal::ReaderImplementation::ReadResult::EndOfFile && _seekPositionMs > 0) {
 				// If seek was done to the end: try to read the first frame,
 				// get the frame size and return a black frame with that size.
 
 				auto firstFramePlayId = 0LL;
 				auto firstFramePositionMs = 0LL;
-				auto reader = std_::make_unique<internal::FFMpegReaderImplementation>(_location.get(), &_data, firstFramePlayId);
+				auto reader = std_::make_unique<internal::FFMpegReaderImplementation>(_location.get(), &_data, firstFramePlayId, _streaming);
 				if (reader->start(internal::ReaderImplementation::Mode::Normal, firstFramePositionMs)) {
 					auto firstFrameReadResult = reader->readFramesTill(-1, ms);
 					if (firstFrameReadResult == internal::ReaderImplementation::ReadResult::Success) {
@@ -405,6 +415,9 @@ public:
 			}
 		}
 
+		if (_waitingForData) { // the frame to write was taken already, read it again
+			return finishProcess(ms);
+		}
 		if (!_autoPausedGif && !_videoPausedAtMs && ms >= _nextFrameWhen) {
 			return ProcessResult::Repaint;
 		}
@@ -414,7 +427,10 @@ public:
 	ProcessResult finishProcess(uint64 ms) {
 		auto frameMs = _seekPositionMs + ms - _animationStarted;
 		auto readResult = _implementation->readFramesTill(frameMs, ms);
-		if (readResult == internal::ReaderImplementation::ReadResult::EndOfFile) {
+		_waitingForData = (readResult == internal::ReaderImplementation::ReadResult::Wait);
+		if (_waitingForData) {
+			return ProcessResult::Wait;
+		} else if (readResult == internal::ReaderImplementation::ReadResult::EndOfFile) {
 			stop();
 			_state = State::Finished;
 			return ProcessResult::Finished;
@@ -449,7 +465,7 @@ public:
 	}
 
 	bool init() {
-		if (_data.isEmpty() && QFileInfo(_location->name()).size() <= AnimationInMemory) {
+		if (_data.isEmpty() && !_streaming && QFileInfo(_location->name()).size() <= AnimationInMemory) {
 			QFile f(_location->name());
 			if (f.open(QIODevice::ReadOnly)) {
 				_data = f.readAll();
@@ -459,7 +475,7 @@ public:
 			}
 		}
 
-		_implementation = std_::make_unique<internal::FFMpegReaderImplementation>(_location.get(), &_data, _playId);
+		_implementation = std_::make_unique<internal::FFMpegReaderImplementation>(_location.get(), &_data, _playId, _streaming);
 //		_implementation = new QtGifReaderImplementation(_location, &_data);
 
 		auto implementationMode = [this]() {
@@ -526,6 +542,7 @@ private:
 
 	QByteArray _data;
 	std_::unique_ptr<FileLocation> _location;
+	StreamingSourcePtr _streaming;
 	bool _accessed = false;
 
 	QBuffer _buffer;
@@ -560,6 +577,10 @@ private:
 	bool _started = false;
 	uint64 _videoPausedAtMs = 0;
 
+	// The streaming file part is not loaded yet, the manager
+	// doesn't process this reader until some part is loaded.
+	bool _waitingForData = false;
+
 	friend class Manager;
 
 };
@@ -577,8 +598,11 @@ Manager::Manager(QThread *thread) : _processingInThread(0), _needReProcess(false
 	anim::registerClipManager(this);
 }
 
-void Manager::append(Reader *reader, const FileLocation &location, const QByteArray &data) {
-	reader->_private = new ReaderPrivate(reader, location, data);
+void Manager::append(Reader *reader, const FileLocation &location, const QByteArray &data, const StreamingSourcePtr &streaming) {
+	reader->_private = new ReaderPrivate(reader, location, data, streaming);
+	if (streaming) {
+		connect(streaming.data(), SIGNAL(loaded()), this, SLOT(onStreamingLoaded()), Qt::UniqueConnection);
+	}
 	_loadLevel.fetchAndAddRelaxed(AverageGifSize);
 	update(reader);
 }
@@ -606,6 +630,11 @@ void Manager::stop(Reader *reader) {
 	emit processDelayed();
 }
 
+void Manager::onStreamingLoaded() {
+	_streamingLoaded = true;
+	emit processDelayed();
+}
+
 bool Manager::carries(Reader *reader) const {
 	QMutexLocker lock(&_readerPointersMutex);
 	return _readerPointers.contains(reader);
@@ -757,6 +786,14 @@ void Manager::process() {
 		}
 		checkAllReaders = (_readers.size() > _readerPointers.size());
 	}
+	if (_streamingLoaded) {
+		_streamingLoaded = false;
+		for (auto i = _readers.begin(), e = _readers.end(); i != e; ++i) {
+			if (i.key()->_waitingForData) {
+				i.value() = ms;
+			}
+		}
+	}
 
 	for (auto i = _readers.begin(), e = _readers.end(); i != e;) {
 		ReaderPrivate *reader = i.key();
@@ -770,7 +807,7 @@ void Manager::process() {
 				return;
 			}
 			ms = getms();
-			if (reader->_videoPausedAtMs) {
+			if (reader->_videoPausedAtMs || reader->_waitingForData) {
 				i.value() = ms + 86400 * 1000ULL;
 			} else if (reader->_nextFrameWhen && reader->_started) {
 				i.value() = reader->_nextFrameWhen;
@@ -58,7 +58,7 @@ public:
 		Video,
 	};
 
-	Reader(const FileLocation &location, const QByteArray &data, Callback &&callback, Mode mode = Mode::Gif, int64 seekMs = 0);
+	Reader(const FileLocation &location, const QByteArray &data, Callback &&callback, Mode mode = Mode::Gif, int64 seekMs = 0, const StreamingSourcePtr &streaming = StreamingSourcePtr());
 	static void callback(Reader *reader, int threadIndex, Notification notification); // reader can be deleted
 
 	void setAutoplay() {
@@ -195,7 +195,7 @@ public:
 	int32 loadLevel() const {
 		return _loadLevel.load();
 	}
-	void append(Reader *reader, const FileLocation &location, const QByteArray &data);
+	void append(Reader *reader, const FileLocation &location, const QByteArray &data, const StreamingSourcePtr &streaming);
 	void start(Reader *reader);
 	void update(Reader *reader);
 	void stop(Reader *reader);
@@ -211,6 +211,8 @@ public slots:
 	void process();
 	void finish();
 
+	void onStreamingLoaded();
+
 private:
 
 	void clear();
@@ -238,6 +240,7 @@ private:
 	QTimer _timer;
 	QThread *_processingInThread;
 	bool _needReProcess;
+	bool _streamingLoaded = false;
 
 };
 
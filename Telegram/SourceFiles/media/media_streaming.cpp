@@ -0,0 +1,159 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#include "stdafx.h"
+#include "media/media_streaming.h"
+
+namespace Media {
+namespace {
+
+constexpr int64 kReadAhead = 512 * 1024; // written bytes after the position for a demuxer read, the largest file part
+
+} // namespace
+
+StreamingSource::StreamingSource(const QString &path, int64 size)
+: _path(path)
+, _size(size) {
+}
+
+void StreamingSource::partLoaded(int64 offset, int64 length) {
+	if (length <= 0) return;
+
+	{
+		QMutexLocker lock(&_mutex);
+		auto from = offset, till = offset + length;
+		auto i = _loaded.upperBound(from);
+		if (i != _loaded.begin()) {
+			auto prev = i - 1;
+			if (prev.value() >= from) {
+				from = prev.key();
+				till = qMax(till, prev.value());
+				i = _loaded.erase(prev);
+			}
+		}
+		while (i != _loaded.end() && i.key() <= till) {
+			till = qMax(till, i.value());
+			i = _loaded.erase(i);
+		}
+		_loaded.insert(from, till);
+	}
+	emit loaded();
+}
+
+void StreamingSource::loadFailed() {
+	{
+		QMutexLocker lock(&_mutex);
+		_failed = true;
+	}
+	emit loaded();
+}
+
+int64 StreamingSource::availableLocked(int64 offset) const {
+	if (offset >= _size) return 0;
+
+	auto i = _loaded.upperBound(offset);
+	if (i == _loaded.cbegin()) return -1;
+	--i;
+	return (i.value() > offset) ? (i.value() - offset) : -1;
+}
+
+void StreamingSource::wantLocked(int64 offset) {
+	if (_failed || _lastWanted == offset) return;
+
+	_lastWanted = offset;
+	emit wanted(offset); // queued to the loader on the main thread
+}
+
+int64 StreamingSource::available(int64 offset) {
+	QMutexLocker lock(&_mutex);
+	auto result = availableLocked(offset);
+	if (result < 0) {
+		wantLocked(offset);
+	}
+	return _failed ? -1 : result;
+}
+
+bool StreamingSource::availableAhead(int64 offset, int64 bytes) {
+	QMutexLocker lock(&_mutex);
+	auto needed = qMin(bytes, _size - offset);
+	if (needed <= 0 || _failed) return true; // let the read report the error
+
+	auto result = availableLocked(offset);
+	if (result >= needed) return true;
+
+	wantLocked(offset + qMax(result, 0LL));
+	return false;
+}
+
+bool StreamingSource::failed() const {
+	QMutexLocker lock(&_mutex);
+	return _failed;
+}
+
+StreamingSourcePtr MakeStreamingSource(const QString &path, int64 size) {
+	return StreamingSourcePtr(new StreamingSource(path, size), &QObject::deleteLater);
+}
+
+StreamingDevice::StreamingDevice(const StreamingSourcePtr &source)
+: _source(source)
+, _file(source->path()) {
+}
+
+bool StreamingDevice::open(OpenMode mode) {
+	if (mode & QIODevice::WriteOnly) {
+		return false;
+	}
+	if (!_file.open(QIODevice::ReadOnly)) {
+		LOG(("Streaming Error: could not open '%1', error %2, %3").arg(_source->path()).arg(_file.error()).arg(_file.errorString()));
+		return false;
+	}
+	return QIODevice::open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+void StreamingDevice::close() {
+	QIODevice::close();
+	_file.close();
+}
+
+bool StreamingDevice::seek(qint64 pos) {
+	if (pos < 0 || pos > size()) {
+		return false;
+	}
+	return QIODevice::seek(pos);
+}
+
+bool StreamingDevice::readyToRead() {
+	return _source->availableAhead(pos(), kReadAhead);
+}
+
+qint64 StreamingDevice::readData(char *data, qint64 maxSize) {
+	auto offset = pos();
+	auto available = _source->available(offset);
+	_wouldBlock = (available < 0) && !_source->failed();
+	if (available <= 0) {
+		return available;
+	}
+	if (!_file.seek(offset)) {
+		return -1;
+	}
+	return _file.read(data, qMin(maxSize, available));
+}
+
+} // namespace Media
@@ -0,0 +1,114 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+namespace Media {
+
+// A file that is still being downloaded, the loader reports the written
+// ranges. The readers on the other threads never wait for the network: if
+// the bytes they need are not written yet they ask the loader to fetch the
+// missing offset first and retry when loaded() is emitted.
+class StreamingSource : public QObject {
+	Q_OBJECT
+
+public:
+	StreamingSource(const QString &path, int64 size);
+
+	QString path() const {
+		return _path;
+	}
+	int64 size() const {
+		return _size;
+	}
+
+	// Called by the loader on the main thread.
+	void partLoaded(int64 offset, int64 length);
+	void loadFailed();
+
+	// Called by the readers, returns the count of bytes written from the
+	// offset, 0 at the end of file, -1 if they are not written yet or the
+	// load has failed.
+	int64 available(int64 offset);
+
+	// Called by the readers, true if bytes from the offset are written till
+	// the end of file or at least the given count of them.
+	bool availableAhead(int64 offset, int64 bytes);
+
+	bool failed() const;
+
+signals:
+	void wanted(qint64 offset);
+	void loaded(); // some part was written or the load failed
+
+private:
+	int64 availableLocked(int64 offset) const;
+	void wantLocked(int64 offset);
+
+	QString _path;
+	int64 _size;
+
+	mutable QMutex _mutex;
+	QMap<int64, int64> _loaded; // start -> end, merged
+	int64 _lastWanted = -1;
+	bool _failed = false;
+
+};
+using StreamingSourcePtr = QSharedPointer<StreamingSource>;
+StreamingSourcePtr MakeStreamingSource(const QString &path, int64 size);
+
+// Read only random access device over the partially written file, a read
+// of the bytes that are not written yet fails with wouldBlock() set.
+class StreamingDevice : public QIODevice {
+public:
+	StreamingDevice(const StreamingSourcePtr &source);
+
+	bool open(OpenMode mode) override;
+	void close() override;
+	bool isSequential() const override {
+		return false;
+	}
+	qint64 size() const override {
+		return _source->size();
+	}
+	bool seek(qint64 pos) override;
+
+	bool wouldBlock() const {
+		return _wouldBlock;
+	}
+
+	// The demuxers can't be interrupted in the middle of a packet, so they
+	// read only when enough bytes after the current position are written.
+	bool readyToRead();
+
+protected:
+	qint64 readData(char *data, qint64 maxSize) override;
+	qint64 writeData(const char *data, qint64 maxSize) override {
+		return -1;
+	}
+
+private:
+	StreamingSourcePtr _source;
+	QFile _file;
+	bool _wouldBlock = false;
+
+};
+
+} // namespace Media
@@ -1348,6 +1348,8 @@ void MediaView::initAnimation() {
 	} else if (location.accessEnable()) {
 		createClipReader();
 		location.accessDisable();
+	} else if (_doc->isVideo() && _doc->streamingSource()) {
+		createClipReader();
 	} else if (_doc->dimensions.width() && _doc->dimensions.height()) {
 		int w = _doc->dimensions.width();
 		int h = _doc->dimensions.height();
@@ -1373,9 +1375,10 @@ void MediaView::createClipReader() {
 		_current = _doc->thumb->pixNoCache(_doc->thumb->width(), _doc->thumb->height(), ImagePixSmooth | ImagePixBlurred, st::mvDocIconSize, st::mvDocIconSize);
 	}
 	auto mode = _doc->isVideo() ? Media::Clip::Reader::Mode::Video : Media::Clip::Reader::Mode::Gif;
+	auto streaming = _doc->loaded() ? Media::StreamingSourcePtr() : _doc->streamingSource();
 	_gif = std_::make_unique<Media::Clip::Reader>(_doc->location(), _doc->data(), [this](Media::Clip::Notification notification) {
 		clipCallback(notification);
-	}, mode);
+	}, mode, 0, streaming);
 
 	// Correct values will be set when gif gets inited.
 	_videoPaused = _videoIsSilent = _videoStopped = false;
@@ -1446,9 +1449,10 @@ void MediaView::restartVideoAtSeekPosition(int64 positionMs) {
 	if (_current.isNull()) {
 		_current = _gif->current(_gif->width(), _gif->height(), _gif->width(), _gif->height(), getms());
 	}
+	auto streaming = _doc->loaded() ? Media::StreamingSourcePtr() : _doc->streamingSource();
 	_gif = std_::make_unique<Media::Clip::Reader>(_doc->location(), _doc->data(), [this](Media::Clip::Notification notification) {
 		clipCallback(notification);
-	}, Media::Clip::Reader::Mode::Video, positionMs);
+	}, Media::Clip::Reader::Mode::Video, positionMs, streaming);
 
 	// Correct values will be set when gif gets inited.
 	_videoPaused = _videoIsSilent = _videoStopped = false;
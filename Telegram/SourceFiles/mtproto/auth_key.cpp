@@ -22,38 +22,226 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 
 #include "mtproto/auth_key.h"
 
-#include <openssl/aes.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/sha.h>
 
 namespace MTP {
+namespace {
 
-void aesIgeEncrypt(const void *src, void *dst, uint32 len, const void *key, const void *iv) {
-	uchar aes_key[32], aes_iv[32];
-	memcpy(aes_key, key, 32);
-	memcpy(aes_iv, iv, 32);
+constexpr uint32 kBlockSize = 16;
+constexpr uint32 kMessageHeaderSize = 8 * sizeof(mtpPrime); // salt, session_id, msg_id, seq_no, msg_len
+constexpr uint32 kHashChunkSize = 4096; // decrypted bytes hashed at once, while they are in L1
+constexpr int32 kSaltSafety = 30; // seconds before valid_until when a salt is not used any more
+constexpr int32 kSaltsPrefetch = 12 * 3600; // request more salts when the schedule ends in less than that
+constexpr int32 kSaltsRequestTimeout = 60; // seconds before the salts are requested again
+
+// A failed EVP call would leave the data not encrypted or not decrypted.
+void checkEvp(int result, const char *call) {
+	if (result <= 0) {
+		LOG(("Crypto Error: %1 failed, error %2").arg(call).arg(ERR_get_error()));
+		t_assert(!"EVP call failed");
+	}
+}
+
+inline void xorBlock(uchar *to, const uchar *a, const uchar *b) {
+	auto to64 = reinterpret_cast<uint64*>(to);
+	auto a64 = reinterpret_cast<const uint64*>(a), b64 = reinterpret_cast<const uint64*>(b);
+	to64[0] = a64[0] ^ b64[0];
+	to64[1] = a64[1] ^ b64[1];
+}
+
+// EVP does not have IGE, so only the block cipher is done by EVP in ECB
+// mode and the chaining is done here. Unlike AES_ige_encrypt(), which
+// always uses the table based AES, EVP picks AES-NI when it is available.
+// Each ECB input depends on the previous block output in both directions,
+// so the blocks can't be batched, they are passed to EVP_Cipher() which
+// skips the EVP_CipherUpdate() buffering.
+class IgeCipher {
+public:
+	IgeCipher() : _context(EVP_CIPHER_CTX_new()) {
+		t_assert(_context != nullptr);
+	}
+	IgeCipher(const IgeCipher &other) = delete;
+	IgeCipher &operator=(const IgeCipher &other) = delete;
+	~IgeCipher() {
+		EVP_CIPHER_CTX_free(_context);
+	}
+
+	void init(const void *key, const void *iv, bool encrypt) {
+		checkEvp(EVP_CipherInit_ex(_context, EVP_aes_256_ecb(), nullptr, static_cast<const uchar*>(key), nullptr, encrypt ? 1 : 0), "EVP_CipherInit_ex");
+		checkEvp(EVP_CIPHER_CTX_set_padding(_context, 0), "EVP_CIPHER_CTX_set_padding");
+		memcpy(_iv1, iv, kBlockSize);
+		memcpy(_iv2, static_cast<const uchar*>(iv) + kBlockSize, kBlockSize);
+		_encrypt = encrypt;
+	}
+
+	// len must be a multiple of the block size, src and dst may be the same
+	void process(const uchar *src, uchar *dst, uint32 len) {
+		uchar input[kBlockSize], block[kBlockSize];
+		for (uint32 i = 0; i < len; i += kBlockSize) {
+			memcpy(input, src + i, kBlockSize);
+			if (_encrypt) {
+				xorBlock(block, input, _iv1);
+				cipherBlock(block);
+				xorBlock(dst + i, block, _iv2);
+				memcpy(_iv1, dst + i, kBlockSize);
+				memcpy(_iv2, input, kBlockSize);
+			} else {
+				xorBlock(block, input, _iv2);
+				cipherBlock(block);
+				xorBlock(dst + i, block, _iv1);
+				memcpy(_iv1, input, kBlockSize);
+				memcpy(_iv2, dst + i, kBlockSize);
+			}
+		}
+	}
+
+private:
+	void cipherBlock(uchar *block) {
+		checkEvp(EVP_Cipher(_context, block, block, kBlockSize), "EVP_Cipher");
+	}
+
+	EVP_CIPHER_CTX *_context;
+	uchar _iv1[kBlockSize], _iv2[kBlockSize];
+	bool _encrypt = true;
+
+};
 
-	AES_KEY aes;
-	AES_set_encrypt_key(aes_key, 256, &aes);
-	AES_ige_encrypt(static_cast<const uchar*>(src), static_cast<uchar*>(dst), len, &aes, aes_iv, AES_ENCRYPT);
+} // namespace
+
+void aesIgeEncrypt(const void *src, void *dst, uint32 len, const void *key, const void *iv) {
+	IgeCipher cipher;
+	cipher.init(key, iv, true);
+	cipher.process(static_cast<const uchar*>(src), static_cast<uchar*>(dst), len);
 }
 
 void aesIgeDecrypt(const void *src, void *dst, uint32 len, const void *key, const void *iv) {
-	uchar aes_key[32], aes_iv[32];
-	memcpy(aes_key, key, 32);
-	memcpy(aes_iv, iv, 32);
+	IgeCipher cipher;
+	cipher.init(key, iv, false);
+	cipher.process(static_cast<const uchar*>(src), static_cast<uchar*>(dst), len);
+}
+
+struct MessageDecryptor::Impl {
+	IgeCipher cipher;
+};
+
+MessageDecryptor::MessageDecryptor() : _impl(new Impl()) {
+}
 
-	AES_KEY aes;
-	AES_set_decrypt_key(aes_key, 256, &aes);
-	AES_ige_encrypt(static_cast<const uchar*>(src), static_cast<uchar*>(dst), len, &aes, aes_iv, AES_DECRYPT);
+MessageDecryptor::~MessageDecryptor() {
 }
 
-void aesCtrEncrypt(void *data, uint32 len, const void *key, CTRState *state) {
-	AES_KEY aes;
-	AES_set_encrypt_key(static_cast<const uchar*>(key), 256, &aes);
+MessageDecryptor::Result MessageDecryptor::decrypt(void *data, uint32 len, const AuthKeyPtr &authKey, const MTPint128 &msgKey) {
+	if (len < kMessageHeaderSize || (len % kBlockSize)) {
+		return Result::BadLength;
+	}
+
+	MTPint256 aesKey, aesIV;
+	authKey->prepareAES(msgKey, aesKey, aesIV, false);
+	_impl->cipher.init(&aesKey, &aesIV, false);
+
+	auto bytes = static_cast<uchar*>(data);
+	_impl->cipher.process(bytes, bytes, kMessageHeaderSize);
+
+	uint32 msgLen = *reinterpret_cast<const uint32*>(bytes + kMessageHeaderSize - sizeof(uint32));
+	if (msgLen > len - kMessageHeaderSize || (msgLen & 0x03)) {
+		return Result::BadLength;
+	}
+
+	SHA_CTX sha;
+	SHA1_Init(&sha);
+	SHA1_Update(&sha, bytes, kMessageHeaderSize);
+
+	uint32 hashed = kMessageHeaderSize + msgLen; // the padding is not hashed
+	for (uint32 from = kMessageHeaderSize; from < len; from += kHashChunkSize) {
+		uint32 size = qMin(kHashChunkSize, len - from);
+		_impl->cipher.process(bytes + from, bytes + from, size);
+		if (from < hashed) {
+			SHA1_Update(&sha, bytes + from, qMin(size, hashed - from));
+		}
+	}
 
-	static_assert(CTRState::IvecSize == AES_BLOCK_SIZE, "Wrong size of ctr ivec!");
-	static_assert(CTRState::EcountSize == AES_BLOCK_SIZE, "Wrong size of ctr ecount!");
+	uchar sha1Buffer[20];
+	SHA1_Final(sha1Buffer, &sha);
+	return memcmp(&msgKey, sha1Buffer + 4, sizeof(msgKey)) ? Result::BadHash : Result::Good;
+}
+
+struct CTRState::Impl {
+	Impl() : context(EVP_CIPHER_CTX_new()) {
+		t_assert(context != nullptr);
+	}
+	~Impl() {
+		EVP_CIPHER_CTX_free(context);
+	}
+	EVP_CIPHER_CTX *context;
+	bool initialized = false;
+};
+
+CTRState::CTRState() : _impl(new Impl()) {
+}
+
+CTRState::~CTRState() {
+}
+
+void CTRState::init(const void *key, const void *ivec) {
+	checkEvp(EVP_EncryptInit_ex(_impl->context, EVP_aes_256_ctr(), nullptr, static_cast<const uchar*>(key), static_cast<const uchar*>(ivec)), "EVP_EncryptInit_ex");
+	_impl->initialized = true;
+}
+
+void CTRState::encrypt(void *data, uint32 len) {
+	t_assert(_impl->context != nullptr && _impl->initialized);
+
+	int outLength = 0;
+	checkEvp(EVP_EncryptUpdate(_impl->context, static_cast<uchar*>(data), &outLength, static_cast<const uchar*>(data), len), "EVP_EncryptUpdate");
+	t_assert(uint32(outLength) == len);
+}
+
+void AuthKey::setServerSalts(const ServerSalts &salts) {
+	QMutexLocker lock(&_saltsMutex);
+	_salts = salts;
+	qSort(_salts.begin(), _salts.end(), [](const ServerSalt &a, const ServerSalt &b) {
+		return a.validSince < b.validSince;
+	});
+	_saltsRequested = 0;
+}
+
+ServerSalts AuthKey::serverSalts() const {
+	QMutexLocker lock(&_saltsMutex);
+	return _salts;
+}
+
+void AuthKey::clearServerSalts() {
+	QMutexLocker lock(&_saltsMutex);
+	_salts.clear();
+}
+
+uint64 AuthKey::serverSalt(int32 now, uint64 current) const {
+	QMutexLocker lock(&_saltsMutex);
+	uint64 scheduled = 0;
+	for_const (auto &salt, _salts) {
+		if (salt.validSince > now) break;
+		if (salt.validUntil <= now + kSaltSafety) continue;
+		if (salt.salt == current) return current;
+		if (!scheduled) scheduled = salt.salt;
+	}
+	return scheduled ? scheduled : current;
+}
+
+int32 AuthKey::serverSaltValidUntil(uint64 salt) const {
+	QMutexLocker lock(&_saltsMutex);
+	for_const (auto &entry, _salts) {
+		if (entry.salt == salt) return entry.validUntil;
+	}
+	return 0;
+}
 
-	AES_ctr128_encrypt(static_cast<const uchar*>(data), static_cast<uchar*>(data), len, &aes, state->ivec, state->ecount, &state->num);
+bool AuthKey::needServerSalts(int32 now) {
+	QMutexLocker lock(&_saltsMutex);
+	if (!_salts.isEmpty() && _salts.back().validUntil > now + kSaltsPrefetch) return false;
+	if (_saltsRequested && _saltsRequested + kSaltsRequestTimeout > now) return false;
+	_saltsRequested = now;
+	return true;
 }
 
 } // namespace MTP
@@ -22,6 +22,13 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 
 namespace MTP {
 
+struct ServerSalt {
+	int32 validSince = 0;
+	int32 validUntil = 0;
+	uint64 salt = 0;
+};
+using ServerSalts = QVector<ServerSalt>; // sorted by validSince
+
 class AuthKey {
 public:
 
@@ -94,6 +101,22 @@ public:
 		to.writeRawData(_key, 256);
 	}
 
+	// server salts from get_future_salts, they are bound to the key and
+	// shared by all its sessions, persisted together with the key
+	void setServerSalts(const ServerSalts &salts);
+	ServerSalts serverSalts() const;
+	void clearServerSalts();
+
+	// the salt to send with at unixtime now: current if it is still valid by
+	// the schedule (or there is no schedule), else the scheduled one
+	uint64 serverSalt(int32 now, uint64 current) const;
+
+	// valid_until of the salt by the schedule, 0 if it is not in the schedule
+	int32 serverSaltValidUntil(uint64 salt) const;
+
+	// true if the schedule ends soon and nobody has asked for more recently
+	bool needServerSalts(int32 now);
+
 	static const uint64 RecreateKeyId = 0xFFFFFFFFFFFFFFFFL;
 
 	friend bool operator==(const AuthKey &a, const AuthKey &b);
@@ -105,6 +128,10 @@ private:
 	bool _isset;
 	uint32 _dc;
 
+	mutable QMutex _saltsMutex;
+	ServerSalts _salts;
+	int32 _saltsRequested = 0;
+
 };
 
 inline bool operator==(const AuthKey &a, const AuthKey &b) {
@@ -145,16 +172,47 @@ inline void aesDecryptLocal(const void *src, void *dst, uint32 len, const AuthKe
 	return aesIgeDecrypt(src, dst, len, static_cast<const void*>(&aesKey), static_cast<const void*>(&aesIV));
 }
 
-// ctr used inplace, encrypt the data and leave it at the same place
-struct CTRState {
+// Decrypts the received messages in place and checks their msg_key.
+//
+// One object is used for all the packets received in one pass, so the
+// cipher context is allocated once and only the key schedule is done for
+// each message. The SHA1 of the message is computed chunk by chunk while
+// decrypting, when the decrypted data is still in the cache.
+class MessageDecryptor {
+public:
+	MessageDecryptor();
+	~MessageDecryptor();
+
+	enum class Result {
+		Good,
+		BadLength, // msg_len does not fit the packet
+		BadHash, // msg_key is not the SHA1 of the decrypted message
+	};
+	Result decrypt(void *data, uint32 len, const AuthKeyPtr &authKey, const MTPint128 &msgKey);
+
+private:
+	struct Impl;
+	std_::unique_ptr<Impl> _impl;
+
+};
+
+// ctr used inplace, encrypt the data and leave it at the same place,
+// the key schedule is done once in init() for the whole stream
+class CTRState {
+public:
 	static constexpr int KeySize = 32;
 	static constexpr int IvecSize = 16;
-	static constexpr int EcountSize = 16;
 
-	uchar ivec[IvecSize] = { 0 };
-	uint32 num = 0;
-	uchar ecount[EcountSize] = { 0 };
+	CTRState();
+	~CTRState();
+
+	void init(const void *key, const void *ivec);
+	void encrypt(void *data, uint32 len);
+
+private:
+	struct Impl;
+	std_::unique_ptr<Impl> _impl;
+
 };
-void aesCtrEncrypt(void *data, uint32 len, const void *key, CTRState *state);
 
 } // namespace MTP
@@ -0,0 +1,218 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#include "stdafx.h"
+
+#include "mtproto/bandwidth_governor.h"
+
+namespace MTP {
+namespace {
+
+constexpr uint64 kInteractiveTimeout = 1000; // ms, the chats are active if their traffic was seen so recently
+constexpr uint64 kTransferTimeout = 2000; // ms, a transfer that didn't ask for so long doesn't take part in the sharing
+constexpr uint64 kForgetTimeout = 60000; // ms, a transfer that didn't ask for so long is forgotten
+constexpr uint64 kMaxWait = 1000; // ms, the transfers ask again at least once a second
+constexpr uint64 kCleanupTimeout = 1000; // ms, forgotten transfers are removed so often
+constexpr int64 kBurstTime = 1000; // ms of the cap that can be spent at once after a pause
+constexpr int64 kFairQuantum = 512 * 1024; // bytes a transfer can be ahead of the waiting ones, the largest file part
+constexpr uint64 kMeasureWindow = 1000; // ms, the throughput of the transfers is measured over such windows
+constexpr int64 kMeasureDecay = 8; // a slower window moves the measured rate by 1/8 of the difference, a faster one replaces it
+constexpr uint64 kMeasureTimeout = 60000; // ms, the measured rate is forgotten if it was not updated for so long
+
+struct Transfer {
+	int64 given = 0; // bytes given, moved forward when the transfer starts or comes back after a pause
+	uint64 asked = 0;
+	bool waiting = false;
+};
+
+struct Bucket {
+	int64 tokens = 0;
+	uint64 updated = 0;
+	uint64 interactiveAt = 0;
+
+	uint64 cleaned = 0;
+
+	QMap<uint64, Transfer> transfers;
+
+	// the throughput of the transfers while nothing limited them, it is used
+	// instead of the cap to leave the reserve to the chats if there is no cap
+	uint64 windowStart = 0;
+	int64 windowBytes = 0;
+	bool windowLimited = false;
+	int64 measured = 0; // bytes per second
+	uint64 measuredAt = 0;
+
+	int64 transfersBytes = 0, interactiveBytes = 0;
+	int64 delays = 0;
+};
+
+QMutex BucketsMutex;
+Bucket Buckets[2];
+
+Bucket &bucket(BandwidthGovernor::Direction direction) {
+	return Buckets[(direction == BandwidthGovernor::Direction::Upload) ? 1 : 0];
+}
+
+int64 rate(const Bucket &b, BandwidthGovernor::Direction direction, uint64 ms) { // bytes per second, 0 - no cap
+	int64 result = int64((direction == BandwidthGovernor::Direction::Upload) ? cMaxUploadRate() : cMaxDownloadRate()) * 1024;
+	bool chats = (b.interactiveAt > 0 && ms < b.interactiveAt + kInteractiveTimeout);
+	if (!chats) return result;
+
+	if (!result && b.measuredAt && ms < b.measuredAt + kMeasureTimeout) {
+		result = b.measured;
+	}
+	return result * (100 - cInteractiveReserve()) / 100;
+}
+
+// called with the bytes given to the transfers, limited - if the rate was not 0
+void measure(Bucket &b, int64 bytes, uint64 ms, bool limited) {
+	if (ms >= b.windowStart + kMeasureWindow) {
+		// the windows with a pause of the transfers or with a limit don't tell the link capacity
+		if (b.windowStart && !b.windowLimited && ms < b.windowStart + 2 * kMeasureWindow) {
+			auto windowRate = b.windowBytes * 1000 / int64(ms - b.windowStart);
+			if (windowRate > b.measured || ms >= b.measuredAt + kMeasureTimeout) {
+				b.measured = windowRate;
+			} else {
+				b.measured -= (b.measured - windowRate) / kMeasureDecay;
+			}
+			b.measuredAt = ms;
+		}
+		b.windowStart = ms;
+		b.windowBytes = 0;
+		b.windowLimited = false;
+	}
+	b.windowBytes += bytes;
+	if (limited) b.windowLimited = true;
+}
+
+void refill(Bucket &b, int64 rate, uint64 ms) {
+	if (!rate) {
+		b.tokens = 0;
+	} else if (ms > b.updated) {
+		b.tokens = qMin(b.tokens + rate * int64(ms - b.updated) / 1000, rate * kBurstTime / 1000);
+	}
+	b.updated = ms;
+}
+
+void count(Bucket &b, int64 bytes, uint64 ms) {
+	if (ms >= b.cleaned + kCleanupTimeout) {
+		b.cleaned = ms;
+		for (auto i = b.transfers.begin(); i != b.transfers.end();) {
+			if (ms >= i->asked + kForgetTimeout) {
+				i = b.transfers.erase(i);
+			} else {
+				++i;
+			}
+		}
+	}
+	b.tokens -= bytes;
+}
+
+// the least given bytes of the other transfers that are running
+int64 minGiven(const Bucket &b, uint64 transfer, uint64 ms, bool waitingOnly) {
+	int64 result = std::numeric_limits<int64>::max();
+	for (auto i = b.transfers.cbegin(), e = b.transfers.cend(); i != e; ++i) {
+		if (i.key() == transfer || ms >= i->asked + kTransferTimeout) continue;
+		if (waitingOnly && !i->waiting) continue;
+		accumulate_min(result, i->given);
+	}
+	return result;
+}
+
+} // namespace
+
+uint64 BandwidthGovernor::acquire(Direction direction, uint64 transfer, int32 bytes) {
+	QMutexLocker lock(&BucketsMutex);
+	auto &b = bucket(direction);
+	auto ms = getms(true);
+	auto r = rate(b, direction, ms);
+	refill(b, r, ms);
+
+	auto &t = b.transfers[transfer];
+	if (!t.asked || ms >= t.asked + kTransferTimeout) { // no credit for the time it was not running
+		auto others = minGiven(b, transfer, ms, false);
+		if (others != std::numeric_limits<int64>::max()) {
+			accumulate_max(t.given, others);
+		}
+	}
+	t.asked = ms;
+
+	if (r) {
+		uint64 wait = 0;
+		if (b.tokens < 0) {
+			wait = uint64(-b.tokens * 1000 / r) + 1;
+		} else {
+			auto waiting = minGiven(b, transfer, ms, true);
+			if (waiting != std::numeric_limits<int64>::max() && t.given > waiting + kFairQuantum) {
+				wait = uint64(kFairQuantum * 1000 / r) + 1; // let the ones behind catch up
+			}
+		}
+		if (wait) {
+			t.waiting = true;
+			++b.delays;
+			return qMin(wait, kMaxWait);
+		}
+	}
+	t.waiting = false;
+	t.given += bytes;
+	b.transfersBytes += bytes;
+	count(b, bytes, ms);
+	measure(b, bytes, ms, r != 0);
+	return 0;
+}
+
+void BandwidthGovernor::refund(Direction direction, uint64 transfer, int32 bytes) {
+	if (bytes <= 0) return;
+
+	QMutexLocker lock(&BucketsMutex);
+	auto &b = bucket(direction);
+	auto i = b.transfers.find(transfer);
+	if (i != b.transfers.end()) {
+		i->given -= bytes;
+	}
+	b.transfersBytes -= bytes;
+	b.tokens += bytes; // not above the burst, refill() caps it next time
+}
+
+void BandwidthGovernor::finished(Direction direction, uint64 transfer) {
+	QMutexLocker lock(&BucketsMutex);
+	bucket(direction).transfers.remove(transfer);
+}
+
+void BandwidthGovernor::interactive(Direction direction, int32 bytes) {
+	QMutexLocker lock(&BucketsMutex);
+	auto &b = bucket(direction);
+	auto ms = getms(true);
+	b.interactiveAt = ms;
+	b.interactiveBytes += bytes;
+	count(b, bytes, ms);
+}
+
+void BandwidthGovernor::logStats() {
+	QMutexLocker lock(&BucketsMutex);
+	for (int i = 0; i < 2; ++i) {
+		const auto &b = Buckets[i];
+		if (!b.transfersBytes && !b.interactiveBytes) continue;
+
+		DEBUG_LOG(("MTP Info: %1 bandwidth, transfers %2 bytes, interactive %3 bytes, transfers delayed %4 times, measured %5 bytes per second").arg(i ? "upload" : "download").arg(b.transfersBytes).arg(b.interactiveBytes).arg(b.delays).arg(b.measured));
+	}
+}
+
+} // namespace MTP
@@ -0,0 +1,55 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+#include "mtproto/core_types.h"
+
+namespace MTP {
+
+// Token buckets shared by everything that moves a lot of bytes: file uploads,
+// file downloads and web loads. Each of them asks for the bytes of its next
+// part and waits the returned time if the bucket is empty. The transfers that
+// wait share the bucket fairly: the one which was given the least bytes goes
+// first, so a large upload can't take all the bandwidth from a small one.
+//
+// The interactive traffic of the main sessions is never delayed, it is only
+// counted. While it is running the transfers leave a part of the configured
+// cap to it. Without a cap they leave a part of their throughput measured
+// while nothing limited them, the peak of the recent one second windows, and
+// until it is measured they are not limited at all.
+class BandwidthGovernor {
+public:
+	enum class Direction {
+		Download,
+		Upload,
+	};
+
+	// returns 0 if the bytes can be transferred now, otherwise ms to wait and ask again
+	static uint64 acquire(Direction direction, uint64 transfer, int32 bytes);
+	static void refund(Direction direction, uint64 transfer, int32 bytes); // acquired, but not transferred
+	static void finished(Direction direction, uint64 transfer); // the transfer is completed or cancelled
+	static void interactive(Direction direction, int32 bytes); // can be called from any thread
+
+	static void logStats();
+
+};
+
+} // namespace MTP
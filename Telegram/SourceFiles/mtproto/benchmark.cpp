@@ -0,0 +1,572 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#include "stdafx.h"
+
+#include "mtproto/benchmark.h"
+
+#include "mtproto/auth_key.h"
+#include "mtproto/file_sessions.h"
+#include "mtproto/request_registry.h"
+
+#include <openssl/aes.h>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else // Q_OS_WIN
+#include <sys/resource.h>
+#endif // Q_OS_WIN
+
+namespace MTP {
+namespace {
+
+constexpr int32 kHistoryLimit = 100; // messages in one getHistory slice
+constexpr int kHistoryPipeline = 4; // getHistory requests in flight
+constexpr int32 kFilePartSize = 128 * 1024;
+constexpr int kFilePartsPipeline = 16; // getFile requests in flight
+constexpr int kTimeout = 30000; // ms without any progress before the scenario is abandoned
+constexpr uint32 kCryptoBytes = 64 * 1024 * 1024; // bytes processed by each crypto path
+constexpr uint32 kCtrChunkSize = 16 * 1024; // about one socket read
+constexpr int kRegistryRequests = 50000; // requests in flight at once
+constexpr int kRegistryThreads = 4; // like the main thread and a few sessions threads
+constexpr int kRegistryLookups = 4; // dc and request lookups of each request while it is sent
+
+int64 processCpuMs() {
+#ifdef Q_OS_WIN
+	FILETIME creation, exit, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0;
+	auto ticks = [](const FILETIME &time) {
+		return (int64(time.dwHighDateTime) << 32) | int64(time.dwLowDateTime);
+	};
+	return (ticks(kernel) + ticks(user)) / 10000; // 100ns ticks
+#else // Q_OS_WIN
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage)) return 0;
+	return int64(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+#endif // Q_OS_WIN
+}
+
+uint64 percentile(QVector<uint64> sorted, int percent) {
+	if (sorted.isEmpty()) return 0;
+	return sorted.at(qMin((sorted.size() * percent) / 100, sorted.size() - 1));
+}
+
+float64 megabytesPerSecond(uint64 bytes, uint64 ms) {
+	return (bytes / float64(1024 * 1024)) * 1000. / qMax(ms, uint64(1));
+}
+
+// the OpenSSL calls used before MessageDecryptor and CTRState, kept to compare with
+void legacyIgeDecrypt(const void *src, void *dst, uint32 len, const void *key, const void *iv) {
+	uchar aes_key[32], aes_iv[32];
+	memcpy(aes_key, key, 32);
+	memcpy(aes_iv, iv, 32);
+
+	AES_KEY aes;
+	AES_set_decrypt_key(aes_key, 256, &aes);
+	AES_ige_encrypt(static_cast<const uchar*>(src), static_cast<uchar*>(dst), len, &aes, aes_iv, AES_DECRYPT);
+}
+
+bool legacyDecryptMessage(void *data, uint32 len, const AuthKeyPtr &authKey, const MTPint128 &msgKey) {
+	MTPint256 aesKey, aesIV;
+	authKey->prepareAES(msgKey, aesKey, aesIV, false);
+	legacyIgeDecrypt(data, data, len, &aesKey, &aesIV);
+
+	uint32 msgLen = static_cast<const uint32*>(data)[7];
+	if (len < msgLen + 8 * sizeof(mtpPrime)) return false;
+
+	uchar sha1Buffer[20];
+	return !memcmp(&msgKey, hashSha1(data, msgLen + 8 * sizeof(mtpPrime), sha1Buffer) + 1, sizeof(msgKey));
+}
+
+void legacyCtrEncrypt(void *data, uint32 len, const void *key, uchar *ivec, uchar *ecount, uint32 *num) {
+	AES_KEY aes;
+	AES_set_encrypt_key(static_cast<const uchar*>(key), 256, &aes);
+	AES_ctr128_encrypt(static_cast<const uchar*>(data), static_cast<uchar*>(data), len, &aes, ivec, ecount, num);
+}
+
+void benchmarkMessageDecrypt(uint32 size) {
+	AuthKeyPtr key(new AuthKey());
+	uchar keyData[256];
+	memset_rand(keyData, sizeof(keyData));
+	key->setKey(keyData);
+
+	// a message like the server sends: header, body and no padding
+	QByteArray plain(size, Qt::Uninitialized), encrypted(size, Qt::Uninitialized), work(size, Qt::Uninitialized);
+	memset_rand(plain.data(), size);
+	reinterpret_cast<uint32*>(plain.data())[7] = size - 8 * sizeof(mtpPrime);
+
+	uchar sha1Buffer[20];
+	MTPint128 msgKey(*reinterpret_cast<const MTPint128*>(hashSha1(plain.constData(), size, sha1Buffer) + 1));
+	aesEncryptLocal(plain.constData(), encrypted.data(), size, key.data(), &msgKey);
+
+	uint32 count = qMax(kCryptoBytes / size, 1U);
+	bool good = true;
+
+	uint64 legacyStart = getms(true);
+	for (uint32 i = 0; i < count; ++i) {
+		memcpy(work.data(), encrypted.constData(), size);
+		good = legacyDecryptMessage(work.data(), size, key, msgKey) && good;
+	}
+	uint64 legacyMs = getms(true) - legacyStart;
+	good = good && (work == plain);
+
+	MessageDecryptor decryptor;
+	uint64 fusedStart = getms(true);
+	for (uint32 i = 0; i < count; ++i) {
+		memcpy(work.data(), encrypted.constData(), size);
+		good = (decryptor.decrypt(work.data(), size, key, msgKey) == MessageDecryptor::Result::Good) && good;
+	}
+	uint64 fusedMs = getms(true) - fusedStart;
+	good = good && (work == plain);
+
+	LOG(("Benchmark: crypto - message decrypt and msg_key check, %1 byte messages: AES_ige_encrypt %2 MB/s, EVP fused %3 MB/s%4"
+		).arg(size
+		).arg(megabytesPerSecond(uint64(count) * size, legacyMs), 0, 'f', 1
+		).arg(megabytesPerSecond(uint64(count) * size, fusedMs), 0, 'f', 1
+		).arg(good ? QString() : qsl(", RESULTS DIFFER!")));
+}
+
+void benchmarkCtr() {
+	uchar key[CTRState::KeySize], ivec[CTRState::IvecSize];
+	memset_rand(key, sizeof(key));
+	memset_rand(ivec, sizeof(ivec));
+
+	QByteArray legacy(kCryptoBytes, 0), evp(kCryptoBytes, 0);
+
+	uchar legacyIvec[AES_BLOCK_SIZE], legacyEcount[AES_BLOCK_SIZE] = { 0 };
+	uint32 legacyNum = 0;
+	memcpy(legacyIvec, ivec, sizeof(legacyIvec));
+	uint64 legacyStart = getms(true);
+	for (uint32 from = 0; from < kCryptoBytes; from += kCtrChunkSize) {
+		legacyCtrEncrypt(legacy.data() + from, kCtrChunkSize, key, legacyIvec, legacyEcount, &legacyNum);
+	}
+	uint64 legacyMs = getms(true) - legacyStart;
+
+	CTRState state;
+	state.init(key, ivec);
+	uint64 evpStart = getms(true);
+	for (uint32 from = 0; from < kCryptoBytes; from += kCtrChunkSize) {
+		state.encrypt(evp.data() + from, kCtrChunkSize);
+	}
+	uint64 evpMs = getms(true) - evpStart;
+
+	LOG(("Benchmark: crypto - obfuscation ctr, %1 byte reads: AES_ctr128_encrypt %2 MB/s, EVP %3 MB/s%4"
+		).arg(kCtrChunkSize
+		).arg(megabytesPerSecond(kCryptoBytes, legacyMs), 0, 'f', 1
+		).arg(megabytesPerSecond(kCryptoBytes, evpMs), 0, 'f', 1
+		).arg((legacy == evp) ? QString() : qsl(", RESULTS DIFFER!")));
+}
+
+// the facade maps used before RequestRegistry, kept to compare with
+class LegacyRegistry {
+public:
+	void store(mtpRequestId requestId, const mtpRequest &request, const RPCResponseHandler &handler) {
+		{
+			QMutexLocker locker(&_parserMapLock);
+			_parserMap.insert(requestId, handler);
+		}
+		QWriteLocker locker(&_requestMapLock);
+		_requestMap.insert(requestId, request);
+	}
+	void setDc(mtpRequestId requestId, int32 dcWithShift) {
+		QMutexLocker locker(&_requestByDCLock);
+		_requestsByDC.insert(requestId, dcWithShift);
+	}
+	int32 dc(mtpRequestId requestId) const {
+		QMutexLocker locker(&_requestByDCLock);
+		return _requestsByDC.value(requestId);
+	}
+	mtpRequest request(mtpRequestId requestId) const {
+		QReadLocker locker(&_requestMapLock);
+		return _requestMap.value(requestId);
+	}
+	bool takeHandler(mtpRequestId requestId, RPCResponseHandler *handler) {
+		QMutexLocker locker(&_parserMapLock);
+		auto i = _parserMap.find(requestId);
+		if (i == _parserMap.end()) return false;
+		*handler = i.value();
+		_parserMap.erase(i);
+		return true;
+	}
+	void unregister(mtpRequestId requestId) {
+		{
+			QWriteLocker locker(&_requestMapLock);
+			_requestMap.remove(requestId);
+		}
+		QMutexLocker locker(&_requestByDCLock);
+		_requestsByDC.remove(requestId);
+	}
+
+private:
+	QMap<mtpRequestId, int32> _requestsByDC;
+	mutable QMutex _requestByDCLock;
+	QMap<mtpRequestId, RPCResponseHandler> _parserMap;
+	QMutex _parserMapLock;
+	QMap<mtpRequestId, mtpRequest> _requestMap;
+	mutable QReadWriteLock _requestMapLock;
+
+};
+
+void registryDone() {
+}
+
+// the life of a request in the facade: stored, sent to a dc, looked up
+// while it is resent or acked, completed with its handler and forgotten
+template <typename Registry>
+class RegistryThread : public QThread {
+public:
+	RegistryThread(Registry &registry, mtpRequestId from, mtpRequestId till) : _registry(registry), _from(from), _till(till) {
+	}
+	bool good() const {
+		return _good;
+	}
+
+protected:
+	void run() override {
+		mtpRequest request = mtpRequestData::prepare(8);
+		RPCResponseHandler handler(rpcDone(&registryDone), RPCFailHandlerPtr());
+		for (mtpRequestId requestId = _from; requestId < _till; ++requestId) {
+			_registry.store(requestId, request, handler);
+			_registry.setDc(requestId, (requestId % 5) + 1);
+		}
+		for (int i = 0; i < kRegistryLookups; ++i) {
+			for (mtpRequestId requestId = _from; requestId < _till; ++requestId) {
+				_good = (_registry.dc(requestId) == (requestId % 5) + 1) && _registry.request(requestId) && _good;
+			}
+		}
+		for (mtpRequestId requestId = _from; requestId < _till; ++requestId) {
+			RPCResponseHandler h;
+			_good = _registry.takeHandler(requestId, &h) && _good;
+			_registry.unregister(requestId);
+		}
+	}
+
+private:
+	Registry &_registry;
+	mtpRequestId _from, _till;
+	bool _good = true;
+
+};
+
+template <typename Registry>
+uint64 benchmarkRegistryRun(Registry &registry, bool *good) {
+	QVector<RegistryThread<Registry>*> threads;
+	auto perThread = kRegistryRequests / kRegistryThreads;
+	for (int i = 0; i < kRegistryThreads; ++i) {
+		threads.push_back(new RegistryThread<Registry>(registry, 1 + i * perThread, 1 + (i + 1) * perThread));
+	}
+	uint64 started = getms(true);
+	for_const (auto thread, threads) {
+		thread->start();
+	}
+	for_const (auto thread, threads) {
+		thread->wait();
+		*good = thread->good() && *good;
+		delete thread;
+	}
+	return getms(true) - started;
+}
+
+void benchmarkRegistry() {
+	bool good = true;
+
+	LegacyRegistry legacy;
+	uint64 legacyMs = benchmarkRegistryRun(legacy, &good);
+
+	internal::RequestRegistry sharded;
+	uint64 shardedMs = benchmarkRegistryRun(sharded, &good);
+	good = good && !sharded.size();
+
+	auto operations = float64(kRegistryRequests) * (4 + 2 * kRegistryLookups);
+	auto perSecond = [operations](uint64 ms) {
+		return operations * 1000. / qMax(ms, uint64(1));
+	};
+	LOG(("Benchmark: registry - %1 requests in flight from %2 threads: locked maps %3 ms (%4 ops/s), sharded registry %5 ms (%6 ops/s)%7"
+		).arg(kRegistryRequests
+		).arg(kRegistryThreads
+		).arg(legacyMs
+		).arg(perSecond(legacyMs), 0, 'f', 0
+		).arg(shardedMs
+		).arg(perSecond(shardedMs), 0, 'f', 0
+		).arg(good ? QString() : qsl(", LOOKUPS FAILED!")));
+}
+
+} // namespace
+
+void Benchmark::start() {
+	if (cBenchmark().isEmpty()) return;
+
+	QList<Scenario> scenarios;
+	auto names = cBenchmark().split(',', QString::SkipEmptyParts);
+	for_const (auto &scenario, names) {
+		auto name = scenario.trimmed().toLower();
+		if (name == qstr("updates") || name == qstr("all")) scenarios.push_back(Scenario::Updates);
+		if (name == qstr("history") || name == qstr("all")) scenarios.push_back(Scenario::History);
+		if (name == qstr("download") || name == qstr("all")) scenarios.push_back(Scenario::Download);
+		if (name == qstr("crypto") || name == qstr("all")) scenarios.push_back(Scenario::Crypto);
+		if (name == qstr("registry") || name == qstr("all")) scenarios.push_back(Scenario::Registry);
+	}
+	if (scenarios.isEmpty()) {
+		LOG(("Benchmark Error: unknown scenarios '%1', use updates, history, download, crypto, registry or all").arg(cBenchmark()));
+		return;
+	}
+	if (!cFakeDcPort() && !offlineOnly(scenarios)) {
+		LOG(("Benchmark Error: the network scenarios work only with -fakedc <port>"));
+		return;
+	}
+	new Benchmark(scenarios);
+}
+
+Benchmark::Benchmark(const QList<Scenario> &scenarios) : QObject(QCoreApplication::instance())
+, _scenarios(scenarios) {
+	_timeout.setSingleShot(true);
+	connect(&_timeout, SIGNAL(timeout()), this, SLOT(onTimeout()));
+
+	if (offlineOnly(_scenarios)) {
+		QTimer::singleShot(0, this, SLOT(onTimeout()));
+		return;
+	}
+
+	// the first request waits for the auth key creation, it is not measured
+	LOG(("Benchmark: waiting for the connection..."));
+	send(MTPhelp_GetNearestDc(), rpcDone(&Benchmark::warmedUp), rpcFail(&Benchmark::failed));
+}
+
+bool Benchmark::offlineOnly(const QList<Scenario> &scenarios) {
+	for_const (auto scenario, scenarios) {
+		if (scenario != Scenario::Crypto && scenario != Scenario::Registry) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void Benchmark::warmedUp() {
+	startNext();
+}
+
+void Benchmark::startNext() {
+	_timeout.stop();
+	_running = false;
+	for (auto i = _sent.cbegin(), e = _sent.cend(); i != e; ++i) {
+		cancel(i.key());
+	}
+	_sent.clear();
+	_latencies.clear();
+	_bytes = _items = _itemsExpected = 0;
+
+	if (_scenarios.isEmpty()) {
+		LOG(("Benchmark: finished."));
+		App::quit();
+		return;
+	}
+
+	_current = _scenarios.takeFirst();
+	_running = true;
+	_started = getms(true);
+	_cpuStarted = processCpuMs();
+	_timeout.start(kTimeout);
+
+	switch (_current) {
+	case Scenario::Updates: {
+		setGlobalDoneHandler(rpcDone(&Benchmark::updateReceived));
+		_sent.insert(send(MTPupdates_GetState(), rpcDone(&Benchmark::updatesState), rpcFail(&Benchmark::failed)), getms(true));
+	} break;
+
+	case Scenario::History: {
+		_historyOffsetId = 0;
+		sendHistory();
+	} break;
+
+	case Scenario::Download: {
+		_fileOffset = 0;
+		_fileFinished = false;
+		for (int i = 0; i < kFilePartsPipeline; ++i) {
+			sendFilePart();
+		}
+	} break;
+
+	case Scenario::Crypto: {
+		benchmarkMessageDecrypt(1024);
+		benchmarkMessageDecrypt(128 * 1024);
+		benchmarkCtr();
+		_running = false;
+		QTimer::singleShot(0, this, SLOT(onTimeout()));
+	} break;
+
+	case Scenario::Registry: {
+		benchmarkRegistry();
+		_running = false;
+		QTimer::singleShot(0, this, SLOT(onTimeout()));
+	} break;
+
+	}
+}
+
+void Benchmark::finish(int64 items, const char *itemsName) {
+	if (!_running) return;
+	_running = false;
+
+	auto ms = qMax(getms(true) - _started, uint64(1));
+	auto cpu = processCpuMs() - _cpuStarted;
+	auto megabytes = qMax(_bytes / float64(1024 * 1024), 0.001);
+	qSort(_latencies);
+
+	const char *name = (_current == Scenario::Updates) ? "updates" : (_current == Scenario::History) ? "history" : "download";
+	LOG(("Benchmark: %1 - %2 %3 in %4 ms, %5 %3/s, %6 MB/s, latency p50 %7 ms, p99 %8 ms, cpu %9 ms, %10 cpu ms/MB"
+		).arg(name
+		).arg(items
+		).arg(itemsName
+		).arg(ms
+		).arg(int64(items * 1000 / ms)
+		).arg(megabytes * 1000. / ms, 0, 'f', 2
+		).arg(percentile(_latencies, 50)
+		).arg(percentile(_latencies, 99)
+		).arg(cpu
+		).arg(cpu / megabytes, 0, 'f', 1));
+
+	if (_current == Scenario::Updates) {
+		setGlobalDoneHandler(RPCDoneHandlerPtr());
+	}
+	QTimer::singleShot(0, this, SLOT(onTimeout()));
+}
+
+void Benchmark::onTimeout() {
+	if (_running) {
+		LOG(("Benchmark Error: no progress in %1 ms, scenario abandoned").arg(kTimeout));
+	}
+	startNext();
+}
+
+void Benchmark::requestDone(mtpRequestId requestId, int64 bytes) {
+	auto i = _sent.find(requestId);
+	if (i != _sent.end()) {
+		_latencies.push_back(getms(true) - i.value());
+		_sent.erase(i);
+	}
+	_bytes += bytes;
+	_timeout.start(kTimeout);
+}
+
+void Benchmark::updatesState(const MTPupdates_State &result, mtpRequestId requestId) {
+	if (!_running || _current != Scenario::Updates) return;
+
+	// FakeDc reports the count of the updates it is going to push in unread_count
+	_itemsExpected = result.c_updates_state().vunread_count.v;
+	requestDone(requestId, 0);
+	if (_items >= _itemsExpected) {
+		finish(_items, "updates");
+	}
+}
+
+void Benchmark::updateReceived(const mtpPrime *from, const mtpPrime *end) {
+	if (!_running || _current != Scenario::Updates) return;
+
+	_bytes += (end - from) * sizeof(mtpPrime);
+	_timeout.start(kTimeout);
+	if (++_items >= _itemsExpected && _itemsExpected > 0) {
+		finish(_items, "updates");
+	}
+}
+
+void Benchmark::sendHistory() {
+	auto peer = MTP_inputPeerUser(MTP_int(0), MTP_long(0)); // FakeDc serves the same chat for any peer
+	auto request = MTPmessages_GetHistory(peer, MTP_int(_historyOffsetId), MTP_int(0), MTP_int(0), MTP_int(kHistoryLimit), MTP_int(0), MTP_int(0));
+	_sent.insert(send(request, rpcDone(&Benchmark::historyDone), rpcFail(&Benchmark::failed)), getms(true));
+
+	// after the first slice the ids are sequential, so the next offsets are known without waiting for the answers
+	if (_historyOffsetId > 0) {
+		_historyOffsetId -= kHistoryLimit;
+	}
+}
+
+void Benchmark::historyDone(const MTPmessages_Messages &result, mtpRequestId requestId) {
+	if (!_running || _current != Scenario::History) return;
+
+	int32 count = 0, total = 0;
+	switch (result.type()) {
+	case mtpc_messages_messages: count = result.c_messages_messages().vmessages.c_vector().v.size(); break;
+	case mtpc_messages_messagesSlice: {
+		auto &d(result.c_messages_messagesSlice());
+		count = d.vmessages.c_vector().v.size();
+		total = d.vcount.v;
+	} break;
+	case mtpc_messages_channelMessages: count = result.c_messages_channelMessages().vmessages.c_vector().v.size(); break;
+	}
+	if (!_historyOffsetId && total > count) {
+		_historyOffsetId = total + 1 - kHistoryLimit; // FakeDc message ids are 1..total
+	}
+	_items += count;
+	requestDone(requestId, result.innerLength());
+
+	if (!count || _historyOffsetId <= 1) {
+		if (_sent.isEmpty()) {
+			finish(_items, "messages");
+		}
+		return;
+	}
+	while (_sent.size() < kHistoryPipeline && _historyOffsetId > 1) {
+		sendHistory();
+	}
+}
+
+void Benchmark::sendFilePart() {
+	if (_fileFinished) return;
+
+	auto index = (_fileOffset / kFilePartSize) % FileSessionsPool::maxCount();
+	auto location = MTP_inputFileLocation(MTP_long(0), MTP_int(0), MTP_long(0)); // any location is the same synthetic file
+	auto request = MTPupload_GetFile(location, MTP_int(_fileOffset), MTP_int(kFilePartSize));
+	_sent.insert(send(request, rpcDone(&Benchmark::filePartDone, _fileOffset), rpcFail(&Benchmark::failed), dldDcId(maindc(), index)), getms(true));
+	_fileOffset += kFilePartSize;
+}
+
+void Benchmark::filePartDone(int32 offset, const MTPupload_File &result, mtpRequestId requestId) {
+	if (!_running || _current != Scenario::Download) return;
+
+	auto size = result.c_upload_file().vbytes.c_string().v.size();
+	++_items;
+	requestDone(requestId, size);
+
+	if (size < kFilePartSize) {
+		_fileFinished = true;
+	}
+	if (_fileFinished) {
+		if (_sent.isEmpty()) {
+			finish(_items, "parts");
+		}
+		return;
+	}
+	while (_sent.size() < kFilePartsPipeline) {
+		sendFilePart();
+	}
+}
+
+bool Benchmark::failed(const RPCError &error) {
+	if (isDefaultHandledError(error)) return false;
+
+	LOG(("Benchmark Error: %1 %2").arg(error.code()).arg(error.type()));
+	if (_running) {
+		_running = false;
+		QTimer::singleShot(0, this, SLOT(onTimeout()));
+	}
+	return true;
+}
+
+} // namespace MTP
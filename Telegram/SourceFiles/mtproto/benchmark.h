@@ -0,0 +1,97 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+#include "mtproto/rpc_sender.h"
+
+namespace MTP {
+
+// Transport benchmark, started with -benchmark <scenarios> together with
+// -fakedc <port>, see _other/fakedc.h for the server side. It is built
+// only with -Dfake_dc=1 (TDESKTOP_FAKE_DC), never in the official builds.
+//
+// Scenarios are run one after another, each one logs its throughput,
+// request latency percentiles and the process CPU time per megabyte:
+// "updates" - a burst of updates pushed by the server after updates.getState,
+// "history" - pipelined messages.getHistory slices of a large chat,
+// "download" - upload.getFile parts through the download sessions,
+// "crypto" - the message decryption and the obfuscation paths compared
+// with the plain OpenSSL calls they replaced, it doesn't need -fakedc,
+// "registry" - 50k requests in flight stored, looked up and completed from
+// several threads, the request registry compared with the locked maps it
+// replaced, it doesn't need -fakedc either,
+// "all" - all of the above. The application quits when they are finished.
+class Benchmark : public QObject, public RPCSender {
+	Q_OBJECT
+
+public:
+	static void start(); // does nothing without -benchmark
+
+private slots:
+	void onTimeout();
+
+private:
+	enum class Scenario {
+		Updates,
+		History,
+		Download,
+		Crypto,
+		Registry,
+	};
+	static bool offlineOnly(const QList<Scenario> &scenarios); // no -fakedc needed
+	Benchmark(const QList<Scenario> &scenarios);
+
+	void warmedUp();
+	void startNext();
+	void finish(int64 items, const char *itemsName);
+
+	void updatesState(const MTPupdates_State &result, mtpRequestId requestId);
+	void updateReceived(const mtpPrime *from, const mtpPrime *end);
+
+	void sendHistory();
+	void historyDone(const MTPmessages_Messages &result, mtpRequestId requestId);
+
+	void sendFilePart();
+	void filePartDone(int32 offset, const MTPupload_File &result, mtpRequestId requestId);
+
+	bool failed(const RPCError &error);
+	void requestDone(mtpRequestId requestId, int64 bytes);
+
+	QList<Scenario> _scenarios;
+	Scenario _current = Scenario::Updates;
+	bool _running = false;
+
+	uint64 _started = 0;
+	int64 _cpuStarted = 0;
+	int64 _bytes = 0;
+	int64 _items = 0, _itemsExpected = 0;
+	QMap<mtpRequestId, uint64> _sent;
+	QVector<uint64> _latencies;
+
+	int32 _historyOffsetId = 0;
+	int32 _fileOffset = 0;
+	bool _fileFinished = false;
+
+	QTimer _timeout;
+
+};
+
+} // namespace MTP
@@ -30,7 +30,11 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 #include <openssl/rand.h>
 #include "zlib.h"
 
+#include "mtproto/bandwidth_governor.h"
+#include "mtproto/file_sessions.h"
 #include "mtproto/rsa_public_key.h"
+#include "mtproto/send_scheduler.h"
+#include "mtproto/traffic_recorder.h"
 
 using std::string;
 
@@ -286,6 +290,65 @@ RSAPublicKeys InitRSAPublicKeys() {
 	return result;
 }
 
+constexpr int32 kFutureSaltsCount = 64; // the server gives at most 64 salts, one for each hour
+
+// salts taken from the schedule instead of waiting for bad_server_salt,
+// each of them saves a round trip with a resend
+QAtomicInt SaltResendsAvoided;
+QAtomicInt BadServerSaltsReceived;
+
+constexpr int kMaxRaceCandidates = 4; // connecting at the same time
+constexpr int32 kRaceStaggerDelay = 300; // ms between the starts of the endpoints in the race
+
+bool isIPv6Endpoint(const DcEndpoint &endpoint) {
+	return (endpoint.flags & MTPDdcOption::Flag::f_ipv6) ? true : false;
+}
+
+// Pending acks wait for an outgoing request and the ping rides in its container,
+// a packet is sent just to ack or to ping only if nothing went out in the meantime.
+constexpr int32 kMinPingInterval = 10000; // ms, the shortest NAT binding timeout we adapt to
+constexpr int32 kMaxPingInterval = MTPPingSendAfter * 1000; // ms, must stay below MTPPingDelayDisconnect
+constexpr int32 kPingIntervalGrowStep = 1000; // ms added after each idle period the connection survived
+constexpr int32 kAckAlignSlack = 5000; // ms a standalone ack may wait over MTPAckSendWaiting to go with a ping
+
+// A connection lost after a silence is taken for a NAT timeout only if the
+// same endpoint is connected again right away (so the network didn't change)
+// and that happens several times after a similar silence.
+constexpr uint64 kNatReconnectTimeout = 3000; // ms from the loss till the new connection is chosen
+constexpr int kNatLossesToAdapt = 2; // losses after a similar silence before the ping interval is lowered
+constexpr int64 kNatSilenceTolerance = 5; // the silences are similar if they differ by less than 1/5
+
+// The NAT binding timeout belongs to the network, not to the dc,
+// so the forced ping interval is shared by all the main sessions.
+QAtomicInt PingInterval(kMaxPingInterval);
+
+QAtomicInt StandaloneAckPackets; // packets with nothing but acks
+QAtomicInt KeepAliveWakeups; // packets sent only to ack or to ping
+QAtomicInt PiggybackedAcks; // acks sent in a container with some requests
+QAtomicInt PiggybackedPings; // pings sent in a container with some requests
+QAtomicInt NatTimeoutsDetected;
+
+QMutex NatLossesMutex;
+uint64 NatLossesSilence = 0; // the shortest silence of the similar losses counted
+int NatLossesCount = 0;
+
+uint64 pingAutoInterval(int32 interval) { // ping is added to any outgoing packet after that
+	return uint64(interval) * 2 / 3;
+}
+
+// wereAcked keeps only the last msg_ids, the request of the forgotten
+// oldest one won't ever be resent or answered, so its callbacks are cleared
+void insertAcked(AckedMsgIds &wereAcked, mtpMsgId msgId, mtpRequestId requestId, RPCCallbackClears &clearedAcked) {
+	mtpMsgId evictedMsgId = 0;
+	mtpRequestId evictedRequestId = 0;
+	if (wereAcked.insert(msgId, requestId, &evictedMsgId, &evictedRequestId) && evictedMsgId) {
+		DEBUG_LOG(("Message Info: forgetting old acked sent msgId %1").arg(evictedMsgId));
+		if (evictedRequestId) {
+			clearedAcked.push_back(RPCCallbackClear(evictedRequestId, RPCError::TimeoutError));
+		}
+	}
+}
+
 } // namespace
 
 uint32 ThreadIdIncrement = 0;
@@ -354,24 +417,44 @@ QString Connection::transport() const {
 	return data->transport();
 }
 
+KeepAliveStats Connection::keepAliveStats() {
+	KeepAliveStats result;
+	result.standaloneAckPackets = StandaloneAckPackets.load();
+	result.wakeups = KeepAliveWakeups.load();
+	result.piggybackedAcks = PiggybackedAcks.load();
+	result.piggybackedPings = PiggybackedPings.load();
+	result.natTimeouts = NatTimeoutsDetected.load();
+	result.pingInterval = PingInterval.load();
+	return result;
+}
+
+void Connection::logStats() {
+	KeepAliveStats stats(keepAliveStats());
+	DEBUG_LOG(("MTP Info: keep-alive standalone ack packets %1, wakeups %2, piggybacked acks %3, piggybacked pings %4, NAT timeouts %5, ping interval %6ms").arg(stats.standaloneAckPackets).arg(stats.wakeups).arg(stats.piggybackedAcks).arg(stats.piggybackedPings).arg(stats.natTimeouts).arg(stats.pingInterval));
+}
+
 Connection::~Connection() {
 	t_assert(data == nullptr && thread == nullptr);
 }
 
-void ConnectionPrivate::createConn(bool createIPv4, bool createIPv6) {
+void ConnectionPrivate::createConn(const RaceCandidates &candidates) {
 	destroyConn();
-	if (createIPv4) {
-		QWriteLocker lock(&stateConnMutex);
-		_conn4 = AbstractConnection::create(thread());
-		connect(_conn4, SIGNAL(error(bool)), this, SLOT(onError4(bool)));
-		connect(_conn4, SIGNAL(receivedSome()), this, SLOT(onReceivedSome()));
+
+	// the best IPv4 and the best IPv6 endpoints start right away,
+	// all the others join the race one by one
+	_raceQueue = candidates;
+	for (auto ipv6 : { false, true }) {
+		for (int i = 0, l = _raceQueue.size(); i != l; ++i) {
+			if (isIPv6Endpoint(_raceQueue.at(i).tcp) == ipv6) {
+				startCandidate(_raceQueue.takeAt(i));
+				break;
+			}
+		}
 	}
-	if (createIPv6) {
-		QWriteLocker lock(&stateConnMutex);
-		_conn6 = AbstractConnection::create(thread());
-		connect(_conn6, SIGNAL(error(bool)), this, SLOT(onError6(bool)));
-		connect(_conn6, SIGNAL(receivedSome()), this, SLOT(onReceivedSome()));
+	if (!_raceQueue.isEmpty()) {
+		_raceTimer.start(kRaceStaggerDelay);
 	}
+
 	firstSentAt = 0;
 	if (oldConnection) {
 		oldConnection = false;
@@ -380,31 +463,113 @@ void ConnectionPrivate::createConn(bool createIPv4, bool createIPv6) {
 	oldConnectionTimer.start(MTPConnectionOldTimeout);
 }
 
-void ConnectionPrivate::destroyConn(AbstractConnection **conn) {
-	if (conn) {
-		AbstractConnection *toDisconnect = nullptr;
+void ConnectionPrivate::startCandidate(RaceCandidate candidate) {
+	candidate.conn = AbstractConnection::create(thread());
+	candidate.startedAt = getms(true);
+	{
+		QWriteLocker lock(&stateConnMutex);
+		_race.push_back(candidate);
+	}
+
+	auto conn = candidate.conn;
+	connect(conn, SIGNAL(error(bool)), this, SLOT(onError(bool)));
+	connect(conn, SIGNAL(receivedSome()), this, SLOT(onReceivedSome()));
+	connect(conn, SIGNAL(connected()), this, SLOT(onConnected()));
+	connect(conn, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
 
-		{
-			QWriteLocker lock(&stateConnMutex);
-			if (*conn) {
-				toDisconnect = *conn;
-				disconnect(*conn, SIGNAL(connected()), nullptr, nullptr);
-				disconnect(*conn, SIGNAL(disconnected()), nullptr, nullptr);
-				disconnect(*conn, SIGNAL(error(bool)), nullptr, nullptr);
-				disconnect(*conn, SIGNAL(receivedData()), nullptr, nullptr);
-				disconnect(*conn, SIGNAL(receivedSome()), nullptr, nullptr);
-				*conn = nullptr;
-			}
+	DEBUG_LOG(("MTP Info: creating %1 connection to %2:%3 (tcp) and %4:%5 (http)...").arg(isIPv6Endpoint(candidate.tcp) ? "IPv6" : "IPv4").arg(candidate.tcp.ip.c_str()).arg(candidate.tcp.port).arg(candidate.http.ip.c_str()).arg(candidate.http.port));
+	conn->connectTcp(candidate.tcp.ip.c_str(), candidate.tcp.port, candidate.tcp.flags);
+	conn->connectHttp(candidate.http.ip.c_str(), candidate.http.port, candidate.http.flags);
+}
+
+int ConnectionPrivate::findCandidate(AbstractConnection *conn) const {
+	for (int i = 0, l = _race.size(); i != l; ++i) {
+		if (_race.at(i).conn == conn) {
+			return i;
 		}
-		if (toDisconnect) {
-			toDisconnect->disconnectFromServer();
-			toDisconnect->deleteLater();
+	}
+	return -1;
+}
+
+bool ConnectionPrivate::waitingForIPv4() const {
+	for_const (auto &candidate, _race) {
+		if (!isIPv6Endpoint(candidate.tcp)) return true;
+	}
+	for_const (auto &candidate, _raceQueue) {
+		if (!isIPv6Endpoint(candidate.tcp)) return true;
+	}
+	return false;
+}
+
+void ConnectionPrivate::chooseConn(AbstractConnection *conn) {
+	_raceTimer.stop();
+	_waitForIPv4Timer.stop();
+	_raceQueue.clear();
+
+	QVector<AbstractConnection*> losers;
+	for_const (auto &candidate, _race) {
+		if (candidate.conn != conn) {
+			losers.push_back(candidate.conn);
 		}
-	} else {
-		destroyConn(&_conn4);
-		destroyConn(&_conn6);
-		_conn = nullptr;
 	}
+	for_const (auto loser, losers) {
+		destroyConn(loser);
+	}
+
+	{
+		QWriteLocker lock(&stateConnMutex);
+		_conn = conn;
+		_connIPv6 = isIPv6Endpoint(_race.at(findCandidate(conn)).tcp);
+		_connIPv6Ready = nullptr;
+	}
+	confirmNatTimeout(_race.at(findCandidate(conn)).tcp);
+	updateAuthKey();
+}
+
+bool ConnectionPrivate::dropCandidate(AbstractConnection *conn) {
+	auto index = findCandidate(conn);
+	if (index < 0) return !_race.isEmpty();
+
+	dcEndpointFailed(_race.at(index).tcp);
+	emit endpointsStatsChanged();
+
+	destroyConn(conn);
+	if (!_raceQueue.isEmpty()) {
+		onRaceNext();
+	}
+	if (_connIPv6Ready && !waitingForIPv4()) {
+		DEBUG_LOG(("MTP Info: no IPv4 endpoints left, using IPv6 connection."));
+		chooseConn(_connIPv6Ready);
+	}
+	return !_race.isEmpty();
+}
+
+void ConnectionPrivate::destroyConn(AbstractConnection *conn) {
+	if (!conn) {
+		_raceTimer.stop();
+		_raceQueue.clear();
+		while (!_race.isEmpty()) {
+			destroyConn(_race.back().conn);
+		}
+		return;
+	}
+
+	{
+		QWriteLocker lock(&stateConnMutex);
+		auto index = findCandidate(conn);
+		if (index < 0) return;
+
+		disconnect(conn, SIGNAL(connected()), nullptr, nullptr);
+		disconnect(conn, SIGNAL(disconnected()), nullptr, nullptr);
+		disconnect(conn, SIGNAL(error(bool)), nullptr, nullptr);
+		disconnect(conn, SIGNAL(receivedData()), nullptr, nullptr);
+		disconnect(conn, SIGNAL(receivedSome()), nullptr, nullptr);
+		_race.remove(index);
+		if (_conn == conn) _conn = nullptr;
+		if (_connIPv6Ready == conn) _connIPv6Ready = nullptr;
+	}
+	conn->disconnectFromServer();
+	conn->deleteLater();
 }
 
 ConnectionPrivate::ConnectionPrivate(QThread *thread, Connection *owner, SessionData *data, uint32 _dc) : QObject(nullptr)
@@ -413,8 +578,8 @@ ConnectionPrivate::ConnectionPrivate(QThread *thread, Connection *owner, Session
 , dc(_dc)
 , _owner(owner)
 , _conn(nullptr)
-, _conn4(nullptr)
-, _conn6(nullptr)
+, _connIPv6Ready(nullptr)
+, _connIPv6(false)
 , retryTimeout(1)
 , oldConnection(true)
 , _waitForReceived(MTPMinReceiveDelay)
@@ -423,6 +588,11 @@ ConnectionPrivate::ConnectionPrivate(QThread *thread, Connection *owner, Session
 , _pingId(0)
 , _pingIdToSend(0)
 , _pingSendAt(0)
+, _pingForcedAt(0)
+, _pingAfterIdle(false)
+, _lastTrafficAt(0)
+, _natLossSilence(0)
+, _natLossAt(0)
 , _pingMsgId(0)
 , restarted(false)
 , _finished(false)
@@ -436,6 +606,7 @@ ConnectionPrivate::ConnectionPrivate(QThread *thread, Connection *owner, Session
 	_waitForConnectedTimer.moveToThread(thread);
 	_waitForReceivedTimer.moveToThread(thread);
 	_waitForIPv4Timer.moveToThread(thread);
+	_raceTimer.moveToThread(thread);
 	_pingSender.moveToThread(thread);
 	retryTimer.moveToThread(thread);
 	moveToThread(thread);
@@ -460,6 +631,7 @@ ConnectionPrivate::ConnectionPrivate(QThread *thread, Connection *owner, Session
 	connect(&_waitForConnectedTimer, SIGNAL(timeout()), this, SLOT(onWaitConnectedFailed()));
 	connect(&_waitForReceivedTimer, SIGNAL(timeout()), this, SLOT(onWaitReceivedFailed()));
 	connect(&_waitForIPv4Timer, SIGNAL(timeout()), this, SLOT(onWaitIPv4Failed()));
+	connect(&_raceTimer, SIGNAL(timeout()), this, SLOT(onRaceNext()));
 	connect(&oldConnectionTimer, SIGNAL(timeout()), this, SLOT(onOldConnection()));
 	connect(&_pingSender, SIGNAL(timeout()), this, SLOT(onPingSender()));
 	connect(sessionData->owner(), SIGNAL(authKeyCreated()), this, SLOT(updateAuthKey()), Qt::QueuedConnection);
@@ -485,6 +657,8 @@ ConnectionPrivate::ConnectionPrivate(QThread *thread, Connection *owner, Session
 	connect(this, SIGNAL(resendAsync(quint64,quint64,bool,bool)), sessionData->owner(), SLOT(resend(quint64,quint64,bool,bool)), Qt::QueuedConnection);
 	connect(this, SIGNAL(resendManyAsync(QVector<quint64>,quint64,bool,bool)), sessionData->owner(), SLOT(resendMany(QVector<quint64>,quint64,bool,bool)), Qt::QueuedConnection);
 	connect(this, SIGNAL(resendAllAsync()), sessionData->owner(), SLOT(resendAll()));
+	connect(this, SIGNAL(serverSaltsReceived()), sessionData->owner(), SLOT(onServerSaltsReceived()), Qt::QueuedConnection);
+	connect(this, SIGNAL(endpointsStatsChanged()), sessionData->owner(), SLOT(onEndpointsStatsChanged()), Qt::QueuedConnection);
 }
 
 void ConnectionPrivate::onConfigLoaded() {
@@ -511,11 +685,11 @@ int32 ConnectionPrivate::getState() const {
 
 QString ConnectionPrivate::transport() const {
 	QReadLocker lock(&stateConnMutex);
-	if ((!_conn4 && !_conn6) || (_conn4 && _conn6) || (_state < 0)) {
+	if (!_conn || (_state < 0)) {
 		return QString();
 	}
-	QString result = (_conn4 ? _conn4 : _conn6)->transport();
-	if (!result.isEmpty() && Global::TryIPv6()) result += (_conn4 ? "/IPv4" : "/IPv6");
+	QString result = _conn->transport();
+	if (!result.isEmpty() && Global::TryIPv6()) result += (_connIPv6 ? "/IPv6" : "/IPv4");
 	return result;
 }
 
@@ -546,8 +720,9 @@ void ConnectionPrivate::resetSession() { // recreate all msg_id and msg_seqno
 	mtpRequestMap &haveSent(sessionData->haveSentMap());
 	mtpRequestIdsMap &toResend(sessionData->toResendMap());
 	mtpPreRequestMap &toSend(sessionData->toSendMap());
-	mtpRequestIdsMap &wereAcked(sessionData->wereAckedMap());
+	AckedMsgIds &wereAcked(sessionData->wereAckedMap());
 
+	RPCCallbackClears clearedAcked;
 	mtpMsgId newId = msgid();
 	mtpRequestMap setSeqNumbers;
 	typedef QMap<mtpMsgId, mtpMsgId> Replaces;
@@ -559,7 +734,7 @@ void ConnectionPrivate::resetSession() { // recreate all msg_id and msg_seqno
 			mtpMsgId id = i.key();
 			if (id > newId) {
 				while (true) {
-					if (toResend.constFind(newId) == toResend.cend() && wereAcked.constFind(newId) == wereAcked.cend() && haveSent.constFind(newId) == haveSent.cend()) {
+					if (toResend.constFind(newId) == toResend.cend() && !wereAcked.contains(newId) && haveSent.constFind(newId) == haveSent.cend()) {
 						break;
 					}
 					mtpMsgId m = msgid();
@@ -586,7 +761,7 @@ void ConnectionPrivate::resetSession() { // recreate all msg_id and msg_seqno
 			mtpMsgId id = i.key();
 			if (id > newId) {
 				while (true) {
-					if (toResend.constFind(newId) == toResend.cend() && wereAcked.constFind(newId) == wereAcked.cend() && haveSent.constFind(newId) == haveSent.cend()) {
+					if (toResend.constFind(newId) == toResend.cend() && !wereAcked.contains(newId) && haveSent.constFind(newId) == haveSent.cend()) {
 						break;
 					}
 					mtpMsgId m = msgid();
@@ -626,11 +801,9 @@ void ConnectionPrivate::resetSession() { // recreate all msg_id and msg_seqno
 				toResend.erase(k);
 				toResend.insert(i.value(), req);
 			}
-			k = wereAcked.find(i.key());
-			if (k != wereAcked.cend()) {
-				mtpRequestId req = k.value();
-				wereAcked.erase(k);
-				wereAcked.insert(i.value(), req);
+			mtpRequestId ackedRequestId = 0;
+			if (wereAcked.remove(i.key(), &ackedRequestId)) {
+				insertAcked(wereAcked, i.value(), ackedRequestId, clearedAcked);
 			}
 		}
 		for (mtpRequestMap::const_iterator i = haveSent.cbegin(), e = haveSent.cend(); i != e; ++i) { // replace msgIds in saved containers
@@ -652,6 +825,9 @@ void ConnectionPrivate::resetSession() { // recreate all msg_id and msg_seqno
 		QWriteLocker locker5(sessionData->stateRequestMutex());
 		sessionData->stateRequestMap().clear();
 	}
+	if (!clearedAcked.isEmpty()) {
+		clearCallbacksDelayed(clearedAcked);
+	}
 
 	emit sessionResetDone();
 }
@@ -683,11 +859,11 @@ mtpMsgId ConnectionPrivate::replaceMsgId(mtpRequest &request, mtpMsgId newId) {
 			// haveSentMutex() and wereAckedMutex() were locked in tryToSend()
 
 			mtpRequestIdsMap &toResend(sessionData->toResendMap());
-			mtpRequestIdsMap &wereAcked(sessionData->wereAckedMap());
+			AckedMsgIds &wereAcked(sessionData->wereAckedMap());
 			mtpRequestMap &haveSent(sessionData->haveSentMap());
 
 			while (true) {
-				if (toResend.constFind(newId) == toResend.cend() && wereAcked.constFind(newId) == wereAcked.cend() && haveSent.constFind(newId) == haveSent.cend()) {
+				if (toResend.constFind(newId) == toResend.cend() && !wereAcked.contains(newId) && haveSent.constFind(newId) == haveSent.cend()) {
 					break;
 				}
 				mtpMsgId m = msgid();
@@ -703,11 +879,13 @@ mtpMsgId ConnectionPrivate::replaceMsgId(mtpRequest &request, mtpMsgId newId) {
 				toResend.insert(newId, req);
 			}
 
-			mtpRequestIdsMap::iterator j = wereAcked.find(oldMsgId);
-			if (j != wereAcked.cend()) {
-				mtpRequestId req = j.value();
-				wereAcked.erase(j);
-				wereAcked.insert(newId, req);
+			mtpRequestId ackedRequestId = 0;
+			if (wereAcked.remove(oldMsgId, &ackedRequestId)) {
+				RPCCallbackClears clearedAcked;
+				insertAcked(wereAcked, newId, ackedRequestId, clearedAcked);
+				if (!clearedAcked.isEmpty()) {
+					clearCallbacksDelayed(clearedAcked);
+				}
 			}
 
 			mtpRequestMap::iterator k = haveSent.find(oldMsgId);
@@ -758,9 +936,12 @@ void ConnectionPrivate::tryToSend() {
 	bool needsLayer = !sessionData->layerWasInited();
 	int32 state = getState();
 	bool prependOnly = (state != ConnectedState);
+	applyServerSaltSchedule();
+
 	mtpRequest pingRequest;
 	if (dc == bareDcId(dc)) { // main session
-		if (!prependOnly && !_pingIdToSend && !_pingId && _pingSendAt <= getms(true)) {
+		uint64 ms = getms(true), pingAhead = ackRequestData.isEmpty() ? 0 : pingAutoInterval(PingInterval.load()) / 2;
+		if (!prependOnly && !_pingIdToSend && !_pingId && _pingSendAt <= ms + pingAhead) { // the acks are going anyway
 			_pingIdToSend = rand_value<mtpPingId>();
 		}
 	}
@@ -779,12 +960,15 @@ void ConnectionPrivate::tryToSend() {
 			DEBUG_LOG(("MTP Info: sending ping_delay_disconnect, ping_id: %1").arg(_pingIdToSend));
 		}
 
+		int32 interval = PingInterval.load();
 		pingRequest->msDate = getms(true); // > 0 - can send without container
-		_pingSendAt = pingRequest->msDate + (MTPPingSendAfterAuto * 1000ULL);
+		_pingSendAt = pingRequest->msDate + pingAutoInterval(interval);
+		_pingAfterIdle = (_lastTrafficAt > 0 && _lastTrafficAt + pingAutoInterval(interval) <= uint64(pingRequest->msDate));
 		pingRequest->requestId = 0; // dont add to haveSent / wereAcked maps
 
 		if (dc == bareDcId(dc) && !prependOnly) { // main session
-			_pingSender.start(MTPPingSendAfter * 1000);
+			_pingForcedAt = pingRequest->msDate + interval;
+			_pingSender.start(interval);
 		}
 
 		_pingId = _pingIdToSend;
@@ -798,7 +982,7 @@ void ConnectionPrivate::tryToSend() {
 		}
 	}
 
-	mtpRequest ackRequest, resendRequest, stateRequest, httpWaitRequest;
+	mtpRequest ackRequest, resendRequest, stateRequest, httpWaitRequest, futureSaltsRequest;
 	if (!prependOnly && !ackRequestData.isEmpty()) {
 		MTPMsgsAck ack(MTP_msgs_ack(MTP_vector<MTPlong>(ackRequestData)));
 
@@ -852,6 +1036,17 @@ void ConnectionPrivate::tryToSend() {
 			httpWaitRequest->msDate = getms(true); // > 0 - can send without container
 			httpWaitRequest->requestId = 0; // dont add to haveSent / wereAcked maps
 		}
+		const AuthKeyPtr &key(sessionData->getKey());
+		if (key && key->needServerSalts(unixtime())) {
+			MTPGet_future_salts req(MTP_int(kFutureSaltsCount));
+
+			futureSaltsRequest = mtpRequestData::prepare(req.innerLength() >> 2);
+			req.write(*futureSaltsRequest);
+
+			futureSaltsRequest->msDate = getms(true); // > 0 - can send without container
+			futureSaltsRequest->requestId = 0; // dont add to haveSent / wereAcked maps, requested again by timeout in AuthKey
+			DEBUG_LOG(("MTP Info: requesting future salts, dc %1").arg(dc));
+		}
 	}
 
 	MTPInitConnection<mtpRequest> initWrapperImpl, *initWrapper = &initWrapperImpl;
@@ -863,27 +1058,42 @@ void ConnectionPrivate::tryToSend() {
 	}
 
 	bool needAnyResponse = false;
+	int64 sendMoreIn = -1;
 	mtpRequest toSendRequest;
+	RPCCallbackClears clearedAcked;
 	{
 		QWriteLocker locker1(sessionData->toSendMutex());
 
-		mtpPreRequestMap toSendDummy, &toSend(prependOnly ? toSendDummy : sessionData->toSendMap());
+		mtpPreRequestMap toSendDummy, &toSendMap(prependOnly ? toSendDummy : sessionData->toSendMap());
 		if (prependOnly) locker1.unlock();
 
+		QVector<mtpRequest> toSend;
+		if (!toSendMap.isEmpty()) {
+			sendMoreIn = SendScheduler::take(toSendMap, toSend, getms(true));
+		}
+
 		uint32 toSendCount = toSend.size();
 		if (pingRequest) ++toSendCount;
 		if (ackRequest) ++toSendCount;
 		if (resendRequest) ++toSendCount;
 		if (stateRequest) ++toSendCount;
 		if (httpWaitRequest) ++toSendCount;
+		if (futureSaltsRequest) ++toSendCount;
 
 		if (!toSendCount) return; // nothing to send
 
-		mtpRequest first = pingRequest ? pingRequest : (ackRequest ? ackRequest : (resendRequest ? resendRequest : (stateRequest ? stateRequest : (httpWaitRequest ? httpWaitRequest : toSend.cbegin().value()))));
+		if (toSend.isEmpty() && !resendRequest && !stateRequest && !httpWaitRequest && !futureSaltsRequest) {
+			KeepAliveWakeups.ref();
+			if (!pingRequest) StandaloneAckPackets.ref();
+		} else {
+			if (ackRequest) PiggybackedAcks.ref();
+			if (pingRequest) PiggybackedPings.ref();
+		}
+
+		mtpRequest first = pingRequest ? pingRequest : (ackRequest ? ackRequest : (resendRequest ? resendRequest : (stateRequest ? stateRequest : (httpWaitRequest ? httpWaitRequest : (futureSaltsRequest ? futureSaltsRequest : toSend.front())))));
 		if (toSendCount == 1 && first->msDate > 0) { // if can send without container
 			toSendRequest = first;
 			if (!prependOnly) {
-				toSend.clear();
 				locker1.unlock();
 			}
 
@@ -891,7 +1101,7 @@ void ConnectionPrivate::tryToSend() {
 			if (pingRequest) {
 				_pingMsgId = msgId;
 				needAnyResponse = true;
-			} else if (resendRequest || stateRequest) {
+			} else if (resendRequest || stateRequest || futureSaltsRequest) {
 				needAnyResponse = true;
 			}
 
@@ -927,7 +1137,7 @@ void ConnectionPrivate::tryToSend() {
 					needAnyResponse = true;
 				} else {
 					QWriteLocker locker3(sessionData->wereAckedMutex());
-					sessionData->wereAckedMap().insert(msgId, toSendRequest->requestId);
+					insertAcked(sessionData->wereAckedMap(), msgId, toSendRequest->requestId, clearedAcked);
 				}
 			}
 		} else { // send in container
@@ -938,9 +1148,10 @@ void ConnectionPrivate::tryToSend() {
 			if (resendRequest) containerSize += mtpRequestData::messageSize(resendRequest);
 			if (stateRequest) containerSize += mtpRequestData::messageSize(stateRequest);
 			if (httpWaitRequest) containerSize += mtpRequestData::messageSize(httpWaitRequest);
-			for (mtpPreRequestMap::iterator i = toSend.begin(), e = toSend.end(); i != e; ++i) {
-				containerSize += mtpRequestData::messageSize(i.value());
-				if (needsLayer && i.value()->needsLayer) {
+			if (futureSaltsRequest) containerSize += mtpRequestData::messageSize(futureSaltsRequest);
+			for (QVector<mtpRequest>::const_iterator i = toSend.cbegin(), e = toSend.cend(); i != e; ++i) {
+				containerSize += mtpRequestData::messageSize(*i);
+				if (needsLayer && (*i)->needsLayer) {
 					containerSize += initSizeInInts;
 					willNeedInit = true;
 				}
@@ -962,7 +1173,7 @@ void ConnectionPrivate::tryToSend() {
 			mtpRequestMap &haveSent(sessionData->haveSentMap());
 
 			QWriteLocker locker3(sessionData->wereAckedMutex()); // the fact of this lock is used in replaceMsgId()
-			mtpRequestIdsMap &wereAcked(sessionData->wereAckedMap());
+			AckedMsgIds &wereAcked(sessionData->wereAckedMap());
 
 			mtpRequest haveSentIdsWrap(mtpRequestData::prepare(idsWrapSize)); // prepare "request-like" wrap for msgId vector
 			haveSentIdsWrap->requestId = 0;
@@ -972,11 +1183,11 @@ void ConnectionPrivate::tryToSend() {
 			if (pingRequest) {
 				_pingMsgId = placeToContainer(toSendRequest, bigMsgId, haveSentArr, pingRequest);
 				needAnyResponse = true;
-			} else if (resendRequest || stateRequest) {
+			} else if (resendRequest || stateRequest || futureSaltsRequest) {
 				needAnyResponse = true;
 			}
-			for (mtpPreRequestMap::iterator i = toSend.begin(), e = toSend.end(); i != e; ++i) {
-				mtpRequest &req(i.value());
+			for (QVector<mtpRequest>::iterator i = toSend.begin(), e = toSend.end(); i != e; ++i) {
+				mtpRequest &req(*i);
 				mtpMsgId msgId = prepareToSend(req, bigMsgId);
 				if (msgId > bigMsgId) msgId = replaceMsgId(req, bigMsgId);
 				if (msgId >= bigMsgId) bigMsgId = msgid();
@@ -1005,7 +1216,7 @@ void ConnectionPrivate::tryToSend() {
 
 						needAnyResponse = true;
 					} else {
-						wereAcked.insert(msgId, req->requestId);
+						insertAcked(wereAcked, msgId, req->requestId, clearedAcked);
 					}
 				}
 				if (!added) {
@@ -1022,16 +1233,26 @@ void ConnectionPrivate::tryToSend() {
 			if (resendRequest) placeToContainer(toSendRequest, bigMsgId, haveSentArr, resendRequest);
 			if (ackRequest) placeToContainer(toSendRequest, bigMsgId, haveSentArr, ackRequest);
 			if (httpWaitRequest) placeToContainer(toSendRequest, bigMsgId, haveSentArr, httpWaitRequest);
+			if (futureSaltsRequest) placeToContainer(toSendRequest, bigMsgId, haveSentArr, futureSaltsRequest);
 
 			mtpMsgId contMsgId = prepareToSend(toSendRequest, bigMsgId);
 			*(mtpMsgId*)(haveSentIdsWrap->data() + 4) = contMsgId;
 			(*haveSentIdsWrap)[6] = 0; // for container, msDate = 0, seqNo = 0
 			haveSent.insert(contMsgId, haveSentIdsWrap);
-			toSend.clear();
 		}
 	}
+	if (!clearedAcked.isEmpty()) {
+		clearCallbacksDelayed(clearedAcked);
+	}
+
 	mtpRequestData::padding(toSendRequest);
 	sendRequest(toSendRequest, needAnyResponse, lockFinished);
+	_lastTrafficAt = getms(true);
+
+	if (sendMoreIn >= 0) {
+		DEBUG_LOG(("MTP Info: dc %1 some requests were left for the next packet in %2ms").arg(dc).arg(sendMoreIn));
+		emit sendAnythingAsync(sendMoreIn);
+	}
 }
 
 void ConnectionPrivate::retryByTimer() {
@@ -1080,59 +1301,83 @@ void ConnectionPrivate::socketStart(bool afterConfig) {
 	}
 	int32 bareDc = bareDcId(dc);
 
-	static const int IPv4address = 0, IPv6address = 1;
-	static const int TcpProtocol = 0, HttpProtocol = 1;
-	MTPDdcOption::Flags flags[2][2] = { { 0 } };
-	string ip[2][2];
-	uint32 port[2][2] = { { 0 } };
+	// all the known addresses of the dc: the chosen ones from the dc options
+	// and all the advertised ones, the media_only are used only by the download
+	// dcs and they are used exclusively if there are any
+	DcEndpoints endpoints;
+	auto addEndpoint = [&endpoints, bareDc](const DcEndpoint &endpoint) {
+		if (endpoint.id != bareDc) return;
+		if ((endpoint.flags & MTPDdcOption::Flag::f_ipv6) && !Global::TryIPv6()) return;
+		for_const (auto &already, endpoints) {
+			if (already.ip == endpoint.ip && already.port == endpoint.port && already.flags == endpoint.flags) return;
+		}
+		endpoints.push_back(endpoint);
+	};
 	{
 		QReadLocker lock(dcOptionsMutex());
-		const auto &options(Global::DcOptions());
-		int32 shifts[2][2][4] = {
-			{ // IPv4
-				{ // TCP IPv4
-					isDldDc ? (MTPDdcOption::Flag::f_media_only | MTPDdcOption::Flag::f_tcpo_only) : -1,
-					qFlags(MTPDdcOption::Flag::f_tcpo_only),
-					isDldDc ? qFlags(MTPDdcOption::Flag::f_media_only) : -1,
-					0
-				}, { // HTTP IPv4
-					-1,
-					-1,
-					isDldDc ? qFlags(MTPDdcOption::Flag::f_media_only) : -1,
-					0
-				},
-			}, { // IPv6
-				{ // TCP IPv6
-					isDldDc ? (MTPDdcOption::Flag::f_media_only | MTPDdcOption::Flag::f_tcpo_only | MTPDdcOption::Flag::f_ipv6) : -1,
-					MTPDdcOption::Flag::f_tcpo_only | MTPDdcOption::Flag::f_ipv6,
-					isDldDc ? (MTPDdcOption::Flag::f_media_only | MTPDdcOption::Flag::f_ipv6) : -1,
-					qFlags(MTPDdcOption::Flag::f_ipv6)
-				}, { // HTTP IPv6
-					-1,
-					-1,
-					isDldDc ? (MTPDdcOption::Flag::f_media_only | MTPDdcOption::Flag::f_ipv6) : -1,
-					qFlags(MTPDdcOption::Flag::f_ipv6)
-				},
-			},
-		};
-		for (int32 address = 0, acount = sizeof(shifts) / sizeof(shifts[0]); address < acount; ++address) {
-			for (int32 protocol = 0, pcount = sizeof(shifts[0]) / sizeof(shifts[0][0]); protocol < pcount; ++protocol) {
-				for (int32 shift = 0, scount = sizeof(shifts[0][0]) / sizeof(shifts[0][0][0]); shift < scount; ++shift) {
-					int32 mask = shifts[address][protocol][shift];
-					if (mask < 0) continue;
-
-					auto index = options.constFind(shiftDcId(bareDc, mask));
-					if (index != options.cend()) {
-						ip[address][protocol] = index->ip;
-						flags[address][protocol] = index->flags;
-						port[address][protocol] = index->port;
-						break;
-					}
-				}
+		for_const (auto &option, Global::DcOptions()) {
+			DcEndpoint endpoint;
+			endpoint.id = option.id;
+			endpoint.flags = option.flags;
+			endpoint.ip = option.ip;
+			endpoint.port = option.port;
+			addEndpoint(endpoint);
+		}
+	}
+#ifdef TDESKTOP_FAKE_DC
+	auto fakeDc = (cFakeDcPort() != 0); // the local fake dc is the only endpoint of all the dcs
+#else // TDESKTOP_FAKE_DC
+	auto fakeDc = false;
+#endif // TDESKTOP_FAKE_DC
+	if (!fakeDc) {
+		for_const (auto &endpoint, dcEndpoints(bareDc)) {
+			addEndpoint(endpoint);
+		}
+	}
+	sortDcEndpoints(endpoints);
+
+	auto hasMedia = [&endpoints](bool ipv6) {
+		for_const (auto &endpoint, endpoints) {
+			if (isIPv6Endpoint(endpoint) == ipv6 && (endpoint.flags & MTPDdcOption::Flag::f_media_only)) return true;
+		}
+		return false;
+	};
+	bool mediaOnly[2] = { isDldDc && hasMedia(false), isDldDc && hasMedia(true) };
+	auto usable = [isDldDc, &mediaOnly](const DcEndpoint &endpoint) {
+		auto media = (endpoint.flags & MTPDdcOption::Flag::f_media_only) ? true : false;
+		return media ? isDldDc : !mediaOnly[isIPv6Endpoint(endpoint) ? 1 : 0];
+	};
+
+	// tcpo_only endpoints race with the http transport through the best
+	// plain endpoint of the same address family
+	const DcEndpoint *http[2] = { nullptr, nullptr };
+	for_const (auto &endpoint, endpoints) {
+		auto &familyHttp = http[isIPv6Endpoint(endpoint) ? 1 : 0];
+		if (!familyHttp && usable(endpoint) && !(endpoint.flags & MTPDdcOption::Flag::f_tcpo_only)) {
+			familyHttp = &endpoint;
+		}
+	}
+	RaceCandidates candidates;
+	for_const (auto &endpoint, endpoints) {
+		auto familyHttp = http[isIPv6Endpoint(endpoint) ? 1 : 0];
+		if (!familyHttp || !usable(endpoint)) continue;
+
+		auto duplicate = false;
+		for_const (auto &candidate, candidates) {
+			if (candidate.tcp.ip == endpoint.ip && candidate.tcp.port == endpoint.port) {
+				duplicate = true;
+				break;
 			}
 		}
+		if (duplicate) continue;
+
+		RaceCandidate candidate;
+		candidate.tcp = endpoint;
+		candidate.http = (endpoint.flags & MTPDdcOption::Flag::f_tcpo_only) ? *familyHttp : endpoint;
+		candidates.push_back(candidate);
 	}
-	bool noIPv4 = !port[IPv4address][HttpProtocol], noIPv6 = (!Global::TryIPv6() || !port[IPv6address][HttpProtocol]);
+
+	bool noIPv4 = !http[0], noIPv6 = (!Global::TryIPv6() || !http[1]);
 	if (noIPv4 && noIPv6) {
 		if (afterConfig) {
 			if (noIPv4) LOG(("MTP Error: DC %1 options for IPv4 over HTTP not found right after config load!").arg(dc));
@@ -1146,31 +1391,29 @@ void ConnectionPrivate::socketStart(bool afterConfig) {
 		return;
 	}
 
-	if (afterConfig && (_conn4 || _conn6)) return;
+	if (afterConfig && !_race.isEmpty()) return;
 
-	createConn(!noIPv4, !noIPv6);
 	retryTimer.stop();
 	_waitForConnectedTimer.stop();
 
 	setState(ConnectingState);
-	_pingId = _pingMsgId = _pingIdToSend = _pingSendAt = 0;
+	_pingId = _pingMsgId = _pingIdToSend = _pingSendAt = _pingForcedAt = _lastTrafficAt = 0;
 	_pingSender.stop();
 
-	if (!noIPv4) DEBUG_LOG(("MTP Info: creating IPv4 connection to %1:%2 (tcp) and %3:%4 (http)...").arg(ip[IPv4address][TcpProtocol].c_str()).arg(port[IPv4address][TcpProtocol]).arg(ip[IPv4address][HttpProtocol].c_str()).arg(port[IPv4address][HttpProtocol]));
-	if (!noIPv6) DEBUG_LOG(("MTP Info: creating IPv6 connection to [%1]:%2 (tcp) and [%3]:%4 (http)...").arg(ip[IPv6address][TcpProtocol].c_str()).arg(port[IPv6address][TcpProtocol]).arg(ip[IPv4address][HttpProtocol].c_str()).arg(port[IPv4address][HttpProtocol]));
+	DEBUG_LOG(("MTP Info: racing %1 endpoints of DC %2...").arg(candidates.size()).arg(dc));
 
 	_waitForConnectedTimer.start(_waitForConnected);
-	if (auto conn = _conn4) {
-		connect(conn, SIGNAL(connected()), this, SLOT(onConnected4()));
-		connect(conn, SIGNAL(disconnected()), this, SLOT(onDisconnected4()));
-		conn->connectTcp(ip[IPv4address][TcpProtocol].c_str(), port[IPv4address][TcpProtocol], flags[IPv4address][TcpProtocol]);
-		conn->connectHttp(ip[IPv4address][HttpProtocol].c_str(), port[IPv4address][HttpProtocol], flags[IPv4address][HttpProtocol]);
+	createConn(candidates);
+}
+
+void ConnectionPrivate::onRaceNext() {
+	if (_conn || _raceQueue.isEmpty()) return;
+
+	if (_race.size() < kMaxRaceCandidates) {
+		startCandidate(_raceQueue.takeFirst());
 	}
-	if (auto conn = _conn6) {
-		connect(conn, SIGNAL(connected()), this, SLOT(onConnected6()));
-		connect(conn, SIGNAL(disconnected()), this, SLOT(onDisconnected6()));
-		conn->connectTcp(ip[IPv6address][TcpProtocol].c_str(), port[IPv6address][TcpProtocol], flags[IPv6address][TcpProtocol]);
-		conn->connectHttp(ip[IPv6address][HttpProtocol].c_str(), port[IPv6address][HttpProtocol], flags[IPv6address][HttpProtocol]);
+	if (!_raceQueue.isEmpty() && _race.size() < kMaxRaceCandidates) {
+		_raceTimer.start(kRaceStaggerDelay);
 	}
 }
 
@@ -1222,9 +1465,9 @@ void ConnectionPrivate::onSentSome(uint64 size) {
 			}
 		}
 		if (isUplDcId(dc)) {
-			remain *= MTPUploadSessionsCount;
+			remain *= FileSessionsPool::currentCount(FileSessionsPool::Kind::Upload);
 		} else if (isDldDcId(dc)) {
-			remain *= MTPDownloadSessionsCount;
+			remain *= FileSessionsPool::currentCount(FileSessionsPool::Kind::Download);
 		}
 		_waitForReceivedTimer.start(remain);
 	}
@@ -1238,6 +1481,7 @@ void ConnectionPrivate::onReceivedSome() {
 	}
 	oldConnectionTimer.start(MTPConnectionOldTimeout);
 	_waitForReceivedTimer.stop();
+	_lastTrafficAt = getms(true);
 	if (firstSentAt > 0) {
 		int32 ms = getms(true) - firstSentAt;
 		DEBUG_LOG(("MTP Info: response in %1ms, _waitForReceived: %2ms").arg(ms).arg(_waitForReceived));
@@ -1255,17 +1499,82 @@ void ConnectionPrivate::onOldConnection() {
 
 void ConnectionPrivate::onPingSender() {
 	if (_pingId) {
-			if (_pingSendAt + (MTPPingSendAfter - MTPPingSendAfterAuto - 1) * 1000ULL < getms(true)) {
-			LOG(("Could not send ping for MTPPingSendAfter seconds, restarting..."));
+		int32 interval = PingInterval.load();
+		uint64 forcedAfterAuto = uint64(interval) - pingAutoInterval(interval);
+		if (_pingSendAt + forcedAfterAuto - 1000 < getms(true)) {
+			LOG(("Could not send ping for %1ms, restarting...").arg(interval));
 			return restart();
 		} else {
-			_pingSender.start(_pingSendAt + (MTPPingSendAfter - MTPPingSendAfterAuto) * 1000ULL - getms(true));
+			_pingForcedAt = _pingSendAt + forcedAfterAuto;
+			_pingSender.start(_pingForcedAt - getms(true));
 		}
 	} else {
 		emit needToSendAsync();
 	}
 }
 
+uint64 ConnectionPrivate::ackSendWaiting() const {
+	uint64 ms = getms(true);
+	if (!_pingId && _pingForcedAt > ms && _pingForcedAt <= ms + MTPAckSendWaiting + kAckAlignSlack) {
+		return _pingForcedAt - ms; // the acks will go with the forced ping
+	}
+	return MTPAckSendWaiting;
+}
+
+void ConnectionPrivate::checkNatTimeout() {
+	if (dc != bareDcId(dc) || !_lastTrafficAt) return;
+
+	// A connection lost after a silence no longer than the ping interval
+	// may be dropped by the NAT, that is decided in confirmNatTimeout().
+	int32 interval = PingInterval.load();
+	uint64 ms = getms(true), idle = ms - _lastTrafficAt;
+	if (idle < uint64(kMinPingInterval) || idle > uint64(interval) * 3 / 2) return;
+
+	auto index = findCandidate(_conn);
+	if (index < 0) return;
+
+	_natLossSilence = idle;
+	_natLossAt = ms;
+	_natLossEndpoint = _race.at(index).tcp;
+}
+
+void ConnectionPrivate::confirmNatTimeout(const DcEndpoint &endpoint) {
+	if (!_natLossAt) return;
+
+	auto silence = _natLossSilence, lostAt = _natLossAt;
+	_natLossSilence = _natLossAt = 0;
+	if (getms(true) > lostAt + kNatReconnectTimeout || endpoint.ip != _natLossEndpoint.ip || endpoint.port != _natLossEndpoint.port) {
+		DEBUG_LOG(("MTP Info: dc %1 connection lost after %2ms of silence, but the network has changed").arg(dc).arg(silence));
+		return;
+	}
+
+	{
+		QMutexLocker lock(&NatLossesMutex);
+		auto difference = qAbs(int64(silence) - int64(NatLossesSilence));
+		if (NatLossesCount > 0 && difference * kNatSilenceTolerance < int64(qMax(silence, NatLossesSilence))) {
+			++NatLossesCount;
+			NatLossesSilence = qMin(NatLossesSilence, silence);
+		} else {
+			NatLossesCount = 1;
+			NatLossesSilence = silence;
+		}
+		if (NatLossesCount < kNatLossesToAdapt) {
+			DEBUG_LOG(("MTP Info: dc %1 connection lost after %2ms of silence, %3 similar losses").arg(dc).arg(silence).arg(NatLossesCount));
+			return;
+		}
+		silence = NatLossesSilence;
+		NatLossesCount = 0;
+	}
+
+	// the NAT drops the bindings after that silence, so the pings should come more often
+	int32 interval = PingInterval.load();
+	int32 updated = qMax(int32(silence * 3 / 4), kMinPingInterval);
+	if (updated < interval && PingInterval.testAndSetOrdered(interval, updated)) {
+		NatTimeoutsDetected.ref();
+		DEBUG_LOG(("MTP Info: dc %1 connections lost after %2ms of silence, ping interval now %3ms").arg(dc).arg(silence).arg(updated));
+	}
+}
+
 void ConnectionPrivate::onPingSendForce() {
 	if (!_pingId) {
 		_pingSendAt = 0;
@@ -1295,6 +1604,13 @@ void ConnectionPrivate::onWaitConnectedFailed() {
 	DEBUG_LOG(("MTP Info: can't connect in %1ms").arg(_waitForConnected));
 	if (_waitForConnected < MTPMaxConnectDelay) _waitForConnected *= 2;
 
+	for_const (auto &candidate, _race) {
+		dcEndpointFailed(candidate.tcp);
+	}
+	if (!_race.isEmpty()) {
+		emit endpointsStatsChanged();
+	}
+
 	doDisconnect();
 	restarted = true;
 
@@ -1303,13 +1619,10 @@ void ConnectionPrivate::onWaitConnectedFailed() {
 }
 
 void ConnectionPrivate::onWaitIPv4Failed() {
-	_conn = _conn6;
-	destroyConn(&_conn4);
-
-	if (_conn) {
+	if (_connIPv6Ready) {
 		DEBUG_LOG(("MTP Info: can't connect through IPv4, using IPv6 connection."));
 
-		updateAuthKey();
+		chooseConn(_connIPv6Ready);
 	} else {
 		restart();
 	}
@@ -1362,10 +1675,13 @@ void ConnectionPrivate::handleReceived() {
 		return restart();
 	}
 
+	MessageDecryptor decryptor; // one cipher context for all the received packets
 	while (_conn->received().size()) {
-		const mtpBuffer &encryptedBuf(_conn->received().front());
-		uint32 len = encryptedBuf.size();
-		const mtpPrime *encrypted(encryptedBuf.data());
+		mtpBuffer slab(_conn->received().front()); // the packet is decrypted in place and shared with the responses
+		_conn->received().pop_front();
+
+		uint32 len = slab.size();
+		mtpPrime *encrypted(slab.data()); // no detach, the queue does not hold the buffer anymore
 		if (len < 18) { // 2 auth_key_id, 4 msg_key, 2 salt, 2 session, 2 msg_id, 1 seq_no, 1 length, (1 data + 3 padding) min
 			LOG(("TCP Error: bad message received, len %1").arg(len * sizeof(mtpPrime)));
 			TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(encrypted, len * sizeof(mtpPrime)).str()));
@@ -1381,30 +1697,27 @@ void ConnectionPrivate::handleReceived() {
 			return restart();
 		}
 
-		QByteArray dataBuffer((len - 6) * sizeof(mtpPrime), Qt::Uninitialized);
-		mtpPrime *data((mtpPrime*)dataBuffer.data()), *msg = data + 8;
+		uint32 dataSize = (len - 6) * sizeof(mtpPrime);
+		mtpPrime *data(encrypted + 6), *msg = data + 8;
 		const mtpPrime *from(msg), *end;
 		MTPint128 msgKey(*(MTPint128*)(encrypted + 2));
 
-		aesIgeDecrypt(encrypted + 6, data, dataBuffer.size(), key, msgKey);
+		auto decrypted = decryptor.decrypt(data, dataSize, key, msgKey);
 
 		uint64 serverSalt = *(uint64*)&data[0], session = *(uint64*)&data[2], msgId = *(uint64*)&data[4];
 		uint32 seqNo = *(uint32*)&data[6], msgLen = *(uint32*)&data[7];
 		bool needAck = (seqNo & 0x01);
 
-		if (uint32(dataBuffer.size()) < msgLen + 8 * sizeof(mtpPrime) || (msgLen & 0x03)) {
-			LOG(("TCP Error: bad msg_len received %1, data size: %2").arg(msgLen).arg(dataBuffer.size()));
+		if (decrypted == MessageDecryptor::Result::BadLength) {
+			LOG(("TCP Error: bad msg_len received %1, data size: %2").arg(msgLen).arg(dataSize));
 			TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(encrypted, len * sizeof(mtpPrime)).str()));
-			_conn->received().pop_front();
 
 			lockFinished.unlock();
 			return restart();
 		}
-		uchar sha1Buffer[20];
-		if (memcmp(&msgKey, hashSha1(data, msgLen + 8 * sizeof(mtpPrime), sha1Buffer) + 1, sizeof(msgKey))) {
+		if (decrypted == MessageDecryptor::Result::BadHash) {
 			LOG(("TCP Error: bad SHA1 hash after aesDecrypt in message"));
 			TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(encrypted, len * sizeof(mtpPrime)).str()));
-			_conn->received().pop_front();
 
 			lockFinished.unlock();
 			return restart();
@@ -1415,14 +1728,11 @@ void ConnectionPrivate::handleReceived() {
 		if (session != serverSession) {
 			LOG(("MTP Error: bad server session received"));
 			TCP_LOG(("MTP Error: bad server session %1 instead of %2 in message received").arg(session).arg(serverSession));
-			_conn->received().pop_front();
 
 			lockFinished.unlock();
 			return restart();
 		}
 
-		_conn->received().pop_front();
-
 		int32 serverTime((int32)(msgId >> 32)), clientTime(unixtime());
 		bool isReply = ((msgId & 0x03) == 1);
 		if (!isReply && ((msgId & 0x03) != 3)) {
@@ -1462,43 +1772,26 @@ void ConnectionPrivate::handleReceived() {
 		int32 res = 1; // if no need to handle, then succeed
 		end = data + 8 + (msgLen >> 2);
 		const mtpPrime *sfrom(data + 4);
+		TrafficRecorder::record(dc, TrafficRecorder::Direction::Received, sfrom, end);
+		if (dc == bareDcId(dc)) { // main session, the file transfers leave the room for it
+			BandwidthGovernor::interactive(BandwidthGovernor::Direction::Download, (end - sfrom) * sizeof(mtpPrime));
+		}
 		MTP_LOG(dc, ("Recv: ") + mtpTextSerialize(sfrom, end));
 
-		bool needToHandle = false;
-		{
-			QWriteLocker lock(sessionData->receivedIdsMutex());
-			mtpMsgIdsMap &receivedIds(sessionData->receivedIdsSet());
-			needToHandle = receivedIds.insert(msgId, needAck);
-		}
+		bool needToHandle = sessionData->receivedIdsSet().registerMsgId(msgId, needAck);
 		if (needToHandle) {
-			res = handleOneReceived(from, end, msgId, serverTime, serverSalt, badTime);
-		}
-		{
-			QWriteLocker lock(sessionData->receivedIdsMutex());
-			mtpMsgIdsMap &receivedIds(sessionData->receivedIdsSet());
-			uint32 receivedIdsSize = receivedIds.size();
-			while (receivedIdsSize-- > MTPIdsBufferSize) {
-				receivedIds.erase(receivedIds.begin());
-			}
+			res = handleOneReceived(slab, from, end, msgId, serverTime, serverSalt, badTime);
 		}
 
 		// send acks
 		uint32 toAckSize = ackRequestData.size();
 		if (toAckSize) {
 			DEBUG_LOG(("MTP Info: will send %1 acks, ids: %2").arg(toAckSize).arg(Logs::vector(ackRequestData)));
-			emit sendAnythingAsync(MTPAckSendWaiting);
-		}
-
-		bool emitSignal = false;
-		{
-			QReadLocker locker(sessionData->haveReceivedMutex());
-			emitSignal = !sessionData->haveReceivedMap().isEmpty();
-			if (emitSignal) {
-				DEBUG_LOG(("MTP Info: emitting needToReceive() - need to parse in another thread, haveReceivedMap.size() = %1").arg(sessionData->haveReceivedMap().size()));
-			}
+			emit sendAnythingAsync(ackSendWaiting());
 		}
 
-		if (emitSignal) {
+		if (sessionData->needToReceive()) {
+			DEBUG_LOG(("MTP Info: emitting needToReceive() - need to parse in another thread"));
 			emit needToReceive();
 		}
 
@@ -1526,7 +1819,7 @@ void ConnectionPrivate::handleReceived() {
 	}
 }
 
-int32 ConnectionPrivate::handleOneReceived(const mtpPrime *from, const mtpPrime *end, uint64 msgId, int32 serverTime, uint64 serverSalt, bool badTime) {
+int32 ConnectionPrivate::handleOneReceived(const mtpBuffer &slab, const mtpPrime *from, const mtpPrime *end, uint64 msgId, int32 serverTime, uint64 serverSalt, bool badTime) {
 	mtpTypeId cons = *from;
 	try {
 
@@ -1538,7 +1831,7 @@ int32 ConnectionPrivate::handleOneReceived(const mtpPrime *from, const mtpPrime
 		if (!response.size()) {
 			return -1;
 		}
-		return handleOneReceived(response.data(), response.data() + response.size(), msgId, serverTime, serverSalt, badTime);
+		return handleOneReceived(response, response.constData(), response.constData() + response.size(), msgId, serverTime, serverSalt, badTime);
 	}
 
 	case mtpc_msg_container: {
@@ -1573,15 +1866,10 @@ int32 ConnectionPrivate::handleOneReceived(const mtpPrime *from, const mtpPrime
 			otherEnd = from + (bytes.v >> 2);
 			if (otherEnd > end) throw mtpErrorInsufficient();
 
-			bool needToHandle = false;
-			{
-				QWriteLocker lock(sessionData->receivedIdsMutex());
-				mtpMsgIdsMap &receivedIds(sessionData->receivedIdsSet());
-				needToHandle = receivedIds.insert(inMsgId.v, needAck);
-			}
+			bool needToHandle = sessionData->receivedIdsSet().registerMsgId(inMsgId.v, needAck);
 			int32 res = 1; // if no need to handle, then succeed
 			if (needToHandle) {
-				res = handleOneReceived(from, otherEnd, inMsgId.v, serverTime, serverSalt, badTime);
+				res = handleOneReceived(slab, from, otherEnd, inMsgId.v, serverTime, serverSalt, badTime);
 				badTime = false;
 			}
 			if (res <= 0) {
@@ -1703,6 +1991,12 @@ int32 ConnectionPrivate::handleOneReceived(const mtpPrime *from, const mtpPrime
 		sessionData->setSalt(serverSalt);
 		unixtimeSet(serverTime);
 
+		// the schedule was wrong or our time was, it will be requested again
+		BadServerSaltsReceived.ref();
+		if (const AuthKeyPtr &key = sessionData->getKey()) {
+			key->clearServerSalts();
+		}
+
 		if (setState(ConnectedState, ConnectingState)) { // maybe only connected
 			if (restarted) {
 				emit resendAllAsync();
@@ -1729,37 +2023,31 @@ int32 ConnectionPrivate::handleOneReceived(const mtpPrime *from, const mtpPrime
 
 		QByteArray info(idsCount, Qt::Uninitialized);
 		{
-			QReadLocker lock(sessionData->receivedIdsMutex());
-			const mtpMsgIdsMap &receivedIds(sessionData->receivedIdsSet());
-			mtpMsgIdsMap::const_iterator receivedIdsEnd(receivedIds.cend());
+			const ReceivedMsgIds &receivedIds(sessionData->receivedIdsSet());
 			uint64 minRecv = receivedIds.min(), maxRecv = receivedIds.max();
 
 			QReadLocker locker(sessionData->wereAckedMutex());
-			const mtpRequestIdsMap &wereAcked(sessionData->wereAckedMap());
-			mtpRequestIdsMap::const_iterator wereAckedEnd(wereAcked.cend());
+			const AckedMsgIds &wereAcked(sessionData->wereAckedMap());
 
 			for (uint32 i = 0, l = idsCount; i < l; ++i) {
 				char state = 0;
 				uint64 reqMsgId = ids[i].v;
-				if (reqMsgId < minRecv) {
+				if (const bool *needAck = receivedIds.find(reqMsgId)) {
+					state |= 0x04;
+					if (wereAcked.contains(reqMsgId)) {
+						state |= 0x80; // we know, that server knows, that we received request
+					}
+					if (*needAck) { // need ack, so we sent ack
+						state |= 0x08;
+					} else {
+						state |= 0x10;
+					}
+				} else if (reqMsgId < minRecv) {
 					state |= 0x01;
 				} else if (reqMsgId > maxRecv) {
 					state |= 0x03;
 				} else {
-					mtpMsgIdsMap::const_iterator recv = receivedIds.constFind(reqMsgId);
-					if (recv == receivedIdsEnd) {
-						state |= 0x02;
-					} else {
-						state |= 0x04;
-						if (wereAcked.constFind(reqMsgId) != wereAckedEnd) {
-							state |= 0x80; // we know, that server knows, that we received request
-						}
-						if (recv.value()) { // need ack, so we sent ack
-							state |= 0x08;
-						} else {
-							state |= 0x10;
-						}
-					}
+					state |= 0x02;
 				}
 				info[i] = state;
 			}
@@ -1854,13 +2142,8 @@ int32 ConnectionPrivate::handleOneReceived(const mtpPrime *from, const mtpPrime
 		}
 		requestsAcked(ids);
 
-		bool received = false;
 		MTPlong resMsgId = data.vanswer_msg_id;
-		{
-			QReadLocker lock(sessionData->receivedIdsMutex());
-			const mtpMsgIdsMap &receivedIds(sessionData->receivedIdsSet());
-			received = (receivedIds.find(resMsgId.v) != receivedIds.cend()) && (receivedIds.min() < resMsgId.v);
-		}
+		bool received = sessionData->receivedIdsSet().contains(resMsgId.v);
 		if (received) {
 			ackRequestData.push_back(resMsgId);
 		} else {
@@ -1879,13 +2162,8 @@ int32 ConnectionPrivate::handleOneReceived(const mtpPrime *from, const mtpPrime
 
 		DEBUG_LOG(("Message Info: msg new detailed info, answerId %2, status %3, bytes %4").arg(data.vanswer_msg_id.v).arg(data.vstatus.v).arg(data.vbytes.v));
 
-		bool received = false;
 		MTPlong resMsgId = data.vanswer_msg_id;
-		{
-			QReadLocker lock(sessionData->receivedIdsMutex());
-			const mtpMsgIdsMap &receivedIds(sessionData->receivedIdsSet());
-			received = (receivedIds.find(resMsgId.v) != receivedIds.cend()) && (receivedIds.min() < resMsgId.v);
-		}
+		bool received = sessionData->receivedIdsSet().contains(resMsgId.v);
 		if (received) {
 			ackRequestData.push_back(resMsgId);
 		} else {
@@ -1929,26 +2207,23 @@ int32 ConnectionPrivate::handleOneReceived(const mtpPrime *from, const mtpPrime
 		}
 		requestsAcked(ids, true);
 
-		if (typeId == mtpc_gzip_packed) {
+		mtpRequestId requestId = wasSent(reqMsgId.v);
+		if (typeId == mtpc_gzip_packed && !ResponseParser::inflateInParser(requestId, from, end)) {
 			DEBUG_LOG(("RPC Info: gzip container"));
 			response = ungzip(++from, end);
-			if (!response.size()) {
+			if (response.isEmpty()) {
 				return -1;
 			}
-			typeId = response[0];
 		} else {
-			response.resize(end - from);
-			memcpy(response.data(), from, (end - from) * sizeof(mtpPrime));
+			response = mtpResponse(slab, from, end);
 		}
 		if (!sessionData->layerWasInited()) {
 			sessionData->setLayerWasInited(true);
 			sessionData->owner()->notifyLayerInited(true);
 		}
 
-		mtpRequestId requestId = wasSent(reqMsgId.v);
 		if (requestId && requestId != mtpRequestId(0xFFFFFFFF)) {
-			QWriteLocker locker(sessionData->haveReceivedMutex());
-			sessionData->haveReceivedMap().insert(requestId, response); // save rpc_result for processing in main mtp thread
+			sessionData->pushReceived(requestId, response); // save rpc_result for processing in main mtp thread
 		} else {
 			DEBUG_LOG(("RPC Info: requestId not found for msgId %1").arg(reqMsgId.v));
 		}
@@ -1984,13 +2259,7 @@ int32 ConnectionPrivate::handleOneReceived(const mtpPrime *from, const mtpPrime
 		}
 		resendMany(toResend, 10, true);
 
-		mtpBuffer update(from - start);
-		if (from > start) memcpy(update.data(), start, (from - start) * sizeof(mtpPrime));
-
-		QWriteLocker locker(sessionData->haveReceivedMutex());
-		mtpResponseMap &haveReceived(sessionData->haveReceivedMap());
-		mtpRequestId fakeRequestId = sessionData->nextFakeRequestId();
-		haveReceived.insert(fakeRequestId, mtpResponse(update)); // notify main process about new session - need to get difference
+		sessionData->pushReceivedUpdate(mtpResponse(slab, start, from)); // notify main process about new session - need to get difference
 	} return 1;
 
 	case mtpc_ping: {
@@ -2002,6 +2271,42 @@ int32 ConnectionPrivate::handleOneReceived(const mtpPrime *from, const mtpPrime
 		emit sendPongAsync(msgId, msg.vping_id.v);
 	} return 1;
 
+	case mtpc_future_salts: {
+		// salts:vector<future_salt> is a bare vector of bare constructors,
+		// the generated MTPfutureSalts expects a boxed one, so read it here
+		MTPlong reqMsgId;
+		MTPint now, count;
+		++from; // future_salts cons
+		reqMsgId.read(from, end);
+		now.read(from, end);
+		count.read(from, end);
+		if (count.v < 0 || count.v > (end - from) / 4) throw mtpErrorInsufficient(); // future_salt is 4 mtpPrime
+		DEBUG_LOG(("Message Info: future salts received, req_msg_id: %1, now: %2, count: %3").arg(reqMsgId.v).arg(now.v).arg(count.v));
+
+		// the schedule is in the server time, it is kept in our unixtime()
+		int32 shift = unixtime() - now.v;
+		ServerSalts schedule;
+		schedule.reserve(count.v);
+		for (int32 i = 0; i < count.v; ++i) {
+			MTPint validSince, validUntil;
+			MTPlong salt;
+			validSince.read(from, end);
+			validUntil.read(from, end);
+			salt.read(from, end);
+
+			ServerSalt entry;
+			entry.validSince = validSince.v + shift;
+			entry.validUntil = validUntil.v + shift;
+			entry.salt = salt.v;
+			schedule.push_back(entry);
+		}
+		if (const AuthKeyPtr &key = sessionData->getKey()) {
+			key->setServerSalts(schedule);
+			applyServerSaltSchedule();
+			emit serverSaltsReceived();
+		}
+	} return 1;
+
 	case mtpc_pong: {
 		MTPPong msg(from, end);
 		const auto &data(msg.c_pong());
@@ -2013,6 +2318,13 @@ int32 ConnectionPrivate::handleOneReceived(const mtpPrime *from, const mtpPrime
 		}
 		if (data.vping_id.v == _pingId) {
 			_pingId = 0;
+			if (_pingAfterIdle) { // survived the silence, try to ping less often
+				_pingAfterIdle = false;
+				int32 interval = PingInterval.load();
+				if (interval < kMaxPingInterval) {
+					PingInterval.testAndSetOrdered(interval, qMin(interval + kPingIntervalGrowStep, kMaxPingInterval));
+				}
+			}
 		} else {
 			DEBUG_LOG(("Message Info: just pong..."));
 		}
@@ -2039,13 +2351,7 @@ int32 ConnectionPrivate::handleOneReceived(const mtpPrime *from, const mtpPrime
 		return -2;
 	}
 
-	mtpBuffer update(end - from);
-	if (end > from) memcpy(update.data(), from, (end - from) * sizeof(mtpPrime));
-
-	QWriteLocker locker(sessionData->haveReceivedMutex());
-	mtpResponseMap &haveReceived(sessionData->haveReceivedMap());
-	mtpRequestId fakeRequestId = sessionData->nextFakeRequestId();
-	haveReceived.insert(fakeRequestId, mtpResponse(update)); // notify main process about new updates
+	sessionData->pushReceivedUpdate(mtpResponse(slab, from, end)); // notify main process about new updates
 
 	if (cons != mtpc_updatesTooLong && cons != mtpc_updateShortMessage && cons != mtpc_updateShortChatMessage && cons != mtpc_updateShortSentMessage && cons != mtpc_updateShort && cons != mtpc_updatesCombined && cons != mtpc_updates) {
 		LOG(("Message Error: unknown constructor %1").arg(cons)); // maybe new api?..
@@ -2054,50 +2360,9 @@ int32 ConnectionPrivate::handleOneReceived(const mtpPrime *from, const mtpPrime
 	return 1;
 }
 
-mtpBuffer ConnectionPrivate::ungzip(const mtpPrime *from, const mtpPrime *end) const {
-	MTPstring packed(from, end); // read packed string as serialized mtp string type
-	uint32 packedLen = packed.c_string().v.size(), unpackedChunk = packedLen, unpackedLen = 0;
-
-	mtpBuffer result; // * 4 because of mtpPrime type
-	result.resize(0);
-	z_stream stream;
-	stream.zalloc = 0;
-	stream.zfree = 0;
-	stream.opaque = 0;
-	stream.avail_in = 0;
-	stream.next_in = 0;
-	int res = inflateInit2(&stream, 16 + MAX_WBITS);
-	if (res != Z_OK) {
-		LOG(("RPC Error: could not init zlib stream, code: %1").arg(res));
-		return result;
-	}
-	stream.avail_in = packedLen;
-	stream.next_in = (Bytef*)&packed._string().v[0];
-
-	stream.avail_out = 0;
-	while (!stream.avail_out) {
-		result.resize(result.size() + unpackedChunk);
-		stream.avail_out = unpackedChunk * sizeof(mtpPrime);
-		stream.next_out = (Bytef*)&result[result.size() - unpackedChunk];
-		int res = inflate(&stream, Z_NO_FLUSH);
-		if (res != Z_OK && res != Z_STREAM_END) {
-			inflateEnd(&stream);
-			LOG(("RPC Error: could not unpack gziped data, code: %1").arg(res));
-			DEBUG_LOG(("RPC Error: bad gzip: %1").arg(Logs::mb(&packed.c_string().v[0], packedLen).str()));
-			return mtpBuffer();
-		}
-	}
-	if (stream.avail_out & 0x03) {
-		uint32 badSize = result.size() * sizeof(mtpPrime) - stream.avail_out;
-		LOG(("RPC Error: bad length of unpacked data %1").arg(badSize));
-		DEBUG_LOG(("RPC Error: bad unpacked data %1").arg(Logs::mb(result.data(), badSize).str()));
-		return mtpBuffer();
-	}
-	result.resize(result.size() - (stream.avail_out >> 2));
-	inflateEnd(&stream);
-	if (!result.size()) {
-		LOG(("RPC Error: bad length of unpacked data 0"));
-	}
+mtpBuffer ConnectionPrivate::ungzip(const mtpPrime *from, const mtpPrime *end) {
+	mtpBuffer result;
+	_inflater.inflate(from, end, result);
 	return result;
 }
 
@@ -2123,7 +2388,7 @@ void ConnectionPrivate::requestsAcked(const QVector<MTPlong> &ids, bool byRespon
 	QVector<MTPlong> toAckMore;
 	{
 		QWriteLocker locker1(sessionData->wereAckedMutex());
-		mtpRequestIdsMap &wereAcked(sessionData->wereAckedMap());
+		AckedMsgIds &wereAcked(sessionData->wereAckedMap());
 
 		{
 			QWriteLocker locker2(sessionData->haveSentMutex());
@@ -2149,7 +2414,10 @@ void ConnectionPrivate::requestsAcked(const QVector<MTPlong> &ids, bool byRespon
 							moveToAcked = !hasCallbacks(reqId);
 						}
 						if (moveToAcked) {
-							wereAcked.insert(msgId, reqId);
+							if (byResponse) {
+								SendScheduler::responseReceived(req.value(), getms(true));
+							}
+							insertAcked(wereAcked, msgId, reqId, clearedAcked);
 							haveSent.erase(req);
 						} else {
 							DEBUG_LOG(("Message Info: ignoring ACK for msgId %1 because request %2 requires a response").arg(msgId).arg(reqId));
@@ -2171,7 +2439,7 @@ void ConnectionPrivate::requestsAcked(const QVector<MTPlong> &ids, bool byRespon
 							mtpPreRequestMap &toSend(sessionData->toSendMap());
 							mtpPreRequestMap::iterator req = toSend.find(reqId);
 							if (req != toSend.cend()) {
-								wereAcked.insert(msgId, req.value()->requestId);
+								insertAcked(wereAcked, msgId, req.value()->requestId, clearedAcked);
 								if (req.value()->requestId != reqId) {
 									DEBUG_LOG(("Message Error: for msgId %1 found resent request, requestId %2, contains requestId %3").arg(msgId).arg(reqId).arg(req.value()->requestId));
 								} else {
@@ -2191,17 +2459,6 @@ void ConnectionPrivate::requestsAcked(const QVector<MTPlong> &ids, bool byRespon
 				}
 			}
 		}
-
-		uint32 ackedCount = wereAcked.size();
-		if (ackedCount > MTPIdsBufferSize) {
-			DEBUG_LOG(("Message Info: removing some old acked sent msgIds %1").arg(ackedCount - MTPIdsBufferSize));
-			clearedAcked.reserve(ackedCount - MTPIdsBufferSize);
-			while (ackedCount-- > MTPIdsBufferSize) {
-				mtpRequestIdsMap::iterator i(wereAcked.begin());
-				clearedAcked.push_back(RPCCallbackClear(i.key(), RPCError::TimeoutError));
-				wereAcked.erase(i);
-			}
-		}
 	}
 
 	if (clearedAcked.size()) {
@@ -2272,71 +2529,55 @@ void ConnectionPrivate::resendMany(QVector<quint64> msgIds, quint64 msCanWait, b
 	emit resendManyAsync(msgIds, msCanWait, forceContainer, sendMsgStateInfo);
 }
 
-void ConnectionPrivate::onConnected4() {
+void ConnectionPrivate::onConnected() {
+	auto conn = qobject_cast<AbstractConnection*>(sender());
+	auto index = findCandidate(conn);
+	if (index < 0) return;
+
 	_waitForConnected = MTPMinConnectDelay;
 	_waitForConnectedTimer.stop();
 
-	_waitForIPv4Timer.stop();
-
 	QReadLocker lockFinished(&sessionDataMutex);
 	if (!sessionData) return;
 
-	disconnect(_conn4, SIGNAL(connected()), this, SLOT(onConnected4()));
-	if (!_conn4->isConnected()) {
-		LOG(("Connection Error: not connected in onConnected4(), state: %1").arg(_conn4->debugState()));
+	disconnect(conn, SIGNAL(connected()), this, SLOT(onConnected()));
+	if (!conn->isConnected()) {
+		LOG(("Connection Error: not connected in onConnected(), state: %1").arg(conn->debugState()));
 
 		lockFinished.unlock();
 		return restart();
 	}
 
-	_conn = _conn4;
-	destroyConn(&_conn6);
-
-	DEBUG_LOG(("MTP Info: connection through IPv4 succeed."));
+	auto candidate = _race.at(index);
+	auto rtt = int32(getms(true) - candidate.startedAt);
+	dcEndpointConnected(candidate.tcp, rtt);
+	emit endpointsStatsChanged();
 
-	lockFinished.unlock();
-	updateAuthKey();
-}
-
-void ConnectionPrivate::onConnected6() {
-	_waitForConnected = MTPMinConnectDelay;
-	_waitForConnectedTimer.stop();
-
-	QReadLocker lockFinished(&sessionDataMutex);
-	if (!sessionData) return;
+	if (isIPv6Endpoint(candidate.tcp) && waitingForIPv4()) {
+		if (!_connIPv6Ready) {
+			DEBUG_LOG(("MTP Info: connection through IPv6 to %1:%2 succeed in %3ms, waiting IPv4 for %4ms.").arg(candidate.tcp.ip.c_str()).arg(candidate.tcp.port).arg(rtt).arg(MTPIPv4ConnectionWaitTimeout));
 
-	disconnect(_conn6, SIGNAL(connected()), this, SLOT(onConnected6()));
-	if (!_conn6->isConnected()) {
-		LOG(("Connection Error: not connected in onConnected(), state: %1").arg(_conn6->debugState()));
-
-		lockFinished.unlock();
-		return restart();
+			_connIPv6Ready = conn;
+			_waitForIPv4Timer.start(MTPIPv4ConnectionWaitTimeout);
+		}
+		return;
 	}
 
-	DEBUG_LOG(("MTP Info: connection through IPv6 succeed, waiting IPv4 for %1ms.").arg(MTPIPv4ConnectionWaitTimeout));
+	DEBUG_LOG(("MTP Info: connection through %1 to %2:%3 succeed in %4ms.").arg(isIPv6Endpoint(candidate.tcp) ? "IPv6" : "IPv4").arg(candidate.tcp.ip.c_str()).arg(candidate.tcp.port).arg(rtt));
 
-	_waitForIPv4Timer.start(MTPIPv4ConnectionWaitTimeout);
-}
-
-void ConnectionPrivate::onDisconnected4() {
-	if (_conn && _conn == _conn6) return; // disconnected the unused
-
-	if (_conn || !_conn6) {
-		destroyConn();
-		restart();
-	} else {
-		destroyConn(&_conn4);
-	}
+	lockFinished.unlock();
+	chooseConn(conn);
 }
 
-void ConnectionPrivate::onDisconnected6() {
-	if (_conn && _conn == _conn4) return; // disconnected the unused
+void ConnectionPrivate::onDisconnected() {
+	auto conn = qobject_cast<AbstractConnection*>(sender());
+	if (findCandidate(conn) < 0) return;
+	if (_conn && _conn != conn) return; // disconnected the unused
 
-	if (_conn || !_conn4) {
+	if (_conn || !dropCandidate(conn)) {
+		if (_conn) checkNatTimeout();
 		destroyConn();
 		restart();
-	} else {
-		destroyConn(&_conn6);
 	}
 }
 
@@ -2803,6 +3044,7 @@ void ConnectionPrivate::authKeyCreated() {
 
 	connect(_conn, SIGNAL(receivedData()), this, SLOT(handleReceived()));
 
+	applyServerSaltSchedule(); // after a restart the persisted schedule may give a salt right away
 	if (sessionData->getSalt()) { // else receive salt in bad_server_salt first, then try to send all the requests
 		setState(ConnectedState);
 		if (restarted) {
@@ -2816,6 +3058,24 @@ void ConnectionPrivate::authKeyCreated() {
 	emit needToSendAsync();
 }
 
+void ConnectionPrivate::applyServerSaltSchedule() {
+	const AuthKeyPtr &key(sessionData->getKey());
+	if (!key) return;
+
+	int32 now = unixtime();
+	uint64 current = sessionData->getSalt(), scheduled = key->serverSalt(now, current);
+	if (scheduled != current) {
+		sessionData->setSalt(scheduled);
+
+		// a resend is avoided only if the old salt has already expired,
+		// before that the server would have accepted it
+		int32 currentValidUntil = key->serverSaltValidUntil(current);
+		bool expired = (currentValidUntil > 0 && currentValidUntil <= now);
+		int avoided = expired ? (SaltResendsAvoided.fetchAndAddRelaxed(1) + 1) : SaltResendsAvoided.load();
+		DEBUG_LOG(("MTP Info: salt %1 taken from the schedule instead of %2, dc %3, salt resends avoided: %4, bad_server_salt received: %5").arg(scheduled).arg(current).arg(dc).arg(avoided).arg(BadServerSaltsReceived.load()));
+	}
+}
+
 void ConnectionPrivate::clearAuthKeyData() {
 	if (authKeyData) {
 #ifdef Q_OS_WIN
@@ -2834,31 +3094,18 @@ void ConnectionPrivate::clearAuthKeyData() {
 	}
 }
 
-void ConnectionPrivate::onError4(bool mayBeBadKey) {
-	if (_conn && _conn == _conn6) return; // error in the unused
+void ConnectionPrivate::onError(bool mayBeBadKey) {
+	auto conn = qobject_cast<AbstractConnection*>(sender());
+	if (findCandidate(conn) < 0) return;
+	if (_conn && _conn != conn) return; // error in the unused
 
-	if (_conn || !_conn6) {
+	if (_conn || !dropCandidate(conn)) {
+		if (_conn) checkNatTimeout();
 		destroyConn();
 		_waitForConnectedTimer.stop();
 
-		MTP_LOG(dc, ("Restarting after error in IPv4 connection, maybe bad key: %1...").arg(Logs::b(mayBeBadKey)));
+		MTP_LOG(dc, ("Restarting after error in connection, maybe bad key: %1...").arg(Logs::b(mayBeBadKey)));
 		return restart(mayBeBadKey);
-	} else {
-		destroyConn(&_conn4);
-	}
-}
-
-void ConnectionPrivate::onError6(bool mayBeBadKey) {
-	if (_conn && _conn == _conn4) return; // error in the unused
-
-	if (_conn || !_conn4) {
-		destroyConn();
-		_waitForConnectedTimer.stop();
-
-		MTP_LOG(dc, ("Restarting after error in IPv6 connection, maybe bad key: %1...").arg(Logs::b(mayBeBadKey)));
-		return restart(mayBeBadKey);
-	} else {
-		destroyConn(&_conn6);
 	}
 }
 
@@ -2965,6 +3212,10 @@ bool ConnectionPrivate::sendRequest(mtpRequest &request, bool needAnyResponse, Q
 	memcpy(request->data() + 2, &session, 2 * sizeof(mtpPrime));
 
 	const mtpPrime *from = request->constData() + 4;
+	TrafficRecorder::record(dc, TrafficRecorder::Direction::Sent, from, from + messageSize);
+	if (dc == bareDcId(dc)) {
+		BandwidthGovernor::interactive(BandwidthGovernor::Direction::Upload, messageSize * sizeof(mtpPrime));
+	}
 	MTP_LOG(dc, ("Send: ") + mtpTextSerialize(from, from + messageSize));
 
 	uchar encryptedSHA[20];
@@ -3006,9 +3257,9 @@ mtpRequestId ConnectionPrivate::wasSent(mtpMsgId msgId) const {
 	}
 	{
 		QReadLocker locker(sessionData->wereAckedMutex());
-		const mtpRequestIdsMap &wereAcked(sessionData->wereAckedMap());
-		mtpRequestIdsMap::const_iterator i = wereAcked.constFind(msgId);
-		if (i != wereAcked.cend()) return i.value();
+		if (const mtpRequestId *requestId = sessionData->wereAckedMap().find(msgId)) {
+			return *requestId;
+		}
 	}
 	return 0;
 }
@@ -3027,7 +3278,7 @@ void ConnectionPrivate::unlockKey() {
 }
 
 ConnectionPrivate::~ConnectionPrivate() {
-	t_assert(_finished && _conn == nullptr && _conn4 == nullptr && _conn6 == nullptr);
+	t_assert(_finished && _conn == nullptr && _race.isEmpty());
 }
 
 void ConnectionPrivate::stop() {
@@ -22,7 +22,9 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 
 #include "mtproto/core_types.h"
 #include "mtproto/auth_key.h"
+#include "mtproto/dc_endpoints.h"
 #include "mtproto/connection_abstract.h"
+#include "mtproto/gzip_inflater.h"
 #include "core/single_timer.h"
 
 namespace MTP {
@@ -44,6 +46,15 @@ private:
 
 };
 
+struct KeepAliveStats {
+	int32 standaloneAckPackets = 0; // packets with nothing but acks
+	int32 wakeups = 0; // packets sent only to ack or to ping
+	int32 piggybackedAcks = 0;
+	int32 piggybackedPings = 0;
+	int32 natTimeouts = 0; // ping interval reductions after a silent connection loss
+	int32 pingInterval = 0; // ms, current forced ping interval
+};
+
 class Connection {
 public:
 
@@ -66,6 +77,9 @@ public:
 	int32 state() const;
 	QString transport() const;
 
+	static KeepAliveStats keepAliveStats();
+	static void logStats();
+
 private:
 
 	QThread *thread;
@@ -103,6 +117,8 @@ signals:
 	void resendAsync(quint64 msgId, quint64 msCanWait, bool forceContainer, bool sendMsgStateInfo);
 	void resendManyAsync(QVector<quint64> msgIds, quint64 msCanWait, bool forceContainer, bool sendMsgStateInfo);
 	void resendAllAsync();
+	void serverSaltsReceived();
+	void endpointsStatsChanged();
 
 	void finished(Connection *connection);
 
@@ -118,6 +134,7 @@ public slots:
 	void onWaitConnectedFailed();
 	void onWaitReceivedFailed();
 	void onWaitIPv4Failed();
+	void onRaceNext();
 
 	void onOldConnection();
 	void onSentSome(uint64 size);
@@ -126,12 +143,9 @@ public slots:
 	void onReadyData();
 	void socketStart(bool afterConfig = false);
 
-	void onConnected4();
-	void onConnected6();
-	void onDisconnected4();
-	void onDisconnected6();
-	void onError4(bool mayBeBadKey = false);
-	void onError6(bool mayBeBadKey = false);
+	void onConnected();
+	void onDisconnected();
+	void onError(bool mayBeBadKey = false);
 
 	void doFinish();
 
@@ -154,8 +168,20 @@ private:
 
 	void doDisconnect();
 
-	void createConn(bool createIPv4, bool createIPv6);
-	void destroyConn(AbstractConnection **conn = 0); // 0 - destory all
+	struct RaceCandidate {
+		AbstractConnection *conn = nullptr;
+		DcEndpoint tcp, http; // http is the same address, if it is not tcpo_only
+		uint64 startedAt = 0;
+	};
+	using RaceCandidates = QVector<RaceCandidate>;
+
+	void createConn(const RaceCandidates &candidates); // sorted by the expected connect time
+	void startCandidate(RaceCandidate candidate);
+	int findCandidate(AbstractConnection *conn) const;
+	bool waitingForIPv4() const;
+	void chooseConn(AbstractConnection *conn);
+	bool dropCandidate(AbstractConnection *conn); // false if nothing is left to race
+	void destroyConn(AbstractConnection *conn = nullptr); // nullptr - destroy all
 
 	mtpMsgId placeToContainer(mtpRequest &toSendRequest, mtpMsgId &bigMsgId, mtpMsgId *&haveSentArr, mtpRequest &req);
 	mtpMsgId prepareToSend(mtpRequest &request, mtpMsgId currentLastId);
@@ -164,8 +190,9 @@ private:
 	bool sendRequest(mtpRequest &request, bool needAnyResponse, QReadLocker &lockFinished);
 	mtpRequestId wasSent(mtpMsgId msgId) const;
 
-	int32 handleOneReceived(const mtpPrime *from, const mtpPrime *end, uint64 msgId, int32 serverTime, uint64 serverSalt, bool badTime);
-	mtpBuffer ungzip(const mtpPrime *from, const mtpPrime *end) const;
+	// slab is the decrypted packet buffer [from, end) points into, responses are passed as views of it
+	int32 handleOneReceived(const mtpBuffer &slab, const mtpPrime *from, const mtpPrime *end, uint64 msgId, int32 serverTime, uint64 serverSalt, bool badTime);
+	mtpBuffer ungzip(const mtpPrime *from, const mtpPrime *end);
 	void handleMsgsStates(const QVector<MTPlong> &ids, const std::string &states, QVector<MTPlong> &acked);
 
 	void clearMessages();
@@ -179,7 +206,13 @@ private:
 
 	ShiftedDcId dc;
 	Connection *_owner;
-	AbstractConnection *_conn, *_conn4, *_conn6;
+	AbstractConnection *_conn, *_connIPv6Ready;
+	bool _connIPv6;
+
+	// All the endpoints of the dc are raced, the next one starts
+	// each kRaceStaggerDelay ms until one of them is connected.
+	RaceCandidates _race, _raceQueue;
+	SingleTimer _raceTimer;
 
 	SingleTimer retryTimer; // exp retry timer
 	int retryTimeout;
@@ -194,6 +227,8 @@ private:
 
 	QVector<MTPlong> ackRequestData, resendRequestData;
 
+	GzipInflater _inflater;
+
 	// if badTime received - search for ids in sessionData->haveSent and sessionData->wereAcked and sync time/salt, return true if found
 	bool requestsFixTimeSalt(const QVector<MTPlong> &ids, int32 serverTime, uint64 serverSalt);
 
@@ -201,10 +236,18 @@ private:
 	void requestsAcked(const QVector<MTPlong> &ids, bool byResponse = false);
 
 	mtpPingId _pingId, _pingIdToSend;
-	uint64 _pingSendAt;
+	uint64 _pingSendAt, _pingForcedAt;
+	bool _pingAfterIdle; // the ping was sent after a silence, grow the ping interval if pong is received
+	uint64 _lastTrafficAt; // last time anything was sent or received, for the NAT timeout guess
+	uint64 _natLossSilence, _natLossAt; // the used connection was lost after that silence, not yet confirmed as a NAT timeout
+	DcEndpoint _natLossEndpoint;
 	mtpMsgId _pingMsgId;
 	SingleTimer _pingSender;
 
+	uint64 ackSendWaiting() const; // how long the acks may wait for some outgoing request
+	void checkNatTimeout(); // called when the used connection is lost
+	void confirmNatTimeout(const DcEndpoint &endpoint); // called when the next connection is chosen
+
 	void resend(quint64 msgId, quint64 msCanWait = 0, bool forceContainer = false, bool sendMsgStateInfo = false);
 	void resendMany(QVector<quint64> msgIds, quint64 msCanWait = 0, bool forceContainer = false, bool sendMsgStateInfo = false);
 
@@ -266,6 +309,9 @@ private:
 	void authKeyCreated();
 	void clearAuthKeyData();
 
+	// take the salt from the key salts schedule if ours is missing or stale
+	void applyServerSaltSchedule();
+
 };
 
 } // namespace internal
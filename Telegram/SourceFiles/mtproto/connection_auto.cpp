@@ -172,7 +172,11 @@ void AutoConnection::connectTcp(const QString &addr, int32 port, MTPDdcOption::F
 }
 
 void AutoConnection::connectHttp(const QString &addr, int32 port, MTPDdcOption::Flags flags) {
-	address = QUrl(((flags & MTPDdcOption::Flag::f_ipv6) ? qsl("http://[%1]:%2/api") : qsl("http://%1:%2/api")).arg(addr).arg(80));//not p - always 80 port for http transport
+	auto httpPort = 80; // not p - always 80 port for http transport
+#ifdef TDESKTOP_FAKE_DC
+	if (cFakeDcPort()) httpPort = port; // the local fake dc serves both on one port
+#endif // TDESKTOP_FAKE_DC
+	address = QUrl(((flags & MTPDdcOption::Flag::f_ipv6) ? qsl("http://[%1]:%2/api") : qsl("http://%1:%2/api")).arg(addr).arg(httpPort));
 	TCP_LOG(("HTTP Info: address is %1").arg(address.toDisplayString()));
 	connect(&manager, SIGNAL(finished(QNetworkReply*)), this, SLOT(requestFinished(QNetworkReply*)));
 
@@ -137,7 +137,11 @@ void HTTPConnection::disconnectFromServer() {
 }
 
 void HTTPConnection::connectHttp(const QString &addr, int32 p, MTPDdcOption::Flags flags) {
-	address = QUrl(((flags & MTPDdcOption::Flag::f_ipv6) ? qsl("http://[%1]:%2/api") : qsl("http://%1:%2/api")).arg(addr).arg(80));//not p - always 80 port for http transport
+	auto httpPort = 80; // not p - always 80 port for http transport
+#ifdef TDESKTOP_FAKE_DC
+	if (cFakeDcPort()) httpPort = p; // the local fake dc serves both on one port
+#endif // TDESKTOP_FAKE_DC
+	address = QUrl(((flags & MTPDdcOption::Flag::f_ipv6) ? qsl("http://[%1]:%2/api") : qsl("http://%1:%2/api")).arg(addr).arg(httpPort));
 	TCP_LOG(("HTTP Info: address is %1").arg(address.toDisplayString()));
 	connect(&manager, SIGNAL(finished(QNetworkReply*)), this, SLOT(requestFinished(QNetworkReply*)));
 
@@ -76,7 +76,7 @@ void AbstractTCPConnection::socketRead() {
 		}
 		int32 bytes = (int32)sock.read(currentPos, toRead);
 		if (bytes > 0) {
-			aesCtrEncrypt(currentPos, bytes, _receiveKey, &_receiveState);
+			_receiveState.encrypt(currentPos, bytes);
 			TCP_LOG(("TCP Info: read %1 bytes").arg(bytes));
 
 			packetRead += bytes;
@@ -292,21 +292,19 @@ void AbstractTCPConnection::tcpSend(mtpBuffer &buffer) {
 		//sock.write(nonce, 64);
 
 		// prepare encryption key/iv
-		memcpy(_sendKey, nonce + 8, CTRState::KeySize);
-		memcpy(_sendState.ivec, nonce + 8 + CTRState::KeySize, CTRState::IvecSize);
+		_sendState.init(nonce + 8, nonce + 8 + CTRState::KeySize);
 
 		// prepare decryption key/iv
 		char reversed[48];
 		memcpy(reversed, nonce + 8, sizeof(reversed));
 		std::reverse(reversed, reversed + base::array_size(reversed));
-		memcpy(_receiveKey, reversed, CTRState::KeySize);
-		memcpy(_receiveState.ivec, reversed + CTRState::KeySize, CTRState::IvecSize);
+		_receiveState.init(reversed, reversed + CTRState::KeySize);
 
 		// write protocol identifier
 		*reinterpret_cast<uint32*>(nonce + 56) = 0xefefefefU;
 
 		sock.write(nonce, 56);
-		aesCtrEncrypt(nonce, 64, _sendKey, &_sendState);
+		_sendState.encrypt(nonce, 64);
 		sock.write(nonce + 56, 8);
 	}
 	++packetNum;
@@ -317,7 +315,7 @@ void AbstractTCPConnection::tcpSend(mtpBuffer &buffer) {
 		data[7] = char(size);
 		TCP_LOG(("TCP Info: write %1 packet %2").arg(packetNum).arg(len + 1));
 
-		aesCtrEncrypt(data + 7, len + 1, _sendKey, &_sendState);
+		_sendState.encrypt(data + 7, len + 1);
 		sock.write(data + 7, len + 1);
 	} else {
 		data[4] = 0x7f;
@@ -326,7 +324,7 @@ void AbstractTCPConnection::tcpSend(mtpBuffer &buffer) {
 		reinterpret_cast<uchar*>(data)[7] = uchar((size >> 16) & 0xFF);
 		TCP_LOG(("TCP Info: write %1 packet %2").arg(packetNum).arg(len + 4));
 
-		aesCtrEncrypt(data + 4, len + 4, _sendKey, &_sendState);
+		_sendState.encrypt(data + 4, len + 4);
 		sock.write(data + 4, len + 4);
 	}
 }
@@ -59,9 +59,7 @@ protected:
 	}
 
 	void tcpSend(mtpBuffer &buffer);
-	uchar _sendKey[CTRState::KeySize];
 	CTRState _sendState;
-	uchar _receiveKey[CTRState::KeySize];
 	CTRState _receiveState;
 
 };
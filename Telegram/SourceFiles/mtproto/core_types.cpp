@@ -26,6 +26,211 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 
 #include "lang.h"
 
+namespace {
+
+constexpr int kRequestPoolMinCapacity = 32; // size classes are 32, 64, .., 4096 mtpPrime
+constexpr int kRequestPoolClassesCount = 8;
+constexpr int kRequestPoolClassLimit = 32; // requests kept in each size class
+
+class RequestsPool {
+public:
+	RequestsPool() : _hits(0), _misses(0) {
+	}
+
+	mtpRequestData *take(int capacity) {
+		int index = 0;
+		while (index < kRequestPoolClassesCount && (kRequestPoolMinCapacity << index) < capacity) {
+			++index;
+		}
+		if (index < kRequestPoolClassesCount) {
+			QMutexLocker lock(&_mutex);
+			QVector<mtpRequestData*> &requests(_free[index]);
+			if (!requests.isEmpty()) {
+				mtpRequestData *result = requests.back();
+				requests.pop_back();
+				++_hits;
+				return result;
+			}
+			++_misses;
+			capacity = (kRequestPoolMinCapacity << index);
+		} else {
+			QMutexLocker lock(&_mutex);
+			++_misses;
+		}
+		mtpRequestData *result = new mtpRequestData(true);
+		result->reserve(capacity);
+		return result;
+	}
+
+	// request is already reset, so no other request is released while the lock is held
+	bool put(mtpRequestData *request) {
+		if (!request->isDetached() || request->capacity() < kRequestPoolMinCapacity) {
+			return false;
+		}
+		if (request->capacity() > (kRequestPoolMinCapacity << (kRequestPoolClassesCount - 1)) * 2) {
+			return false; // don't keep huge buffers
+		}
+		int index = 0;
+		while (index + 1 < kRequestPoolClassesCount && (kRequestPoolMinCapacity << (index + 1)) <= request->capacity()) {
+			++index;
+		}
+
+		QMutexLocker lock(&_mutex);
+		QVector<mtpRequestData*> &requests(_free[index]);
+		if (requests.size() >= kRequestPoolClassLimit) {
+			return false;
+		}
+		request->resize(0); // keeps the capacity
+		requests.push_back(request);
+		return true;
+	}
+
+	uint64 hits() const {
+		QMutexLocker lock(&_mutex);
+		return _hits;
+	}
+	uint64 misses() const {
+		QMutexLocker lock(&_mutex);
+		return _misses;
+	}
+
+private:
+	mutable QMutex _mutex;
+	QVector<mtpRequestData*> _free[kRequestPoolClassesCount];
+	uint64 _hits, _misses;
+
+};
+
+RequestsPool &requestsPool() {
+	// never destroyed, requests may be released from other static destructors
+	static RequestsPool *pool = new RequestsPool();
+	return *pool;
+}
+
+constexpr uint32 kArenaChunkSize = 16384;
+constexpr uint32 kArenaAlignment = 16;
+
+struct ArenaSlot {
+	mtpArena *arena = nullptr;
+};
+QThreadStorage<ArenaSlot> currentArena;
+
+} // namespace
+
+mtpRequestData *mtpRequestData::acquire(uint32 capacity) {
+	return requestsPool().take(capacity);
+}
+
+void mtpRequestData::destroy(mtpRequestData *request) {
+	request->after.clear();
+	request->msDate = request->msQueued = 0;
+	request->requestId = 0;
+	request->needsLayer = false;
+	request->priority = mtpRequestPriority::Normal;
+	if (!requestsPool().put(request)) {
+		delete request;
+	}
+}
+
+uint64 mtpRequestData::poolHits() {
+	return requestsPool().hits();
+}
+
+uint64 mtpRequestData::poolMisses() {
+	return requestsPool().misses();
+}
+
+mtpArena *mtpArena::current() {
+	return currentArena.hasLocalData() ? currentArena.localData().arena : nullptr;
+}
+
+mtpArena::mtpArena(mtpTypeId response) : _position(nullptr), _left(0), _refs(1), _response(response) {
+}
+
+void mtpArena::checkAndUnref() {
+	auto kept = _refs.load() - 1;
+	if (kept > 0) {
+		LOG(("MTP Error: %1 objects of response 0x%2 outlived it and keep its arena of %3 chunks, use mtpEscape() to keep them").arg(kept).arg(_response, 0, 16).arg(_chunks.size()));
+#ifdef _DEBUG
+		t_assert_c(false, "arena-backed data outlived its response, use mtpEscape() to keep it");
+#endif // _DEBUG
+	}
+	unref();
+}
+
+void *mtpArena::allocate(uint32 size) {
+	size = (size + kArenaAlignment - 1) & ~(kArenaAlignment - 1);
+	if (size > _left) {
+		if (size > kArenaChunkSize / 4) { // don't waste the rest of the current chunk
+			char *chunk = new char[size];
+			_chunks.push_back(chunk);
+			return chunk;
+		}
+		_position = new char[kArenaChunkSize];
+		_left = kArenaChunkSize;
+		_chunks.push_back(_position);
+	}
+	void *result = _position;
+	_position += size;
+	_left -= size;
+	return result;
+}
+
+mtpArena::~mtpArena() {
+	for_const (char *chunk, _chunks) {
+		delete[] chunk;
+	}
+}
+
+bool mtpArenaAllowed(mtpTypeId response) {
+	switch (response) {
+	case mtpc_messages_messages: // history slices, the search results are escaped
+	case mtpc_messages_messagesSlice:
+	case mtpc_messages_channelMessages:
+	case mtpc_messages_dialogs:
+	case mtpc_messages_dialogsSlice:
+	case mtpc_updates_difference: // the postponed updates are escaped
+	case mtpc_updates_differenceSlice:
+	case mtpc_updates_channelDifference:
+	case mtpc_updates_channelDifferenceTooLong:
+	case mtpc_updates: // global updates, the same
+	case mtpc_updatesCombined:
+		return true;
+	}
+	return false;
+}
+
+mtpArenaScope::mtpArenaScope(Mode mode) : _arena((mode == Mode::Arena) ? new mtpArena(0) : nullptr), _handedOver(false) {
+	ArenaSlot &slot(currentArena.localData());
+	_previous = slot.arena;
+	slot.arena = _arena;
+}
+
+mtpArenaScope::mtpArenaScope(mtpTypeId response) : _arena(mtpArenaAllowed(response) ? new mtpArena(response) : nullptr), _handedOver(false) {
+	ArenaSlot &slot(currentArena.localData());
+	_previous = slot.arena;
+	slot.arena = _arena;
+}
+
+mtpArenaScope::~mtpArenaScope() {
+	currentArena.localData().arena = _previous;
+	if (!_arena) return;
+
+	if (_handedOver) {
+		_arena->unref();
+	} else {
+		_arena->checkAndUnref();
+	}
+}
+
+mtpArena *mtpArenaScope::handOver() {
+	if (!_arena) return nullptr;
+
+	_handedOver = true;
+	_arena->ref();
+	return _arena;
+}
+
 QString mtpWrapNumber(float64 number) {
 	return QString::number(number);
 }
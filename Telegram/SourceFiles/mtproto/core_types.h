@@ -39,20 +39,61 @@ typedef uint64 mtpPingId;
 typedef QVector<mtpPrime> mtpBuffer;
 typedef uint32 mtpTypeId;
 
+enum class mtpRequestPriority : uchar {
+	Interactive, // user is waiting for it: sending messages, read marks, sent right away
+	Normal,
+	Background, // bulk transfers like file parts, give way to others in packets
+};
+constexpr int mtpRequestPrioritiesCount = 3;
+
 class mtpRequestData;
-class mtpRequest : public QSharedPointer<mtpRequestData> {
+
+// intrusively refcounted, so a request is a single pooled object
+// without a separate shared pointer control block
+class mtpRequest {
 public:
 
-	mtpRequest() {
+	mtpRequest() : _data(nullptr) {
+	}
+	explicit mtpRequest(mtpRequestData *ptr);
+	mtpRequest(const mtpRequest &other);
+	mtpRequest(mtpRequest &&other) : _data(other._data) {
+		other._data = nullptr;
+	}
+	mtpRequest &operator=(const mtpRequest &other);
+	mtpRequest &operator=(mtpRequest &&other);
+	~mtpRequest() {
+		clear();
+	}
+
+	mtpRequestData *data() const {
+		return _data;
+	}
+	mtpRequestData *operator->() const {
+		return _data;
+	}
+	mtpRequestData &operator*() const {
+		return *_data;
 	}
-    explicit mtpRequest(mtpRequestData *ptr) : QSharedPointer<mtpRequestData>(ptr) {
+	explicit operator bool() const {
+		return (_data != nullptr);
 	}
+	bool operator!() const {
+		return !_data;
+	}
+	bool isNull() const {
+		return !_data;
+	}
+	void clear();
 
 	uint32 innerLength() const;
 	void write(mtpBuffer &to) const;
 
 	typedef void ResponseType; // don't know real response type =(
 
+private:
+	mtpRequestData *_data;
+
 };
 
 class mtpRequestData : public mtpBuffer {
@@ -61,17 +102,19 @@ public:
 	// in haveSent: = 0 - container with msgIds, > 0 - when was sent
 	uint64 msDate;
 
+	uint64 msQueued; // when was put to toSend
+
 	mtpRequestId requestId;
 	mtpRequest after;
 	bool needsLayer;
+	mtpRequestPriority priority;
 
-	mtpRequestData(bool/* sure*/) : msDate(0), requestId(0), needsLayer(false) {
+	mtpRequestData(bool/* sure*/) : msDate(0), msQueued(0), requestId(0), needsLayer(false), priority(mtpRequestPriority::Normal) {
 	}
 
 	static mtpRequest prepare(uint32 requestSize, uint32 maxSize = 0) {
 		if (!maxSize) maxSize = requestSize;
-		mtpRequest result(new mtpRequestData(true));
-		result->reserve(8 + maxSize + _padding(maxSize)); // 2: salt, 2: session_id, 2: msg_id, 1: seq_no, 1: message_length
+		mtpRequest result(acquire(8 + maxSize + _padding(maxSize))); // 2: salt, 2: session_id, 2: msg_id, 1: seq_no, 1: message_length
 		result->resize(7);
 		result->push_back(requestSize << 2);
 		return result;
@@ -99,14 +142,60 @@ public:
 	static bool needAck(const mtpRequest &request);
 	static bool needAckByType(mtpTypeId type);
 
+	// request objects together with their buffers are taken from a size-classed
+	// pool in prepare() and returned to it when the last mtpRequest reference is dropped
+	static void destroy(mtpRequestData *request);
+	static uint64 poolHits();
+	static uint64 poolMisses();
+
 private:
 
+	friend class mtpRequest;
+	QAtomicInt _refs;
+
+	static mtpRequestData *acquire(uint32 capacity);
+
 	static uint32 _padding(uint32 requestSize) {
 		return ((8 + requestSize) & 0x03) ? (4 - ((8 + requestSize) & 0x03)) : 0;
 	}
 
 };
 
+inline mtpRequest::mtpRequest(mtpRequestData *ptr) : _data(ptr) {
+	if (_data) _data->_refs.ref();
+}
+
+inline mtpRequest::mtpRequest(const mtpRequest &other) : _data(other._data) {
+	if (_data) _data->_refs.ref();
+}
+
+inline mtpRequest &mtpRequest::operator=(const mtpRequest &other) {
+	if (_data != other._data) {
+		if (other._data) other._data->_refs.ref();
+		clear();
+		_data = other._data;
+	}
+	return *this;
+}
+
+inline mtpRequest &mtpRequest::operator=(mtpRequest &&other) {
+	if (this != &other) {
+		clear();
+		_data = other._data;
+		other._data = nullptr;
+	}
+	return *this;
+}
+
+inline void mtpRequest::clear() {
+	if (auto data = _data) {
+		_data = nullptr;
+		if (!data->_refs.deref()) {
+			mtpRequestData::destroy(data);
+		}
+	}
+}
+
 inline uint32 mtpRequest::innerLength() const { // for template MTP requests and MTPBoxed instanciation
     mtpRequestData *value = data();
 	if (!value || value->size() < 9) return 0;
@@ -121,56 +210,45 @@ inline void mtpRequest::write(mtpBuffer &to) const {
     memcpy(to.data() + was, value->constData() + 8, s * sizeof(mtpPrime));
 }
 
-class mtpResponse : public mtpBuffer {
+// view of a response inside a received packet buffer, shares the packet data
+// so rpc_result and updates are passed to the main thread without copying
+class mtpResponse {
 public:
-	mtpResponse() {
-	}
-	mtpResponse(const mtpBuffer &v) : mtpBuffer(v) {
+	mtpResponse() : _offset(0), _length(0) {
 	}
-	mtpResponse &operator=(const mtpBuffer &v) {
-		mtpBuffer::operator=(v);
-		return (*this);
+	mtpResponse(const mtpBuffer &v) : _buffer(v), _offset(0), _length(v.size()) {
 	}
-	bool needAck() const {
-		if (size() < 8) return false;
-		uint32 seqNo = *(uint32*)(constData() + 6);
-		return (seqNo & 0x01) ? true : false;
+	mtpResponse(const mtpBuffer &slab, const mtpPrime *from, const mtpPrime *end) : _buffer(slab)
+	, _offset(from - slab.constData())
+	, _length(end - from) {
+		t_assert(_offset >= 0 && _length >= 0 && _offset + _length <= slab.size());
 	}
-};
 
-typedef QMap<mtpRequestId, mtpRequest> mtpPreRequestMap;
-typedef QMap<mtpMsgId, mtpRequest> mtpRequestMap;
-typedef QMap<mtpMsgId, bool> mtpMsgIdsSet;
-class mtpMsgIdsMap : public QMap<mtpMsgId, bool> {
-public:
-	typedef QMap<mtpMsgId, bool> ParentType;
-
-	bool insert(const mtpMsgId &k, bool v) {
-		ParentType::const_iterator i = constFind(k);
-		if (i == cend()) {
-			if (size() >= MTPIdsBufferSize && k < min()) {
-				MTP_LOG(-1, ("No need to handle - %1 < min = %2").arg(k).arg(min()));
-				return false;
-			} else {
-				ParentType::insert(k, v);
-				return true;
-			}
-		} else {
-			MTP_LOG(-1, ("No need to handle - %1 already is in map").arg(k));
-			return false;
-		}
+	const mtpPrime *constData() const {
+		return _buffer.constData() + _offset;
 	}
-
-	mtpMsgId min() const {
-		return isEmpty() ? 0 : cbegin().key();
+	const mtpPrime *constEnd() const {
+		return constData() + _length;
 	}
-
-	mtpMsgId max() const {
-		ParentType::const_iterator e(cend());
-		return isEmpty() ? 0 : (--e).key();
+	int size() const {
+		return _length;
+	}
+	bool isEmpty() const {
+		return !_length;
+	}
+	mtpPrime operator[](int index) const {
+		return constData()[index];
 	}
+
+private:
+	mtpBuffer _buffer;
+	int _offset, _length;
+
 };
 
+typedef QMap<mtpRequestId, mtpRequest> mtpPreRequestMap;
+typedef QMap<mtpMsgId, mtpRequest> mtpRequestMap;
+typedef QMap<mtpMsgId, bool> mtpMsgIdsSet;
 class mtpRequestIdsMap : public QMap<mtpMsgId, mtpRequestId> {
 public:
 	typedef QMap<mtpMsgId, mtpRequestId> ParentType;
@@ -205,11 +283,82 @@ public:
 	}
 };
 
+class mtpData;
+
+// All data objects decoded while an mtpArenaScope is active are placed
+// in one arena, each of them holds an arena reference. The arena chunks
+// are freed in bulk when both the scope and the last object are gone.
+class mtpArena {
+public:
+	static mtpArena *current();
+
+	template <typename T>
+	T *create();
+
+	void ref() {
+		_refs.ref();
+	}
+	void unref() {
+		if (!_refs.deref()) delete this;
+	}
+
+	// Decoded objects must be released or copied by mtpEscape() before the
+	// response is handled. When the last holder other than the objects
+	// themselves is gone, kept objects are logged and asserted in debug.
+	void checkAndUnref();
+
+private:
+	mtpArena(mtpTypeId response);
+	mtpArena(const mtpArena &other) = delete;
+	mtpArena &operator=(const mtpArena &other) = delete;
+	~mtpArena();
+
+	void *allocate(uint32 size);
+
+	QVector<char*> _chunks;
+	char *_position;
+	uint32 _left;
+	QAtomicInt _refs;
+	mtpTypeId _response;
+
+	friend class mtpArenaScope;
+
+};
+
+// Only the responses of these types are decoded in an arena, their handlers
+// were checked to keep no decoded objects or to keep them by mtpEscape().
+// Any other response is decoded on the heap, like the app built objects.
+bool mtpArenaAllowed(mtpTypeId response);
+
+class mtpArenaScope {
+public:
+	enum class Mode {
+		Arena,
+		Heap, // objects decoded in this scope are heap allocated, see mtpEscape()
+	};
+	explicit mtpArenaScope(Mode mode);
+	explicit mtpArenaScope(mtpTypeId response); // an arena if mtpArenaAllowed(response)
+	mtpArenaScope(const mtpArenaScope &other) = delete;
+	mtpArenaScope &operator=(const mtpArenaScope &other) = delete;
+	~mtpArenaScope();
+
+	// Objects decoded in this scope are handled somewhere else (on the main
+	// thread for the parser threads), the returned arena reference must be
+	// released by mtpArena::checkAndUnref() after they were handled.
+	mtpArena *handOver();
+
+private:
+	mtpArena *_arena;
+	mtpArena *_previous;
+	bool _handedOver;
+
+};
+
 class mtpData {
 public:
-	mtpData() : cnt(1) {
+	mtpData() : cnt(1), arena(nullptr) {
 	}
-    mtpData(const mtpData &) : cnt(1) {
+	mtpData(const mtpData &) : cnt(1), arena(nullptr) { // clones are always heap allocated
 	}
 
 	mtpData *incr() {
@@ -227,10 +376,42 @@ public:
 	virtual ~mtpData() {
 	}
 
+	static void destroy(mtpData *data) {
+		if (mtpArena *owner = data->arena) {
+			data->~mtpData();
+			owner->unref();
+		} else {
+			delete data;
+		}
+	}
+
 private:
 	uint32 cnt;
+	mtpArena *arena;
+
+	friend class mtpArena;
+
 };
 
+template <typename T>
+T *mtpArena::create() {
+	T *result = new (allocate(sizeof(T))) T();
+	result->arena = this;
+	ref();
+	return result;
+}
+
+// Data objects for decoding, placed in the current arena if there is one.
+// Default constructors and creators always allocate on the heap, because
+// objects constructed by the app are usually stored for long.
+template <typename T>
+inline T *mtpNewData() {
+	if (mtpArena *arena = mtpArena::current()) {
+		return arena->create<T>();
+	}
+	return new T();
+}
+
 template <typename T>
 class mtpDataImpl : public mtpData {
 public:
@@ -248,7 +429,7 @@ public:
 		return *this;
 	}
 	~mtpDataOwner() {
-		if (data && data->decr()) delete data;
+		if (data && data->decr()) mtpData::destroy(data);
 	}
 
 protected:
@@ -257,13 +438,13 @@ protected:
 	void split() {
 		if (data && data->needSplit()) {
 			mtpData *clone = data->clone();
-			if (data->decr()) delete data;
+			if (data->decr()) mtpData::destroy(data);
 			data = clone;
 		}
 	}
 	void setData(mtpData *_data) {
 		if (data != _data) {
-			if (data && data->decr()) delete data;
+			if (data && data->decr()) mtpData::destroy(data);
 			data = _data;
 		}
 	}
@@ -708,10 +889,8 @@ public:
 		}
 		if (from > end) throw mtpErrorInsufficient();
 
-		if (!data) setData(new MTPDstring());
-		MTPDstring &v(_string());
-		v.v.resize(l);
-		memcpy(&v.v[0], buf, l);
+		if (!data) setData(mtpNewData<MTPDstring>());
+		_string().v.assign((const char*)buf, l); // no zero-fill before copying, unlike resize() + memcpy()
 	}
 	void write(mtpBuffer &to) const {
 		uint32 l = c_string().v.length(), s = l + ((l < 254) ? 1 : 4), was = to.size();
@@ -829,7 +1008,7 @@ public:
 		if (cons != mtpc_vector) throw mtpErrorUnexpected(cons, "MTPvector");
 		uint32 count = (uint32)*(from++);
 
-		if (!data) setData(new MTPDvector<T>());
+		if (!data) setData(mtpNewData<MTPDvector<T> >());
 		MTPDvector<T> &v(_vector());
 		v.v.resize(0);
 		v.v.reserve(count);
@@ -880,6 +1059,20 @@ inline bool operator!=(const MTPvector<T> &a, const MTPvector<T> &b) {
 	return a.c_vector().v != b.c_vector().v;
 }
 
+// Deep copy of a decoded object to the heap, for objects that are kept
+// long after the response was handled and should not pin its arena.
+template <typename T>
+T mtpEscape(const T &value) {
+	mtpArenaScope heap(mtpArenaScope::Mode::Heap);
+
+	mtpBuffer buffer;
+	buffer.reserve(value.innerLength() / sizeof(mtpPrime) + 1);
+	value.write(buffer);
+
+	const mtpPrime *from = buffer.constData();
+	return T(from, from + buffer.size(), value.type());
+}
+
 // Human-readable text serialization
 
 template <typename Type>
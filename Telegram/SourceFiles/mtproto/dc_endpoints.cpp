@@ -0,0 +1,210 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#include "stdafx.h"
+
+#include "mtproto/dc_endpoints.h"
+
+namespace MTP {
+namespace {
+
+constexpr int32 kUnknownRtt = 500; // expected connect time of a never connected endpoint, ms
+constexpr int32 kFailurePenalty = 2000; // added to the expected connect time for each recent failure, ms
+constexpr int32 kMaxPenaltyFailures = 4;
+constexpr int32 kForgetFailuresTimeout = 86400; // failures older than that are not counted, seconds
+constexpr int kMaxEndpointsPerDc = 32;
+
+QMutex EndpointsMutex;
+QVector<DcEndpointStats> Endpoints;
+bool EndpointsChanged = false;
+
+bool sameEndpoint(const DcEndpoint &a, const DcEndpoint &b) {
+	return (a.id == b.id) && (a.flags == b.flags) && (a.port == b.port) && (a.ip == b.ip);
+}
+
+int findEndpoint(const DcEndpoint &endpoint) {
+	for (int i = 0, l = Endpoints.size(); i != l; ++i) {
+		if (sameEndpoint(Endpoints.at(i).endpoint, endpoint)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+int endpointsCount(int bareDc) {
+	int result = 0;
+	for_const (auto &stats, Endpoints) {
+		if (stats.endpoint.id == bareDc) {
+			++result;
+		}
+	}
+	return result;
+}
+
+// returns -1 if there are too many endpoints of that dc already
+int findOrAppendEndpoint(const DcEndpoint &endpoint) {
+	auto result = findEndpoint(endpoint);
+	if (result < 0 && endpointsCount(endpoint.id) < kMaxEndpointsPerDc) {
+		DcEndpointStats stats;
+		stats.endpoint = endpoint;
+		Endpoints.push_back(stats);
+		result = Endpoints.size() - 1;
+	}
+	return result;
+}
+
+int32 expectedConnectTime(const DcEndpointStats &stats, int32 now) {
+	int32 result = stats.rtt ? stats.rtt : kUnknownRtt;
+	if (stats.failures > 0 && stats.lastFailure + kForgetFailuresTimeout > now) {
+		result += kFailurePenalty * qMin(stats.failures, kMaxPenaltyFailures);
+	}
+	return result;
+}
+
+} // namespace
+
+void updateDcEndpoints(const DcEndpoints &advertised) {
+	QMutexLocker lock(&EndpointsMutex);
+
+	QSet<int> dcs;
+	for_const (auto &endpoint, advertised) {
+		dcs.insert(endpoint.id);
+	}
+	for (auto i = Endpoints.begin(); i != Endpoints.end();) {
+		if (!dcs.contains(i->endpoint.id)) {
+			++i;
+			continue;
+		}
+		auto found = false;
+		for_const (auto &endpoint, advertised) {
+			if (sameEndpoint(endpoint, i->endpoint)) {
+				found = true;
+				break;
+			}
+		}
+		if (found) {
+			++i;
+		} else {
+			DEBUG_LOG(("MTP Info: dc %1 endpoint %2:%3 is not advertised anymore").arg(i->endpoint.id).arg(i->endpoint.ip.c_str()).arg(i->endpoint.port));
+			i = Endpoints.erase(i);
+			EndpointsChanged = true;
+		}
+	}
+	for_const (auto &endpoint, advertised) {
+		if (findEndpoint(endpoint) < 0 && findOrAppendEndpoint(endpoint) >= 0) {
+			EndpointsChanged = true;
+		}
+	}
+}
+
+DcEndpoints dcEndpoints(int bareDc) {
+	QMutexLocker lock(&EndpointsMutex);
+
+	DcEndpoints result;
+	for_const (auto &stats, Endpoints) {
+		if (stats.endpoint.id == bareDc) {
+			result.push_back(stats.endpoint);
+		}
+	}
+	return result;
+}
+
+void sortDcEndpoints(DcEndpoints &endpoints) {
+	auto now = unixtime();
+
+	QVector<int32> expected;
+	expected.reserve(endpoints.size());
+	{
+		QMutexLocker lock(&EndpointsMutex);
+		for_const (auto &endpoint, endpoints) {
+			auto index = findEndpoint(endpoint);
+			expected.push_back((index >= 0) ? expectedConnectTime(Endpoints.at(index), now) : kUnknownRtt);
+		}
+	}
+
+	QVector<int> order;
+	order.reserve(endpoints.size());
+	for (int i = 0, l = endpoints.size(); i != l; ++i) {
+		order.push_back(i);
+	}
+	std::stable_sort(order.begin(), order.end(), [&expected](int a, int b) {
+		return expected.at(a) < expected.at(b);
+	});
+
+	DcEndpoints result;
+	result.reserve(endpoints.size());
+	for_const (auto index, order) {
+		result.push_back(endpoints.at(index));
+	}
+	endpoints = result;
+}
+
+void dcEndpointConnected(const DcEndpoint &endpoint, int32 rtt) {
+	QMutexLocker lock(&EndpointsMutex);
+
+	auto index = findOrAppendEndpoint(endpoint);
+	if (index < 0) return;
+
+	auto &stats = Endpoints[index];
+	rtt = qMax(rtt, 1);
+	stats.rtt = stats.rtt ? ((stats.rtt * 3 + rtt) / 4) : rtt;
+	++stats.successes;
+	stats.failures = 0;
+	EndpointsChanged = true;
+}
+
+void dcEndpointFailed(const DcEndpoint &endpoint) {
+	QMutexLocker lock(&EndpointsMutex);
+
+	auto index = findOrAppendEndpoint(endpoint);
+	if (index < 0) return;
+
+	auto &stats = Endpoints[index];
+	++stats.failures;
+	stats.lastFailure = unixtime();
+	EndpointsChanged = true;
+}
+
+bool takeDcEndpointsChanged() {
+	QMutexLocker lock(&EndpointsMutex);
+
+	auto result = EndpointsChanged;
+	EndpointsChanged = false;
+	return result;
+}
+
+QVector<DcEndpointStats> dcEndpointsStats() {
+	QMutexLocker lock(&EndpointsMutex);
+	return Endpoints;
+}
+
+void setDcEndpointsStats(const QVector<DcEndpointStats> &stats) {
+	QMutexLocker lock(&EndpointsMutex);
+
+	Endpoints.clear();
+	for_const (auto &entry, stats) {
+		if (findEndpoint(entry.endpoint) < 0 && endpointsCount(entry.endpoint.id) < kMaxEndpointsPerDc) {
+			Endpoints.push_back(entry);
+		}
+	}
+	EndpointsChanged = false;
+}
+
+} // namespace MTP
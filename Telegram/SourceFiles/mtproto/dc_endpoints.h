@@ -0,0 +1,60 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+#include "mtproto/core_types.h"
+
+namespace MTP {
+
+// One address a dc can be reached at, as advertised in the config.
+struct DcEndpoint {
+	int id = 0; // bare dc id
+	MTPDdcOption::Flags flags = 0;
+	std::string ip;
+	int port = 0;
+};
+using DcEndpoints = QVector<DcEndpoint>;
+
+// What we have learned connecting to an endpoint, kept in the settings.
+struct DcEndpointStats {
+	DcEndpoint endpoint;
+	int32 rtt = 0; // smoothed connect time in ms, 0 - never connected
+	int32 successes = 0;
+	int32 failures = 0; // failed attempts since the last successful one
+	int32 lastFailure = 0; // unixtime
+};
+
+// DcOptions keeps only one address for each dc and flags combination,
+// the endpoints table keeps all of them with the connect statistics.
+void updateDcEndpoints(const DcEndpoints &advertised); // replaces the endpoints of the mentioned dcs
+DcEndpoints dcEndpoints(int bareDc);
+
+// Stable sort by the expected connect time, the best endpoint goes first.
+void sortDcEndpoints(DcEndpoints &endpoints);
+
+void dcEndpointConnected(const DcEndpoint &endpoint, int32 rtt);
+void dcEndpointFailed(const DcEndpoint &endpoint);
+bool takeDcEndpointsChanged(); // returns true once after the statistics were updated
+
+QVector<DcEndpointStats> dcEndpointsStats();
+void setDcEndpointsStats(const QVector<DcEndpointStats> &stats);
+
+} // namespace MTP
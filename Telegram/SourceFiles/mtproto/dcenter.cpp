@@ -23,6 +23,7 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 #include "mtproto/dcenter.h"
 
 #include "mtproto/facade.h"
+#include "mtproto/dc_endpoints.h"
 #include "localstorage.h"
 
 namespace MTP {
@@ -115,6 +116,13 @@ void Dcenter::authKeyWrite() {
 	}
 }
 
+void Dcenter::serverSaltsWrite() {
+	DEBUG_LOG(("AuthKey Info: MTProtoDC::serverSaltsWrite(), dc %1").arg(_id));
+	if (_key) {
+		Local::writeMtpData();
+	}
+}
+
 void Dcenter::setKey(const AuthKeyPtr &key) {
 	DEBUG_LOG(("AuthKey Info: MTProtoDC::setKey(%1), emitting authKeyCreated, dc %2").arg(key ? key->keyId() : 0).arg(_id));
 	_key = key;
@@ -188,6 +196,20 @@ namespace {
 
 void updateDcOptions(const QVector<MTPDcOption> &options) {
 	QSet<int32> already, restart;
+	{
+		DcEndpoints advertised;
+		advertised.reserve(options.size());
+		for_const (auto &option, options) {
+			const auto &optData(option.c_dcOption());
+			DcEndpoint endpoint;
+			endpoint.id = optData.vid.v;
+			endpoint.flags = optData.vflags.v;
+			endpoint.ip = optData.vip_address.c_string().v;
+			endpoint.port = optData.vport.v;
+			advertised.push_back(endpoint);
+		}
+		updateDcEndpoints(advertised);
+	}
 	{
 		MTP::DcOptions opts;
 		{
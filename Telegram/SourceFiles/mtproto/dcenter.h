@@ -35,6 +35,7 @@ public:
 	const AuthKeyPtr &getKey() const;
 	void setKey(const AuthKeyPtr &key);
 	void destroyKey();
+	void serverSaltsWrite(); // the key got new future salts, persist them with it
 
 	bool connectionInited() const {
 		QMutexLocker lock(&initLock);
@@ -22,6 +22,12 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 
 #include "mtproto/facade.h"
 
+#include "mtproto/bandwidth_governor.h"
+#include "mtproto/request_registry.h"
+#include "mtproto/send_scheduler.h"
+#include "mtproto/traffic_recorder.h"
+#include "mtproto/warm_sessions.h"
+
 #include "localstorage.h"
 
 namespace MTP {
@@ -32,9 +38,8 @@ namespace {
 	Sessions sessions;
 	internal::Session *mainSession;
 
-	typedef QMap<mtpRequestId, int32> RequestsByDC; // holds dcWithShift for request to this dc or -dc for request to main dc
-	RequestsByDC requestsByDC;
-	QMutex requestByDCLock;
+	internal::RequestRegistry requests; // requests, their handlers and dcs by request id
+	internal::WarmSessions *warmSessions = nullptr;
 
 	typedef QMap<mtpRequestId, int32> AuthExportRequests; // holds target dcWithShift for auth export request
 	AuthExportRequests authExportRequests;
@@ -43,21 +48,10 @@ namespace {
 
 	uint32 layer;
 
-	typedef QMap<mtpRequestId, RPCResponseHandler> ParserMap;
-	ParserMap parserMap;
-	QMutex parserMapLock;
-
-	typedef QMap<mtpRequestId, mtpRequest> RequestMap;
-	RequestMap requestMap;
-	QReadWriteLock requestMapLock;
-
 	typedef QPair<mtpRequestId, uint64> DelayedRequest;
 	typedef QList<DelayedRequest> DelayedRequestsList;
 	DelayedRequestsList delayedRequests;
 
-	typedef QMap<mtpRequestId, int32> RequestsDelays;
-	RequestsDelays requestsDelays;
-
 	typedef QSet<mtpRequestId> BadGuestDCRequests;
 	BadGuestDCRequests badGuestDCRequests;
 
@@ -77,47 +71,44 @@ namespace {
 	internal::GlobalSlotCarrier *_globalSlotCarrier = 0;
 
 	void importDone(const MTPauth_Authorization &result, mtpRequestId req) {
-		QMutexLocker locker1(&requestByDCLock);
-
-		RequestsByDC::iterator i = requestsByDC.find(req);
-		if (i == requestsByDC.end()) {
-			LOG(("MTP Error: auth import request not found in requestsByDC, requestId: %1").arg(req));
-			RPCError error(internal::rpcClientError("AUTH_IMPORT_FAIL", QString("did not find import request in requestsByDC, request %1").arg(req)));
+		int32 importDcWithShift = requests.dc(req);
+		if (!importDcWithShift) {
+			LOG(("MTP Error: auth import request not found in requests, requestId: %1").arg(req));
+			RPCError error(internal::rpcClientError("AUTH_IMPORT_FAIL", QString("did not find import request in requests, request %1").arg(req)));
 			if (globalHandler.onFail && authedId()) (*globalHandler.onFail)(req, error); // auth failed in main dc
 			return;
 		}
-		DcId newdc = bareDcId(i.value());
+		DcId newdc = bareDcId(importDcWithShift);
 
 		DEBUG_LOG(("MTP Info: auth import to dc %1 succeeded").arg(newdc));
 
 		DCAuthWaiters &waiters(authWaiters[newdc]);
 		if (waiters.size()) {
-			QReadLocker locker(&requestMapLock);
 			for (DCAuthWaiters::iterator i = waiters.begin(), e = waiters.end(); i != e; ++i) {
 				mtpRequestId requestId = *i;
-				RequestMap::const_iterator j = requestMap.constFind(requestId);
-				if (j == requestMap.cend()) {
+				mtpRequest request = requests.request(requestId);
+				if (!request) {
 					LOG(("MTP Error: could not find request %1 for resending").arg(requestId));
 					continue;
 				}
 				ShiftedDcId dcWithShift = newdc;
 				{
-					RequestsByDC::iterator k = requestsByDC.find(requestId);
-					if (k == requestsByDC.cend()) {
+					int32 wasDcWithShift = requests.dc(requestId);
+					if (!wasDcWithShift) {
 						LOG(("MTP Error: could not find request %1 by dc for resending").arg(requestId));
 						continue;
 					}
-					if (k.value() < 0) {
+					if (wasDcWithShift < 0) {
 						setdc(newdc);
-						k.value() = -newdc;
+						requests.setDc(requestId, -newdc);
 					} else {
-						dcWithShift = shiftDcId(newdc, getDcIdShift(k.value()));
-						k.value() = dcWithShift;
+						dcWithShift = shiftDcId(newdc, getDcIdShift(wasDcWithShift));
+						requests.setDc(requestId, dcWithShift);
 					}
-					DEBUG_LOG(("MTP Info: resending request %1 to dc %2 after import auth").arg(requestId).arg(k.value()));
+					DEBUG_LOG(("MTP Info: resending request %1 to dc %2 after import auth").arg(requestId).arg(requests.dc(requestId)));
 				}
 				if (internal::Session *session = internal::getSession(dcWithShift)) {
-					session->sendPrepared(j.value());
+					session->sendPrepared(request);
 				}
 			}
 			waiters.clear();
@@ -167,15 +158,9 @@ namespace {
 		if ((m = QRegularExpression("^(FILE|PHONE|NETWORK|USER)_MIGRATE_(\\d+)$").match(err)).hasMatch()) {
 			if (!requestId) return false;
 
-			ShiftedDcId dcWithShift = 0, newdcWithShift = m.captured(2).toInt();
-			{
-				QMutexLocker locker(&requestByDCLock);
-				RequestsByDC::iterator i = requestsByDC.find(requestId);
-				if (i == requestsByDC.end()) {
-					LOG(("MTP Error: could not find request %1 for migrating to %2").arg(requestId).arg(newdcWithShift));
-				} else {
-					dcWithShift = i.value();
-				}
+			ShiftedDcId dcWithShift = requests.dc(requestId), newdcWithShift = m.captured(2).toInt();
+			if (!dcWithShift) {
+				LOG(("MTP Error: could not find request %1 for migrating to %2").arg(requestId).arg(newdcWithShift));
 			}
 			if (!dcWithShift || !newdcWithShift) return false;
 
@@ -196,15 +181,10 @@ namespace {
 				newdcWithShift = shiftDcId(newdcWithShift, getDcIdShift(dcWithShift));
 			}
 
-			mtpRequest req;
-			{
-				QReadLocker locker(&requestMapLock);
-				RequestMap::const_iterator i = requestMap.constFind(requestId);
-				if (i == requestMap.cend()) {
-					LOG(("MTP Error: could not find request %1").arg(requestId));
-					return false;
-				}
-				req = i.value();
+			mtpRequest req = requests.request(requestId);
+			if (!req) {
+				LOG(("MTP Error: could not find request %1").arg(requestId));
+				return false;
 			}
 			if (auto session = internal::getSession(newdcWithShift)) {
 				internal::registerRequest(requestId, (dcWithShift < 0) ? -newdcWithShift : newdcWithShift);
@@ -216,12 +196,7 @@ namespace {
 
 			int32 secs = 1;
 			if (code < 0 || code >= 500) {
-				RequestsDelays::iterator i = requestsDelays.find(requestId);
-				if (i != requestsDelays.cend()) {
-					secs = (i.value() > 60) ? i.value() : (i.value() *= 2);
-				} else {
-					requestsDelays.insert(requestId, secs);
-				}
+				secs = requests.nextDelay(requestId);
 			} else {
 				secs = m.captured(1).toInt();
 //				if (secs >= 60) return false;
@@ -238,15 +213,9 @@ namespace {
 
 			return true;
 		} else if (code == 401 || (badGuestDC && badGuestDCRequests.constFind(requestId) == badGuestDCRequests.cend())) {
-			int32 dcWithShift = 0;
-			{
-				QMutexLocker locker(&requestByDCLock);
-				RequestsByDC::iterator i = requestsByDC.find(requestId);
-				if (i != requestsByDC.end()) {
-					dcWithShift = i.value();
-				} else {
-					LOG(("MTP Error: unauthorized request without dc info, requestId %1").arg(requestId));
-				}
+			int32 dcWithShift = requests.dc(requestId);
+			if (!dcWithShift) {
+				LOG(("MTP Error: unauthorized request without dc info, requestId %1").arg(requestId));
 			}
 			int32 newdc = bareDcId(qAbs(dcWithShift));
 			if (!newdc || newdc == internal::mainDC() || !authedId()) {
@@ -263,25 +232,14 @@ namespace {
 			if (badGuestDC) badGuestDCRequests.insert(requestId);
 			return true;
 		} else if (err == qstr("CONNECTION_NOT_INITED") || err == qstr("CONNECTION_LAYER_INVALID")) {
-			mtpRequest req;
-			{
-				QReadLocker locker(&requestMapLock);
-				RequestMap::const_iterator i = requestMap.constFind(requestId);
-				if (i == requestMap.cend()) {
-					LOG(("MTP Error: could not find request %1").arg(requestId));
-					return false;
-				}
-				req = i.value();
+			mtpRequest req = requests.request(requestId);
+			if (!req) {
+				LOG(("MTP Error: could not find request %1").arg(requestId));
+				return false;
 			}
-			int32 dcWithShift = 0;
-			{
-				QMutexLocker locker(&requestByDCLock);
-				RequestsByDC::iterator i = requestsByDC.find(requestId);
-				if (i == requestsByDC.end()) {
-					LOG(("MTP Error: could not find request %1 for resending with init connection").arg(requestId));
-				} else {
-					dcWithShift = i.value();
-				}
+			int32 dcWithShift = requests.dc(requestId);
+			if (!dcWithShift) {
+				LOG(("MTP Error: could not find request %1 for resending with init connection").arg(requestId));
 			}
 			if (!dcWithShift) return false;
 
@@ -291,34 +249,23 @@ namespace {
 			}
 			return true;
 		} else if (err == qstr("MSG_WAIT_FAILED")) {
-			mtpRequest req;
-			{
-				QReadLocker locker(&requestMapLock);
-				RequestMap::const_iterator i = requestMap.constFind(requestId);
-				if (i == requestMap.cend()) {
-					LOG(("MTP Error: could not find request %1").arg(requestId));
-					return false;
-				}
-				req = i.value();
+			mtpRequest req = requests.request(requestId);
+			if (!req) {
+				LOG(("MTP Error: could not find request %1").arg(requestId));
+				return false;
 			}
 			if (!req->after) {
 				LOG(("MTP Error: wait failed for not dependent request %1").arg(requestId));
 				return false;
 			}
-			int32 dcWithShift = 0;
-			{
-				QMutexLocker locker(&requestByDCLock);
-				RequestsByDC::iterator i = requestsByDC.find(requestId), j = requestsByDC.find(req->after->requestId);
-				if (i == requestsByDC.end()) {
-					LOG(("MTP Error: could not find request %1 by dc").arg(requestId));
-				} else if (j == requestsByDC.end()) {
-					LOG(("MTP Error: could not find dependent request %1 by dc").arg(req->after->requestId));
-				} else {
-					dcWithShift = i.value();
-					if (i.value() != j.value()) {
-						req->after = mtpRequest();
-					}
-				}
+			int32 dcWithShift = requests.dc(requestId), afterDcWithShift = requests.dc(req->after->requestId);
+			if (!dcWithShift) {
+				LOG(("MTP Error: could not find request %1 by dc").arg(requestId));
+			} else if (!afterDcWithShift) {
+				LOG(("MTP Error: could not find dependent request %1 by dc").arg(req->after->requestId));
+				dcWithShift = 0;
+			} else if (dcWithShift != afterDcWithShift) {
+				req->after = mtpRequest();
 			}
 			if (!dcWithShift) return false;
 
@@ -384,48 +331,23 @@ bool paused() {
 }
 
 void registerRequest(mtpRequestId requestId, int32 dcWithShift) {
-	{
-		QMutexLocker locker(&requestByDCLock);
-		requestsByDC.insert(requestId, dcWithShift);
-	}
+	requests.setDc(requestId, dcWithShift);
 	internal::performDelayedClear(); // need to do it somewhere...
 }
 
 void unregisterRequest(mtpRequestId requestId) {
-	requestsDelays.remove(requestId);
-
-	{
-		QWriteLocker locker(&requestMapLock);
-		requestMap.remove(requestId);
-	}
-
-	QMutexLocker locker(&requestByDCLock);
-	requestsByDC.remove(requestId);
+	requests.unregister(requestId);
 }
 
 mtpRequestId storeRequest(mtpRequest &request, const RPCResponseHandler &parser) {
 	mtpRequestId res = reqid();
 	request->requestId = res;
-	if (parser.onDone || parser.onFail) {
-		QMutexLocker locker(&parserMapLock);
-		parserMap.insert(res, parser);
-	}
-	{
-		QWriteLocker locker(&requestMapLock);
-		requestMap.insert(res, request);
-	}
+	requests.store(res, request, parser);
 	return res;
 }
 
 mtpRequest getRequest(mtpRequestId reqId) {
-	static mtpRequest zero;
-	mtpRequest req;
-	{
-		QReadLocker locker(&requestMapLock);
-		RequestMap::const_iterator i = requestMap.constFind(reqId);
-		req = (i == requestMap.cend()) ? zero : i.value();
-	}
-	return req;
+	return requests.request(reqId);
 }
 
 void wrapInvokeAfter(mtpRequest &to, const mtpRequest &from, const mtpRequestMap &haveSent, int32 skipBeforeRequest) {
@@ -453,17 +375,7 @@ void wrapInvokeAfter(mtpRequest &to, const mtpRequest &from, const mtpRequestMap
 
 void clearCallbacks(mtpRequestId requestId, int32 errorCode) {
 	RPCResponseHandler h;
-	bool found = false;
-	{
-		QMutexLocker locker(&parserMapLock);
-		ParserMap::iterator i = parserMap.find(requestId);
-		if (i != parserMap.end()) {
-			h = i.value();
-			found = true;
-
-			parserMap.erase(i);
-		}
-	}
+	bool found = requests.takeHandler(requestId, &h);
 	if (errorCode && found) {
 		rpcErrorOccured(requestId, h, rpcClientError("CLEAR_CALLBACK", QString("did not handle request %1, error code %2").arg(requestId).arg(errorCode)));
 	}
@@ -495,11 +407,8 @@ void performDelayedClear() {
 	QMutexLocker lock(&toClearLock);
 	if (!toClear.isEmpty()) {
 		for (RPCCallbackClears::iterator i = toClear.begin(), e = toClear.end(); i != e; ++i) {
-			if (cDebug()) {
-				QMutexLocker locker(&parserMapLock);
-				if (parserMap.find(i->requestId) != parserMap.end()) {
-					DEBUG_LOG(("RPC Info: clearing delayed callback %1, error code %2").arg(i->requestId).arg(i->errorCode));
-				}
+			if (cDebug() && requests.hasHandler(i->requestId)) {
+				DEBUG_LOG(("RPC Info: clearing delayed callback %1, error code %2").arg(i->requestId).arg(i->errorCode));
 			}
 			clearCallbacks(i->requestId, i->errorCode);
 			internal::unregisterRequest(i->requestId);
@@ -509,18 +418,20 @@ void performDelayedClear() {
 }
 
 void execCallback(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) {
+	execParsedCallback(requestId, from, end, RPCDoneHandlerPtr(), RPCParsedResponsePtr());
+}
+
+RPCDoneHandlerPtr getDoneHandler(mtpRequestId requestId) {
+	return requests.doneHandler(requestId);
+}
+
+void execParsedCallback(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end, const RPCDoneHandlerPtr &parsedBy, const RPCParsedResponsePtr &parsed) {
 	RPCResponseHandler h;
-	{
-		QMutexLocker locker(&parserMapLock);
-		ParserMap::iterator i = parserMap.find(requestId);
-		if (i != parserMap.cend()) {
-			h = i.value();
-			parserMap.erase(i);
-
-			DEBUG_LOG(("RPC Info: found parser for request %1, trying to parse response...").arg(requestId));
-		}
+	if (requests.takeHandler(requestId, &h)) {
+		DEBUG_LOG(("RPC Info: found parser for request %1, trying to parse response...").arg(requestId));
 	}
 	if (h.onDone || h.onFail) {
+		mtpArenaScope arena((from < end) ? mtpTypeId(*from) : 0); // decoded response objects are freed in bulk
 		try {
 			if (from >= end) throw mtpErrorInsufficient();
 
@@ -528,20 +439,22 @@ void execCallback(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *
 				RPCError err(MTPRpcError(from, end));
 				DEBUG_LOG(("RPC Info: error received, code %1, type %2, description: %3").arg(err.code()).arg(err.type()).arg(err.description()));
 				if (!rpcErrorOccured(requestId, h, err)) {
-					QMutexLocker locker(&parserMapLock);
-					parserMap.insert(requestId, h);
+					requests.restoreHandler(requestId, h);
 					return;
 				}
 			} else {
 				if (h.onDone) {
 //						t_assert(App::app() != 0);
-					(*h.onDone)(requestId, from, end);
+					if (parsed && h.onDone == parsedBy) {
+						(*h.onDone)(requestId, *parsed);
+					} else { // not parsed in advance or parsing failed
+						(*h.onDone)(requestId, from, end);
+					}
 				}
 			}
 		} catch (Exception &e) {
 			if (!rpcErrorOccured(requestId, h, rpcClientError("RESPONSE_PARSE_FAILED", QString("exception text: ") + e.what()))) {
-				QMutexLocker locker(&parserMapLock);
-				parserMap.insert(requestId, h);
+				requests.restoreHandler(requestId, h);
 				return;
 			}
 		}
@@ -552,13 +465,14 @@ void execCallback(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *
 }
 
 bool hasCallbacks(mtpRequestId requestId) {
-	QMutexLocker locker(&parserMapLock);
-	ParserMap::iterator i = parserMap.find(requestId);
-	return (i != parserMap.cend());
+	return requests.hasHandler(requestId);
 }
 
 void globalCallback(const mtpPrime *from, const mtpPrime *end) {
-	if (globalHandler.onDone) (*globalHandler.onDone)(0, from, end); // some updates were received
+	if (globalHandler.onDone) {
+		mtpArenaScope arena((from < end) ? mtpTypeId(*from) : 0);
+		(*globalHandler.onDone)(0, from, end); // some updates were received
+	}
 }
 
 void onStateChange(int32 dcWithShift, int32 state) {
@@ -592,27 +506,16 @@ void GlobalSlotCarrier::checkDelayed() {
 		mtpRequestId requestId = delayedRequests.front().first;
 		delayedRequests.pop_front();
 
-		int32 dcWithShift = 0;
-		{
-			QMutexLocker locker(&requestByDCLock);
-			RequestsByDC::const_iterator i = requestsByDC.constFind(requestId);
-			if (i != requestsByDC.cend()) {
-				dcWithShift = i.value();
-			} else {
-				LOG(("MTP Error: could not find request dc for delayed resend, requestId %1").arg(requestId));
-				continue;
-			}
+		int32 dcWithShift = requests.dc(requestId);
+		if (!dcWithShift) {
+			LOG(("MTP Error: could not find request dc for delayed resend, requestId %1").arg(requestId));
+			continue;
 		}
 
-		mtpRequest req;
-		{
-			QReadLocker locker(&requestMapLock);
-			RequestMap::const_iterator j = requestMap.constFind(requestId);
-			if (j == requestMap.cend()) {
-				DEBUG_LOG(("MTP Error: could not find request %1").arg(requestId));
-				continue;
-			}
-			req = j.value();
+		mtpRequest req = requests.request(requestId);
+		if (!req) {
+			DEBUG_LOG(("MTP Error: could not find request %1").arg(requestId));
+			continue;
 		}
 		if (Session *session = getSession(qAbs(dcWithShift))) {
 			session->sendPrepared(req);
@@ -651,7 +554,12 @@ void start() {
 
 	internal::DcenterMap &dcs(internal::DCMap());
 
+	if (cMtpRecordSize() > 0) {
+		TrafficRecorder::start(cWorkingDir() + qsl("DebugLogs/traffic"), int64(cMtpRecordSize()) * 1024 * 1024);
+	}
+
 	_globalSlotCarrier = new internal::GlobalSlotCarrier();
+	warmSessions = new internal::WarmSessions();
 
 	mainSession = new internal::Session(internal::mainDC());
 	sessions.insert(mainSession->getDcWithShift(), mainSession);
@@ -756,24 +664,12 @@ void ping() {
 void cancel(mtpRequestId requestId) {
 	if (!_started) return;
 
-	mtpMsgId msgId = 0;
-	requestsDelays.remove(requestId);
-	{
-		QWriteLocker locker(&requestMapLock);
-		RequestMap::iterator i = requestMap.find(requestId);
-		if (i != requestMap.end()) {
-			msgId = *(mtpMsgId*)(i.value()->constData() + 4);
-			requestMap.erase(i);
-		}
-	}
-	{
-		QMutexLocker locker(&requestByDCLock);
-		RequestsByDC::iterator i = requestsByDC.find(requestId);
-		if (i != requestsByDC.end()) {
-			if (internal::Session *session = internal::getSession(qAbs(i.value()))) {
-				session->cancel(requestId, msgId);
-			}
-			requestsByDC.erase(i);
+	int32 dcWithShift = 0;
+	mtpRequest request = requests.cancel(requestId, &dcWithShift);
+	mtpMsgId msgId = request ? *(mtpMsgId*)(request->constData() + 4) : 0;
+	if (dcWithShift) {
+		if (internal::Session *session = internal::getSession(qAbs(dcWithShift))) {
+			session->cancel(requestId, msgId);
 		}
 	}
 	internal::clearCallbacks(requestId);
@@ -811,12 +707,22 @@ void stopSession(int32 dc) {
 	}
 }
 
+void downloadSessionUsed(DcId dcId) {
+	if (warmSessions) warmSessions->used(dcId);
+}
+
+bool keepDownloadSessionWarm(DcId dcId) {
+	return warmSessions ? warmSessions->idle(dcId) : false;
+}
+
+void fileFirstByte(DcId dcId, uint64 ms, bool cold) {
+	internal::WarmSessions::firstByte(dcId, ms, cold);
+}
+
 int32 state(mtpRequestId requestId) {
 	if (requestId > 0) {
-		QMutexLocker locker(&requestByDCLock);
-		RequestsByDC::iterator i = requestsByDC.find(requestId);
-		if (i != requestsByDC.end()) {
-			if (internal::Session *session = internal::getSession(qAbs(i.value()))) {
+		if (int32 dcWithShift = requests.dc(requestId)) {
+			if (internal::Session *session = internal::getSession(qAbs(dcWithShift))) {
 				return session->requestState(requestId);
 			}
 			return MTP::RequestConnecting;
@@ -846,8 +752,22 @@ void finish() {
 	delete _globalSlotCarrier;
 	_globalSlotCarrier = nullptr;
 
+	delete warmSessions;
+	warmSessions = nullptr;
+
 	internal::destroyConfigLoader();
 
+	internal::ResponseParser::finish();
+	internal::ResponseParser::logStats();
+	internal::GzipInflater::logStats();
+	internal::SendScheduler::logStats();
+	internal::WarmSessions::logStats();
+	internal::Connection::logStats();
+	BandwidthGovernor::logStats();
+	TrafficRecorder::finish();
+
+	DEBUG_LOG(("MTP Info: requests pool hits %1, misses %2").arg(mtpRequestData::poolHits()).arg(mtpRequestData::poolMisses()));
+
 	_started = false;
 }
 
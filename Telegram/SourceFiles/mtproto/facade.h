@@ -42,6 +42,8 @@ void clearCallbacks(mtpRequestId requestId, int32 errorCode = RPCError::NoError)
 void clearCallbacksDelayed(const RPCCallbackClears &requestIds);
 void performDelayedClear();
 void execCallback(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end);
+RPCDoneHandlerPtr getDoneHandler(mtpRequestId requestId);
+void execParsedCallback(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end, const RPCDoneHandlerPtr &parsedBy, const RPCParsedResponsePtr &parsed); // parsed is null if parsing failed
 bool hasCallbacks(mtpRequestId requestId);
 void globalCallback(const mtpPrime *from, const mtpPrime *end);
 void onStateChange(int32 dcWithShift, int32 state);
@@ -97,23 +99,23 @@ constexpr ShiftedDcId lgtDcId(DcId dcId) {
 
 namespace internal {
 	constexpr ShiftedDcId downloadDcId(DcId dcId, int index) {
-		static_assert(MTPDownloadSessionsCount < 0x10, "Too large MTPDownloadSessionsCount!");
+		static_assert(MTPFileSessionsMaxCount < 0x10, "Too large MTPFileSessionsMaxCount!");
 		return shiftDcId(dcId, 0x10 + index);
 	};
 }
 
 // send(req, callbacks, MTP::dldDcId(dc, index)) - for download shifted dc id
 inline ShiftedDcId dldDcId(DcId dcId, int index) {
-	t_assert(index >= 0 && index < MTPDownloadSessionsCount);
+	t_assert(index >= 0 && index < MTPFileSessionsMaxCount);
 	return internal::downloadDcId(dcId, index);
 }
 constexpr bool isDldDcId(ShiftedDcId shiftedDcId) {
-	return (shiftedDcId >= internal::downloadDcId(0, 0)) && (shiftedDcId < internal::downloadDcId(0, MTPDownloadSessionsCount - 1) + DCShift);
+	return (shiftedDcId >= internal::downloadDcId(0, 0)) && (shiftedDcId < internal::downloadDcId(0, MTPFileSessionsMaxCount - 1) + DCShift);
 }
 
 namespace internal {
 	constexpr ShiftedDcId uploadDcId(DcId dcId, int index) {
-		static_assert(MTPUploadSessionsCount < 0x10, "Too large MTPUploadSessionsCount!");
+		static_assert(MTPFileSessionsMaxCount < 0x10, "Too large MTPFileSessionsMaxCount!");
 		return shiftDcId(dcId, 0x20 + index);
 	};
 }
@@ -121,11 +123,11 @@ namespace internal {
 // send(req, callbacks, MTP::uplDcId(index)) - for upload shifted dc id
 // uploading always to the main dc so bareDcId == 0
 inline ShiftedDcId uplDcId(int index) {
-	t_assert(index >= 0 && index < MTPUploadSessionsCount);
+	t_assert(index >= 0 && index < MTPFileSessionsMaxCount);
 	return internal::uploadDcId(0, index);
 };
 constexpr bool isUplDcId(ShiftedDcId shiftedDcId) {
-	return (shiftedDcId >= internal::uploadDcId(0, 0)) && (shiftedDcId < internal::uploadDcId(0, MTPUploadSessionsCount - 1) + DCShift);
+	return (shiftedDcId >= internal::uploadDcId(0, 0)) && (shiftedDcId < internal::uploadDcId(0, MTPFileSessionsMaxCount - 1) + DCShift);
 }
 
 void start();
@@ -150,15 +152,15 @@ int32 dcstate(int32 dc = 0);
 QString dctransport(int32 dc = 0);
 
 template <typename TRequest>
-inline mtpRequestId send(const TRequest &request, RPCResponseHandler callbacks = RPCResponseHandler(), int32 dc = 0, uint64 msCanWait = 0, mtpRequestId after = 0) {
+inline mtpRequestId send(const TRequest &request, RPCResponseHandler callbacks = RPCResponseHandler(), int32 dc = 0, uint64 msCanWait = 0, mtpRequestId after = 0, mtpRequestPriority priority = mtpRequestPriority::Normal) {
 	if (internal::Session *session = internal::getSession(dc)) {
-		return session->send(request, callbacks, msCanWait, true, !dc, after);
+		return session->send(request, callbacks, msCanWait, true, !dc, after, priority);
 	}
 	return 0;
 }
 template <typename TRequest>
-inline mtpRequestId send(const TRequest &request, RPCDoneHandlerPtr onDone, RPCFailHandlerPtr onFail = RPCFailHandlerPtr(), int32 dc = 0, uint64 msCanWait = 0, mtpRequestId after = 0) {
-	return send(request, RPCResponseHandler(onDone, onFail), dc, msCanWait, after);
+inline mtpRequestId send(const TRequest &request, RPCDoneHandlerPtr onDone, RPCFailHandlerPtr onFail = RPCFailHandlerPtr(), int32 dc = 0, uint64 msCanWait = 0, mtpRequestId after = 0, mtpRequestPriority priority = mtpRequestPriority::Normal) {
+	return send(request, RPCResponseHandler(onDone, onFail), dc, msCanWait, after, priority);
 }
 inline void sendAnything(int32 dc = 0, uint64 msCanWait = 0) {
 	if (internal::Session *session = internal::getSession(dc)) {
@@ -170,6 +172,10 @@ void cancel(mtpRequestId req);
 void killSession(int32 dc);
 void stopSession(int32 dc);
 
+void downloadSessionUsed(DcId dcId);
+bool keepDownloadSessionWarm(DcId dcId); // the downloads have stopped, returns true if the first session should stay connected
+void fileFirstByte(DcId dcId, uint64 ms, bool cold); // reports the time to the first byte of a file
+
 enum {
 	RequestSent = 0,
 	RequestConnecting = 1,
@@ -210,7 +216,7 @@ typedef QMap<int, DcOption> DcOptions;
 namespace internal {
 
 	template <typename TRequest>
-	mtpRequestId Session::send(const TRequest &request, RPCResponseHandler callbacks, uint64 msCanWait, bool needsLayer, bool toMainDC, mtpRequestId after) {
+	mtpRequestId Session::send(const TRequest &request, RPCResponseHandler callbacks, uint64 msCanWait, bool needsLayer, bool toMainDC, mtpRequestId after, mtpRequestPriority priority) {
 		mtpRequestId requestId = 0;
 		try {
 			uint32 requestSize = request.innerLength() >> 2;
@@ -221,6 +227,7 @@ namespace internal {
 
 			reqSerialized->msDate = getms(true); // > 0 - can send without container
 			reqSerialized->needsLayer = needsLayer;
+			reqSerialized->priority = priority;
 			if (after) reqSerialized->after = MTP::internal::getRequest(after);
 			requestId = MTP::internal::storeRequest(reqSerialized, callbacks);
 
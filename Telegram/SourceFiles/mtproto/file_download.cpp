@@ -27,16 +27,12 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 
 #include "application.h"
 #include "localstorage.h"
+#include "mtproto/bandwidth_governor.h"
+#include "mtproto/file_sessions.h"
 
 namespace {
 	int32 GlobalPriority = 1;
-	struct DataRequested {
-		DataRequested() {
-			memset(v, 0, sizeof(v));
-		}
-		int64 v[MTPDownloadSessionsCount];
-	};
-	QMap<int32, DataRequested> DataRequestedMap;
+	QMap<int32, MTP::FileSessionsPool> DownloadSessionsPools;
 }
 
 struct FileLoaderQueue {
@@ -58,6 +54,19 @@ namespace {
 		return (_webLoadManager && _webLoadManager != FinishedWebLoadManager) ? _webLoadManager : 0;
 	}
 	WebLoadMainManager *_webLoadMainManager = 0;
+
+	bool LoadNextScheduled = false;
+
+	constexpr qint64 kWebReadBufferSize = 256 * 1024; // not read data stops the socket when the governor delays the load
+
+	constexpr int32 kMaxDocumentPartSize = 512 * 1024; // the largest part upload.getFile gives
+	constexpr int32 kMaxPartsWindow = 16 * 1024 * 1024; // bytes from the first part in flight to the end of the last one
+	constexpr int32 kPartialSaveStep = 2 * 1024 * 1024; // bytes loaded between the partial download state writes
+	constexpr uint64 kHiddenLoaderTimeout = 3000; // ms after the last display when an automatic load can be dropped
+
+	uint64 transferId(const void *loader) {
+		return uint64(reinterpret_cast<quintptr>(loader));
+	}
 }
 
 FileLoader::FileLoader(const QString &toFile, int32 size, LocationType locationType, LoadToCacheSetting toCache, LoadFromCloudSetting fromCloud, bool autoLoading)
@@ -138,6 +147,18 @@ void FileLoader::loadNext() {
 	}
 }
 
+void FileLoader::loadNextAfter(uint64 wait) {
+	if (LoadNextScheduled) return;
+
+	LoadNextScheduled = true;
+	QTimer::singleShot(wait, [] {
+		LoadNextScheduled = false;
+		for (auto i = queues.cbegin(), e = queues.cend(); i != e; ++i) {
+			if (i->start) i->start->loadNext();
+		}
+	});
+}
+
 void FileLoader::removeFromQueue() {
 	if (!_inQueue) return;
 	if (_next) {
@@ -217,7 +238,7 @@ void FileLoader::start(bool loadFirst, bool prior) {
 	}
 
 	if (!_fname.isEmpty() && _toCache == LoadToFileOnly && !_fileIsOpen) {
-		_fileIsOpen = _file.open(QIODevice::WriteOnly);
+		_fileIsOpen = resumeFile() || _file.open(QIODevice::WriteOnly);
 		if (!_fileIsOpen) {
 			return cancel(true);
 		}
@@ -315,6 +336,13 @@ void FileLoader::cancel() {
 	cancel(false);
 }
 
+void FileLoader::markVisible() {
+	_visibleAt = getms();
+	if (!_inQueue || _complete || _priority == GlobalPriority) return;
+
+	start(false, true);
+}
+
 void FileLoader::cancel(bool fail) {
 	bool started = currentOffset(true) > 0;
 	cancelRequests();
@@ -369,6 +397,11 @@ int32 mtpFileLoader::currentOffset(bool includeSkipped) const {
 	return (_fileIsOpen ? _file.size() : _data.size()) - (includeSkipped ? 0 : _skippedBytes);
 }
 
+int64 mtpFileLoader::throughput() const {
+	uint64 ms = _firstRequestAt ? (getms(true) - _firstRequestAt) : 0;
+	return ms ? (_loadedBytes * 1000 / int64(ms)) : 0;
+}
+
 namespace {
 	QString serializereqs(const QMap<mtpRequestId, int32> &reqs) { // serialize requests map in json-like format
 		QString result;
@@ -388,11 +421,17 @@ namespace {
 }
 
 bool mtpFileLoader::loadPart() {
-	if (_complete || _lastComplete || (!_requests.isEmpty() && !_size)) {
+	if (_complete || (_lastComplete && !_size) || (!_requests.isEmpty() && !_size)) {
 		if (DebugLogging::FileLoader() && _id) DEBUG_LOG(("FileLoader(%1): loadPart() returned, _complete=%2, _lastComplete=%3, _requests.size()=%4, _size=%5").arg(_id).arg(Logs::b(_complete)).arg(Logs::b(_lastComplete)).arg(_requests.size()).arg(_size));
 		return false;
 	}
-	if (_size && _nextRequestOffset >= _size) {
+	if (_size) {
+		_nextRequestOffset = nextMissingOffset(_nextRequestOffset);
+		if (_nextRequestOffset < _windowFrom) {
+			_windowFrom = 0; // all after the seek point is requested, fill the holes before it
+		}
+	}
+	if (_size && _nextRequestOffset >= loadEnd()) {
 		if (DebugLogging::FileLoader() && _id) DEBUG_LOG(("FileLoader(%1): loadPart() returned, _size=%2, _nextRequestOffset=%3, _requests=%4").arg(_id).arg(_size).arg(_nextRequestOffset).arg(serializereqs(_requests)));
 		return false;
 	}
@@ -410,23 +449,56 @@ bool mtpFileLoader::loadPart() {
 		default: cancel(true); return false; break;
 		}
 	}
+	MTP::FileSessionsPool &pool(DownloadSessionsPools[_dc]);
+	if (!_location) {
+		limit = _partSize;
+		while (limit > DocumentDownloadPartSize && (_nextRequestOffset % limit)) { // the part must not cross the limit boundary
+			limit /= 2;
+		}
+		auto loaded = _loadedRanges.upperBound(_nextRequestOffset);
+		auto inFlight = _partsInFlight.upperBound(_nextRequestOffset);
+		while (limit > DocumentDownloadPartSize
+			&& ((loaded != _loadedRanges.cend() && _nextRequestOffset + limit > loaded.key())
+				|| (inFlight != _partsInFlight.cend() && _nextRequestOffset + limit > inFlight.key()))) {
+			limit /= 2; // do not request again what is loaded or requested after a seek
+		}
+	}
+	if (!_partsInFlight.isEmpty()) {
+		auto first = _partsInFlight.lowerBound(_windowFrom);
+		auto windowStart = (first != _partsInFlight.cend() && first.key() <= _nextRequestOffset) ? first.key() : _partsInFlight.firstKey();
+		if (_nextRequestOffset + limit > windowStart + _window) {
+			return false; // wait for the first part in the window
+		}
+		if (!pool.canSend()) {
+			return false; // one part of each file is always allowed, the others wait for the dc window
+		}
+	}
+
 	int32 offset = _nextRequestOffset, dcIndex = 0;
-	DataRequested &dr(DataRequestedMap[_dc]);
 	if (_size) {
-		for (int32 i = 1; i < MTPDownloadSessionsCount; ++i) {
-			if (dr.v[i] < dr.v[dcIndex]) {
-				dcIndex = i;
-			}
-		}
+		dcIndex = pool.chooseSession();
+	}
+
+	if (auto wait = MTP::BandwidthGovernor::acquire(MTP::BandwidthGovernor::Direction::Download, transferId(this), limit)) {
+		loadNextAfter(wait);
+		return false;
 	}
 
 	App::app()->killDownloadSessionsStop(_dc);
+	MTP::downloadSessionUsed(_dc);
+	if (!_firstRequestAt) {
+		_firstRequestAt = getms(true);
+		_firstRequestCold = (MTP::dcstate(MTP::dldDcId(_dc, 0)) != MTP::ConnectedState);
+	}
 
-	mtpRequestId reqId = MTP::send(MTPupload_GetFile(loc, MTP_int(offset), MTP_int(limit)), rpcDone(&mtpFileLoader::partLoaded, offset), rpcFail(&mtpFileLoader::partFailed), MTP::dldDcId(_dc, dcIndex), 50);
+	auto priority = _location ? mtpRequestPriority::Normal : mtpRequestPriority::Background; // thumbnails and photos are shown right away
+	mtpRequestId reqId = MTP::send(MTPupload_GetFile(loc, MTP_int(offset), MTP_int(limit)), rpcDone(&mtpFileLoader::partLoaded, offset), rpcFail(&mtpFileLoader::partFailed), MTP::dldDcId(_dc, dcIndex), 50, 0, priority);
 
 	++_queue->queries;
-	dr.v[dcIndex] += limit;
+	pool.sent(reqId, dcIndex, limit);
 	_requests.insert(reqId, dcIndex);
+	_partsInFlight.insert(offset, limit);
+	_partRequests.insert(offset, reqId);
 	_nextRequestOffset += limit;
 
 	if (DebugLogging::FileLoader() && _id) DEBUG_LOG(("FileLoader(%1): requested part with offset=%2, _queue->queries=%3, _nextRequestOffset=%4, _requests=%5").arg(_id).arg(offset).arg(_queue->queries).arg(_nextRequestOffset).arg(serializereqs(_requests)));
@@ -445,9 +517,9 @@ void mtpFileLoader::partLoaded(int32 offset, const MTPupload_File &result, mtpRe
 		return cancel(true);
 	}
 
-	int32 limit = (_locationType == UnknownFileLocation) ? DownloadPartSize : DocumentDownloadPartSize;
-	int32 dcIndex = i.value();
-	DataRequestedMap[_dc].v[dcIndex] -= limit;
+	MTP::FileSessionsPool &pool(DownloadSessionsPools[_dc]);
+	pool.done(req);
+	_queue->limit = qMax(int32(MaxFileQueries), int32(pool.window() / DocumentDownloadPartSize));
 
 	--_queue->queries;
 	_requests.erase(i);
@@ -455,9 +527,27 @@ void mtpFileLoader::partLoaded(int32 offset, const MTPupload_File &result, mtpRe
 	auto &d = result.c_upload_file();
 	auto &bytes = d.vbytes.c_string().v;
 
+	int32 partSize = _partsInFlight.take(offset);
+	_partRequests.remove(offset);
+	_loadedBytes += bytes.size();
+	if (partSize > bytes.size()) { // the last part, only the received bytes are charged
+		MTP::BandwidthGovernor::refund(MTP::BandwidthGovernor::Direction::Download, transferId(this), partSize - bytes.size());
+	}
+	if (partSize > 0 && bytes.size() == partSize) { // slow start: the window grows by each full part
+		_window = qMin(_window + partSize, kMaxPartsWindow);
+		if (!_location && partSize == _partSize && _partSize < kMaxDocumentPartSize && _size - _nextRequestOffset >= 4 * _partSize) {
+			_partSize *= 2;
+		}
+	}
+
 	if (DebugLogging::FileLoader() && _id) DEBUG_LOG(("FileLoader(%1): got part with offset=%2, bytes=%3, _queue->queries=%4, _nextRequestOffset=%5, _requests=%6").arg(_id).arg(offset).arg(bytes.size()).arg(_queue->queries).arg(_nextRequestOffset).arg(serializereqs(_requests)));
 
+	if (bytes.size() && !_firstByteReported) {
+		_firstByteReported = true;
+		MTP::fileFirstByte(_dc, getms(true) - _firstRequestAt, _firstRequestCold);
+	}
 	if (bytes.size()) {
+		rangeLoaded(offset, bytes.size());
 		if (_fileIsOpen) {
 			int64 fsize = _file.size();
 			if (offset < fsize) {
@@ -469,8 +559,16 @@ void mtpFileLoader::partLoaded(int32 offset, const MTPupload_File &result, mtpRe
 			if (_file.write(bytes.data(), bytes.size()) != qint64(bytes.size())) {
 				return cancel(true);
 			}
+			if (_streaming) {
+				_file.flush();
+				_streaming->partLoaded(offset, bytes.size());
+			}
+			if (resumable() && (_unsavedBytes += bytes.size()) >= kPartialSaveStep) {
+				_file.flush();
+				savePartial();
+			}
 		} else {
-			_data.reserve(offset + bytes.size());
+			_data.reserve(qMax(_size, offset + bytes.size()));
 			if (offset > _data.size()) {
 				_skippedBytes += offset - _data.size();
 				_data.resize(offset);
@@ -487,9 +585,11 @@ void mtpFileLoader::partLoaded(int32 offset, const MTPupload_File &result, mtpRe
 		}
 	}
 	if (!bytes.size() || (bytes.size() % 1024)) { // bad next offset
+		auto end = offset + bytes.size();
+		_lastCompleteOffset = _lastComplete ? qMin(_lastCompleteOffset, end) : end;
 		_lastComplete = true;
 	}
-	if (_requests.isEmpty() && (_lastComplete || (_size && _nextRequestOffset >= _size))) {
+	if (_requests.isEmpty() && (_size ? loadedAll() : _lastComplete)) {
 		if (!_fname.isEmpty() && (_toCache == LoadToCacheAsWell)) {
 			if (!_fileIsOpen) _fileIsOpen = _file.open(QIODevice::WriteOnly);
 			if (!_fileIsOpen) {
@@ -501,6 +601,13 @@ void mtpFileLoader::partLoaded(int32 offset, const MTPupload_File &result, mtpRe
 		}
 		_type = d.vtype.type();
 		_complete = true;
+		if (_partialSaved) {
+			Local::clearPartialDownload(mediaKey(_locationType, _dc, _id, _version));
+			_partialSaved = false;
+		}
+		if (_id && _firstRequestAt) {
+			DEBUG_LOG(("FileLoader(%1): loaded %2 bytes in %3ms, %4 KB/s, part size %5, window %6").arg(_id).arg(_loadedBytes).arg(getms(true) - _firstRequestAt).arg(throughput() / 1024).arg(_partSize).arg(_window));
+		}
 		if (_fileIsOpen) {
 			_file.close();
 			_fileIsOpen = false;
@@ -539,6 +646,138 @@ void mtpFileLoader::partLoaded(int32 offset, const MTPupload_File &result, mtpRe
 	loadNext();
 }
 
+bool mtpFileLoader::resumable() const {
+	return !_location && _id && _locationType != UnknownFileLocation && _toCache == LoadToFileOnly && _size > 0;
+}
+
+void mtpFileLoader::savePartial() {
+	Local::PartialDownload partial;
+	partial.path = _fname;
+	partial.size = _size;
+	partial.ranges = _loadedRanges;
+	Local::writePartialDownload(mediaKey(_locationType, _dc, _id, _version), partial);
+	_partialSaved = true;
+	_unsavedBytes = 0;
+}
+
+bool mtpFileLoader::resumeFile() {
+	if (!resumable()) return false;
+
+	auto mkey = mediaKey(_locationType, _dc, _id, _version);
+	auto partial = Local::readPartialDownload(mkey);
+	if (partial.path.isEmpty()) return false;
+
+	auto discard = [this, &mkey, &partial](const QString &reason) {
+		LOG(("FileLoader(%1): could not resume '%2', %3").arg(_id).arg(partial.path).arg(reason));
+		Local::clearPartialDownload(mkey);
+		return false;
+	};
+	if (partial.size != _size) {
+		return discard(qsl("size changed from %1 to %2").arg(partial.size).arg(_size));
+	} else if (!QFileInfo(partial.path).isFile()) {
+		return discard(qsl("file not found"));
+	} else if (partial.path != _fname) { // the new download got a unique name, take the old file
+		if (QFileInfo(_fname).exists() || !QFile::rename(partial.path, _fname)) {
+			return discard(qsl("could not move it to '%1'").arg(_fname));
+		}
+	}
+	if (!_file.open(QIODevice::ReadWrite)) {
+		return discard(qsl("could not open it, error %1, %2").arg(_file.error()).arg(_file.errorString()));
+	}
+
+	// Only the ranges that made it to the disk are kept, the parts written
+	// after the last state write are requested again.
+	auto fileSize = int32(qMin(_file.size(), qint64(_size)));
+	auto loaded = 0;
+	for (auto i = partial.ranges.cbegin(), e = partial.ranges.cend(); i != e; ++i) {
+		auto start = i.key(), end = qMin(i.value(), fileSize);
+		if (end < _size) {
+			end -= end % DocumentDownloadPartSize;
+		}
+		if (start >= 0 && end > start) {
+			rangeLoaded(start, end - start);
+			loaded += end - start;
+		}
+	}
+	_skippedBytes = int32(_file.size()) - loaded;
+	_partialSaved = true;
+
+	DEBUG_LOG(("FileLoader(%1): resumed '%2' with %3 of %4 bytes loaded").arg(_id).arg(_fname).arg(loaded).arg(_size));
+	return true;
+}
+
+void mtpFileLoader::rangeLoaded(int32 offset, int32 length) {
+	auto from = offset, till = offset + length;
+	auto i = _loadedRanges.upperBound(from);
+	if (i != _loadedRanges.begin()) {
+		auto prev = i - 1;
+		if (prev.value() >= from) {
+			from = prev.key();
+			till = qMax(till, prev.value());
+			i = _loadedRanges.erase(prev);
+		}
+	}
+	while (i != _loadedRanges.end() && i.key() <= till) {
+		till = qMax(till, i.value());
+		i = _loadedRanges.erase(i);
+	}
+	_loadedRanges.insert(from, till);
+}
+
+int32 mtpFileLoader::loadEnd() const {
+	return (_lastComplete && (!_size || _lastCompleteOffset < _size)) ? _lastCompleteOffset : _size;
+}
+
+int32 mtpFileLoader::nextMissingOffset(int32 from) const {
+	auto end = loadEnd();
+	for (auto wrapped = false;; wrapped = true, from = 0) {
+		for (auto moved = true; moved;) {
+			moved = false;
+			auto loaded = _loadedRanges.upperBound(from);
+			if (loaded != _loadedRanges.cbegin() && (loaded - 1).value() > from) {
+				from = (loaded - 1).value();
+				moved = true;
+			}
+			auto inFlight = _partsInFlight.upperBound(from);
+			if (inFlight != _partsInFlight.cbegin() && (inFlight - 1).key() + (inFlight - 1).value() > from) {
+				from = (inFlight - 1).key() + (inFlight - 1).value();
+				moved = true;
+			}
+		}
+		if (from < end || wrapped) {
+			return from;
+		}
+	}
+}
+
+bool mtpFileLoader::loadedAll() const {
+	return _partsInFlight.isEmpty() && (nextMissingOffset(0) >= loadEnd());
+}
+
+Media::StreamingSourcePtr mtpFileLoader::streamingSource() {
+	if (!_streaming && !_location && _toCache == LoadToFileOnly && _fileIsOpen && _size > 0 && !_complete) {
+		_streaming = Media::MakeStreamingSource(_fname, _size);
+		for (auto i = _loadedRanges.cbegin(), e = _loadedRanges.cend(); i != e; ++i) {
+			_streaming->partLoaded(i.key(), i.value() - i.key());
+		}
+		connect(_streaming.data(), SIGNAL(wanted(qint64)), this, SLOT(onStreamingWanted(qint64)));
+	}
+	return _streaming;
+}
+
+void mtpFileLoader::onStreamingWanted(qint64 offset) {
+	if (_complete || offset < 0 || offset >= _size) return;
+
+	auto aligned = int32(offset) - (int32(offset) % DocumentDownloadPartSize);
+	auto missing = nextMissingOffset(aligned);
+	if (missing > offset || missing < aligned) return; // already loaded or requested
+
+	if (DebugLogging::FileLoader() && _id) DEBUG_LOG(("FileLoader(%1): streaming wants offset=%2, was _nextRequestOffset=%3").arg(_id).arg(offset).arg(_nextRequestOffset));
+
+	_windowFrom = _nextRequestOffset = aligned;
+	start(true, true);
+}
+
 bool mtpFileLoader::partFailed(const RPCError &error) {
 	if (MTP::isDefaultHandledError(error)) return false;
 
@@ -547,21 +786,42 @@ bool mtpFileLoader::partFailed(const RPCError &error) {
 }
 
 void mtpFileLoader::cancelRequests() {
-	if (_requests.isEmpty()) return;
-
-	int32 limit = (_locationType == UnknownFileLocation) ? DownloadPartSize : DocumentDownloadPartSize;
-	DataRequested &dr(DataRequestedMap[_dc]);
-	for (Requests::const_iterator i = _requests.cbegin(), e = _requests.cend(); i != e; ++i) {
-		MTP::cancel(i.key());
-		int32 dcIndex = i.value();
-		dr.v[dcIndex] -= limit;
+	if (_streaming && !_complete) {
+		_streaming->loadFailed(); // the waiting readers retry and report the error
 	}
-	_queue->queries -= _requests.size();
-	_requests.clear();
+	dropRequests(_requests.size());
+}
+
+int32 mtpFileLoader::dropRequests(int32 count) {
+	if (_requests.isEmpty() || count <= 0) return 0;
+
+	MTP::FileSessionsPool &pool(DownloadSessionsPools[_dc]);
+	auto result = 0;
+	while (result < count && !_partRequests.isEmpty()) { // the last parts first, the loaded prefix keeps growing
+		auto last = _partRequests.end() - 1;
+		auto offset = last.key();
+		auto reqId = last.value();
+		_partRequests.erase(last);
+		MTP::BandwidthGovernor::refund(MTP::BandwidthGovernor::Direction::Download, transferId(this), _partsInFlight.take(offset));
+		_requests.remove(reqId);
+		MTP::cancel(reqId);
+		pool.cancelled(reqId);
+		_nextRequestOffset = qMin(_nextRequestOffset, offset);
+		++result;
+	}
+	_queue->queries -= result;
 
 	if (!_queue->queries && App::app()) {
 		App::app()->killDownloadSessionsStart(_dc);
 	}
+	return result;
+}
+
+bool mtpFileLoader::needsRequestSlot() const {
+	if (_complete || !_requests.isEmpty() || loadingLocal() || (_lastComplete && !_size)) {
+		return false;
+	}
+	return !_size || (nextMissingOffset(_nextRequestOffset) < loadEnd());
 }
 
 bool mtpFileLoader::tryLoadLocal() {
@@ -597,7 +857,14 @@ bool mtpFileLoader::tryLoadLocal() {
 }
 
 mtpFileLoader::~mtpFileLoader() {
+	if (_partialSaved && _fname.isEmpty()) { // cancelled, the file is removed
+		Local::clearPartialDownload(mediaKey(_locationType, _dc, _id, _version));
+	} else if (_fileIsOpen && !_complete && _unsavedBytes && resumable()) {
+		_file.flush();
+		savePartial();
+	}
 	cancelRequests();
+	MTP::BandwidthGovernor::finished(MTP::BandwidthGovernor::Direction::Download, transferId(this));
 }
 
 webFileLoader::webFileLoader(const QString &url, const QString &to, LoadFromCloudSetting fromCloud, bool autoLoading)
@@ -709,6 +976,9 @@ public:
 		, _reply(0)
 		, _redirectsLeft(MaxHttpRedirects) {
 	}
+	~webFileLoaderPrivate() {
+		MTP::BandwidthGovernor::finished(MTP::BandwidthGovernor::Direction::Download, transferId(this));
+	}
 
 	QNetworkReply *reply() {
 		return _reply;
@@ -797,7 +1067,9 @@ void WebLoadManager::setProxySettings(const QNetworkProxy &proxy) {
 WebLoadManager::WebLoadManager(QThread *thread) {
 	moveToThread(thread);
 	_manager.moveToThread(thread);
+	_throttleTimer.moveToThread(thread);
 	connect(thread, SIGNAL(started()), this, SLOT(process()));
+	connect(&_throttleTimer, SIGNAL(timeout()), this, SLOT(onThrottled()));
 	connect(thread, SIGNAL(finished()), this, SLOT(finish()));
 	connect(this, SIGNAL(processDelayed()), this, SLOT(process()), Qt::QueuedConnection);
 	connect(this, SIGNAL(proxyApplyDelayed()), this, SLOT(proxyApply()), Qt::QueuedConnection);
@@ -885,9 +1157,23 @@ void WebLoadManager::onFailed(QNetworkReply *reply) {
 }
 
 void WebLoadManager::onProgress(qint64 already, qint64 size) {
-	QNetworkReply *reply = qobject_cast<QNetworkReply*>(QObject::sender());
-	if (!reply) return;
+	if (QNetworkReply *reply = qobject_cast<QNetworkReply*>(QObject::sender())) {
+		progressReply(reply, already, size);
+	}
+}
+
+void WebLoadManager::onThrottled() {
+	auto replies = _replies.keys(); // progressReply() can remove from _replies
+	for_const (QNetworkReply *reply, replies) {
+		Replies::const_iterator j = _replies.constFind(reply);
+		if (j == _replies.cend() || reply->bytesAvailable() <= 0) continue;
+
+		webFileLoaderPrivate *loader = j.value();
+		progressReply(reply, loader->already() + reply->bytesAvailable(), loader->size() ? loader->size() : -1);
+	}
+}
 
+void WebLoadManager::progressReply(QNetworkReply *reply, qint64 already, qint64 size) {
 	Replies::iterator j = _replies.find(reply);
 	if (j == _replies.cend()) { // handled already
 		return;
@@ -914,6 +1200,14 @@ void WebLoadManager::onProgress(qint64 already, qint64 size) {
 			result = WebReplyProcessError;
 		}
 	} else {
+		qint64 available = reply->bytesAvailable();
+		if (available > 0) {
+			if (auto wait = MTP::BandwidthGovernor::acquire(MTP::BandwidthGovernor::Direction::Download, transferId(loader), available)) {
+				loader->setProgress(already - available, size); // only the read bytes are counted
+				_throttleTimer.startIfNotActive(wait);
+				return;
+			}
+		}
 		loader->setProgress(already, size);
 		QByteArray r = reply->readAll();
 		if (!r.isEmpty()) {
@@ -1014,6 +1308,7 @@ void WebLoadManager::sendRequest(webFileLoaderPrivate *loader, const QString &re
 	}
 
 	QNetworkReply *r = loader->request(_manager, redirect);
+	r->setReadBufferSize(kWebReadBufferSize);
 	connect(r, SIGNAL(downloadProgress(qint64, qint64)), this, SLOT(onProgress(qint64, qint64)));
 	connect(r, SIGNAL(error(QNetworkReply::NetworkError)), this, SLOT(onFailed(QNetworkReply::NetworkError)));
 	connect(r, SIGNAL(metaDataChanged()), this, SLOT(onMeta()));
@@ -1077,6 +1372,45 @@ namespace MTP {
 	void clearLoaderPriorities() {
 		++GlobalPriority;
 	}
+
+	void dropHiddenLoaderRequests() {
+		auto ms = getms();
+		for (auto i = queues.begin(), e = queues.end(); i != e; ++i) {
+			auto queue = &i.value();
+
+			// The loaders of this pass are in front of the queue, count the
+			// slots lacking for the ones that wait for their first request.
+			auto needed = queue->queries - queue->limit;
+			for (auto loader = queue->start; loader && loader->_priority == GlobalPriority; loader = loader->_next) {
+				if (loader->needsRequestSlot()) {
+					++needed;
+				}
+			}
+			if (needed <= 0) continue;
+
+			// The loaders never marked visible belong to the widgets that
+			// don't report the displayed media, they are not dropped.
+			auto dropped = 0;
+			for (auto loader = queue->end; loader && dropped < needed; loader = loader->_prev) {
+				if (loader->_autoLoading && loader->_visibleAt && loader->_visibleAt + kHiddenLoaderTimeout < ms) {
+					dropped += loader->dropRequests(needed - dropped);
+				}
+			}
+			if (!dropped) continue;
+
+			DEBUG_LOG(("Download Info: dropped %1 hidden loader requests, %2 queries left of %3").arg(dropped).arg(queue->queries).arg(queue->limit));
+
+			// Not loadNext(): it walks the whole queue and could give the
+			// freed slots back to the dropped loaders.
+			for (auto loader = queue->start; loader && loader->_priority == GlobalPriority && queue->queries < queue->limit;) {
+				auto next = loader->_next;
+				if (loader->needsRequestSlot()) {
+					loader->loadPart();
+				}
+				loader = next;
+			}
+		}
+	}
 }
 
 namespace FileDownload {
@@ -21,9 +21,17 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 #pragma once
 
 #include "core/observer.h"
+#include "core/single_timer.h"
+#include "media/media_streaming.h"
 
 namespace MTP {
+	// A visible area pass starts with clearLoaderPriorities(), marks the
+	// loaders of the displayed media visible and ends with
+	// dropHiddenLoaderRequests(). When the displayed media wait for the
+	// slots of a full queue it frees that many requests of the automatic
+	// loads not displayed for a few seconds.
 	void clearLoaderPriorities();
+	void dropHiddenLoaderRequests();
 }
 
 enum LocationType {
@@ -139,6 +147,7 @@ public:
 	void pause();
 	void start(bool loadFirst = false, bool prior = true);
 	void cancel();
+	void markVisible(); // the media is displayed in the current visible area pass
 
 	bool loading() const {
 		return _inQueue;
@@ -185,6 +194,7 @@ protected:
 	FileLoader *_prev = nullptr;
 	FileLoader *_next = nullptr;
 	int _priority = 0;
+	uint64 _visibleAt = 0; // the last markVisible() time, 0 if the owner doesn't track the display
 	FileLoaderQueue *_queue;
 
 	bool _paused = false;
@@ -195,6 +205,16 @@ protected:
 
 	virtual bool tryLoadLocal() = 0;
 	virtual void cancelRequests() = 0;
+	virtual bool resumeFile() { // open the file left by the previous launch
+		return false;
+	}
+	virtual int32 dropRequests(int32 count) { // the loader stays in the queue and requests the parts again later
+		return 0;
+	}
+	virtual bool needsRequestSlot() const { // nothing is requested and loadPart() would send a request
+		return false;
+	}
+	friend void MTP::dropHiddenLoaderRequests();
 
 	void startLoading(bool loadFirst, bool prior);
 	void removeFromQueue();
@@ -202,6 +222,7 @@ protected:
 
 	void loadNext();
 	virtual bool loadPart() = 0;
+	static void loadNextAfter(uint64 wait); // the bandwidth governor delayed some parts, retry all the queues
 
 	QFile _file;
 	QString _fname;
@@ -231,6 +252,7 @@ public:
 	mtpFileLoader(int32 dc, const uint64 &id, const uint64 &access, int32 version, LocationType type, const QString &toFile, int32 size, LoadToCacheSetting toCache, LoadFromCloudSetting fromCloud, bool autoLoading);
 
 	virtual int32 currentOffset(bool includeSkipped = false) const;
+	int64 throughput() const; // bytes per second since the first request
 
 	uint64 objId() const {
 		return _id;
@@ -247,11 +269,21 @@ public:
 		rpcClear();
 	}
 
+	// Documents loaded to a file can be played while loading, the readers
+	// ask for the missing offsets through the returned source.
+	Media::StreamingSourcePtr streamingSource();
+
 	~mtpFileLoader();
 
+public slots:
+	void onStreamingWanted(qint64 offset);
+
 protected:
 	virtual bool tryLoadLocal();
 	virtual void cancelRequests();
+	virtual bool resumeFile();
+	virtual int32 dropRequests(int32 count);
+	virtual bool needsRequestSlot() const;
 
 	typedef QMap<mtpRequestId, int32> Requests;
 	Requests _requests;
@@ -261,9 +293,45 @@ protected:
 	bool partFailed(const RPCError &error);
 
 	bool _lastComplete = false;
+	int32 _lastCompleteOffset = 0; // end of the file found by a short part
 	int32 _skippedBytes = 0;
 	int32 _nextRequestOffset = 0;
 
+	// After a seek the parts are requested from the wanted offset, the holes
+	// left behind are requested when the end of the file is reached.
+	typedef QMap<int32, int32> LoadedRanges; // start -> end, merged
+	LoadedRanges _loadedRanges;
+	int32 _windowFrom = 0;
+	Media::StreamingSourcePtr _streaming;
+
+	// The written ranges are saved to the local storage every few megabytes,
+	// the next launch continues the download from them.
+	int32 _unsavedBytes = 0;
+	bool _partialSaved = false;
+	bool resumable() const;
+	void savePartial();
+
+	void rangeLoaded(int32 offset, int32 length);
+	int32 loadEnd() const;
+	int32 nextMissingOffset(int32 from) const;
+	bool loadedAll() const;
+
+	// The parts are requested while they fit in the window counted from the
+	// first part in flight, the parts received out of order are written at
+	// their offsets. Both the window and the document part size grow while
+	// the full parts are received.
+	typedef QMap<int32, int32> PartsInFlight; // offset -> requested size
+	PartsInFlight _partsInFlight;
+	QMap<int32, mtpRequestId> _partRequests; // offset -> request, the hidden loaders drop the last parts
+	int32 _window = MaxFileQueries * DocumentDownloadPartSize;
+	int32 _partSize = DocumentDownloadPartSize;
+	int64 _loadedBytes = 0;
+
+	// time to the first byte is reported to compare warm and cold sessions
+	uint64 _firstRequestAt = 0;
+	bool _firstRequestCold = false;
+	bool _firstByteReported = false;
+
 	int32 _dc;
 	const StorageImageLocation *_location = nullptr;
 
@@ -352,6 +420,7 @@ public slots:
 	void onFailed(QNetworkReply::NetworkError error);
 	void onProgress(qint64 already, qint64 size);
 	void onMeta();
+	void onThrottled();
 
 	void process();
 	void proxyApply();
@@ -361,6 +430,7 @@ private:
 	void clear();
 	void sendRequest(webFileLoaderPrivate *loader, const QString &redirect = QString());
 	bool handleReplyResult(webFileLoaderPrivate *loader, WebReplyProcessResult result);
+	void progressReply(QNetworkReply *reply, qint64 already, qint64 size);
 
 #ifndef TDESKTOP_DISABLE_NETWORK_PROXY
 	QNetworkProxy _proxySettings;
@@ -376,6 +446,8 @@ private:
 	typedef QMap<QNetworkReply*, webFileLoaderPrivate*> Replies;
 	Replies _replies;
 
+	SingleTimer _throttleTimer; // reads the replies delayed by the bandwidth governor
+
 };
 
 class WebLoadMainManager : public QObject {
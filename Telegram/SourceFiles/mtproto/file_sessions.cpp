@@ -0,0 +1,172 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#include "stdafx.h"
+
+#include "mtproto/file_sessions.h"
+
+namespace MTP {
+namespace {
+
+constexpr int64 kDownloadSessionWindow = 4 * 1024 * 1024; // bytes in flight for one download session
+constexpr int64 kUploadSessionWindow = 2 * 1024 * 1024; // bytes in flight for one upload session
+constexpr int64 kWindowGain = 2; // window is twice the bandwidth-delay product to probe for more
+constexpr uint64 kMinSampleInterval = 250; // ms, the delivery rate is sampled not more often
+constexpr uint64 kMinRttExpire = 10000; // ms, the minimal rtt is forgotten after that
+
+// the sessions counts of the last updated pools, used by the connection timeouts
+QAtomicInt CurrentDownloadCount(MTPDownloadSessionsCount);
+QAtomicInt CurrentUploadCount(MTPUploadSessionsCount);
+
+QAtomicInt &currentCountRef(FileSessionsPool::Kind kind) {
+	return (kind == FileSessionsPool::Kind::Download) ? CurrentDownloadCount : CurrentUploadCount;
+}
+
+int initialCount(FileSessionsPool::Kind kind) {
+	return qMin(int((kind == FileSessionsPool::Kind::Download) ? MTPDownloadSessionsCount : MTPUploadSessionsCount), FileSessionsPool::maxCount());
+}
+
+} // namespace
+
+FileSessionsPool::FileSessionsPool(Kind kind) : _kind(kind)
+, _minWindow((kind == Kind::Download) ? int64(MaxFileQueries) * DocumentDownloadPartSize : int64(MaxUploadFileParallelSize))
+, _sessionWindow((kind == Kind::Download) ? kDownloadSessionWindow : kUploadSessionWindow)
+, _window(_minWindow)
+, _activeCount(initialCount(kind)) {
+}
+
+int FileSessionsPool::chooseSession() const {
+	int result = 0;
+	for (int i = 1; i < _activeCount; ++i) {
+		if (_sessionsInFlight[i] < _sessionsInFlight[result]) {
+			result = i;
+		}
+	}
+	return result;
+}
+
+void FileSessionsPool::sent(mtpRequestId requestId, int index, int32 size) {
+	t_assert(index >= 0 && index < MTPFileSessionsMaxCount);
+
+	uint64 ms = getms(true);
+	if (!_inFlight) { // was idle, start a new sample
+		_intervalStart = ms;
+		_intervalDelivered = 0;
+		_intervalLimited = false;
+	}
+	_requests.insert(requestId, { index, size, ms });
+	_inFlight += size;
+	_sessionsInFlight[index] += size;
+}
+
+int FileSessionsPool::done(mtpRequestId requestId) {
+	auto i = _requests.find(requestId);
+	if (i == _requests.cend()) return -1;
+
+	Request request = i.value();
+	_requests.erase(i);
+	_inFlight -= request.size;
+	_sessionsInFlight[request.index] -= request.size;
+
+	uint64 ms = getms(true), rtt = qMax(ms - request.sent, uint64(1));
+	_srtt = _srtt ? ((_srtt * 7 + rtt) / 8) : rtt;
+	if (!_minRtt || rtt <= _minRtt || ms - _minRttStamp > kMinRttExpire) {
+		_minRtt = rtt;
+		_minRttStamp = ms;
+	}
+
+	_intervalDelivered += request.size;
+	if (_inFlight + request.size < _window / 2) {
+		_intervalLimited = true;
+	}
+	sample(ms);
+
+	return request.index;
+}
+
+int FileSessionsPool::cancelled(mtpRequestId requestId) {
+	auto i = _requests.find(requestId);
+	if (i == _requests.cend()) return -1;
+
+	int index = i->index;
+	_inFlight -= i->size;
+	_sessionsInFlight[index] -= i->size;
+	_requests.erase(i);
+	return index;
+}
+
+void FileSessionsPool::clear() {
+	_requests.clear();
+	_inFlight = 0;
+	memset(_sessionsInFlight, 0, sizeof(_sessionsInFlight));
+}
+
+int FileSessionsPool::maxCount() {
+	return snap(int(cFileSessionsMax()), 1, int(MTPFileSessionsMaxCount));
+}
+
+int FileSessionsPool::currentCount(Kind kind) {
+	return currentCountRef(kind).load();
+}
+
+void FileSessionsPool::sample(uint64 ms) {
+	uint64 elapsed = ms - _intervalStart;
+	if (elapsed < qMax(_srtt, kMinSampleInterval)) return;
+
+	int64 bandwidth = _intervalDelivered * 1000 / int64(elapsed);
+	int64 maxBandwidth = 0;
+	for (auto sample : _bandwidthSamples) {
+		accumulate_max(maxBandwidth, sample);
+	}
+
+	// a sample taken while the window was not full only tells how much was requested
+	if (!_intervalLimited || bandwidth > maxBandwidth) {
+		_bandwidthSamples[_bandwidthSampleIndex] = bandwidth;
+		_bandwidthSampleIndex = (_bandwidthSampleIndex + 1) % base::array_size(_bandwidthSamples);
+	}
+	_intervalStart = ms;
+	_intervalDelivered = 0;
+	_intervalLimited = false;
+
+	update();
+}
+
+void FileSessionsPool::update() {
+	int64 bandwidth = 0;
+	for (auto sample : _bandwidthSamples) {
+		accumulate_max(bandwidth, sample);
+	}
+	if (!bandwidth || !_minRtt) return;
+
+	int ceiling = maxCount();
+	int64 maxWindow = qMax(_minWindow, ceiling * _sessionWindow);
+	int64 target = snap(kWindowGain * bandwidth * int64(_minRtt) / 1000, _minWindow, maxWindow);
+	int64 window = snap(snap(target, _window * 3 / 4, _window * 5 / 4), _minWindow, maxWindow);
+	int count = snap(int((window + _sessionWindow - 1) / _sessionWindow), initialCount(_kind), ceiling);
+
+	if (count != _activeCount) {
+		DEBUG_LOG(("File Sessions: %1 sessions count %2 -> %3, window %4 kb, bandwidth %5 kb/s, min rtt %6 ms, srtt %7 ms").arg((_kind == Kind::Download) ? "download" : "upload").arg(_activeCount).arg(count).arg(window / 1024).arg(bandwidth / 1024).arg(_minRtt).arg(_srtt));
+		currentCountRef(_kind).store(count);
+	}
+	_window = window;
+	_activeCount = count;
+}
+
+} // namespace MTP
@@ -0,0 +1,93 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+#include "mtproto/core_types.h"
+
+namespace MTP {
+
+// Spreads the file part requests of one dc across several sessions.
+//
+// The window of bytes in flight follows the measured bandwidth-delay
+// product: the delivery rate is sampled once in a round trip and multiplied
+// by the minimal round trip time. While the round trip time stays close to
+// the minimal one the window keeps growing, when the requests start to
+// queue up somewhere it shrinks back. The sessions count follows the window,
+// so that one session doesn't carry more than its share of the bytes.
+class FileSessionsPool {
+public:
+	enum class Kind {
+		Download,
+		Upload,
+	};
+	explicit FileSessionsPool(Kind kind = Kind::Download);
+
+	int chooseSession() const; // the active session with the least bytes in flight
+
+	void sent(mtpRequestId requestId, int index, int32 size);
+	int done(mtpRequestId requestId); // returns session index or -1 if the request was not found
+	int cancelled(mtpRequestId requestId); // the same, but the request is not measured
+	void clear();
+
+	bool canSend() const {
+		return _inFlight < _window;
+	}
+	int64 window() const {
+		return _window;
+	}
+	int64 inFlight() const {
+		return _inFlight;
+	}
+	int activeCount() const {
+		return _activeCount;
+	}
+
+	static int maxCount(); // the configured ceiling
+	static int currentCount(Kind kind); // can be called from any thread
+
+private:
+	void sample(uint64 ms);
+	void update();
+
+	struct Request {
+		int index;
+		int32 size;
+		uint64 sent;
+	};
+
+	Kind _kind;
+	int64 _minWindow, _sessionWindow;
+	int64 _window;
+	int64 _inFlight = 0;
+	int _activeCount;
+	int64 _sessionsInFlight[MTPFileSessionsMaxCount] = { 0 };
+	QMap<mtpRequestId, Request> _requests;
+
+	uint64 _minRtt = 0, _minRttStamp = 0, _srtt = 0; // ms
+	uint64 _intervalStart = 0;
+	int64 _intervalDelivered = 0;
+	bool _intervalLimited = false; // the window was not full, the sample shows the demand and not the link
+	int64 _bandwidthSamples[8] = { 0 }; // bytes per second
+	int _bandwidthSampleIndex = 0;
+
+};
+
+} // namespace MTP
@@ -708,7 +708,7 @@ for restype in typesList:
       reader += '\t\tcase mtpc_' + name + ': _type = cons; '; # read switch line
       if (len(prms) > len(trivialConditions)):
         reader += '{\n';
-        reader += '\t\t\tif (!data) setData(new MTPD' + name + '());\n';
+        reader += '\t\t\tif (!data) setData(mtpNewData<MTPD' + name + '>());\n';
         reader += '\t\t\tMTPD' + name + ' &v(_' + name + '());\n';
         reader += readText;
         reader += '\t\t} break;\n';
@@ -721,7 +721,7 @@ for restype in typesList:
         reader += 'break;\n';
     else:
       if (len(prms) > len(trivialConditions)):
-        reader += '\n\tif (!data) setData(new MTPD' + name + '());\n';
+        reader += '\n\tif (!data) setData(mtpNewData<MTPD' + name + '>());\n';
         reader += '\tMTPD' + name + ' &v(_' + name + '());\n';
         reader += readText;
 
@@ -0,0 +1,156 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#include "stdafx.h"
+
+#include "mtproto/gzip_inflater.h"
+
+namespace MTP {
+namespace internal {
+namespace {
+
+constexpr float64 kInitialRatio = 4.;
+constexpr float64 kRatioReserve = 1.1; // preallocated output is bigger than the expected one
+constexpr float64 kRatioSmoothing = 0.25; // weight of the last object in the learned ratio
+
+struct InflateStats {
+	uint64 objects = 0;
+	uint64 packed = 0;
+	uint64 unpacked = 0;
+	uint64 reallocations = 0;
+	int64 time = 0; // mcs
+};
+InflateStats inflateStats;
+QMutex inflateStatsLock;
+
+bool readPackedBytes(const mtpPrime *from, const mtpPrime *end, const uchar *&bytes, uint32 &length) {
+	if (from >= end) return false;
+
+	const uchar *data = reinterpret_cast<const uchar*>(from);
+	uint32 available = (end - from) * sizeof(mtpPrime), offset = 1;
+	length = data[0];
+	if (length == 254) {
+		length = uint32(data[1]) | (uint32(data[2]) << 8) | (uint32(data[3]) << 16);
+		offset = 4;
+	}
+	if (offset + length > available) return false;
+
+	bytes = data + offset;
+	return true;
+}
+
+} // namespace
+
+GzipInflater::GzipInflater() : _inited(false), _ratio(kInitialRatio) {
+	memset(&_stream, 0, sizeof(_stream));
+}
+
+bool GzipInflater::inflate(const mtpPrime *from, const mtpPrime *end, mtpBuffer &result) {
+	const uchar *packed = nullptr;
+	uint32 packedLen = 0;
+	if (!readPackedBytes(from, end, packed, packedLen)) {
+		LOG(("RPC Error: bad gzip_packed object length"));
+		return false;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	int res = _inited ? inflateReset(&_stream) : inflateInit2(&_stream, 16 + MAX_WBITS);
+	if (res != Z_OK) {
+		LOG(("RPC Error: could not init zlib stream, code: %1").arg(res));
+		if (_inited) {
+			inflateEnd(&_stream);
+			_inited = false;
+		}
+		return false;
+	}
+	_inited = true;
+
+	uint32 capacity = qMax(uint32(packedLen * _ratio * kRatioReserve) / sizeof(mtpPrime) + 1, packedLen / sizeof(mtpPrime) + 1);
+	result.resize(capacity);
+
+	_stream.avail_in = packedLen;
+	_stream.next_in = const_cast<Bytef*>(packed);
+	_stream.avail_out = capacity * sizeof(mtpPrime);
+	_stream.next_out = reinterpret_cast<Bytef*>(result.data());
+
+	uint32 reallocations = 0;
+	while (true) {
+		res = ::inflate(&_stream, Z_NO_FLUSH);
+		if (res == Z_STREAM_END) {
+			break;
+		} else if ((res == Z_OK || res == Z_BUF_ERROR) && !_stream.avail_out) {
+			uint32 unpackedLen = capacity * sizeof(mtpPrime);
+			capacity += capacity / 2 + 1;
+			result.resize(capacity);
+			_stream.avail_out = capacity * sizeof(mtpPrime) - unpackedLen;
+			_stream.next_out = reinterpret_cast<Bytef*>(result.data()) + unpackedLen;
+			++reallocations;
+		} else if (res != Z_OK || !_stream.avail_in) {
+			LOG(("RPC Error: could not unpack gziped data, code: %1").arg(res));
+			DEBUG_LOG(("RPC Error: bad gzip: %1").arg(Logs::mb(packed, packedLen).str()));
+			result.clear();
+			return false;
+		}
+	}
+
+	uint32 unpackedLen = capacity * sizeof(mtpPrime) - _stream.avail_out;
+	if (!unpackedLen || (unpackedLen & 0x03)) {
+		LOG(("RPC Error: bad length of unpacked data %1").arg(unpackedLen));
+		DEBUG_LOG(("RPC Error: bad unpacked data %1").arg(Logs::mb(result.constData(), unpackedLen).str()));
+		result.clear();
+		return false;
+	}
+	result.resize(unpackedLen / sizeof(mtpPrime));
+
+	if (packedLen) {
+		_ratio += (float64(unpackedLen) / packedLen - _ratio) * kRatioSmoothing;
+	}
+
+	int64 time = timer.nsecsElapsed() / 1000;
+	{
+		QMutexLocker lock(&inflateStatsLock);
+		++inflateStats.objects;
+		inflateStats.packed += packedLen;
+		inflateStats.unpacked += unpackedLen;
+		inflateStats.reallocations += reallocations;
+		inflateStats.time += time;
+	}
+	DEBUG_LOG(("RPC Info: inflated %1 bytes to %2 bytes in %3 mcs, reallocations: %4").arg(packedLen).arg(unpackedLen).arg(time).arg(reallocations));
+	return true;
+}
+
+void GzipInflater::logStats() {
+	QMutexLocker lock(&inflateStatsLock);
+	if (!inflateStats.objects) return;
+
+	float64 speed = inflateStats.time ? (inflateStats.unpacked / float64(inflateStats.time)) : 0.; // bytes per mcs = MB per second
+	DEBUG_LOG(("MTP Info: inflated %1 objects, %2 bytes to %3 bytes, %4 MB/s, reallocations: %5").arg(inflateStats.objects).arg(inflateStats.packed).arg(inflateStats.unpacked).arg(speed).arg(inflateStats.reallocations));
+}
+
+GzipInflater::~GzipInflater() {
+	if (_inited) {
+		inflateEnd(&_stream);
+	}
+}
+
+} // namespace internal
+} // namespace MTP
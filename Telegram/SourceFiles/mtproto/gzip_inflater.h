@@ -0,0 +1,53 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+#include "mtproto/core_types.h"
+
+#include "zlib.h"
+
+namespace MTP {
+namespace internal {
+
+// Reusable inflater for gzip_packed objects, the zlib stream is reset between
+// the objects and the output is allocated once, sized by the packing ratio
+// of the objects inflated before.
+class GzipInflater {
+public:
+	GzipInflater();
+	GzipInflater(const GzipInflater &other) = delete;
+	GzipInflater &operator=(const GzipInflater &other) = delete;
+	~GzipInflater();
+
+	// [from, end) is the gzip_packed object data following its constructor id
+	bool inflate(const mtpPrime *from, const mtpPrime *end, mtpBuffer &result);
+
+	static void logStats();
+
+private:
+	z_stream _stream;
+	bool _inited;
+	float64 _ratio; // unpacked / packed size
+
+};
+
+} // namespace internal
+} // namespace MTP
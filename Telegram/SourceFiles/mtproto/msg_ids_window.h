@@ -0,0 +1,208 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+#include "mtproto/core_types.h"
+
+namespace MTP {
+namespace internal {
+
+// The last Capacity msg_ids with a value for each of them, in arrival order.
+//
+// msg_ids only grow (up to a small reordering), so the oldest one is the one
+// to forget: the ids are kept in a ring buffer overwriting the oldest slot,
+// a bitmap marks the slots still in use and an open addressing index over
+// the ring gives O(1) insert, lookup and remove without any allocations.
+template <typename Value, int Capacity = MTPIdsBufferSize>
+class MsgIdsWindow {
+	static_assert(Capacity > 0 && !(Capacity & (Capacity - 1)), "MsgIdsWindow capacity must be a power of two.");
+
+public:
+	MsgIdsWindow() {
+		clear();
+	}
+
+	// false if msgId is already there, the forgotten oldest one is returned in evicted*
+	bool insert(mtpMsgId msgId, const Value &value, mtpMsgId *evictedId = nullptr, Value *evictedValue = nullptr) {
+		if (indexOf(msgId) >= 0) return false;
+
+		int slot = _head;
+		if (_written == Capacity) {
+			if (alive(slot)) {
+				if (evictedId) *evictedId = _ids[slot];
+				if (evictedValue) *evictedValue = _values[slot];
+				if (_ids[slot] > _evictedMax) _evictedMax = _ids[slot];
+				unindex(slot);
+				--_size;
+			}
+		} else {
+			++_written;
+		}
+		_ids[slot] = msgId;
+		_values[slot] = value;
+		setAlive(slot, true);
+		index(slot);
+		_head = (_head + 1) & (Capacity - 1);
+
+		if (!_size++ || msgId < _smallest) _smallest = msgId;
+		if (msgId > _max) _max = msgId;
+		return true;
+	}
+
+	bool contains(mtpMsgId msgId) const {
+		return indexOf(msgId) >= 0;
+	}
+	const Value *find(mtpMsgId msgId) const { // nullptr if not found
+		int slot = indexOf(msgId);
+		return (slot < 0) ? nullptr : &_values[slot];
+	}
+	bool remove(mtpMsgId msgId, Value *value = nullptr) {
+		int slot = indexOf(msgId);
+		if (slot < 0) return false;
+
+		if (value) *value = _values[slot];
+		unindex(slot);
+		setAlive(slot, false);
+		--_size;
+		return true;
+	}
+
+	// msg_ids below min() were forgotten (or never received if nothing was forgotten yet)
+	mtpMsgId min() const {
+		return _evictedMax ? (_evictedMax + 1) : _smallest;
+	}
+	mtpMsgId max() const {
+		return _max;
+	}
+
+	int size() const {
+		return _size;
+	}
+	bool isEmpty() const {
+		return !_size;
+	}
+	bool full() const { // the next insert will forget the oldest one
+		return _written == Capacity;
+	}
+
+	template <typename Callback>
+	void enumerate(Callback callback) const { // callback(msgId, value), from the oldest to the newest
+		int from = (_written == Capacity) ? _head : 0;
+		for (int i = 0; i != _written; ++i) {
+			int slot = (from + i) & (Capacity - 1);
+			if (alive(slot)) {
+				callback(_ids[slot], _values[slot]);
+			}
+		}
+	}
+
+	void clear() {
+		memset(_alive, 0, sizeof(_alive));
+		memset(_index, 0xFF, sizeof(_index));
+		_head = _written = _size = 0;
+		_smallest = _max = _evictedMax = 0;
+	}
+
+private:
+	static constexpr int kIndexSize = Capacity * 2; // at most half full
+	static constexpr int kAliveWords = (Capacity + 63) / 64;
+
+	static int hash(mtpMsgId msgId) {
+		// the low bits of msg_ids are mostly zeros or a small counter, so mix all of them
+		return int((msgId * 0x9E3779B97F4A7C15ULL) >> 32) & (kIndexSize - 1);
+	}
+
+	bool alive(int slot) const {
+		return (_alive[slot >> 6] >> (slot & 63)) & 1;
+	}
+	void setAlive(int slot, bool alive) {
+		if (alive) {
+			_alive[slot >> 6] |= (1ULL << (slot & 63));
+		} else {
+			_alive[slot >> 6] &= ~(1ULL << (slot & 63));
+		}
+	}
+
+	int indexOf(mtpMsgId msgId) const { // ring slot or -1
+		for (int position = hash(msgId); _index[position] >= 0; position = (position + 1) & (kIndexSize - 1)) {
+			if (_ids[_index[position]] == msgId) {
+				return _index[position];
+			}
+		}
+		return -1;
+	}
+	void index(int slot) {
+		int position = hash(_ids[slot]);
+		while (_index[position] >= 0) {
+			position = (position + 1) & (kIndexSize - 1);
+		}
+		_index[position] = slot;
+	}
+	void unindex(int slot) {
+		int position = hash(_ids[slot]);
+		while (_index[position] != slot) {
+			position = (position + 1) & (kIndexSize - 1);
+		}
+
+		// linear probing removal: move back the following entries of the
+		// probe sequence that can't be found anymore with a hole left here
+		for (int next = (position + 1) & (kIndexSize - 1); _index[next] >= 0; next = (next + 1) & (kIndexSize - 1)) {
+			int wanted = hash(_ids[_index[next]]);
+			bool between = (position <= next) ? (position < wanted && wanted <= next) : (position < wanted || wanted <= next);
+			if (!between) {
+				_index[position] = _index[next];
+				position = next;
+			}
+		}
+		_index[position] = -1;
+	}
+
+	mtpMsgId _ids[Capacity];
+	Value _values[Capacity];
+	uint64 _alive[kAliveWords];
+	int32 _index[kIndexSize];
+
+	int _head, _written, _size;
+	mtpMsgId _smallest, _max, _evictedMax;
+
+};
+
+// received msg_ids with the needAck flags, to skip the repeated messages
+class ReceivedMsgIds : public MsgIdsWindow<bool> {
+public:
+	bool registerMsgId(mtpMsgId msgId, bool needAck) { // false if there is no need to handle it
+		if (contains(msgId)) {
+			MTP_LOG(-1, ("No need to handle - %1 already is in map").arg(msgId));
+			return false;
+		} else if (full() && msgId < min()) {
+			MTP_LOG(-1, ("No need to handle - %1 < min = %2").arg(msgId).arg(min()));
+			return false;
+		}
+		insert(msgId, needAck);
+		return true;
+	}
+
+};
+
+using AckedMsgIds = MsgIdsWindow<mtpRequestId>; // msg_id -> request_id
+
+} // namespace internal
+} // namespace MTP
@@ -0,0 +1,150 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#include "stdafx.h"
+
+#include "mtproto/request_registry.h"
+
+namespace MTP {
+namespace internal {
+
+void RequestRegistry::store(mtpRequestId requestId, const mtpRequest &request, const RPCResponseHandler &handler) {
+	auto &s = shard(requestId);
+	QMutexLocker lock(&s.mutex);
+	auto &record = s.records[requestId];
+	record.request = request;
+	record.hasRequest = true;
+	if (handler.onDone || handler.onFail) {
+		record.handler = handler;
+		record.hasHandler = true;
+	}
+}
+
+void RequestRegistry::setDc(mtpRequestId requestId, int32 dcWithShift) {
+	auto &s = shard(requestId);
+	QMutexLocker lock(&s.mutex);
+	auto &record = s.records[requestId];
+	record.dcWithShift = dcWithShift;
+	record.hasRequest = true;
+}
+
+int32 RequestRegistry::dc(mtpRequestId requestId) const {
+	auto &s = shard(requestId);
+	QMutexLocker lock(&s.mutex);
+	auto i = s.records.constFind(requestId);
+	return (i == s.records.cend() || !i->hasRequest) ? 0 : i->dcWithShift;
+}
+
+mtpRequest RequestRegistry::request(mtpRequestId requestId) const {
+	auto &s = shard(requestId);
+	QMutexLocker lock(&s.mutex);
+	auto i = s.records.constFind(requestId);
+	return (i == s.records.cend() || !i->hasRequest) ? mtpRequest() : i->request;
+}
+
+int32 RequestRegistry::nextDelay(mtpRequestId requestId) {
+	auto &s = shard(requestId);
+	QMutexLocker lock(&s.mutex);
+	auto i = s.records.find(requestId);
+	if (i == s.records.end()) return 1;
+
+	if (!i->delay) {
+		i->delay = 1;
+	} else if (i->delay <= 60) {
+		i->delay *= 2;
+	}
+	return i->delay;
+}
+
+mtpRequest RequestRegistry::cancel(mtpRequestId requestId, int32 *dcWithShift) {
+	auto &s = shard(requestId);
+	QMutexLocker lock(&s.mutex);
+	auto i = s.records.find(requestId);
+	if (i == s.records.end() || !i->hasRequest) {
+		*dcWithShift = 0;
+		return mtpRequest();
+	}
+
+	auto result = i->request;
+	*dcWithShift = i->dcWithShift;
+	if (i->hasHandler) {
+		i->request = mtpRequest();
+		i->dcWithShift = i->delay = 0;
+		i->hasRequest = false;
+	} else {
+		s.records.erase(i);
+	}
+	return result;
+}
+
+void RequestRegistry::unregister(mtpRequestId requestId) {
+	int32 dcWithShift = 0;
+	cancel(requestId, &dcWithShift);
+}
+
+bool RequestRegistry::hasHandler(mtpRequestId requestId) const {
+	auto &s = shard(requestId);
+	QMutexLocker lock(&s.mutex);
+	auto i = s.records.constFind(requestId);
+	return (i != s.records.cend() && i->hasHandler);
+}
+
+RPCDoneHandlerPtr RequestRegistry::doneHandler(mtpRequestId requestId) const {
+	auto &s = shard(requestId);
+	QMutexLocker lock(&s.mutex);
+	auto i = s.records.constFind(requestId);
+	return (i != s.records.cend() && i->hasHandler) ? i->handler.onDone : RPCDoneHandlerPtr();
+}
+
+bool RequestRegistry::takeHandler(mtpRequestId requestId, RPCResponseHandler *handler) {
+	auto &s = shard(requestId);
+	QMutexLocker lock(&s.mutex);
+	auto i = s.records.find(requestId);
+	if (i == s.records.end() || !i->hasHandler) return false;
+
+	*handler = i->handler;
+	if (i->hasRequest) {
+		i->handler = RPCResponseHandler();
+		i->hasHandler = false;
+	} else {
+		s.records.erase(i);
+	}
+	return true;
+}
+
+void RequestRegistry::restoreHandler(mtpRequestId requestId, const RPCResponseHandler &handler) {
+	auto &s = shard(requestId);
+	QMutexLocker lock(&s.mutex);
+	auto &record = s.records[requestId];
+	record.handler = handler;
+	record.hasHandler = true;
+}
+
+int RequestRegistry::size() const {
+	int result = 0;
+	for (auto &s : _shards) {
+		QMutexLocker lock(&s.mutex);
+		result += s.records.size();
+	}
+	return result;
+}
+
+} // namespace internal
+} // namespace MTP
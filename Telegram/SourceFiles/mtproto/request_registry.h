@@ -0,0 +1,84 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+#include "mtproto/core_types.h"
+#include "mtproto/rpc_sender.h"
+
+namespace MTP {
+namespace internal {
+
+// Everything the facade knows about the sent requests: the serialized
+// request, its response handlers, the dc it was sent to and the resend
+// delay, in one record per request.
+//
+// Records are spread across independently locked shards by request id,
+// so the sessions threads and the main thread don't wait on one lock
+// for the requests of different dcs.
+class RequestRegistry {
+public:
+	void store(mtpRequestId requestId, const mtpRequest &request, const RPCResponseHandler &handler);
+
+	// request part, it is removed by unregister()
+	void setDc(mtpRequestId requestId, int32 dcWithShift); // -dc for the requests to the main dc
+	int32 dc(mtpRequestId requestId) const; // 0 if not found
+	mtpRequest request(mtpRequestId requestId) const; // null if not found
+	int32 nextDelay(mtpRequestId requestId); // seconds before the next resend after an internal server error
+	mtpRequest cancel(mtpRequestId requestId, int32 *dcWithShift); // unregisters and returns what was sent, if found
+	void unregister(mtpRequestId requestId);
+
+	// response handlers part
+	bool hasHandler(mtpRequestId requestId) const;
+	RPCDoneHandlerPtr doneHandler(mtpRequestId requestId) const;
+	bool takeHandler(mtpRequestId requestId, RPCResponseHandler *handler);
+	void restoreHandler(mtpRequestId requestId, const RPCResponseHandler &handler);
+
+	int size() const;
+
+private:
+	struct Record {
+		mtpRequest request;
+		RPCResponseHandler handler;
+		int32 dcWithShift = 0;
+		int32 delay = 0;
+		bool hasRequest = false;
+		bool hasHandler = false;
+	};
+	using Records = QHash<mtpRequestId, Record>;
+
+	static constexpr int kShardsCount = 32; // power of two
+	struct Shard {
+		mutable QMutex mutex;
+		Records records;
+	};
+	Shard &shard(mtpRequestId requestId) {
+		return _shards[requestId & (kShardsCount - 1)];
+	}
+	const Shard &shard(mtpRequestId requestId) const {
+		return _shards[requestId & (kShardsCount - 1)];
+	}
+
+	Shard _shards[kShardsCount];
+
+};
+
+} // namespace internal
+} // namespace MTP
@@ -0,0 +1,216 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#include "stdafx.h"
+
+#include "mtproto/response_parser.h"
+
+#include "mtproto/facade.h"
+
+namespace MTP {
+namespace internal {
+namespace {
+
+constexpr int kParseInAdvanceMinSize = 2048; // mtpPrime, smaller responses are parsed in the main thread
+constexpr int kInflateInParserMinSize = 512; // mtpPrime, smaller gzip_packed responses are inflated in the connection thread
+constexpr int kParserThreadsCount = 2;
+
+QThreadPool &parserThreads() {
+	static QThreadPool *pool = nullptr;
+	if (!pool) {
+		pool = new QThreadPool();
+		pool->setMaxThreadCount(kParserThreadsCount);
+	}
+	return *pool;
+}
+
+GzipInflater &parserThreadInflater() {
+	static QThreadStorage<GzipInflater*> inflaters;
+	if (!inflaters.hasLocalData()) {
+		inflaters.setLocalData(new GzipInflater());
+	}
+	return *inflaters.localData();
+}
+
+struct ParseTimeStats {
+	int count = 0;
+	int64 total = 0; // mcs
+	int64 max = 0;
+};
+QMap<mtpTypeId, ParseTimeStats> parseTimeStats;
+QMutex parseTimeStatsLock;
+
+void addParseTime(mtpTypeId type, int64 time) {
+	QMutexLocker lock(&parseTimeStatsLock);
+	ParseTimeStats &stats(parseTimeStats[type]);
+	++stats.count;
+	stats.total += time;
+	accumulate_max(stats.max, time);
+}
+
+} // namespace
+
+struct ResponseParser::Pending {
+	mtpRequestId requestId = 0;
+	mtpResponse response;
+	bool global = false;
+
+	RPCDoneHandlerPtr parsedBy; // not null if parsing in the parser thread
+	RPCParsedResponsePtr parsed; // null if parsing failed
+	mtpArena *arena = nullptr; // holds the objects of parsed
+	QAtomicInt ready;
+
+	~Pending() {
+		if (arena) arena->unref();
+	}
+};
+
+class ResponseParser::Task : public QRunnable {
+public:
+	Task(const QSharedPointer<ResponseParser> &parser, const PendingPtr &pending) : _parser(parser), _pending(pending) {
+	}
+
+	void run() override {
+		if (_pending->response[0] == mtpc_gzip_packed) {
+			mtpBuffer unpacked;
+			parserThreadInflater().inflate(_pending->response.constData() + 1, _pending->response.constEnd(), unpacked);
+			_pending->response = mtpResponse(unpacked); // empty response is reported as a parse error
+		}
+
+		const mtpResponse &response(_pending->response);
+		if (response.isEmpty() || response[0] == mtpc_rpc_error) {
+			done();
+			return;
+		}
+
+		QElapsedTimer timer;
+		timer.start();
+		{
+			mtpArenaScope arena(response[0]);
+			try {
+				_pending->parsed = _pending->parsedBy->parser()(response.constData(), response.constEnd());
+			} catch (Exception &) {
+				// will be parsed again in the main thread to report the error
+			}
+			_pending->arena = arena.handOver();
+		}
+		int64 time = timer.nsecsElapsed() / 1000;
+		addParseTime(response[0], time);
+		DEBUG_LOG(("RPC Info: response to %1 (type 0x%2, %3 bytes) parsed in %4 mcs").arg(_pending->requestId).arg(uint32(response[0]), 0, 16).arg(response.size() * sizeof(mtpPrime)).arg(time));
+
+		done();
+	}
+
+private:
+	void done() {
+		// Pending and the objects parsed to it have non-atomic reference
+		// counters, it is released only in the main thread from the queue.
+		Pending *pending = _pending.data();
+		_pending.clear();
+
+		pending->ready.storeRelease(1);
+		QMetaObject::invokeMethod(_parser.data(), "onParsed", Qt::QueuedConnection);
+		_parser.clear(); // deleted later in the main thread if it was the last reference
+	}
+
+	QSharedPointer<ResponseParser> _parser;
+	PendingPtr _pending;
+
+};
+
+QSharedPointer<ResponseParser> ResponseParser::create() {
+	QSharedPointer<ResponseParser> result(new ResponseParser(), &QObject::deleteLater); // tasks may release it in the parser threads
+	result->_weak = result;
+	return result;
+}
+
+void ResponseParser::push(mtpRequestId requestId, const mtpResponse &response, bool global) {
+	PendingPtr pending(new Pending());
+	pending->requestId = requestId;
+	pending->response = response;
+	pending->global = global;
+	_pending.push_back(pending);
+
+	bool packed = !response.isEmpty() && (response[0] == mtpc_gzip_packed);
+	if (requestId > 0 && (packed || (response.size() >= kParseInAdvanceMinSize && response[0] != mtpc_rpc_error))) {
+		RPCDoneHandlerPtr handler = getDoneHandler(requestId);
+		if (handler && handler->parser()) {
+			pending->parsedBy = handler;
+			parserThreads().start(new Task(_weak.toStrongRef(), pending));
+			return;
+		}
+	}
+	if (packed) { // handler has changed since the response was received
+		mtpBuffer unpacked;
+		_inflater.inflate(response.constData() + 1, response.constEnd(), unpacked);
+		pending->response = mtpResponse(unpacked);
+	}
+	pending->ready.store(1);
+}
+
+bool ResponseParser::inflateInParser(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) {
+	if (requestId <= 0 || requestId == mtpRequestId(0xFFFFFFFF) || end - from < kInflateInParserMinSize) {
+		return false;
+	}
+	RPCDoneHandlerPtr handler = getDoneHandler(requestId);
+	return handler && handler->parser();
+}
+
+void ResponseParser::deliver() {
+	while (!_pending.isEmpty() && _pending.front()->ready.loadAcquire()) {
+		PendingPtr pending = _pending.front();
+		_pending.pop_front();
+
+		const mtpResponse &response(pending->response);
+		if (pending->requestId <= 0) {
+			if (pending->global) {
+				globalCallback(response.constData(), response.constEnd());
+			}
+		} else if (pending->parsedBy) {
+			execParsedCallback(pending->requestId, response.constData(), response.constEnd(), pending->parsedBy, pending->parsed);
+			if (pending->arena) {
+				pending->parsed.clear();
+				pending->arena->checkAndUnref();
+				pending->arena = nullptr;
+			}
+		} else {
+			execCallback(pending->requestId, response.constData(), response.constEnd());
+		}
+	}
+}
+
+void ResponseParser::onParsed() {
+	emit parsed();
+}
+
+void ResponseParser::logStats() {
+	QMutexLocker lock(&parseTimeStatsLock);
+	for (auto i = parseTimeStats.cbegin(), e = parseTimeStats.cend(); i != e; ++i) {
+		const ParseTimeStats &stats(i.value());
+		DEBUG_LOG(("RPC Info: responses of type 0x%1 parsed %2 times, average %3 mcs, max %4 mcs").arg(uint32(i.key()), 0, 16).arg(stats.count).arg(stats.total / stats.count).arg(stats.max));
+	}
+}
+
+void ResponseParser::finish() {
+	parserThreads().waitForDone();
+}
+
+} // namespace internal
+} // namespace MTP
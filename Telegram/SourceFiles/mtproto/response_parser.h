@@ -0,0 +1,69 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+#include "mtproto/rpc_sender.h"
+#include "mtproto/gzip_inflater.h"
+
+namespace MTP {
+namespace internal {
+
+// Large responses with typed done handlers are parsed in the parser threads,
+// all responses of a session are passed to their handlers in the main thread
+// in the order they were received. Large gzip_packed responses for such
+// handlers are inflated in the parser threads as well, right before parsing.
+class ResponseParser : public QObject {
+	Q_OBJECT
+
+public:
+	static QSharedPointer<ResponseParser> create();
+
+	// connection thread, [from, end) is gzip_packed object with its constructor id
+	static bool inflateInParser(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end);
+
+	// main thread
+	void push(mtpRequestId requestId, const mtpResponse &response, bool global); // global - for updates
+	void deliver(); // calls handlers of all responses that are ready
+
+	static void logStats();
+	static void finish(); // waits for the parser threads
+
+signals:
+	void parsed();
+
+private slots:
+	void onParsed();
+
+private:
+	ResponseParser() = default;
+
+	struct Pending;
+	using PendingPtr = QSharedPointer<Pending>;
+	class Task;
+
+	QWeakPointer<ResponseParser> _weak;
+	QList<PendingPtr> _pending;
+	GzipInflater _inflater;
+
+};
+
+} // namespace internal
+} // namespace MTP
@@ -80,9 +80,44 @@ inline bool isDefaultHandledError(const RPCError &error) {
 
 } // namespace MTP
 
+class RPCParsedResponse { // response decoded in advance, see RPCAbstractDoneHandler::parser()
+public:
+	virtual ~RPCParsedResponse() {
+	}
+};
+typedef QSharedPointer<RPCParsedResponse> RPCParsedResponsePtr;
+typedef RPCParsedResponsePtr (*RPCResponseParser)(const mtpPrime *from, const mtpPrime *end);
+
+template <typename TResponse>
+class RPCParsedResponseImpl : public RPCParsedResponse {
+public:
+	RPCParsedResponseImpl(const mtpPrime *from, const mtpPrime *end) : value(from, end) {
+	}
+	TResponse value;
+};
+
+template <typename TResponse>
+RPCParsedResponsePtr rpcParseResponse(const mtpPrime *from, const mtpPrime *end) {
+	return RPCParsedResponsePtr(new RPCParsedResponseImpl<TResponse>(from, end));
+}
+
+template <typename TResponse>
+inline const TResponse &rpcParsedResponse(const RPCParsedResponse &parsed) {
+	return static_cast<const RPCParsedResponseImpl<TResponse>&>(parsed).value;
+}
+
 class RPCAbstractDoneHandler { // abstract done
 public:
 	virtual void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) const = 0;
+
+	// handlers of typed responses return a parser that can be called in any thread,
+	// its result is passed to the second call operator in the main thread
+	virtual RPCResponseParser parser() const {
+		return nullptr;
+	}
+	virtual void operator()(mtpRequestId requestId, const RPCParsedResponse &parsed) const {
+	}
+
 	virtual ~RPCAbstractDoneHandler() {
 	}
 };
@@ -151,6 +186,12 @@ public:
 	virtual void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) const {
 		(*_onDone)(TResponse(from, end));
 	}
+	virtual RPCResponseParser parser() const {
+		return &rpcParseResponse<TResponse>;
+	}
+	virtual void operator()(mtpRequestId requestId, const RPCParsedResponse &parsed) const {
+		(*_onDone)(rpcParsedResponse<TResponse>(parsed));
+	}
 
 private:
 	CallbackType _onDone;
@@ -167,6 +208,12 @@ public:
 	virtual void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) const {
 		(*_onDone)(TResponse(from, end), requestId);
 	}
+	virtual RPCResponseParser parser() const {
+		return &rpcParseResponse<TResponse>;
+	}
+	virtual void operator()(mtpRequestId requestId, const RPCParsedResponse &parsed) const {
+		(*_onDone)(rpcParsedResponse<TResponse>(parsed), requestId);
+	}
 
 private:
 	CallbackType _onDone;
@@ -388,6 +435,12 @@ public:
 	virtual void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) const {
 		if (_owner) (static_cast<TReceiver*>(_owner)->*_onDone)(TResponse(from, end));
 	}
+	virtual RPCResponseParser parser() const {
+		return &rpcParseResponse<TResponse>;
+	}
+	virtual void operator()(mtpRequestId requestId, const RPCParsedResponse &parsed) const {
+		if (_owner) (static_cast<TReceiver*>(_owner)->*_onDone)(rpcParsedResponse<TResponse>(parsed));
+	}
 
 private:
 	CallbackType _onDone;
@@ -404,6 +457,12 @@ public:
 	virtual void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) const {
 		if (_owner) (static_cast<TReceiver*>(_owner)->*_onDone)(TResponse(from, end), requestId);
 	}
+	virtual RPCResponseParser parser() const {
+		return &rpcParseResponse<TResponse>;
+	}
+	virtual void operator()(mtpRequestId requestId, const RPCParsedResponse &parsed) const {
+		if (_owner) (static_cast<TReceiver*>(_owner)->*_onDone)(rpcParsedResponse<TResponse>(parsed), requestId);
+	}
 
 private:
 	CallbackType _onDone;
@@ -486,6 +545,12 @@ public:
 	virtual void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) const {
 		if (_owner) (static_cast<TReceiver*>(_owner)->*_onDone)(_b, TResponse(from, end));
 	}
+	virtual RPCResponseParser parser() const {
+		return &rpcParseResponse<TResponse>;
+	}
+	virtual void operator()(mtpRequestId requestId, const RPCParsedResponse &parsed) const {
+		if (_owner) (static_cast<TReceiver*>(_owner)->*_onDone)(_b, rpcParsedResponse<TResponse>(parsed));
+	}
 
 private:
 	CallbackType _onDone;
@@ -503,6 +568,12 @@ public:
 	virtual void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) const {
 		if (_owner) (static_cast<TReceiver*>(_owner)->*_onDone)(_b, TResponse(from, end), requestId);
 	}
+	virtual RPCResponseParser parser() const {
+		return &rpcParseResponse<TResponse>;
+	}
+	virtual void operator()(mtpRequestId requestId, const RPCParsedResponse &parsed) const {
+		if (_owner) (static_cast<TReceiver*>(_owner)->*_onDone)(_b, rpcParsedResponse<TResponse>(parsed), requestId);
+	}
 
 private:
 	CallbackType _onDone;
@@ -885,6 +956,12 @@ public:
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) const override {
 		return this->_handler ? this->_handler(T(from, end)) : void(0);
 	}
+	RPCResponseParser parser() const override {
+		return &rpcParseResponse<T>;
+	}
+	void operator()(mtpRequestId requestId, const RPCParsedResponse &parsed) const override {
+		return this->_handler ? this->_handler(rpcParsedResponse<T>(parsed)) : void(0);
+	}
 
 };
 
@@ -895,6 +972,12 @@ public:
 	void operator()(mtpRequestId requestId, const mtpPrime *from, const mtpPrime *end) const override {
 		return this->_handler ? this->_handler(T(from, end), requestId) : void(0);
 	}
+	RPCResponseParser parser() const override {
+		return &rpcParseResponse<T>;
+	}
+	void operator()(mtpRequestId requestId, const RPCParsedResponse &parsed) const override {
+		return this->_handler ? this->_handler(rpcParsedResponse<T>(parsed), requestId) : void(0);
+	}
 
 };
 
@@ -24799,7 +24799,7 @@ inline mtpTypeId MTPresPQ::type() const {
 inline void MTPresPQ::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_resPQ) throw mtpErrorUnexpected(cons, "MTPresPQ");
 
-	if (!data) setData(new MTPDresPQ());
+	if (!data) setData(mtpNewData<MTPDresPQ>());
 	MTPDresPQ &v(_resPQ());
 	v.vnonce.read(from, end);
 	v.vserver_nonce.read(from, end);
@@ -24832,7 +24832,7 @@ inline mtpTypeId MTPp_Q_inner_data::type() const {
 inline void MTPp_Q_inner_data::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_p_q_inner_data) throw mtpErrorUnexpected(cons, "MTPp_Q_inner_data");
 
-	if (!data) setData(new MTPDp_q_inner_data());
+	if (!data) setData(mtpNewData<MTPDp_q_inner_data>());
 	MTPDp_q_inner_data &v(_p_q_inner_data());
 	v.vpq.read(from, end);
 	v.vp.read(from, end);
@@ -24877,14 +24877,14 @@ inline void MTPserver_DH_Params::read(const mtpPrime *&from, const mtpPrime *end
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_server_DH_params_fail: _type = cons; {
-			if (!data) setData(new MTPDserver_DH_params_fail());
+			if (!data) setData(mtpNewData<MTPDserver_DH_params_fail>());
 			MTPDserver_DH_params_fail &v(_server_DH_params_fail());
 			v.vnonce.read(from, end);
 			v.vserver_nonce.read(from, end);
 			v.vnew_nonce_hash.read(from, end);
 		} break;
 		case mtpc_server_DH_params_ok: _type = cons; {
-			if (!data) setData(new MTPDserver_DH_params_ok());
+			if (!data) setData(mtpNewData<MTPDserver_DH_params_ok>());
 			MTPDserver_DH_params_ok &v(_server_DH_params_ok());
 			v.vnonce.read(from, end);
 			v.vserver_nonce.read(from, end);
@@ -24940,7 +24940,7 @@ inline mtpTypeId MTPserver_DH_inner_data::type() const {
 inline void MTPserver_DH_inner_data::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_server_DH_inner_data) throw mtpErrorUnexpected(cons, "MTPserver_DH_inner_data");
 
-	if (!data) setData(new MTPDserver_DH_inner_data());
+	if (!data) setData(mtpNewData<MTPDserver_DH_inner_data>());
 	MTPDserver_DH_inner_data &v(_server_DH_inner_data());
 	v.vnonce.read(from, end);
 	v.vserver_nonce.read(from, end);
@@ -24977,7 +24977,7 @@ inline mtpTypeId MTPclient_DH_Inner_Data::type() const {
 inline void MTPclient_DH_Inner_Data::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_client_DH_inner_data) throw mtpErrorUnexpected(cons, "MTPclient_DH_Inner_Data");
 
-	if (!data) setData(new MTPDclient_DH_inner_data());
+	if (!data) setData(mtpNewData<MTPDclient_DH_inner_data>());
 	MTPDclient_DH_inner_data &v(_client_DH_inner_data());
 	v.vnonce.read(from, end);
 	v.vserver_nonce.read(from, end);
@@ -25022,21 +25022,21 @@ inline void MTPset_client_DH_params_answer::read(const mtpPrime *&from, const mt
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_dh_gen_ok: _type = cons; {
-			if (!data) setData(new MTPDdh_gen_ok());
+			if (!data) setData(mtpNewData<MTPDdh_gen_ok>());
 			MTPDdh_gen_ok &v(_dh_gen_ok());
 			v.vnonce.read(from, end);
 			v.vserver_nonce.read(from, end);
 			v.vnew_nonce_hash1.read(from, end);
 		} break;
 		case mtpc_dh_gen_retry: _type = cons; {
-			if (!data) setData(new MTPDdh_gen_retry());
+			if (!data) setData(mtpNewData<MTPDdh_gen_retry>());
 			MTPDdh_gen_retry &v(_dh_gen_retry());
 			v.vnonce.read(from, end);
 			v.vserver_nonce.read(from, end);
 			v.vnew_nonce_hash2.read(from, end);
 		} break;
 		case mtpc_dh_gen_fail: _type = cons; {
-			if (!data) setData(new MTPDdh_gen_fail());
+			if (!data) setData(mtpNewData<MTPDdh_gen_fail>());
 			MTPDdh_gen_fail &v(_dh_gen_fail());
 			v.vnonce.read(from, end);
 			v.vserver_nonce.read(from, end);
@@ -25104,7 +25104,7 @@ inline mtpTypeId MTPmsgsAck::type() const {
 inline void MTPmsgsAck::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_msgs_ack) throw mtpErrorUnexpected(cons, "MTPmsgsAck");
 
-	if (!data) setData(new MTPDmsgs_ack());
+	if (!data) setData(mtpNewData<MTPDmsgs_ack>());
 	MTPDmsgs_ack &v(_msgs_ack());
 	v.vmsg_ids.read(from, end);
 }
@@ -25139,14 +25139,14 @@ inline void MTPbadMsgNotification::read(const mtpPrime *&from, const mtpPrime *e
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_bad_msg_notification: _type = cons; {
-			if (!data) setData(new MTPDbad_msg_notification());
+			if (!data) setData(mtpNewData<MTPDbad_msg_notification>());
 			MTPDbad_msg_notification &v(_bad_msg_notification());
 			v.vbad_msg_id.read(from, end);
 			v.vbad_msg_seqno.read(from, end);
 			v.verror_code.read(from, end);
 		} break;
 		case mtpc_bad_server_salt: _type = cons; {
-			if (!data) setData(new MTPDbad_server_salt());
+			if (!data) setData(mtpNewData<MTPDbad_server_salt>());
 			MTPDbad_server_salt &v(_bad_server_salt());
 			v.vbad_msg_id.read(from, end);
 			v.vbad_msg_seqno.read(from, end);
@@ -25204,7 +25204,7 @@ inline mtpTypeId MTPmsgsStateReq::type() const {
 inline void MTPmsgsStateReq::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_msgs_state_req) throw mtpErrorUnexpected(cons, "MTPmsgsStateReq");
 
-	if (!data) setData(new MTPDmsgs_state_req());
+	if (!data) setData(mtpNewData<MTPDmsgs_state_req>());
 	MTPDmsgs_state_req &v(_msgs_state_req());
 	v.vmsg_ids.read(from, end);
 }
@@ -25231,7 +25231,7 @@ inline mtpTypeId MTPmsgsStateInfo::type() const {
 inline void MTPmsgsStateInfo::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_msgs_state_info) throw mtpErrorUnexpected(cons, "MTPmsgsStateInfo");
 
-	if (!data) setData(new MTPDmsgs_state_info());
+	if (!data) setData(mtpNewData<MTPDmsgs_state_info>());
 	MTPDmsgs_state_info &v(_msgs_state_info());
 	v.vreq_msg_id.read(from, end);
 	v.vinfo.read(from, end);
@@ -25260,7 +25260,7 @@ inline mtpTypeId MTPmsgsAllInfo::type() const {
 inline void MTPmsgsAllInfo::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_msgs_all_info) throw mtpErrorUnexpected(cons, "MTPmsgsAllInfo");
 
-	if (!data) setData(new MTPDmsgs_all_info());
+	if (!data) setData(mtpNewData<MTPDmsgs_all_info>());
 	MTPDmsgs_all_info &v(_msgs_all_info());
 	v.vmsg_ids.read(from, end);
 	v.vinfo.read(from, end);
@@ -25297,7 +25297,7 @@ inline void MTPmsgDetailedInfo::read(const mtpPrime *&from, const mtpPrime *end,
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_msg_detailed_info: _type = cons; {
-			if (!data) setData(new MTPDmsg_detailed_info());
+			if (!data) setData(mtpNewData<MTPDmsg_detailed_info>());
 			MTPDmsg_detailed_info &v(_msg_detailed_info());
 			v.vmsg_id.read(from, end);
 			v.vanswer_msg_id.read(from, end);
@@ -25305,7 +25305,7 @@ inline void MTPmsgDetailedInfo::read(const mtpPrime *&from, const mtpPrime *end,
 			v.vstatus.read(from, end);
 		} break;
 		case mtpc_msg_new_detailed_info: _type = cons; {
-			if (!data) setData(new MTPDmsg_new_detailed_info());
+			if (!data) setData(mtpNewData<MTPDmsg_new_detailed_info>());
 			MTPDmsg_new_detailed_info &v(_msg_new_detailed_info());
 			v.vanswer_msg_id.read(from, end);
 			v.vbytes.read(from, end);
@@ -25362,7 +25362,7 @@ inline mtpTypeId MTPmsgResendReq::type() const {
 inline void MTPmsgResendReq::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_msg_resend_req) throw mtpErrorUnexpected(cons, "MTPmsgResendReq");
 
-	if (!data) setData(new MTPDmsg_resend_req());
+	if (!data) setData(mtpNewData<MTPDmsg_resend_req>());
 	MTPDmsg_resend_req &v(_msg_resend_req());
 	v.vmsg_ids.read(from, end);
 }
@@ -25389,7 +25389,7 @@ inline mtpTypeId MTPrpcError::type() const {
 inline void MTPrpcError::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_rpc_error) throw mtpErrorUnexpected(cons, "MTPrpcError");
 
-	if (!data) setData(new MTPDrpc_error());
+	if (!data) setData(mtpNewData<MTPDrpc_error>());
 	MTPDrpc_error &v(_rpc_error());
 	v.verror_code.read(from, end);
 	v.verror_message.read(from, end);
@@ -25424,7 +25424,7 @@ inline void MTPrpcDropAnswer::read(const mtpPrime *&from, const mtpPrime *end, m
 		case mtpc_rpc_answer_unknown: _type = cons; break;
 		case mtpc_rpc_answer_dropped_running: _type = cons; break;
 		case mtpc_rpc_answer_dropped: _type = cons; {
-			if (!data) setData(new MTPDrpc_answer_dropped());
+			if (!data) setData(mtpNewData<MTPDrpc_answer_dropped>());
 			MTPDrpc_answer_dropped &v(_rpc_answer_dropped());
 			v.vmsg_id.read(from, end);
 			v.vseq_no.read(from, end);
@@ -25476,7 +25476,7 @@ inline mtpTypeId MTPfutureSalt::type() const {
 inline void MTPfutureSalt::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_future_salt) throw mtpErrorUnexpected(cons, "MTPfutureSalt");
 
-	if (!data) setData(new MTPDfuture_salt());
+	if (!data) setData(mtpNewData<MTPDfuture_salt>());
 	MTPDfuture_salt &v(_future_salt());
 	v.vvalid_since.read(from, end);
 	v.vvalid_until.read(from, end);
@@ -25507,7 +25507,7 @@ inline mtpTypeId MTPfutureSalts::type() const {
 inline void MTPfutureSalts::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_future_salts) throw mtpErrorUnexpected(cons, "MTPfutureSalts");
 
-	if (!data) setData(new MTPDfuture_salts());
+	if (!data) setData(mtpNewData<MTPDfuture_salts>());
 	MTPDfuture_salts &v(_future_salts());
 	v.vreq_msg_id.read(from, end);
 	v.vnow.read(from, end);
@@ -25538,7 +25538,7 @@ inline mtpTypeId MTPpong::type() const {
 inline void MTPpong::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_pong) throw mtpErrorUnexpected(cons, "MTPpong");
 
-	if (!data) setData(new MTPDpong());
+	if (!data) setData(mtpNewData<MTPDpong>());
 	MTPDpong &v(_pong());
 	v.vmsg_id.read(from, end);
 	v.vping_id.read(from, end);
@@ -25575,12 +25575,12 @@ inline void MTPdestroySessionRes::read(const mtpPrime *&from, const mtpPrime *en
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_destroy_session_ok: _type = cons; {
-			if (!data) setData(new MTPDdestroy_session_ok());
+			if (!data) setData(mtpNewData<MTPDdestroy_session_ok>());
 			MTPDdestroy_session_ok &v(_destroy_session_ok());
 			v.vsession_id.read(from, end);
 		} break;
 		case mtpc_destroy_session_none: _type = cons; {
-			if (!data) setData(new MTPDdestroy_session_none());
+			if (!data) setData(mtpNewData<MTPDdestroy_session_none>());
 			MTPDdestroy_session_none &v(_destroy_session_none());
 			v.vsession_id.read(from, end);
 		} break;
@@ -25630,7 +25630,7 @@ inline mtpTypeId MTPnewSession::type() const {
 inline void MTPnewSession::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_new_session_created) throw mtpErrorUnexpected(cons, "MTPnewSession");
 
-	if (!data) setData(new MTPDnew_session_created());
+	if (!data) setData(mtpNewData<MTPDnew_session_created>());
 	MTPDnew_session_created &v(_new_session_created());
 	v.vfirst_msg_id.read(from, end);
 	v.vunique_id.read(from, end);
@@ -25661,7 +25661,7 @@ inline mtpTypeId MTPhttpWait::type() const {
 inline void MTPhttpWait::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_http_wait) throw mtpErrorUnexpected(cons, "MTPhttpWait");
 
-	if (!data) setData(new MTPDhttp_wait());
+	if (!data) setData(mtpNewData<MTPDhttp_wait>());
 	MTPDhttp_wait &v(_http_wait());
 	v.vmax_delay.read(from, end);
 	v.vwait_after.read(from, end);
@@ -25736,7 +25736,7 @@ inline mtpTypeId MTPerror::type() const {
 inline void MTPerror::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_error) throw mtpErrorUnexpected(cons, "MTPerror");
 
-	if (!data) setData(new MTPDerror());
+	if (!data) setData(mtpNewData<MTPDerror>());
 	MTPDerror &v(_error());
 	v.vcode.read(from, end);
 	v.vtext.read(from, end);
@@ -25793,18 +25793,18 @@ inline void MTPinputPeer::read(const mtpPrime *&from, const mtpPrime *end, mtpTy
 		case mtpc_inputPeerEmpty: _type = cons; break;
 		case mtpc_inputPeerSelf: _type = cons; break;
 		case mtpc_inputPeerChat: _type = cons; {
-			if (!data) setData(new MTPDinputPeerChat());
+			if (!data) setData(mtpNewData<MTPDinputPeerChat>());
 			MTPDinputPeerChat &v(_inputPeerChat());
 			v.vchat_id.read(from, end);
 		} break;
 		case mtpc_inputPeerUser: _type = cons; {
-			if (!data) setData(new MTPDinputPeerUser());
+			if (!data) setData(mtpNewData<MTPDinputPeerUser>());
 			MTPDinputPeerUser &v(_inputPeerUser());
 			v.vuser_id.read(from, end);
 			v.vaccess_hash.read(from, end);
 		} break;
 		case mtpc_inputPeerChannel: _type = cons; {
-			if (!data) setData(new MTPDinputPeerChannel());
+			if (!data) setData(mtpNewData<MTPDinputPeerChannel>());
 			MTPDinputPeerChannel &v(_inputPeerChannel());
 			v.vchannel_id.read(from, end);
 			v.vaccess_hash.read(from, end);
@@ -25881,7 +25881,7 @@ inline void MTPinputUser::read(const mtpPrime *&from, const mtpPrime *end, mtpTy
 		case mtpc_inputUserEmpty: _type = cons; break;
 		case mtpc_inputUserSelf: _type = cons; break;
 		case mtpc_inputUser: _type = cons; {
-			if (!data) setData(new MTPDinputUser());
+			if (!data) setData(mtpNewData<MTPDinputUser>());
 			MTPDinputUser &v(_inputUser());
 			v.vuser_id.read(from, end);
 			v.vaccess_hash.read(from, end);
@@ -25931,7 +25931,7 @@ inline mtpTypeId MTPinputContact::type() const {
 inline void MTPinputContact::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_inputPhoneContact) throw mtpErrorUnexpected(cons, "MTPinputContact");
 
-	if (!data) setData(new MTPDinputPhoneContact());
+	if (!data) setData(mtpNewData<MTPDinputPhoneContact>());
 	MTPDinputPhoneContact &v(_inputPhoneContact());
 	v.vclient_id.read(from, end);
 	v.vphone.read(from, end);
@@ -25972,7 +25972,7 @@ inline void MTPinputFile::read(const mtpPrime *&from, const mtpPrime *end, mtpTy
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_inputFile: _type = cons; {
-			if (!data) setData(new MTPDinputFile());
+			if (!data) setData(mtpNewData<MTPDinputFile>());
 			MTPDinputFile &v(_inputFile());
 			v.vid.read(from, end);
 			v.vparts.read(from, end);
@@ -25980,7 +25980,7 @@ inline void MTPinputFile::read(const mtpPrime *&from, const mtpPrime *end, mtpTy
 			v.vmd5_checksum.read(from, end);
 		} break;
 		case mtpc_inputFileBig: _type = cons; {
-			if (!data) setData(new MTPDinputFileBig());
+			if (!data) setData(mtpNewData<MTPDinputFileBig>());
 			MTPDinputFileBig &v(_inputFileBig());
 			v.vid.read(from, end);
 			v.vparts.read(from, end);
@@ -26086,7 +26086,7 @@ inline void MTPinputMedia::read(const mtpPrime *&from, const mtpPrime *end, mtpT
 	switch (cons) {
 		case mtpc_inputMediaEmpty: _type = cons; break;
 		case mtpc_inputMediaUploadedPhoto: _type = cons; {
-			if (!data) setData(new MTPDinputMediaUploadedPhoto());
+			if (!data) setData(mtpNewData<MTPDinputMediaUploadedPhoto>());
 			MTPDinputMediaUploadedPhoto &v(_inputMediaUploadedPhoto());
 			v.vflags.read(from, end);
 			v.vfile.read(from, end);
@@ -26094,25 +26094,25 @@ inline void MTPinputMedia::read(const mtpPrime *&from, const mtpPrime *end, mtpT
 			if (v.has_stickers()) { v.vstickers.read(from, end); } else { v.vstickers = MTPVector<MTPInputDocument>(); }
 		} break;
 		case mtpc_inputMediaPhoto: _type = cons; {
-			if (!data) setData(new MTPDinputMediaPhoto());
+			if (!data) setData(mtpNewData<MTPDinputMediaPhoto>());
 			MTPDinputMediaPhoto &v(_inputMediaPhoto());
 			v.vid.read(from, end);
 			v.vcaption.read(from, end);
 		} break;
 		case mtpc_inputMediaGeoPoint: _type = cons; {
-			if (!data) setData(new MTPDinputMediaGeoPoint());
+			if (!data) setData(mtpNewData<MTPDinputMediaGeoPoint>());
 			MTPDinputMediaGeoPoint &v(_inputMediaGeoPoint());
 			v.vgeo_point.read(from, end);
 		} break;
 		case mtpc_inputMediaContact: _type = cons; {
-			if (!data) setData(new MTPDinputMediaContact());
+			if (!data) setData(mtpNewData<MTPDinputMediaContact>());
 			MTPDinputMediaContact &v(_inputMediaContact());
 			v.vphone_number.read(from, end);
 			v.vfirst_name.read(from, end);
 			v.vlast_name.read(from, end);
 		} break;
 		case mtpc_inputMediaUploadedDocument: _type = cons; {
-			if (!data) setData(new MTPDinputMediaUploadedDocument());
+			if (!data) setData(mtpNewData<MTPDinputMediaUploadedDocument>());
 			MTPDinputMediaUploadedDocument &v(_inputMediaUploadedDocument());
 			v.vflags.read(from, end);
 			v.vfile.read(from, end);
@@ -26122,7 +26122,7 @@ inline void MTPinputMedia::read(const mtpPrime *&from, const mtpPrime *end, mtpT
 			if (v.has_stickers()) { v.vstickers.read(from, end); } else { v.vstickers = MTPVector<MTPInputDocument>(); }
 		} break;
 		case mtpc_inputMediaUploadedThumbDocument: _type = cons; {
-			if (!data) setData(new MTPDinputMediaUploadedThumbDocument());
+			if (!data) setData(mtpNewData<MTPDinputMediaUploadedThumbDocument>());
 			MTPDinputMediaUploadedThumbDocument &v(_inputMediaUploadedThumbDocument());
 			v.vflags.read(from, end);
 			v.vfile.read(from, end);
@@ -26133,13 +26133,13 @@ inline void MTPinputMedia::read(const mtpPrime *&from, const mtpPrime *end, mtpT
 			if (v.has_stickers()) { v.vstickers.read(from, end); } else { v.vstickers = MTPVector<MTPInputDocument>(); }
 		} break;
 		case mtpc_inputMediaDocument: _type = cons; {
-			if (!data) setData(new MTPDinputMediaDocument());
+			if (!data) setData(mtpNewData<MTPDinputMediaDocument>());
 			MTPDinputMediaDocument &v(_inputMediaDocument());
 			v.vid.read(from, end);
 			v.vcaption.read(from, end);
 		} break;
 		case mtpc_inputMediaVenue: _type = cons; {
-			if (!data) setData(new MTPDinputMediaVenue());
+			if (!data) setData(mtpNewData<MTPDinputMediaVenue>());
 			MTPDinputMediaVenue &v(_inputMediaVenue());
 			v.vgeo_point.read(from, end);
 			v.vtitle.read(from, end);
@@ -26148,25 +26148,25 @@ inline void MTPinputMedia::read(const mtpPrime *&from, const mtpPrime *end, mtpT
 			v.vvenue_id.read(from, end);
 		} break;
 		case mtpc_inputMediaGifExternal: _type = cons; {
-			if (!data) setData(new MTPDinputMediaGifExternal());
+			if (!data) setData(mtpNewData<MTPDinputMediaGifExternal>());
 			MTPDinputMediaGifExternal &v(_inputMediaGifExternal());
 			v.vurl.read(from, end);
 			v.vq.read(from, end);
 		} break;
 		case mtpc_inputMediaPhotoExternal: _type = cons; {
-			if (!data) setData(new MTPDinputMediaPhotoExternal());
+			if (!data) setData(mtpNewData<MTPDinputMediaPhotoExternal>());
 			MTPDinputMediaPhotoExternal &v(_inputMediaPhotoExternal());
 			v.vurl.read(from, end);
 			v.vcaption.read(from, end);
 		} break;
 		case mtpc_inputMediaDocumentExternal: _type = cons; {
-			if (!data) setData(new MTPDinputMediaDocumentExternal());
+			if (!data) setData(mtpNewData<MTPDinputMediaDocumentExternal>());
 			MTPDinputMediaDocumentExternal &v(_inputMediaDocumentExternal());
 			v.vurl.read(from, end);
 			v.vcaption.read(from, end);
 		} break;
 		case mtpc_inputMediaGame: _type = cons; {
-			if (!data) setData(new MTPDinputMediaGame());
+			if (!data) setData(mtpNewData<MTPDinputMediaGame>());
 			MTPDinputMediaGame &v(_inputMediaGame());
 			v.vid.read(from, end);
 		} break;
@@ -26357,12 +26357,12 @@ inline void MTPinputChatPhoto::read(const mtpPrime *&from, const mtpPrime *end,
 	switch (cons) {
 		case mtpc_inputChatPhotoEmpty: _type = cons; break;
 		case mtpc_inputChatUploadedPhoto: _type = cons; {
-			if (!data) setData(new MTPDinputChatUploadedPhoto());
+			if (!data) setData(mtpNewData<MTPDinputChatUploadedPhoto>());
 			MTPDinputChatUploadedPhoto &v(_inputChatUploadedPhoto());
 			v.vfile.read(from, end);
 		} break;
 		case mtpc_inputChatPhoto: _type = cons; {
-			if (!data) setData(new MTPDinputChatPhoto());
+			if (!data) setData(mtpNewData<MTPDinputChatPhoto>());
 			MTPDinputChatPhoto &v(_inputChatPhoto());
 			v.vid.read(from, end);
 		} break;
@@ -26421,7 +26421,7 @@ inline void MTPinputGeoPoint::read(const mtpPrime *&from, const mtpPrime *end, m
 	switch (cons) {
 		case mtpc_inputGeoPointEmpty: _type = cons; break;
 		case mtpc_inputGeoPoint: _type = cons; {
-			if (!data) setData(new MTPDinputGeoPoint());
+			if (!data) setData(mtpNewData<MTPDinputGeoPoint>());
 			MTPDinputGeoPoint &v(_inputGeoPoint());
 			v.vlat.read(from, end);
 			v.vlong.read(from, end);
@@ -26472,7 +26472,7 @@ inline void MTPinputPhoto::read(const mtpPrime *&from, const mtpPrime *end, mtpT
 	switch (cons) {
 		case mtpc_inputPhotoEmpty: _type = cons; break;
 		case mtpc_inputPhoto: _type = cons; {
-			if (!data) setData(new MTPDinputPhoto());
+			if (!data) setData(mtpNewData<MTPDinputPhoto>());
 			MTPDinputPhoto &v(_inputPhoto());
 			v.vid.read(from, end);
 			v.vaccess_hash.read(from, end);
@@ -26530,20 +26530,20 @@ inline void MTPinputFileLocation::read(const mtpPrime *&from, const mtpPrime *en
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_inputFileLocation: _type = cons; {
-			if (!data) setData(new MTPDinputFileLocation());
+			if (!data) setData(mtpNewData<MTPDinputFileLocation>());
 			MTPDinputFileLocation &v(_inputFileLocation());
 			v.vvolume_id.read(from, end);
 			v.vlocal_id.read(from, end);
 			v.vsecret.read(from, end);
 		} break;
 		case mtpc_inputEncryptedFileLocation: _type = cons; {
-			if (!data) setData(new MTPDinputEncryptedFileLocation());
+			if (!data) setData(mtpNewData<MTPDinputEncryptedFileLocation>());
 			MTPDinputEncryptedFileLocation &v(_inputEncryptedFileLocation());
 			v.vid.read(from, end);
 			v.vaccess_hash.read(from, end);
 		} break;
 		case mtpc_inputDocumentFileLocation: _type = cons; {
-			if (!data) setData(new MTPDinputDocumentFileLocation());
+			if (!data) setData(mtpNewData<MTPDinputDocumentFileLocation>());
 			MTPDinputDocumentFileLocation &v(_inputDocumentFileLocation());
 			v.vid.read(from, end);
 			v.vaccess_hash.read(from, end);
@@ -26610,7 +26610,7 @@ inline mtpTypeId MTPinputAppEvent::type() const {
 inline void MTPinputAppEvent::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_inputAppEvent) throw mtpErrorUnexpected(cons, "MTPinputAppEvent");
 
-	if (!data) setData(new MTPDinputAppEvent());
+	if (!data) setData(mtpNewData<MTPDinputAppEvent>());
 	MTPDinputAppEvent &v(_inputAppEvent());
 	v.vtime.read(from, end);
 	v.vtype.read(from, end);
@@ -26655,17 +26655,17 @@ inline void MTPpeer::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_peerUser: _type = cons; {
-			if (!data) setData(new MTPDpeerUser());
+			if (!data) setData(mtpNewData<MTPDpeerUser>());
 			MTPDpeerUser &v(_peerUser());
 			v.vuser_id.read(from, end);
 		} break;
 		case mtpc_peerChat: _type = cons; {
-			if (!data) setData(new MTPDpeerChat());
+			if (!data) setData(mtpNewData<MTPDpeerChat>());
 			MTPDpeerChat &v(_peerChat());
 			v.vchat_id.read(from, end);
 		} break;
 		case mtpc_peerChannel: _type = cons; {
-			if (!data) setData(new MTPDpeerChannel());
+			if (!data) setData(mtpNewData<MTPDpeerChannel>());
 			MTPDpeerChannel &v(_peerChannel());
 			v.vchannel_id.read(from, end);
 		} break;
@@ -26803,14 +26803,14 @@ inline void MTPfileLocation::read(const mtpPrime *&from, const mtpPrime *end, mt
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_fileLocationUnavailable: _type = cons; {
-			if (!data) setData(new MTPDfileLocationUnavailable());
+			if (!data) setData(mtpNewData<MTPDfileLocationUnavailable>());
 			MTPDfileLocationUnavailable &v(_fileLocationUnavailable());
 			v.vvolume_id.read(from, end);
 			v.vlocal_id.read(from, end);
 			v.vsecret.read(from, end);
 		} break;
 		case mtpc_fileLocation: _type = cons; {
-			if (!data) setData(new MTPDfileLocation());
+			if (!data) setData(mtpNewData<MTPDfileLocation>());
 			MTPDfileLocation &v(_fileLocation());
 			v.vdc_id.read(from, end);
 			v.vvolume_id.read(from, end);
@@ -26876,12 +26876,12 @@ inline void MTPuser::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_userEmpty: _type = cons; {
-			if (!data) setData(new MTPDuserEmpty());
+			if (!data) setData(mtpNewData<MTPDuserEmpty>());
 			MTPDuserEmpty &v(_userEmpty());
 			v.vid.read(from, end);
 		} break;
 		case mtpc_user: _type = cons; {
-			if (!data) setData(new MTPDuser());
+			if (!data) setData(mtpNewData<MTPDuser>());
 			MTPDuser &v(_user());
 			v.vflags.read(from, end);
 			v.vid.read(from, end);
@@ -26959,7 +26959,7 @@ inline void MTPuserProfilePhoto::read(const mtpPrime *&from, const mtpPrime *end
 	switch (cons) {
 		case mtpc_userProfilePhotoEmpty: _type = cons; break;
 		case mtpc_userProfilePhoto: _type = cons; {
-			if (!data) setData(new MTPDuserProfilePhoto());
+			if (!data) setData(mtpNewData<MTPDuserProfilePhoto>());
 			MTPDuserProfilePhoto &v(_userProfilePhoto());
 			v.vphoto_id.read(from, end);
 			v.vphoto_small.read(from, end);
@@ -27016,12 +27016,12 @@ inline void MTPuserStatus::read(const mtpPrime *&from, const mtpPrime *end, mtpT
 	switch (cons) {
 		case mtpc_userStatusEmpty: _type = cons; break;
 		case mtpc_userStatusOnline: _type = cons; {
-			if (!data) setData(new MTPDuserStatusOnline());
+			if (!data) setData(mtpNewData<MTPDuserStatusOnline>());
 			MTPDuserStatusOnline &v(_userStatusOnline());
 			v.vexpires.read(from, end);
 		} break;
 		case mtpc_userStatusOffline: _type = cons; {
-			if (!data) setData(new MTPDuserStatusOffline());
+			if (!data) setData(mtpNewData<MTPDuserStatusOffline>());
 			MTPDuserStatusOffline &v(_userStatusOffline());
 			v.vwas_online.read(from, end);
 		} break;
@@ -27110,12 +27110,12 @@ inline void MTPchat::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_chatEmpty: _type = cons; {
-			if (!data) setData(new MTPDchatEmpty());
+			if (!data) setData(mtpNewData<MTPDchatEmpty>());
 			MTPDchatEmpty &v(_chatEmpty());
 			v.vid.read(from, end);
 		} break;
 		case mtpc_chat: _type = cons; {
-			if (!data) setData(new MTPDchat());
+			if (!data) setData(mtpNewData<MTPDchat>());
 			MTPDchat &v(_chat());
 			v.vflags.read(from, end);
 			v.vid.read(from, end);
@@ -27127,13 +27127,13 @@ inline void MTPchat::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId
 			if (v.has_migrated_to()) { v.vmigrated_to.read(from, end); } else { v.vmigrated_to = MTPInputChannel(); }
 		} break;
 		case mtpc_chatForbidden: _type = cons; {
-			if (!data) setData(new MTPDchatForbidden());
+			if (!data) setData(mtpNewData<MTPDchatForbidden>());
 			MTPDchatForbidden &v(_chatForbidden());
 			v.vid.read(from, end);
 			v.vtitle.read(from, end);
 		} break;
 		case mtpc_channel: _type = cons; {
-			if (!data) setData(new MTPDchannel());
+			if (!data) setData(mtpNewData<MTPDchannel>());
 			MTPDchannel &v(_channel());
 			v.vflags.read(from, end);
 			v.vid.read(from, end);
@@ -27146,7 +27146,7 @@ inline void MTPchat::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId
 			if (v.has_restriction_reason()) { v.vrestriction_reason.read(from, end); } else { v.vrestriction_reason = MTPstring(); }
 		} break;
 		case mtpc_channelForbidden: _type = cons; {
-			if (!data) setData(new MTPDchannelForbidden());
+			if (!data) setData(mtpNewData<MTPDchannelForbidden>());
 			MTPDchannelForbidden &v(_channelForbidden());
 			v.vflags.read(from, end);
 			v.vid.read(from, end);
@@ -27259,7 +27259,7 @@ inline void MTPchatFull::read(const mtpPrime *&from, const mtpPrime *end, mtpTyp
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_chatFull: _type = cons; {
-			if (!data) setData(new MTPDchatFull());
+			if (!data) setData(mtpNewData<MTPDchatFull>());
 			MTPDchatFull &v(_chatFull());
 			v.vid.read(from, end);
 			v.vparticipants.read(from, end);
@@ -27269,7 +27269,7 @@ inline void MTPchatFull::read(const mtpPrime *&from, const mtpPrime *end, mtpTyp
 			v.vbot_info.read(from, end);
 		} break;
 		case mtpc_channelFull: _type = cons; {
-			if (!data) setData(new MTPDchannelFull());
+			if (!data) setData(mtpNewData<MTPDchannelFull>());
 			MTPDchannelFull &v(_channelFull());
 			v.vflags.read(from, end);
 			v.vid.read(from, end);
@@ -27367,19 +27367,19 @@ inline void MTPchatParticipant::read(const mtpPrime *&from, const mtpPrime *end,
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_chatParticipant: _type = cons; {
-			if (!data) setData(new MTPDchatParticipant());
+			if (!data) setData(mtpNewData<MTPDchatParticipant>());
 			MTPDchatParticipant &v(_chatParticipant());
 			v.vuser_id.read(from, end);
 			v.vinviter_id.read(from, end);
 			v.vdate.read(from, end);
 		} break;
 		case mtpc_chatParticipantCreator: _type = cons; {
-			if (!data) setData(new MTPDchatParticipantCreator());
+			if (!data) setData(mtpNewData<MTPDchatParticipantCreator>());
 			MTPDchatParticipantCreator &v(_chatParticipantCreator());
 			v.vuser_id.read(from, end);
 		} break;
 		case mtpc_chatParticipantAdmin: _type = cons; {
-			if (!data) setData(new MTPDchatParticipantAdmin());
+			if (!data) setData(mtpNewData<MTPDchatParticipantAdmin>());
 			MTPDchatParticipantAdmin &v(_chatParticipantAdmin());
 			v.vuser_id.read(from, end);
 			v.vinviter_id.read(from, end);
@@ -27453,14 +27453,14 @@ inline void MTPchatParticipants::read(const mtpPrime *&from, const mtpPrime *end
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_chatParticipantsForbidden: _type = cons; {
-			if (!data) setData(new MTPDchatParticipantsForbidden());
+			if (!data) setData(mtpNewData<MTPDchatParticipantsForbidden>());
 			MTPDchatParticipantsForbidden &v(_chatParticipantsForbidden());
 			v.vflags.read(from, end);
 			v.vchat_id.read(from, end);
 			if (v.has_self_participant()) { v.vself_participant.read(from, end); } else { v.vself_participant = MTPChatParticipant(); }
 		} break;
 		case mtpc_chatParticipants: _type = cons; {
-			if (!data) setData(new MTPDchatParticipants());
+			if (!data) setData(mtpNewData<MTPDchatParticipants>());
 			MTPDchatParticipants &v(_chatParticipants());
 			v.vchat_id.read(from, end);
 			v.vparticipants.read(from, end);
@@ -27522,7 +27522,7 @@ inline void MTPchatPhoto::read(const mtpPrime *&from, const mtpPrime *end, mtpTy
 	switch (cons) {
 		case mtpc_chatPhotoEmpty: _type = cons; break;
 		case mtpc_chatPhoto: _type = cons; {
-			if (!data) setData(new MTPDchatPhoto());
+			if (!data) setData(mtpNewData<MTPDchatPhoto>());
 			MTPDchatPhoto &v(_chatPhoto());
 			v.vphoto_small.read(from, end);
 			v.vphoto_big.read(from, end);
@@ -27580,12 +27580,12 @@ inline void MTPmessage::read(const mtpPrime *&from, const mtpPrime *end, mtpType
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_messageEmpty: _type = cons; {
-			if (!data) setData(new MTPDmessageEmpty());
+			if (!data) setData(mtpNewData<MTPDmessageEmpty>());
 			MTPDmessageEmpty &v(_messageEmpty());
 			v.vid.read(from, end);
 		} break;
 		case mtpc_message: _type = cons; {
-			if (!data) setData(new MTPDmessage());
+			if (!data) setData(mtpNewData<MTPDmessage>());
 			MTPDmessage &v(_message());
 			v.vflags.read(from, end);
 			v.vid.read(from, end);
@@ -27603,7 +27603,7 @@ inline void MTPmessage::read(const mtpPrime *&from, const mtpPrime *end, mtpType
 			if (v.has_edit_date()) { v.vedit_date.read(from, end); } else { v.vedit_date = MTPint(); }
 		} break;
 		case mtpc_messageService: _type = cons; {
-			if (!data) setData(new MTPDmessageService());
+			if (!data) setData(mtpNewData<MTPDmessageService>());
 			MTPDmessageService &v(_messageService());
 			v.vflags.read(from, end);
 			v.vid.read(from, end);
@@ -27719,18 +27719,18 @@ inline void MTPmessageMedia::read(const mtpPrime *&from, const mtpPrime *end, mt
 	switch (cons) {
 		case mtpc_messageMediaEmpty: _type = cons; break;
 		case mtpc_messageMediaPhoto: _type = cons; {
-			if (!data) setData(new MTPDmessageMediaPhoto());
+			if (!data) setData(mtpNewData<MTPDmessageMediaPhoto>());
 			MTPDmessageMediaPhoto &v(_messageMediaPhoto());
 			v.vphoto.read(from, end);
 			v.vcaption.read(from, end);
 		} break;
 		case mtpc_messageMediaGeo: _type = cons; {
-			if (!data) setData(new MTPDmessageMediaGeo());
+			if (!data) setData(mtpNewData<MTPDmessageMediaGeo>());
 			MTPDmessageMediaGeo &v(_messageMediaGeo());
 			v.vgeo.read(from, end);
 		} break;
 		case mtpc_messageMediaContact: _type = cons; {
-			if (!data) setData(new MTPDmessageMediaContact());
+			if (!data) setData(mtpNewData<MTPDmessageMediaContact>());
 			MTPDmessageMediaContact &v(_messageMediaContact());
 			v.vphone_number.read(from, end);
 			v.vfirst_name.read(from, end);
@@ -27739,18 +27739,18 @@ inline void MTPmessageMedia::read(const mtpPrime *&from, const mtpPrime *end, mt
 		} break;
 		case mtpc_messageMediaUnsupported: _type = cons; break;
 		case mtpc_messageMediaDocument: _type = cons; {
-			if (!data) setData(new MTPDmessageMediaDocument());
+			if (!data) setData(mtpNewData<MTPDmessageMediaDocument>());
 			MTPDmessageMediaDocument &v(_messageMediaDocument());
 			v.vdocument.read(from, end);
 			v.vcaption.read(from, end);
 		} break;
 		case mtpc_messageMediaWebPage: _type = cons; {
-			if (!data) setData(new MTPDmessageMediaWebPage());
+			if (!data) setData(mtpNewData<MTPDmessageMediaWebPage>());
 			MTPDmessageMediaWebPage &v(_messageMediaWebPage());
 			v.vwebpage.read(from, end);
 		} break;
 		case mtpc_messageMediaVenue: _type = cons; {
-			if (!data) setData(new MTPDmessageMediaVenue());
+			if (!data) setData(mtpNewData<MTPDmessageMediaVenue>());
 			MTPDmessageMediaVenue &v(_messageMediaVenue());
 			v.vgeo.read(from, end);
 			v.vtitle.read(from, end);
@@ -27759,7 +27759,7 @@ inline void MTPmessageMedia::read(const mtpPrime *&from, const mtpPrime *end, mt
 			v.vvenue_id.read(from, end);
 		} break;
 		case mtpc_messageMediaGame: _type = cons; {
-			if (!data) setData(new MTPDmessageMediaGame());
+			if (!data) setData(mtpNewData<MTPDmessageMediaGame>());
 			MTPDmessageMediaGame &v(_messageMediaGame());
 			v.vgame.read(from, end);
 		} break;
@@ -27917,49 +27917,49 @@ inline void MTPmessageAction::read(const mtpPrime *&from, const mtpPrime *end, m
 	switch (cons) {
 		case mtpc_messageActionEmpty: _type = cons; break;
 		case mtpc_messageActionChatCreate: _type = cons; {
-			if (!data) setData(new MTPDmessageActionChatCreate());
+			if (!data) setData(mtpNewData<MTPDmessageActionChatCreate>());
 			MTPDmessageActionChatCreate &v(_messageActionChatCreate());
 			v.vtitle.read(from, end);
 			v.vusers.read(from, end);
 		} break;
 		case mtpc_messageActionChatEditTitle: _type = cons; {
-			if (!data) setData(new MTPDmessageActionChatEditTitle());
+			if (!data) setData(mtpNewData<MTPDmessageActionChatEditTitle>());
 			MTPDmessageActionChatEditTitle &v(_messageActionChatEditTitle());
 			v.vtitle.read(from, end);
 		} break;
 		case mtpc_messageActionChatEditPhoto: _type = cons; {
-			if (!data) setData(new MTPDmessageActionChatEditPhoto());
+			if (!data) setData(mtpNewData<MTPDmessageActionChatEditPhoto>());
 			MTPDmessageActionChatEditPhoto &v(_messageActionChatEditPhoto());
 			v.vphoto.read(from, end);
 		} break;
 		case mtpc_messageActionChatDeletePhoto: _type = cons; break;
 		case mtpc_messageActionChatAddUser: _type = cons; {
-			if (!data) setData(new MTPDmessageActionChatAddUser());
+			if (!data) setData(mtpNewData<MTPDmessageActionChatAddUser>());
 			MTPDmessageActionChatAddUser &v(_messageActionChatAddUser());
 			v.vusers.read(from, end);
 		} break;
 		case mtpc_messageActionChatDeleteUser: _type = cons; {
-			if (!data) setData(new MTPDmessageActionChatDeleteUser());
+			if (!data) setData(mtpNewData<MTPDmessageActionChatDeleteUser>());
 			MTPDmessageActionChatDeleteUser &v(_messageActionChatDeleteUser());
 			v.vuser_id.read(from, end);
 		} break;
 		case mtpc_messageActionChatJoinedByLink: _type = cons; {
-			if (!data) setData(new MTPDmessageActionChatJoinedByLink());
+			if (!data) setData(mtpNewData<MTPDmessageActionChatJoinedByLink>());
 			MTPDmessageActionChatJoinedByLink &v(_messageActionChatJoinedByLink());
 			v.vinviter_id.read(from, end);
 		} break;
 		case mtpc_messageActionChannelCreate: _type = cons; {
-			if (!data) setData(new MTPDmessageActionChannelCreate());
+			if (!data) setData(mtpNewData<MTPDmessageActionChannelCreate>());
 			MTPDmessageActionChannelCreate &v(_messageActionChannelCreate());
 			v.vtitle.read(from, end);
 		} break;
 		case mtpc_messageActionChatMigrateTo: _type = cons; {
-			if (!data) setData(new MTPDmessageActionChatMigrateTo());
+			if (!data) setData(mtpNewData<MTPDmessageActionChatMigrateTo>());
 			MTPDmessageActionChatMigrateTo &v(_messageActionChatMigrateTo());
 			v.vchannel_id.read(from, end);
 		} break;
 		case mtpc_messageActionChannelMigrateFrom: _type = cons; {
-			if (!data) setData(new MTPDmessageActionChannelMigrateFrom());
+			if (!data) setData(mtpNewData<MTPDmessageActionChannelMigrateFrom>());
 			MTPDmessageActionChannelMigrateFrom &v(_messageActionChannelMigrateFrom());
 			v.vtitle.read(from, end);
 			v.vchat_id.read(from, end);
@@ -27967,7 +27967,7 @@ inline void MTPmessageAction::read(const mtpPrime *&from, const mtpPrime *end, m
 		case mtpc_messageActionPinMessage: _type = cons; break;
 		case mtpc_messageActionHistoryClear: _type = cons; break;
 		case mtpc_messageActionGameScore: _type = cons; {
-			if (!data) setData(new MTPDmessageActionGameScore());
+			if (!data) setData(mtpNewData<MTPDmessageActionGameScore>());
 			MTPDmessageActionGameScore &v(_messageActionGameScore());
 			v.vgame_id.read(from, end);
 			v.vscore.read(from, end);
@@ -28117,7 +28117,7 @@ inline mtpTypeId MTPdialog::type() const {
 inline void MTPdialog::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_dialog) throw mtpErrorUnexpected(cons, "MTPdialog");
 
-	if (!data) setData(new MTPDdialog());
+	if (!data) setData(mtpNewData<MTPDdialog>());
 	MTPDdialog &v(_dialog());
 	v.vflags.read(from, end);
 	v.vpeer.read(from, end);
@@ -28169,12 +28169,12 @@ inline void MTPphoto::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_photoEmpty: _type = cons; {
-			if (!data) setData(new MTPDphotoEmpty());
+			if (!data) setData(mtpNewData<MTPDphotoEmpty>());
 			MTPDphotoEmpty &v(_photoEmpty());
 			v.vid.read(from, end);
 		} break;
 		case mtpc_photo: _type = cons; {
-			if (!data) setData(new MTPDphoto());
+			if (!data) setData(mtpNewData<MTPDphoto>());
 			MTPDphoto &v(_photo());
 			v.vflags.read(from, end);
 			v.vid.read(from, end);
@@ -28245,12 +28245,12 @@ inline void MTPphotoSize::read(const mtpPrime *&from, const mtpPrime *end, mtpTy
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_photoSizeEmpty: _type = cons; {
-			if (!data) setData(new MTPDphotoSizeEmpty());
+			if (!data) setData(mtpNewData<MTPDphotoSizeEmpty>());
 			MTPDphotoSizeEmpty &v(_photoSizeEmpty());
 			v.vtype.read(from, end);
 		} break;
 		case mtpc_photoSize: _type = cons; {
-			if (!data) setData(new MTPDphotoSize());
+			if (!data) setData(mtpNewData<MTPDphotoSize>());
 			MTPDphotoSize &v(_photoSize());
 			v.vtype.read(from, end);
 			v.vlocation.read(from, end);
@@ -28259,7 +28259,7 @@ inline void MTPphotoSize::read(const mtpPrime *&from, const mtpPrime *end, mtpTy
 			v.vsize.read(from, end);
 		} break;
 		case mtpc_photoCachedSize: _type = cons; {
-			if (!data) setData(new MTPDphotoCachedSize());
+			if (!data) setData(mtpNewData<MTPDphotoCachedSize>());
 			MTPDphotoCachedSize &v(_photoCachedSize());
 			v.vtype.read(from, end);
 			v.vlocation.read(from, end);
@@ -28336,7 +28336,7 @@ inline void MTPgeoPoint::read(const mtpPrime *&from, const mtpPrime *end, mtpTyp
 	switch (cons) {
 		case mtpc_geoPointEmpty: _type = cons; break;
 		case mtpc_geoPoint: _type = cons; {
-			if (!data) setData(new MTPDgeoPoint());
+			if (!data) setData(mtpNewData<MTPDgeoPoint>());
 			MTPDgeoPoint &v(_geoPoint());
 			v.vlong.read(from, end);
 			v.vlat.read(from, end);
@@ -28382,7 +28382,7 @@ inline mtpTypeId MTPauth_checkedPhone::type() const {
 inline void MTPauth_checkedPhone::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_auth_checkedPhone) throw mtpErrorUnexpected(cons, "MTPauth_checkedPhone");
 
-	if (!data) setData(new MTPDauth_checkedPhone());
+	if (!data) setData(mtpNewData<MTPDauth_checkedPhone>());
 	MTPDauth_checkedPhone &v(_auth_checkedPhone());
 	v.vphone_registered.read(from, end);
 }
@@ -28409,7 +28409,7 @@ inline mtpTypeId MTPauth_sentCode::type() const {
 inline void MTPauth_sentCode::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_auth_sentCode) throw mtpErrorUnexpected(cons, "MTPauth_sentCode");
 
-	if (!data) setData(new MTPDauth_sentCode());
+	if (!data) setData(mtpNewData<MTPDauth_sentCode>());
 	MTPDauth_sentCode &v(_auth_sentCode());
 	v.vflags.read(from, end);
 	v.vtype.read(from, end);
@@ -28445,7 +28445,7 @@ inline mtpTypeId MTPauth_authorization::type() const {
 inline void MTPauth_authorization::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_auth_authorization) throw mtpErrorUnexpected(cons, "MTPauth_authorization");
 
-	if (!data) setData(new MTPDauth_authorization());
+	if (!data) setData(mtpNewData<MTPDauth_authorization>());
 	MTPDauth_authorization &v(_auth_authorization());
 	v.vflags.read(from, end);
 	if (v.has_tmp_sessions()) { v.vtmp_sessions.read(from, end); } else { v.vtmp_sessions = MTPint(); }
@@ -28477,7 +28477,7 @@ inline mtpTypeId MTPauth_exportedAuthorization::type() const {
 inline void MTPauth_exportedAuthorization::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_auth_exportedAuthorization) throw mtpErrorUnexpected(cons, "MTPauth_exportedAuthorization");
 
-	if (!data) setData(new MTPDauth_exportedAuthorization());
+	if (!data) setData(mtpNewData<MTPDauth_exportedAuthorization>());
 	MTPDauth_exportedAuthorization &v(_auth_exportedAuthorization());
 	v.vid.read(from, end);
 	v.vbytes.read(from, end);
@@ -28510,7 +28510,7 @@ inline void MTPinputNotifyPeer::read(const mtpPrime *&from, const mtpPrime *end,
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_inputNotifyPeer: _type = cons; {
-			if (!data) setData(new MTPDinputNotifyPeer());
+			if (!data) setData(mtpNewData<MTPDinputNotifyPeer>());
 			MTPDinputNotifyPeer &v(_inputNotifyPeer());
 			v.vpeer.read(from, end);
 		} break;
@@ -28595,7 +28595,7 @@ inline mtpTypeId MTPinputPeerNotifySettings::type() const {
 inline void MTPinputPeerNotifySettings::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_inputPeerNotifySettings) throw mtpErrorUnexpected(cons, "MTPinputPeerNotifySettings");
 
-	if (!data) setData(new MTPDinputPeerNotifySettings());
+	if (!data) setData(mtpNewData<MTPDinputPeerNotifySettings>());
 	MTPDinputPeerNotifySettings &v(_inputPeerNotifySettings());
 	v.vflags.read(from, end);
 	v.vmute_until.read(from, end);
@@ -28662,7 +28662,7 @@ inline void MTPpeerNotifySettings::read(const mtpPrime *&from, const mtpPrime *e
 	switch (cons) {
 		case mtpc_peerNotifySettingsEmpty: _type = cons; break;
 		case mtpc_peerNotifySettings: _type = cons; {
-			if (!data) setData(new MTPDpeerNotifySettings());
+			if (!data) setData(mtpNewData<MTPDpeerNotifySettings>());
 			MTPDpeerNotifySettings &v(_peerNotifySettings());
 			v.vflags.read(from, end);
 			v.vmute_until.read(from, end);
@@ -28711,7 +28711,7 @@ inline mtpTypeId MTPpeerSettings::type() const {
 inline void MTPpeerSettings::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_peerSettings) throw mtpErrorUnexpected(cons, "MTPpeerSettings");
 
-	if (!data) setData(new MTPDpeerSettings());
+	if (!data) setData(mtpNewData<MTPDpeerSettings>());
 	MTPDpeerSettings &v(_peerSettings());
 	v.vflags.read(from, end);
 }
@@ -28747,7 +28747,7 @@ inline void MTPwallPaper::read(const mtpPrime *&from, const mtpPrime *end, mtpTy
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_wallPaper: _type = cons; {
-			if (!data) setData(new MTPDwallPaper());
+			if (!data) setData(mtpNewData<MTPDwallPaper>());
 			MTPDwallPaper &v(_wallPaper());
 			v.vid.read(from, end);
 			v.vtitle.read(from, end);
@@ -28755,7 +28755,7 @@ inline void MTPwallPaper::read(const mtpPrime *&from, const mtpPrime *end, mtpTy
 			v.vcolor.read(from, end);
 		} break;
 		case mtpc_wallPaperSolid: _type = cons; {
-			if (!data) setData(new MTPDwallPaperSolid());
+			if (!data) setData(mtpNewData<MTPDwallPaperSolid>());
 			MTPDwallPaperSolid &v(_wallPaperSolid());
 			v.vid.read(from, end);
 			v.vtitle.read(from, end);
@@ -28821,7 +28821,7 @@ inline void MTPreportReason::read(const mtpPrime *&from, const mtpPrime *end, mt
 		case mtpc_inputReportReasonViolence: _type = cons; break;
 		case mtpc_inputReportReasonPornography: _type = cons; break;
 		case mtpc_inputReportReasonOther: _type = cons; {
-			if (!data) setData(new MTPDinputReportReasonOther());
+			if (!data) setData(mtpNewData<MTPDinputReportReasonOther>());
 			MTPDinputReportReasonOther &v(_inputReportReasonOther());
 			v.vtext.read(from, end);
 		} break;
@@ -28873,7 +28873,7 @@ inline mtpTypeId MTPuserFull::type() const {
 inline void MTPuserFull::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_userFull) throw mtpErrorUnexpected(cons, "MTPuserFull");
 
-	if (!data) setData(new MTPDuserFull());
+	if (!data) setData(mtpNewData<MTPDuserFull>());
 	MTPDuserFull &v(_userFull());
 	v.vflags.read(from, end);
 	v.vuser.read(from, end);
@@ -28913,7 +28913,7 @@ inline mtpTypeId MTPcontact::type() const {
 inline void MTPcontact::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_contact) throw mtpErrorUnexpected(cons, "MTPcontact");
 
-	if (!data) setData(new MTPDcontact());
+	if (!data) setData(mtpNewData<MTPDcontact>());
 	MTPDcontact &v(_contact());
 	v.vuser_id.read(from, end);
 	v.vmutual.read(from, end);
@@ -28942,7 +28942,7 @@ inline mtpTypeId MTPimportedContact::type() const {
 inline void MTPimportedContact::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_importedContact) throw mtpErrorUnexpected(cons, "MTPimportedContact");
 
-	if (!data) setData(new MTPDimportedContact());
+	if (!data) setData(mtpNewData<MTPDimportedContact>());
 	MTPDimportedContact &v(_importedContact());
 	v.vuser_id.read(from, end);
 	v.vclient_id.read(from, end);
@@ -28971,7 +28971,7 @@ inline mtpTypeId MTPcontactBlocked::type() const {
 inline void MTPcontactBlocked::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_contactBlocked) throw mtpErrorUnexpected(cons, "MTPcontactBlocked");
 
-	if (!data) setData(new MTPDcontactBlocked());
+	if (!data) setData(mtpNewData<MTPDcontactBlocked>());
 	MTPDcontactBlocked &v(_contactBlocked());
 	v.vuser_id.read(from, end);
 	v.vdate.read(from, end);
@@ -29000,7 +29000,7 @@ inline mtpTypeId MTPcontactStatus::type() const {
 inline void MTPcontactStatus::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_contactStatus) throw mtpErrorUnexpected(cons, "MTPcontactStatus");
 
-	if (!data) setData(new MTPDcontactStatus());
+	if (!data) setData(mtpNewData<MTPDcontactStatus>());
 	MTPDcontactStatus &v(_contactStatus());
 	v.vuser_id.read(from, end);
 	v.vstatus.read(from, end);
@@ -29029,7 +29029,7 @@ inline mtpTypeId MTPcontacts_link::type() const {
 inline void MTPcontacts_link::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_contacts_link) throw mtpErrorUnexpected(cons, "MTPcontacts_link");
 
-	if (!data) setData(new MTPDcontacts_link());
+	if (!data) setData(mtpNewData<MTPDcontacts_link>());
 	MTPDcontacts_link &v(_contacts_link());
 	v.vmy_link.read(from, end);
 	v.vforeign_link.read(from, end);
@@ -29065,7 +29065,7 @@ inline void MTPcontacts_contacts::read(const mtpPrime *&from, const mtpPrime *en
 	switch (cons) {
 		case mtpc_contacts_contactsNotModified: _type = cons; break;
 		case mtpc_contacts_contacts: _type = cons; {
-			if (!data) setData(new MTPDcontacts_contacts());
+			if (!data) setData(mtpNewData<MTPDcontacts_contacts>());
 			MTPDcontacts_contacts &v(_contacts_contacts());
 			v.vcontacts.read(from, end);
 			v.vusers.read(from, end);
@@ -29111,7 +29111,7 @@ inline mtpTypeId MTPcontacts_importedContacts::type() const {
 inline void MTPcontacts_importedContacts::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_contacts_importedContacts) throw mtpErrorUnexpected(cons, "MTPcontacts_importedContacts");
 
-	if (!data) setData(new MTPDcontacts_importedContacts());
+	if (!data) setData(mtpNewData<MTPDcontacts_importedContacts>());
 	MTPDcontacts_importedContacts &v(_contacts_importedContacts());
 	v.vimported.read(from, end);
 	v.vretry_contacts.read(from, end);
@@ -29150,13 +29150,13 @@ inline void MTPcontacts_blocked::read(const mtpPrime *&from, const mtpPrime *end
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_contacts_blocked: _type = cons; {
-			if (!data) setData(new MTPDcontacts_blocked());
+			if (!data) setData(mtpNewData<MTPDcontacts_blocked>());
 			MTPDcontacts_blocked &v(_contacts_blocked());
 			v.vblocked.read(from, end);
 			v.vusers.read(from, end);
 		} break;
 		case mtpc_contacts_blockedSlice: _type = cons; {
-			if (!data) setData(new MTPDcontacts_blockedSlice());
+			if (!data) setData(mtpNewData<MTPDcontacts_blockedSlice>());
 			MTPDcontacts_blockedSlice &v(_contacts_blockedSlice());
 			v.vcount.read(from, end);
 			v.vblocked.read(from, end);
@@ -29219,7 +29219,7 @@ inline void MTPmessages_dialogs::read(const mtpPrime *&from, const mtpPrime *end
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_messages_dialogs: _type = cons; {
-			if (!data) setData(new MTPDmessages_dialogs());
+			if (!data) setData(mtpNewData<MTPDmessages_dialogs>());
 			MTPDmessages_dialogs &v(_messages_dialogs());
 			v.vdialogs.read(from, end);
 			v.vmessages.read(from, end);
@@ -29227,7 +29227,7 @@ inline void MTPmessages_dialogs::read(const mtpPrime *&from, const mtpPrime *end
 			v.vusers.read(from, end);
 		} break;
 		case mtpc_messages_dialogsSlice: _type = cons; {
-			if (!data) setData(new MTPDmessages_dialogsSlice());
+			if (!data) setData(mtpNewData<MTPDmessages_dialogsSlice>());
 			MTPDmessages_dialogsSlice &v(_messages_dialogsSlice());
 			v.vcount.read(from, end);
 			v.vdialogs.read(from, end);
@@ -29300,14 +29300,14 @@ inline void MTPmessages_messages::read(const mtpPrime *&from, const mtpPrime *en
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_messages_messages: _type = cons; {
-			if (!data) setData(new MTPDmessages_messages());
+			if (!data) setData(mtpNewData<MTPDmessages_messages>());
 			MTPDmessages_messages &v(_messages_messages());
 			v.vmessages.read(from, end);
 			v.vchats.read(from, end);
 			v.vusers.read(from, end);
 		} break;
 		case mtpc_messages_messagesSlice: _type = cons; {
-			if (!data) setData(new MTPDmessages_messagesSlice());
+			if (!data) setData(mtpNewData<MTPDmessages_messagesSlice>());
 			MTPDmessages_messagesSlice &v(_messages_messagesSlice());
 			v.vcount.read(from, end);
 			v.vmessages.read(from, end);
@@ -29315,7 +29315,7 @@ inline void MTPmessages_messages::read(const mtpPrime *&from, const mtpPrime *en
 			v.vusers.read(from, end);
 		} break;
 		case mtpc_messages_channelMessages: _type = cons; {
-			if (!data) setData(new MTPDmessages_channelMessages());
+			if (!data) setData(mtpNewData<MTPDmessages_channelMessages>());
 			MTPDmessages_channelMessages &v(_messages_channelMessages());
 			v.vflags.read(from, end);
 			v.vpts.read(from, end);
@@ -29390,7 +29390,7 @@ inline mtpTypeId MTPmessages_chats::type() const {
 inline void MTPmessages_chats::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_messages_chats) throw mtpErrorUnexpected(cons, "MTPmessages_chats");
 
-	if (!data) setData(new MTPDmessages_chats());
+	if (!data) setData(mtpNewData<MTPDmessages_chats>());
 	MTPDmessages_chats &v(_messages_chats());
 	v.vchats.read(from, end);
 }
@@ -29417,7 +29417,7 @@ inline mtpTypeId MTPmessages_chatFull::type() const {
 inline void MTPmessages_chatFull::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_messages_chatFull) throw mtpErrorUnexpected(cons, "MTPmessages_chatFull");
 
-	if (!data) setData(new MTPDmessages_chatFull());
+	if (!data) setData(mtpNewData<MTPDmessages_chatFull>());
 	MTPDmessages_chatFull &v(_messages_chatFull());
 	v.vfull_chat.read(from, end);
 	v.vchats.read(from, end);
@@ -29448,7 +29448,7 @@ inline mtpTypeId MTPmessages_affectedHistory::type() const {
 inline void MTPmessages_affectedHistory::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_messages_affectedHistory) throw mtpErrorUnexpected(cons, "MTPmessages_affectedHistory");
 
-	if (!data) setData(new MTPDmessages_affectedHistory());
+	if (!data) setData(mtpNewData<MTPDmessages_affectedHistory>());
 	MTPDmessages_affectedHistory &v(_messages_affectedHistory());
 	v.vpts.read(from, end);
 	v.vpts_count.read(from, end);
@@ -29742,51 +29742,51 @@ inline void MTPupdate::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeI
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_updateNewMessage: _type = cons; {
-			if (!data) setData(new MTPDupdateNewMessage());
+			if (!data) setData(mtpNewData<MTPDupdateNewMessage>());
 			MTPDupdateNewMessage &v(_updateNewMessage());
 			v.vmessage.read(from, end);
 			v.vpts.read(from, end);
 			v.vpts_count.read(from, end);
 		} break;
 		case mtpc_updateMessageID: _type = cons; {
-			if (!data) setData(new MTPDupdateMessageID());
+			if (!data) setData(mtpNewData<MTPDupdateMessageID>());
 			MTPDupdateMessageID &v(_updateMessageID());
 			v.vid.read(from, end);
 			v.vrandom_id.read(from, end);
 		} break;
 		case mtpc_updateDeleteMessages: _type = cons; {
-			if (!data) setData(new MTPDupdateDeleteMessages());
+			if (!data) setData(mtpNewData<MTPDupdateDeleteMessages>());
 			MTPDupdateDeleteMessages &v(_updateDeleteMessages());
 			v.vmessages.read(from, end);
 			v.vpts.read(from, end);
 			v.vpts_count.read(from, end);
 		} break;
 		case mtpc_updateUserTyping: _type = cons; {
-			if (!data) setData(new MTPDupdateUserTyping());
+			if (!data) setData(mtpNewData<MTPDupdateUserTyping>());
 			MTPDupdateUserTyping &v(_updateUserTyping());
 			v.vuser_id.read(from, end);
 			v.vaction.read(from, end);
 		} break;
 		case mtpc_updateChatUserTyping: _type = cons; {
-			if (!data) setData(new MTPDupdateChatUserTyping());
+			if (!data) setData(mtpNewData<MTPDupdateChatUserTyping>());
 			MTPDupdateChatUserTyping &v(_updateChatUserTyping());
 			v.vchat_id.read(from, end);
 			v.vuser_id.read(from, end);
 			v.vaction.read(from, end);
 		} break;
 		case mtpc_updateChatParticipants: _type = cons; {
-			if (!data) setData(new MTPDupdateChatParticipants());
+			if (!data) setData(mtpNewData<MTPDupdateChatParticipants>());
 			MTPDupdateChatParticipants &v(_updateChatParticipants());
 			v.vparticipants.read(from, end);
 		} break;
 		case mtpc_updateUserStatus: _type = cons; {
-			if (!data) setData(new MTPDupdateUserStatus());
+			if (!data) setData(mtpNewData<MTPDupdateUserStatus>());
 			MTPDupdateUserStatus &v(_updateUserStatus());
 			v.vuser_id.read(from, end);
 			v.vstatus.read(from, end);
 		} break;
 		case mtpc_updateUserName: _type = cons; {
-			if (!data) setData(new MTPDupdateUserName());
+			if (!data) setData(mtpNewData<MTPDupdateUserName>());
 			MTPDupdateUserName &v(_updateUserName());
 			v.vuser_id.read(from, end);
 			v.vfirst_name.read(from, end);
@@ -29794,7 +29794,7 @@ inline void MTPupdate::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeI
 			v.vusername.read(from, end);
 		} break;
 		case mtpc_updateUserPhoto: _type = cons; {
-			if (!data) setData(new MTPDupdateUserPhoto());
+			if (!data) setData(mtpNewData<MTPDupdateUserPhoto>());
 			MTPDupdateUserPhoto &v(_updateUserPhoto());
 			v.vuser_id.read(from, end);
 			v.vdate.read(from, end);
@@ -29802,20 +29802,20 @@ inline void MTPupdate::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeI
 			v.vprevious.read(from, end);
 		} break;
 		case mtpc_updateContactRegistered: _type = cons; {
-			if (!data) setData(new MTPDupdateContactRegistered());
+			if (!data) setData(mtpNewData<MTPDupdateContactRegistered>());
 			MTPDupdateContactRegistered &v(_updateContactRegistered());
 			v.vuser_id.read(from, end);
 			v.vdate.read(from, end);
 		} break;
 		case mtpc_updateContactLink: _type = cons; {
-			if (!data) setData(new MTPDupdateContactLink());
+			if (!data) setData(mtpNewData<MTPDupdateContactLink>());
 			MTPDupdateContactLink &v(_updateContactLink());
 			v.vuser_id.read(from, end);
 			v.vmy_link.read(from, end);
 			v.vforeign_link.read(from, end);
 		} break;
 		case mtpc_updateNewAuthorization: _type = cons; {
-			if (!data) setData(new MTPDupdateNewAuthorization());
+			if (!data) setData(mtpNewData<MTPDupdateNewAuthorization>());
 			MTPDupdateNewAuthorization &v(_updateNewAuthorization());
 			v.vauth_key_id.read(from, end);
 			v.vdate.read(from, end);
@@ -29823,31 +29823,31 @@ inline void MTPupdate::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeI
 			v.vlocation.read(from, end);
 		} break;
 		case mtpc_updateNewEncryptedMessage: _type = cons; {
-			if (!data) setData(new MTPDupdateNewEncryptedMessage());
+			if (!data) setData(mtpNewData<MTPDupdateNewEncryptedMessage>());
 			MTPDupdateNewEncryptedMessage &v(_updateNewEncryptedMessage());
 			v.vmessage.read(from, end);
 			v.vqts.read(from, end);
 		} break;
 		case mtpc_updateEncryptedChatTyping: _type = cons; {
-			if (!data) setData(new MTPDupdateEncryptedChatTyping());
+			if (!data) setData(mtpNewData<MTPDupdateEncryptedChatTyping>());
 			MTPDupdateEncryptedChatTyping &v(_updateEncryptedChatTyping());
 			v.vchat_id.read(from, end);
 		} break;
 		case mtpc_updateEncryption: _type = cons; {
-			if (!data) setData(new MTPDupdateEncryption());
+			if (!data) setData(mtpNewData<MTPDupdateEncryption>());
 			MTPDupdateEncryption &v(_updateEncryption());
 			v.vchat.read(from, end);
 			v.vdate.read(from, end);
 		} break;
 		case mtpc_updateEncryptedMessagesRead: _type = cons; {
-			if (!data) setData(new MTPDupdateEncryptedMessagesRead());
+			if (!data) setData(mtpNewData<MTPDupdateEncryptedMessagesRead>());
 			MTPDupdateEncryptedMessagesRead &v(_updateEncryptedMessagesRead());
 			v.vchat_id.read(from, end);
 			v.vmax_date.read(from, end);
 			v.vdate.read(from, end);
 		} break;
 		case mtpc_updateChatParticipantAdd: _type = cons; {
-			if (!data) setData(new MTPDupdateChatParticipantAdd());
+			if (!data) setData(mtpNewData<MTPDupdateChatParticipantAdd>());
 			MTPDupdateChatParticipantAdd &v(_updateChatParticipantAdd());
 			v.vchat_id.read(from, end);
 			v.vuser_id.read(from, end);
@@ -29856,31 +29856,31 @@ inline void MTPupdate::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeI
 			v.vversion.read(from, end);
 		} break;
 		case mtpc_updateChatParticipantDelete: _type = cons; {
-			if (!data) setData(new MTPDupdateChatParticipantDelete());
+			if (!data) setData(mtpNewData<MTPDupdateChatParticipantDelete>());
 			MTPDupdateChatParticipantDelete &v(_updateChatParticipantDelete());
 			v.vchat_id.read(from, end);
 			v.vuser_id.read(from, end);
 			v.vversion.read(from, end);
 		} break;
 		case mtpc_updateDcOptions: _type = cons; {
-			if (!data) setData(new MTPDupdateDcOptions());
+			if (!data) setData(mtpNewData<MTPDupdateDcOptions>());
 			MTPDupdateDcOptions &v(_updateDcOptions());
 			v.vdc_options.read(from, end);
 		} break;
 		case mtpc_updateUserBlocked: _type = cons; {
-			if (!data) setData(new MTPDupdateUserBlocked());
+			if (!data) setData(mtpNewData<MTPDupdateUserBlocked>());
 			MTPDupdateUserBlocked &v(_updateUserBlocked());
 			v.vuser_id.read(from, end);
 			v.vblocked.read(from, end);
 		} break;
 		case mtpc_updateNotifySettings: _type = cons; {
-			if (!data) setData(new MTPDupdateNotifySettings());
+			if (!data) setData(mtpNewData<MTPDupdateNotifySettings>());
 			MTPDupdateNotifySettings &v(_updateNotifySettings());
 			v.vpeer.read(from, end);
 			v.vnotify_settings.read(from, end);
 		} break;
 		case mtpc_updateServiceNotification: _type = cons; {
-			if (!data) setData(new MTPDupdateServiceNotification());
+			if (!data) setData(mtpNewData<MTPDupdateServiceNotification>());
 			MTPDupdateServiceNotification &v(_updateServiceNotification());
 			v.vtype.read(from, end);
 			v.vmessage.read(from, end);
@@ -29888,19 +29888,19 @@ inline void MTPupdate::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeI
 			v.vpopup.read(from, end);
 		} break;
 		case mtpc_updatePrivacy: _type = cons; {
-			if (!data) setData(new MTPDupdatePrivacy());
+			if (!data) setData(mtpNewData<MTPDupdatePrivacy>());
 			MTPDupdatePrivacy &v(_updatePrivacy());
 			v.vkey.read(from, end);
 			v.vrules.read(from, end);
 		} break;
 		case mtpc_updateUserPhone: _type = cons; {
-			if (!data) setData(new MTPDupdateUserPhone());
+			if (!data) setData(mtpNewData<MTPDupdateUserPhone>());
 			MTPDupdateUserPhone &v(_updateUserPhone());
 			v.vuser_id.read(from, end);
 			v.vphone.read(from, end);
 		} break;
 		case mtpc_updateReadHistoryInbox: _type = cons; {
-			if (!data) setData(new MTPDupdateReadHistoryInbox());
+			if (!data) setData(mtpNewData<MTPDupdateReadHistoryInbox>());
 			MTPDupdateReadHistoryInbox &v(_updateReadHistoryInbox());
 			v.vpeer.read(from, end);
 			v.vmax_id.read(from, end);
@@ -29908,7 +29908,7 @@ inline void MTPupdate::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeI
 			v.vpts_count.read(from, end);
 		} break;
 		case mtpc_updateReadHistoryOutbox: _type = cons; {
-			if (!data) setData(new MTPDupdateReadHistoryOutbox());
+			if (!data) setData(mtpNewData<MTPDupdateReadHistoryOutbox>());
 			MTPDupdateReadHistoryOutbox &v(_updateReadHistoryOutbox());
 			v.vpeer.read(from, end);
 			v.vmax_id.read(from, end);
@@ -29916,46 +29916,46 @@ inline void MTPupdate::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeI
 			v.vpts_count.read(from, end);
 		} break;
 		case mtpc_updateWebPage: _type = cons; {
-			if (!data) setData(new MTPDupdateWebPage());
+			if (!data) setData(mtpNewData<MTPDupdateWebPage>());
 			MTPDupdateWebPage &v(_updateWebPage());
 			v.vwebpage.read(from, end);
 			v.vpts.read(from, end);
 			v.vpts_count.read(from, end);
 		} break;
 		case mtpc_updateReadMessagesContents: _type = cons; {
-			if (!data) setData(new MTPDupdateReadMessagesContents());
+			if (!data) setData(mtpNewData<MTPDupdateReadMessagesContents>());
 			MTPDupdateReadMessagesContents &v(_updateReadMessagesContents());
 			v.vmessages.read(from, end);
 			v.vpts.read(from, end);
 			v.vpts_count.read(from, end);
 		} break;
 		case mtpc_updateChannelTooLong: _type = cons; {
-			if (!data) setData(new MTPDupdateChannelTooLong());
+			if (!data) setData(mtpNewData<MTPDupdateChannelTooLong>());
 			MTPDupdateChannelTooLong &v(_updateChannelTooLong());
 			v.vflags.read(from, end);
 			v.vchannel_id.read(from, end);
 			if (v.has_pts()) { v.vpts.read(from, end); } else { v.vpts = MTPint(); }
 		} break;
 		case mtpc_updateChannel: _type = cons; {
-			if (!data) setData(new MTPDupdateChannel());
+			if (!data) setData(mtpNewData<MTPDupdateChannel>());
 			MTPDupdateChannel &v(_updateChannel());
 			v.vchannel_id.read(from, end);
 		} break;
 		case mtpc_updateNewChannelMessage: _type = cons; {
-			if (!data) setData(new MTPDupdateNewChannelMessage());
+			if (!data) setData(mtpNewData<MTPDupdateNewChannelMessage>());
 			MTPDupdateNewChannelMessage &v(_updateNewChannelMessage());
 			v.vmessage.read(from, end);
 			v.vpts.read(from, end);
 			v.vpts_count.read(from, end);
 		} break;
 		case mtpc_updateReadChannelInbox: _type = cons; {
-			if (!data) setData(new MTPDupdateReadChannelInbox());
+			if (!data) setData(mtpNewData<MTPDupdateReadChannelInbox>());
 			MTPDupdateReadChannelInbox &v(_updateReadChannelInbox());
 			v.vchannel_id.read(from, end);
 			v.vmax_id.read(from, end);
 		} break;
 		case mtpc_updateDeleteChannelMessages: _type = cons; {
-			if (!data) setData(new MTPDupdateDeleteChannelMessages());
+			if (!data) setData(mtpNewData<MTPDupdateDeleteChannelMessages>());
 			MTPDupdateDeleteChannelMessages &v(_updateDeleteChannelMessages());
 			v.vchannel_id.read(from, end);
 			v.vmessages.read(from, end);
@@ -29963,21 +29963,21 @@ inline void MTPupdate::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeI
 			v.vpts_count.read(from, end);
 		} break;
 		case mtpc_updateChannelMessageViews: _type = cons; {
-			if (!data) setData(new MTPDupdateChannelMessageViews());
+			if (!data) setData(mtpNewData<MTPDupdateChannelMessageViews>());
 			MTPDupdateChannelMessageViews &v(_updateChannelMessageViews());
 			v.vchannel_id.read(from, end);
 			v.vid.read(from, end);
 			v.vviews.read(from, end);
 		} break;
 		case mtpc_updateChatAdmins: _type = cons; {
-			if (!data) setData(new MTPDupdateChatAdmins());
+			if (!data) setData(mtpNewData<MTPDupdateChatAdmins>());
 			MTPDupdateChatAdmins &v(_updateChatAdmins());
 			v.vchat_id.read(from, end);
 			v.venabled.read(from, end);
 			v.vversion.read(from, end);
 		} break;
 		case mtpc_updateChatParticipantAdmin: _type = cons; {
-			if (!data) setData(new MTPDupdateChatParticipantAdmin());
+			if (!data) setData(mtpNewData<MTPDupdateChatParticipantAdmin>());
 			MTPDupdateChatParticipantAdmin &v(_updateChatParticipantAdmin());
 			v.vchat_id.read(from, end);
 			v.vuser_id.read(from, end);
@@ -29985,12 +29985,12 @@ inline void MTPupdate::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeI
 			v.vversion.read(from, end);
 		} break;
 		case mtpc_updateNewStickerSet: _type = cons; {
-			if (!data) setData(new MTPDupdateNewStickerSet());
+			if (!data) setData(mtpNewData<MTPDupdateNewStickerSet>());
 			MTPDupdateNewStickerSet &v(_updateNewStickerSet());
 			v.vstickerset.read(from, end);
 		} break;
 		case mtpc_updateStickerSetsOrder: _type = cons; {
-			if (!data) setData(new MTPDupdateStickerSetsOrder());
+			if (!data) setData(mtpNewData<MTPDupdateStickerSetsOrder>());
 			MTPDupdateStickerSetsOrder &v(_updateStickerSetsOrder());
 			v.vflags.read(from, end);
 			v.vorder.read(from, end);
@@ -29998,7 +29998,7 @@ inline void MTPupdate::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeI
 		case mtpc_updateStickerSets: _type = cons; break;
 		case mtpc_updateSavedGifs: _type = cons; break;
 		case mtpc_updateBotInlineQuery: _type = cons; {
-			if (!data) setData(new MTPDupdateBotInlineQuery());
+			if (!data) setData(mtpNewData<MTPDupdateBotInlineQuery>());
 			MTPDupdateBotInlineQuery &v(_updateBotInlineQuery());
 			v.vflags.read(from, end);
 			v.vquery_id.read(from, end);
@@ -30008,7 +30008,7 @@ inline void MTPupdate::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeI
 			v.voffset.read(from, end);
 		} break;
 		case mtpc_updateBotInlineSend: _type = cons; {
-			if (!data) setData(new MTPDupdateBotInlineSend());
+			if (!data) setData(mtpNewData<MTPDupdateBotInlineSend>());
 			MTPDupdateBotInlineSend &v(_updateBotInlineSend());
 			v.vflags.read(from, end);
 			v.vuser_id.read(from, end);
@@ -30018,20 +30018,20 @@ inline void MTPupdate::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeI
 			if (v.has_msg_id()) { v.vmsg_id.read(from, end); } else { v.vmsg_id = MTPInputBotInlineMessageID(); }
 		} break;
 		case mtpc_updateEditChannelMessage: _type = cons; {
-			if (!data) setData(new MTPDupdateEditChannelMessage());
+			if (!data) setData(mtpNewData<MTPDupdateEditChannelMessage>());
 			MTPDupdateEditChannelMessage &v(_updateEditChannelMessage());
 			v.vmessage.read(from, end);
 			v.vpts.read(from, end);
 			v.vpts_count.read(from, end);
 		} break;
 		case mtpc_updateChannelPinnedMessage: _type = cons; {
-			if (!data) setData(new MTPDupdateChannelPinnedMessage());
+			if (!data) setData(mtpNewData<MTPDupdateChannelPinnedMessage>());
 			MTPDupdateChannelPinnedMessage &v(_updateChannelPinnedMessage());
 			v.vchannel_id.read(from, end);
 			v.vid.read(from, end);
 		} break;
 		case mtpc_updateBotCallbackQuery: _type = cons; {
-			if (!data) setData(new MTPDupdateBotCallbackQuery());
+			if (!data) setData(mtpNewData<MTPDupdateBotCallbackQuery>());
 			MTPDupdateBotCallbackQuery &v(_updateBotCallbackQuery());
 			v.vflags.read(from, end);
 			v.vquery_id.read(from, end);
@@ -30043,14 +30043,14 @@ inline void MTPupdate::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeI
 			if (v.has_game_short_name()) { v.vgame_short_name.read(from, end); } else { v.vgame_short_name = MTPstring(); }
 		} break;
 		case mtpc_updateEditMessage: _type = cons; {
-			if (!data) setData(new MTPDupdateEditMessage());
+			if (!data) setData(mtpNewData<MTPDupdateEditMessage>());
 			MTPDupdateEditMessage &v(_updateEditMessage());
 			v.vmessage.read(from, end);
 			v.vpts.read(from, end);
 			v.vpts_count.read(from, end);
 		} break;
 		case mtpc_updateInlineBotCallbackQuery: _type = cons; {
-			if (!data) setData(new MTPDupdateInlineBotCallbackQuery());
+			if (!data) setData(mtpNewData<MTPDupdateInlineBotCallbackQuery>());
 			MTPDupdateInlineBotCallbackQuery &v(_updateInlineBotCallbackQuery());
 			v.vflags.read(from, end);
 			v.vquery_id.read(from, end);
@@ -30061,13 +30061,13 @@ inline void MTPupdate::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeI
 			if (v.has_game_short_name()) { v.vgame_short_name.read(from, end); } else { v.vgame_short_name = MTPstring(); }
 		} break;
 		case mtpc_updateReadChannelOutbox: _type = cons; {
-			if (!data) setData(new MTPDupdateReadChannelOutbox());
+			if (!data) setData(mtpNewData<MTPDupdateReadChannelOutbox>());
 			MTPDupdateReadChannelOutbox &v(_updateReadChannelOutbox());
 			v.vchannel_id.read(from, end);
 			v.vmax_id.read(from, end);
 		} break;
 		case mtpc_updateDraftMessage: _type = cons; {
-			if (!data) setData(new MTPDupdateDraftMessage());
+			if (!data) setData(mtpNewData<MTPDupdateDraftMessage>());
 			MTPDupdateDraftMessage &v(_updateDraftMessage());
 			v.vpeer.read(from, end);
 			v.vdraft.read(from, end);
@@ -30696,7 +30696,7 @@ inline mtpTypeId MTPupdates_state::type() const {
 inline void MTPupdates_state::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_updates_state) throw mtpErrorUnexpected(cons, "MTPupdates_state");
 
-	if (!data) setData(new MTPDupdates_state());
+	if (!data) setData(mtpNewData<MTPDupdates_state>());
 	MTPDupdates_state &v(_updates_state());
 	v.vpts.read(from, end);
 	v.vqts.read(from, end);
@@ -30743,13 +30743,13 @@ inline void MTPupdates_difference::read(const mtpPrime *&from, const mtpPrime *e
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_updates_differenceEmpty: _type = cons; {
-			if (!data) setData(new MTPDupdates_differenceEmpty());
+			if (!data) setData(mtpNewData<MTPDupdates_differenceEmpty>());
 			MTPDupdates_differenceEmpty &v(_updates_differenceEmpty());
 			v.vdate.read(from, end);
 			v.vseq.read(from, end);
 		} break;
 		case mtpc_updates_difference: _type = cons; {
-			if (!data) setData(new MTPDupdates_difference());
+			if (!data) setData(mtpNewData<MTPDupdates_difference>());
 			MTPDupdates_difference &v(_updates_difference());
 			v.vnew_messages.read(from, end);
 			v.vnew_encrypted_messages.read(from, end);
@@ -30759,7 +30759,7 @@ inline void MTPupdates_difference::read(const mtpPrime *&from, const mtpPrime *e
 			v.vstate.read(from, end);
 		} break;
 		case mtpc_updates_differenceSlice: _type = cons; {
-			if (!data) setData(new MTPDupdates_differenceSlice());
+			if (!data) setData(mtpNewData<MTPDupdates_differenceSlice>());
 			MTPDupdates_differenceSlice &v(_updates_differenceSlice());
 			v.vnew_messages.read(from, end);
 			v.vnew_encrypted_messages.read(from, end);
@@ -30860,7 +30860,7 @@ inline void MTPupdates::read(const mtpPrime *&from, const mtpPrime *end, mtpType
 	switch (cons) {
 		case mtpc_updatesTooLong: _type = cons; break;
 		case mtpc_updateShortMessage: _type = cons; {
-			if (!data) setData(new MTPDupdateShortMessage());
+			if (!data) setData(mtpNewData<MTPDupdateShortMessage>());
 			MTPDupdateShortMessage &v(_updateShortMessage());
 			v.vflags.read(from, end);
 			v.vid.read(from, end);
@@ -30875,7 +30875,7 @@ inline void MTPupdates::read(const mtpPrime *&from, const mtpPrime *end, mtpType
 			if (v.has_entities()) { v.ventities.read(from, end); } else { v.ventities = MTPVector<MTPMessageEntity>(); }
 		} break;
 		case mtpc_updateShortChatMessage: _type = cons; {
-			if (!data) setData(new MTPDupdateShortChatMessage());
+			if (!data) setData(mtpNewData<MTPDupdateShortChatMessage>());
 			MTPDupdateShortChatMessage &v(_updateShortChatMessage());
 			v.vflags.read(from, end);
 			v.vid.read(from, end);
@@ -30891,13 +30891,13 @@ inline void MTPupdates::read(const mtpPrime *&from, const mtpPrime *end, mtpType
 			if (v.has_entities()) { v.ventities.read(from, end); } else { v.ventities = MTPVector<MTPMessageEntity>(); }
 		} break;
 		case mtpc_updateShort: _type = cons; {
-			if (!data) setData(new MTPDupdateShort());
+			if (!data) setData(mtpNewData<MTPDupdateShort>());
 			MTPDupdateShort &v(_updateShort());
 			v.vupdate.read(from, end);
 			v.vdate.read(from, end);
 		} break;
 		case mtpc_updatesCombined: _type = cons; {
-			if (!data) setData(new MTPDupdatesCombined());
+			if (!data) setData(mtpNewData<MTPDupdatesCombined>());
 			MTPDupdatesCombined &v(_updatesCombined());
 			v.vupdates.read(from, end);
 			v.vusers.read(from, end);
@@ -30907,7 +30907,7 @@ inline void MTPupdates::read(const mtpPrime *&from, const mtpPrime *end, mtpType
 			v.vseq.read(from, end);
 		} break;
 		case mtpc_updates: _type = cons; {
-			if (!data) setData(new MTPDupdates());
+			if (!data) setData(mtpNewData<MTPDupdates>());
 			MTPDupdates &v(_updates());
 			v.vupdates.read(from, end);
 			v.vusers.read(from, end);
@@ -30916,7 +30916,7 @@ inline void MTPupdates::read(const mtpPrime *&from, const mtpPrime *end, mtpType
 			v.vseq.read(from, end);
 		} break;
 		case mtpc_updateShortSentMessage: _type = cons; {
-			if (!data) setData(new MTPDupdateShortSentMessage());
+			if (!data) setData(mtpNewData<MTPDupdateShortSentMessage>());
 			MTPDupdateShortSentMessage &v(_updateShortSentMessage());
 			v.vflags.read(from, end);
 			v.vid.read(from, end);
@@ -31064,13 +31064,13 @@ inline void MTPphotos_photos::read(const mtpPrime *&from, const mtpPrime *end, m
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_photos_photos: _type = cons; {
-			if (!data) setData(new MTPDphotos_photos());
+			if (!data) setData(mtpNewData<MTPDphotos_photos>());
 			MTPDphotos_photos &v(_photos_photos());
 			v.vphotos.read(from, end);
 			v.vusers.read(from, end);
 		} break;
 		case mtpc_photos_photosSlice: _type = cons; {
-			if (!data) setData(new MTPDphotos_photosSlice());
+			if (!data) setData(mtpNewData<MTPDphotos_photosSlice>());
 			MTPDphotos_photosSlice &v(_photos_photosSlice());
 			v.vcount.read(from, end);
 			v.vphotos.read(from, end);
@@ -31125,7 +31125,7 @@ inline mtpTypeId MTPphotos_photo::type() const {
 inline void MTPphotos_photo::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_photos_photo) throw mtpErrorUnexpected(cons, "MTPphotos_photo");
 
-	if (!data) setData(new MTPDphotos_photo());
+	if (!data) setData(mtpNewData<MTPDphotos_photo>());
 	MTPDphotos_photo &v(_photos_photo());
 	v.vphoto.read(from, end);
 	v.vusers.read(from, end);
@@ -31154,7 +31154,7 @@ inline mtpTypeId MTPupload_file::type() const {
 inline void MTPupload_file::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_upload_file) throw mtpErrorUnexpected(cons, "MTPupload_file");
 
-	if (!data) setData(new MTPDupload_file());
+	if (!data) setData(mtpNewData<MTPDupload_file>());
 	MTPDupload_file &v(_upload_file());
 	v.vtype.read(from, end);
 	v.vmtime.read(from, end);
@@ -31185,7 +31185,7 @@ inline mtpTypeId MTPdcOption::type() const {
 inline void MTPdcOption::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_dcOption) throw mtpErrorUnexpected(cons, "MTPdcOption");
 
-	if (!data) setData(new MTPDdcOption());
+	if (!data) setData(mtpNewData<MTPDdcOption>());
 	MTPDdcOption &v(_dcOption());
 	v.vflags.read(from, end);
 	v.vid.read(from, end);
@@ -31219,7 +31219,7 @@ inline mtpTypeId MTPconfig::type() const {
 inline void MTPconfig::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_config) throw mtpErrorUnexpected(cons, "MTPconfig");
 
-	if (!data) setData(new MTPDconfig());
+	if (!data) setData(mtpNewData<MTPDconfig>());
 	MTPDconfig &v(_config());
 	v.vflags.read(from, end);
 	v.vdate.read(from, end);
@@ -31293,7 +31293,7 @@ inline mtpTypeId MTPnearestDc::type() const {
 inline void MTPnearestDc::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_nearestDc) throw mtpErrorUnexpected(cons, "MTPnearestDc");
 
-	if (!data) setData(new MTPDnearestDc());
+	if (!data) setData(mtpNewData<MTPDnearestDc>());
 	MTPDnearestDc &v(_nearestDc());
 	v.vcountry.read(from, end);
 	v.vthis_dc.read(from, end);
@@ -31328,7 +31328,7 @@ inline void MTPhelp_appUpdate::read(const mtpPrime *&from, const mtpPrime *end,
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_help_appUpdate: _type = cons; {
-			if (!data) setData(new MTPDhelp_appUpdate());
+			if (!data) setData(mtpNewData<MTPDhelp_appUpdate>());
 			MTPDhelp_appUpdate &v(_help_appUpdate());
 			v.vid.read(from, end);
 			v.vcritical.read(from, end);
@@ -31379,7 +31379,7 @@ inline mtpTypeId MTPhelp_inviteText::type() const {
 inline void MTPhelp_inviteText::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_help_inviteText) throw mtpErrorUnexpected(cons, "MTPhelp_inviteText");
 
-	if (!data) setData(new MTPDhelp_inviteText());
+	if (!data) setData(mtpNewData<MTPDhelp_inviteText>());
 	MTPDhelp_inviteText &v(_help_inviteText());
 	v.vmessage.read(from, end);
 }
@@ -31426,12 +31426,12 @@ inline void MTPencryptedChat::read(const mtpPrime *&from, const mtpPrime *end, m
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_encryptedChatEmpty: _type = cons; {
-			if (!data) setData(new MTPDencryptedChatEmpty());
+			if (!data) setData(mtpNewData<MTPDencryptedChatEmpty>());
 			MTPDencryptedChatEmpty &v(_encryptedChatEmpty());
 			v.vid.read(from, end);
 		} break;
 		case mtpc_encryptedChatWaiting: _type = cons; {
-			if (!data) setData(new MTPDencryptedChatWaiting());
+			if (!data) setData(mtpNewData<MTPDencryptedChatWaiting>());
 			MTPDencryptedChatWaiting &v(_encryptedChatWaiting());
 			v.vid.read(from, end);
 			v.vaccess_hash.read(from, end);
@@ -31440,7 +31440,7 @@ inline void MTPencryptedChat::read(const mtpPrime *&from, const mtpPrime *end, m
 			v.vparticipant_id.read(from, end);
 		} break;
 		case mtpc_encryptedChatRequested: _type = cons; {
-			if (!data) setData(new MTPDencryptedChatRequested());
+			if (!data) setData(mtpNewData<MTPDencryptedChatRequested>());
 			MTPDencryptedChatRequested &v(_encryptedChatRequested());
 			v.vid.read(from, end);
 			v.vaccess_hash.read(from, end);
@@ -31450,7 +31450,7 @@ inline void MTPencryptedChat::read(const mtpPrime *&from, const mtpPrime *end, m
 			v.vg_a.read(from, end);
 		} break;
 		case mtpc_encryptedChat: _type = cons; {
-			if (!data) setData(new MTPDencryptedChat());
+			if (!data) setData(mtpNewData<MTPDencryptedChat>());
 			MTPDencryptedChat &v(_encryptedChat());
 			v.vid.read(from, end);
 			v.vaccess_hash.read(from, end);
@@ -31461,7 +31461,7 @@ inline void MTPencryptedChat::read(const mtpPrime *&from, const mtpPrime *end, m
 			v.vkey_fingerprint.read(from, end);
 		} break;
 		case mtpc_encryptedChatDiscarded: _type = cons; {
-			if (!data) setData(new MTPDencryptedChatDiscarded());
+			if (!data) setData(mtpNewData<MTPDencryptedChatDiscarded>());
 			MTPDencryptedChatDiscarded &v(_encryptedChatDiscarded());
 			v.vid.read(from, end);
 		} break;
@@ -31556,7 +31556,7 @@ inline mtpTypeId MTPinputEncryptedChat::type() const {
 inline void MTPinputEncryptedChat::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_inputEncryptedChat) throw mtpErrorUnexpected(cons, "MTPinputEncryptedChat");
 
-	if (!data) setData(new MTPDinputEncryptedChat());
+	if (!data) setData(mtpNewData<MTPDinputEncryptedChat>());
 	MTPDinputEncryptedChat &v(_inputEncryptedChat());
 	v.vchat_id.read(from, end);
 	v.vaccess_hash.read(from, end);
@@ -31590,7 +31590,7 @@ inline void MTPencryptedFile::read(const mtpPrime *&from, const mtpPrime *end, m
 	switch (cons) {
 		case mtpc_encryptedFileEmpty: _type = cons; break;
 		case mtpc_encryptedFile: _type = cons; {
-			if (!data) setData(new MTPDencryptedFile());
+			if (!data) setData(mtpNewData<MTPDencryptedFile>());
 			MTPDencryptedFile &v(_encryptedFile());
 			v.vid.read(from, end);
 			v.vaccess_hash.read(from, end);
@@ -31655,7 +31655,7 @@ inline void MTPinputEncryptedFile::read(const mtpPrime *&from, const mtpPrime *e
 	switch (cons) {
 		case mtpc_inputEncryptedFileEmpty: _type = cons; break;
 		case mtpc_inputEncryptedFileUploaded: _type = cons; {
-			if (!data) setData(new MTPDinputEncryptedFileUploaded());
+			if (!data) setData(mtpNewData<MTPDinputEncryptedFileUploaded>());
 			MTPDinputEncryptedFileUploaded &v(_inputEncryptedFileUploaded());
 			v.vid.read(from, end);
 			v.vparts.read(from, end);
@@ -31663,13 +31663,13 @@ inline void MTPinputEncryptedFile::read(const mtpPrime *&from, const mtpPrime *e
 			v.vkey_fingerprint.read(from, end);
 		} break;
 		case mtpc_inputEncryptedFile: _type = cons; {
-			if (!data) setData(new MTPDinputEncryptedFile());
+			if (!data) setData(mtpNewData<MTPDinputEncryptedFile>());
 			MTPDinputEncryptedFile &v(_inputEncryptedFile());
 			v.vid.read(from, end);
 			v.vaccess_hash.read(from, end);
 		} break;
 		case mtpc_inputEncryptedFileBigUploaded: _type = cons; {
-			if (!data) setData(new MTPDinputEncryptedFileBigUploaded());
+			if (!data) setData(mtpNewData<MTPDinputEncryptedFileBigUploaded>());
 			MTPDinputEncryptedFileBigUploaded &v(_inputEncryptedFileBigUploaded());
 			v.vid.read(from, end);
 			v.vparts.read(from, end);
@@ -31749,7 +31749,7 @@ inline void MTPencryptedMessage::read(const mtpPrime *&from, const mtpPrime *end
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_encryptedMessage: _type = cons; {
-			if (!data) setData(new MTPDencryptedMessage());
+			if (!data) setData(mtpNewData<MTPDencryptedMessage>());
 			MTPDencryptedMessage &v(_encryptedMessage());
 			v.vrandom_id.read(from, end);
 			v.vchat_id.read(from, end);
@@ -31758,7 +31758,7 @@ inline void MTPencryptedMessage::read(const mtpPrime *&from, const mtpPrime *end
 			v.vfile.read(from, end);
 		} break;
 		case mtpc_encryptedMessageService: _type = cons; {
-			if (!data) setData(new MTPDencryptedMessageService());
+			if (!data) setData(mtpNewData<MTPDencryptedMessageService>());
 			MTPDencryptedMessageService &v(_encryptedMessageService());
 			v.vrandom_id.read(from, end);
 			v.vchat_id.read(from, end);
@@ -31826,12 +31826,12 @@ inline void MTPmessages_dhConfig::read(const mtpPrime *&from, const mtpPrime *en
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_messages_dhConfigNotModified: _type = cons; {
-			if (!data) setData(new MTPDmessages_dhConfigNotModified());
+			if (!data) setData(mtpNewData<MTPDmessages_dhConfigNotModified>());
 			MTPDmessages_dhConfigNotModified &v(_messages_dhConfigNotModified());
 			v.vrandom.read(from, end);
 		} break;
 		case mtpc_messages_dhConfig: _type = cons; {
-			if (!data) setData(new MTPDmessages_dhConfig());
+			if (!data) setData(mtpNewData<MTPDmessages_dhConfig>());
 			MTPDmessages_dhConfig &v(_messages_dhConfig());
 			v.vg.read(from, end);
 			v.vp.read(from, end);
@@ -31895,12 +31895,12 @@ inline void MTPmessages_sentEncryptedMessage::read(const mtpPrime *&from, const
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_messages_sentEncryptedMessage: _type = cons; {
-			if (!data) setData(new MTPDmessages_sentEncryptedMessage());
+			if (!data) setData(mtpNewData<MTPDmessages_sentEncryptedMessage>());
 			MTPDmessages_sentEncryptedMessage &v(_messages_sentEncryptedMessage());
 			v.vdate.read(from, end);
 		} break;
 		case mtpc_messages_sentEncryptedFile: _type = cons; {
-			if (!data) setData(new MTPDmessages_sentEncryptedFile());
+			if (!data) setData(mtpNewData<MTPDmessages_sentEncryptedFile>());
 			MTPDmessages_sentEncryptedFile &v(_messages_sentEncryptedFile());
 			v.vdate.read(from, end);
 			v.vfile.read(from, end);
@@ -31957,7 +31957,7 @@ inline void MTPinputDocument::read(const mtpPrime *&from, const mtpPrime *end, m
 	switch (cons) {
 		case mtpc_inputDocumentEmpty: _type = cons; break;
 		case mtpc_inputDocument: _type = cons; {
-			if (!data) setData(new MTPDinputDocument());
+			if (!data) setData(mtpNewData<MTPDinputDocument>());
 			MTPDinputDocument &v(_inputDocument());
 			v.vid.read(from, end);
 			v.vaccess_hash.read(from, end);
@@ -32011,12 +32011,12 @@ inline void MTPdocument::read(const mtpPrime *&from, const mtpPrime *end, mtpTyp
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_documentEmpty: _type = cons; {
-			if (!data) setData(new MTPDdocumentEmpty());
+			if (!data) setData(mtpNewData<MTPDdocumentEmpty>());
 			MTPDdocumentEmpty &v(_documentEmpty());
 			v.vid.read(from, end);
 		} break;
 		case mtpc_document: _type = cons; {
-			if (!data) setData(new MTPDdocument());
+			if (!data) setData(mtpNewData<MTPDdocument>());
 			MTPDdocument &v(_document());
 			v.vid.read(from, end);
 			v.vaccess_hash.read(from, end);
@@ -32082,7 +32082,7 @@ inline mtpTypeId MTPhelp_support::type() const {
 inline void MTPhelp_support::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_help_support) throw mtpErrorUnexpected(cons, "MTPhelp_support");
 
-	if (!data) setData(new MTPDhelp_support());
+	if (!data) setData(mtpNewData<MTPDhelp_support>());
 	MTPDhelp_support &v(_help_support());
 	v.vphone_number.read(from, end);
 	v.vuser.read(from, end);
@@ -32115,7 +32115,7 @@ inline void MTPnotifyPeer::read(const mtpPrime *&from, const mtpPrime *end, mtpT
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_notifyPeer: _type = cons; {
-			if (!data) setData(new MTPDnotifyPeer());
+			if (!data) setData(mtpNewData<MTPDnotifyPeer>());
 			MTPDnotifyPeer &v(_notifyPeer());
 			v.vpeer.read(from, end);
 		} break;
@@ -32189,23 +32189,23 @@ inline void MTPsendMessageAction::read(const mtpPrime *&from, const mtpPrime *en
 		case mtpc_sendMessageCancelAction: _type = cons; break;
 		case mtpc_sendMessageRecordVideoAction: _type = cons; break;
 		case mtpc_sendMessageUploadVideoAction: _type = cons; {
-			if (!data) setData(new MTPDsendMessageUploadVideoAction());
+			if (!data) setData(mtpNewData<MTPDsendMessageUploadVideoAction>());
 			MTPDsendMessageUploadVideoAction &v(_sendMessageUploadVideoAction());
 			v.vprogress.read(from, end);
 		} break;
 		case mtpc_sendMessageRecordAudioAction: _type = cons; break;
 		case mtpc_sendMessageUploadAudioAction: _type = cons; {
-			if (!data) setData(new MTPDsendMessageUploadAudioAction());
+			if (!data) setData(mtpNewData<MTPDsendMessageUploadAudioAction>());
 			MTPDsendMessageUploadAudioAction &v(_sendMessageUploadAudioAction());
 			v.vprogress.read(from, end);
 		} break;
 		case mtpc_sendMessageUploadPhotoAction: _type = cons; {
-			if (!data) setData(new MTPDsendMessageUploadPhotoAction());
+			if (!data) setData(mtpNewData<MTPDsendMessageUploadPhotoAction>());
 			MTPDsendMessageUploadPhotoAction &v(_sendMessageUploadPhotoAction());
 			v.vprogress.read(from, end);
 		} break;
 		case mtpc_sendMessageUploadDocumentAction: _type = cons; {
-			if (!data) setData(new MTPDsendMessageUploadDocumentAction());
+			if (!data) setData(mtpNewData<MTPDsendMessageUploadDocumentAction>());
 			MTPDsendMessageUploadDocumentAction &v(_sendMessageUploadDocumentAction());
 			v.vprogress.read(from, end);
 		} break;
@@ -32311,7 +32311,7 @@ inline mtpTypeId MTPcontacts_found::type() const {
 inline void MTPcontacts_found::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_contacts_found) throw mtpErrorUnexpected(cons, "MTPcontacts_found");
 
-	if (!data) setData(new MTPDcontacts_found());
+	if (!data) setData(mtpNewData<MTPDcontacts_found>());
 	MTPDcontacts_found &v(_contacts_found());
 	v.vresults.read(from, end);
 	v.vchats.read(from, end);
@@ -32412,14 +32412,14 @@ inline void MTPinputPrivacyRule::read(const mtpPrime *&from, const mtpPrime *end
 		case mtpc_inputPrivacyValueAllowContacts: _type = cons; break;
 		case mtpc_inputPrivacyValueAllowAll: _type = cons; break;
 		case mtpc_inputPrivacyValueAllowUsers: _type = cons; {
-			if (!data) setData(new MTPDinputPrivacyValueAllowUsers());
+			if (!data) setData(mtpNewData<MTPDinputPrivacyValueAllowUsers>());
 			MTPDinputPrivacyValueAllowUsers &v(_inputPrivacyValueAllowUsers());
 			v.vusers.read(from, end);
 		} break;
 		case mtpc_inputPrivacyValueDisallowContacts: _type = cons; break;
 		case mtpc_inputPrivacyValueDisallowAll: _type = cons; break;
 		case mtpc_inputPrivacyValueDisallowUsers: _type = cons; {
-			if (!data) setData(new MTPDinputPrivacyValueDisallowUsers());
+			if (!data) setData(mtpNewData<MTPDinputPrivacyValueDisallowUsers>());
 			MTPDinputPrivacyValueDisallowUsers &v(_inputPrivacyValueDisallowUsers());
 			v.vusers.read(from, end);
 		} break;
@@ -32495,14 +32495,14 @@ inline void MTPprivacyRule::read(const mtpPrime *&from, const mtpPrime *end, mtp
 		case mtpc_privacyValueAllowContacts: _type = cons; break;
 		case mtpc_privacyValueAllowAll: _type = cons; break;
 		case mtpc_privacyValueAllowUsers: _type = cons; {
-			if (!data) setData(new MTPDprivacyValueAllowUsers());
+			if (!data) setData(mtpNewData<MTPDprivacyValueAllowUsers>());
 			MTPDprivacyValueAllowUsers &v(_privacyValueAllowUsers());
 			v.vusers.read(from, end);
 		} break;
 		case mtpc_privacyValueDisallowContacts: _type = cons; break;
 		case mtpc_privacyValueDisallowAll: _type = cons; break;
 		case mtpc_privacyValueDisallowUsers: _type = cons; {
-			if (!data) setData(new MTPDprivacyValueDisallowUsers());
+			if (!data) setData(mtpNewData<MTPDprivacyValueDisallowUsers>());
 			MTPDprivacyValueDisallowUsers &v(_privacyValueDisallowUsers());
 			v.vusers.read(from, end);
 		} break;
@@ -32568,7 +32568,7 @@ inline mtpTypeId MTPaccount_privacyRules::type() const {
 inline void MTPaccount_privacyRules::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_account_privacyRules) throw mtpErrorUnexpected(cons, "MTPaccount_privacyRules");
 
-	if (!data) setData(new MTPDaccount_privacyRules());
+	if (!data) setData(mtpNewData<MTPDaccount_privacyRules>());
 	MTPDaccount_privacyRules &v(_account_privacyRules());
 	v.vrules.read(from, end);
 	v.vusers.read(from, end);
@@ -32597,7 +32597,7 @@ inline mtpTypeId MTPaccountDaysTTL::type() const {
 inline void MTPaccountDaysTTL::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_accountDaysTTL) throw mtpErrorUnexpected(cons, "MTPaccountDaysTTL");
 
-	if (!data) setData(new MTPDaccountDaysTTL());
+	if (!data) setData(mtpNewData<MTPDaccountDaysTTL>());
 	MTPDaccountDaysTTL &v(_accountDaysTTL());
 	v.vdays.read(from, end);
 }
@@ -32644,14 +32644,14 @@ inline void MTPdocumentAttribute::read(const mtpPrime *&from, const mtpPrime *en
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_documentAttributeImageSize: _type = cons; {
-			if (!data) setData(new MTPDdocumentAttributeImageSize());
+			if (!data) setData(mtpNewData<MTPDdocumentAttributeImageSize>());
 			MTPDdocumentAttributeImageSize &v(_documentAttributeImageSize());
 			v.vw.read(from, end);
 			v.vh.read(from, end);
 		} break;
 		case mtpc_documentAttributeAnimated: _type = cons; break;
 		case mtpc_documentAttributeSticker: _type = cons; {
-			if (!data) setData(new MTPDdocumentAttributeSticker());
+			if (!data) setData(mtpNewData<MTPDdocumentAttributeSticker>());
 			MTPDdocumentAttributeSticker &v(_documentAttributeSticker());
 			v.vflags.read(from, end);
 			v.valt.read(from, end);
@@ -32659,14 +32659,14 @@ inline void MTPdocumentAttribute::read(const mtpPrime *&from, const mtpPrime *en
 			if (v.has_mask_coords()) { v.vmask_coords.read(from, end); } else { v.vmask_coords = MTPMaskCoords(); }
 		} break;
 		case mtpc_documentAttributeVideo: _type = cons; {
-			if (!data) setData(new MTPDdocumentAttributeVideo());
+			if (!data) setData(mtpNewData<MTPDdocumentAttributeVideo>());
 			MTPDdocumentAttributeVideo &v(_documentAttributeVideo());
 			v.vduration.read(from, end);
 			v.vw.read(from, end);
 			v.vh.read(from, end);
 		} break;
 		case mtpc_documentAttributeAudio: _type = cons; {
-			if (!data) setData(new MTPDdocumentAttributeAudio());
+			if (!data) setData(mtpNewData<MTPDdocumentAttributeAudio>());
 			MTPDdocumentAttributeAudio &v(_documentAttributeAudio());
 			v.vflags.read(from, end);
 			v.vduration.read(from, end);
@@ -32675,7 +32675,7 @@ inline void MTPdocumentAttribute::read(const mtpPrime *&from, const mtpPrime *en
 			if (v.has_waveform()) { v.vwaveform.read(from, end); } else { v.vwaveform = MTPbytes(); }
 		} break;
 		case mtpc_documentAttributeFilename: _type = cons; {
-			if (!data) setData(new MTPDdocumentAttributeFilename());
+			if (!data) setData(mtpNewData<MTPDdocumentAttributeFilename>());
 			MTPDdocumentAttributeFilename &v(_documentAttributeFilename());
 			v.vfile_name.read(from, end);
 		} break;
@@ -32781,7 +32781,7 @@ inline void MTPmessages_stickers::read(const mtpPrime *&from, const mtpPrime *en
 	switch (cons) {
 		case mtpc_messages_stickersNotModified: _type = cons; break;
 		case mtpc_messages_stickers: _type = cons; {
-			if (!data) setData(new MTPDmessages_stickers());
+			if (!data) setData(mtpNewData<MTPDmessages_stickers>());
 			MTPDmessages_stickers &v(_messages_stickers());
 			v.vhash.read(from, end);
 			v.vstickers.read(from, end);
@@ -32827,7 +32827,7 @@ inline mtpTypeId MTPstickerPack::type() const {
 inline void MTPstickerPack::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_stickerPack) throw mtpErrorUnexpected(cons, "MTPstickerPack");
 
-	if (!data) setData(new MTPDstickerPack());
+	if (!data) setData(mtpNewData<MTPDstickerPack>());
 	MTPDstickerPack &v(_stickerPack());
 	v.vemoticon.read(from, end);
 	v.vdocuments.read(from, end);
@@ -32861,7 +32861,7 @@ inline void MTPmessages_allStickers::read(const mtpPrime *&from, const mtpPrime
 	switch (cons) {
 		case mtpc_messages_allStickersNotModified: _type = cons; break;
 		case mtpc_messages_allStickers: _type = cons; {
-			if (!data) setData(new MTPDmessages_allStickers());
+			if (!data) setData(mtpNewData<MTPDmessages_allStickers>());
 			MTPDmessages_allStickers &v(_messages_allStickers());
 			v.vhash.read(from, end);
 			v.vsets.read(from, end);
@@ -32907,7 +32907,7 @@ inline mtpTypeId MTPdisabledFeature::type() const {
 inline void MTPdisabledFeature::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_disabledFeature) throw mtpErrorUnexpected(cons, "MTPdisabledFeature");
 
-	if (!data) setData(new MTPDdisabledFeature());
+	if (!data) setData(mtpNewData<MTPDdisabledFeature>());
 	MTPDdisabledFeature &v(_disabledFeature());
 	v.vfeature.read(from, end);
 	v.vdescription.read(from, end);
@@ -32936,7 +32936,7 @@ inline mtpTypeId MTPmessages_affectedMessages::type() const {
 inline void MTPmessages_affectedMessages::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_messages_affectedMessages) throw mtpErrorUnexpected(cons, "MTPmessages_affectedMessages");
 
-	if (!data) setData(new MTPDmessages_affectedMessages());
+	if (!data) setData(mtpNewData<MTPDmessages_affectedMessages>());
 	MTPDmessages_affectedMessages &v(_messages_affectedMessages());
 	v.vpts.read(from, end);
 	v.vpts_count.read(from, end);
@@ -33017,18 +33017,18 @@ inline void MTPwebPage::read(const mtpPrime *&from, const mtpPrime *end, mtpType
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_webPageEmpty: _type = cons; {
-			if (!data) setData(new MTPDwebPageEmpty());
+			if (!data) setData(mtpNewData<MTPDwebPageEmpty>());
 			MTPDwebPageEmpty &v(_webPageEmpty());
 			v.vid.read(from, end);
 		} break;
 		case mtpc_webPagePending: _type = cons; {
-			if (!data) setData(new MTPDwebPagePending());
+			if (!data) setData(mtpNewData<MTPDwebPagePending>());
 			MTPDwebPagePending &v(_webPagePending());
 			v.vid.read(from, end);
 			v.vdate.read(from, end);
 		} break;
 		case mtpc_webPage: _type = cons; {
-			if (!data) setData(new MTPDwebPage());
+			if (!data) setData(mtpNewData<MTPDwebPage>());
 			MTPDwebPage &v(_webPage());
 			v.vflags.read(from, end);
 			v.vid.read(from, end);
@@ -33120,7 +33120,7 @@ inline mtpTypeId MTPauthorization::type() const {
 inline void MTPauthorization::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_authorization) throw mtpErrorUnexpected(cons, "MTPauthorization");
 
-	if (!data) setData(new MTPDauthorization());
+	if (!data) setData(mtpNewData<MTPDauthorization>());
 	MTPDauthorization &v(_authorization());
 	v.vhash.read(from, end);
 	v.vflags.read(from, end);
@@ -33171,7 +33171,7 @@ inline mtpTypeId MTPaccount_authorizations::type() const {
 inline void MTPaccount_authorizations::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_account_authorizations) throw mtpErrorUnexpected(cons, "MTPaccount_authorizations");
 
-	if (!data) setData(new MTPDaccount_authorizations());
+	if (!data) setData(mtpNewData<MTPDaccount_authorizations>());
 	MTPDaccount_authorizations &v(_account_authorizations());
 	v.vauthorizations.read(from, end);
 }
@@ -33206,13 +33206,13 @@ inline void MTPaccount_password::read(const mtpPrime *&from, const mtpPrime *end
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_account_noPassword: _type = cons; {
-			if (!data) setData(new MTPDaccount_noPassword());
+			if (!data) setData(mtpNewData<MTPDaccount_noPassword>());
 			MTPDaccount_noPassword &v(_account_noPassword());
 			v.vnew_salt.read(from, end);
 			v.vemail_unconfirmed_pattern.read(from, end);
 		} break;
 		case mtpc_account_password: _type = cons; {
-			if (!data) setData(new MTPDaccount_password());
+			if (!data) setData(mtpNewData<MTPDaccount_password>());
 			MTPDaccount_password &v(_account_password());
 			v.vcurrent_salt.read(from, end);
 			v.vnew_salt.read(from, end);
@@ -33271,7 +33271,7 @@ inline mtpTypeId MTPaccount_passwordSettings::type() const {
 inline void MTPaccount_passwordSettings::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_account_passwordSettings) throw mtpErrorUnexpected(cons, "MTPaccount_passwordSettings");
 
-	if (!data) setData(new MTPDaccount_passwordSettings());
+	if (!data) setData(mtpNewData<MTPDaccount_passwordSettings>());
 	MTPDaccount_passwordSettings &v(_account_passwordSettings());
 	v.vemail.read(from, end);
 }
@@ -33298,7 +33298,7 @@ inline mtpTypeId MTPaccount_passwordInputSettings::type() const {
 inline void MTPaccount_passwordInputSettings::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_account_passwordInputSettings) throw mtpErrorUnexpected(cons, "MTPaccount_passwordInputSettings");
 
-	if (!data) setData(new MTPDaccount_passwordInputSettings());
+	if (!data) setData(mtpNewData<MTPDaccount_passwordInputSettings>());
 	MTPDaccount_passwordInputSettings &v(_account_passwordInputSettings());
 	v.vflags.read(from, end);
 	if (v.has_new_salt()) { v.vnew_salt.read(from, end); } else { v.vnew_salt = MTPbytes(); }
@@ -33334,7 +33334,7 @@ inline mtpTypeId MTPauth_passwordRecovery::type() const {
 inline void MTPauth_passwordRecovery::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_auth_passwordRecovery) throw mtpErrorUnexpected(cons, "MTPauth_passwordRecovery");
 
-	if (!data) setData(new MTPDauth_passwordRecovery());
+	if (!data) setData(mtpNewData<MTPDauth_passwordRecovery>());
 	MTPDauth_passwordRecovery &v(_auth_passwordRecovery());
 	v.vemail_pattern.read(from, end);
 }
@@ -33361,7 +33361,7 @@ inline mtpTypeId MTPreceivedNotifyMessage::type() const {
 inline void MTPreceivedNotifyMessage::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_receivedNotifyMessage) throw mtpErrorUnexpected(cons, "MTPreceivedNotifyMessage");
 
-	if (!data) setData(new MTPDreceivedNotifyMessage());
+	if (!data) setData(mtpNewData<MTPDreceivedNotifyMessage>());
 	MTPDreceivedNotifyMessage &v(_receivedNotifyMessage());
 	v.vid.read(from, end);
 	v.vflags.read(from, end);
@@ -33395,7 +33395,7 @@ inline void MTPexportedChatInvite::read(const mtpPrime *&from, const mtpPrime *e
 	switch (cons) {
 		case mtpc_chatInviteEmpty: _type = cons; break;
 		case mtpc_chatInviteExported: _type = cons; {
-			if (!data) setData(new MTPDchatInviteExported());
+			if (!data) setData(mtpNewData<MTPDchatInviteExported>());
 			MTPDchatInviteExported &v(_chatInviteExported());
 			v.vlink.read(from, end);
 		} break;
@@ -33447,12 +33447,12 @@ inline void MTPchatInvite::read(const mtpPrime *&from, const mtpPrime *end, mtpT
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_chatInviteAlready: _type = cons; {
-			if (!data) setData(new MTPDchatInviteAlready());
+			if (!data) setData(mtpNewData<MTPDchatInviteAlready>());
 			MTPDchatInviteAlready &v(_chatInviteAlready());
 			v.vchat.read(from, end);
 		} break;
 		case mtpc_chatInvite: _type = cons; {
-			if (!data) setData(new MTPDchatInvite());
+			if (!data) setData(mtpNewData<MTPDchatInvite>());
 			MTPDchatInvite &v(_chatInvite());
 			v.vflags.read(from, end);
 			v.vtitle.read(from, end);
@@ -33520,13 +33520,13 @@ inline void MTPinputStickerSet::read(const mtpPrime *&from, const mtpPrime *end,
 	switch (cons) {
 		case mtpc_inputStickerSetEmpty: _type = cons; break;
 		case mtpc_inputStickerSetID: _type = cons; {
-			if (!data) setData(new MTPDinputStickerSetID());
+			if (!data) setData(mtpNewData<MTPDinputStickerSetID>());
 			MTPDinputStickerSetID &v(_inputStickerSetID());
 			v.vid.read(from, end);
 			v.vaccess_hash.read(from, end);
 		} break;
 		case mtpc_inputStickerSetShortName: _type = cons; {
-			if (!data) setData(new MTPDinputStickerSetShortName());
+			if (!data) setData(mtpNewData<MTPDinputStickerSetShortName>());
 			MTPDinputStickerSetShortName &v(_inputStickerSetShortName());
 			v.vshort_name.read(from, end);
 		} break;
@@ -33581,7 +33581,7 @@ inline mtpTypeId MTPstickerSet::type() const {
 inline void MTPstickerSet::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_stickerSet) throw mtpErrorUnexpected(cons, "MTPstickerSet");
 
-	if (!data) setData(new MTPDstickerSet());
+	if (!data) setData(mtpNewData<MTPDstickerSet>());
 	MTPDstickerSet &v(_stickerSet());
 	v.vflags.read(from, end);
 	v.vid.read(from, end);
@@ -33621,7 +33621,7 @@ inline mtpTypeId MTPmessages_stickerSet::type() const {
 inline void MTPmessages_stickerSet::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_messages_stickerSet) throw mtpErrorUnexpected(cons, "MTPmessages_stickerSet");
 
-	if (!data) setData(new MTPDmessages_stickerSet());
+	if (!data) setData(mtpNewData<MTPDmessages_stickerSet>());
 	MTPDmessages_stickerSet &v(_messages_stickerSet());
 	v.vset.read(from, end);
 	v.vpacks.read(from, end);
@@ -33652,7 +33652,7 @@ inline mtpTypeId MTPbotCommand::type() const {
 inline void MTPbotCommand::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_botCommand) throw mtpErrorUnexpected(cons, "MTPbotCommand");
 
-	if (!data) setData(new MTPDbotCommand());
+	if (!data) setData(mtpNewData<MTPDbotCommand>());
 	MTPDbotCommand &v(_botCommand());
 	v.vcommand.read(from, end);
 	v.vdescription.read(from, end);
@@ -33681,7 +33681,7 @@ inline mtpTypeId MTPbotInfo::type() const {
 inline void MTPbotInfo::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_botInfo) throw mtpErrorUnexpected(cons, "MTPbotInfo");
 
-	if (!data) setData(new MTPDbotInfo());
+	if (!data) setData(mtpNewData<MTPDbotInfo>());
 	MTPDbotInfo &v(_botInfo());
 	v.vuser_id.read(from, end);
 	v.vdescription.read(from, end);
@@ -33740,41 +33740,41 @@ inline void MTPkeyboardButton::read(const mtpPrime *&from, const mtpPrime *end,
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_keyboardButton: _type = cons; {
-			if (!data) setData(new MTPDkeyboardButton());
+			if (!data) setData(mtpNewData<MTPDkeyboardButton>());
 			MTPDkeyboardButton &v(_keyboardButton());
 			v.vtext.read(from, end);
 		} break;
 		case mtpc_keyboardButtonUrl: _type = cons; {
-			if (!data) setData(new MTPDkeyboardButtonUrl());
+			if (!data) setData(mtpNewData<MTPDkeyboardButtonUrl>());
 			MTPDkeyboardButtonUrl &v(_keyboardButtonUrl());
 			v.vtext.read(from, end);
 			v.vurl.read(from, end);
 		} break;
 		case mtpc_keyboardButtonCallback: _type = cons; {
-			if (!data) setData(new MTPDkeyboardButtonCallback());
+			if (!data) setData(mtpNewData<MTPDkeyboardButtonCallback>());
 			MTPDkeyboardButtonCallback &v(_keyboardButtonCallback());
 			v.vtext.read(from, end);
 			v.vdata.read(from, end);
 		} break;
 		case mtpc_keyboardButtonRequestPhone: _type = cons; {
-			if (!data) setData(new MTPDkeyboardButtonRequestPhone());
+			if (!data) setData(mtpNewData<MTPDkeyboardButtonRequestPhone>());
 			MTPDkeyboardButtonRequestPhone &v(_keyboardButtonRequestPhone());
 			v.vtext.read(from, end);
 		} break;
 		case mtpc_keyboardButtonRequestGeoLocation: _type = cons; {
-			if (!data) setData(new MTPDkeyboardButtonRequestGeoLocation());
+			if (!data) setData(mtpNewData<MTPDkeyboardButtonRequestGeoLocation>());
 			MTPDkeyboardButtonRequestGeoLocation &v(_keyboardButtonRequestGeoLocation());
 			v.vtext.read(from, end);
 		} break;
 		case mtpc_keyboardButtonSwitchInline: _type = cons; {
-			if (!data) setData(new MTPDkeyboardButtonSwitchInline());
+			if (!data) setData(mtpNewData<MTPDkeyboardButtonSwitchInline>());
 			MTPDkeyboardButtonSwitchInline &v(_keyboardButtonSwitchInline());
 			v.vflags.read(from, end);
 			v.vtext.read(from, end);
 			v.vquery.read(from, end);
 		} break;
 		case mtpc_keyboardButtonGame: _type = cons; {
-			if (!data) setData(new MTPDkeyboardButtonGame());
+			if (!data) setData(mtpNewData<MTPDkeyboardButtonGame>());
 			MTPDkeyboardButtonGame &v(_keyboardButtonGame());
 			v.vtext.read(from, end);
 		} break;
@@ -33879,7 +33879,7 @@ inline mtpTypeId MTPkeyboardButtonRow::type() const {
 inline void MTPkeyboardButtonRow::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_keyboardButtonRow) throw mtpErrorUnexpected(cons, "MTPkeyboardButtonRow");
 
-	if (!data) setData(new MTPDkeyboardButtonRow());
+	if (!data) setData(mtpNewData<MTPDkeyboardButtonRow>());
 	MTPDkeyboardButtonRow &v(_keyboardButtonRow());
 	v.vbuttons.read(from, end);
 }
@@ -33922,23 +33922,23 @@ inline void MTPreplyMarkup::read(const mtpPrime *&from, const mtpPrime *end, mtp
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_replyKeyboardHide: _type = cons; {
-			if (!data) setData(new MTPDreplyKeyboardHide());
+			if (!data) setData(mtpNewData<MTPDreplyKeyboardHide>());
 			MTPDreplyKeyboardHide &v(_replyKeyboardHide());
 			v.vflags.read(from, end);
 		} break;
 		case mtpc_replyKeyboardForceReply: _type = cons; {
-			if (!data) setData(new MTPDreplyKeyboardForceReply());
+			if (!data) setData(mtpNewData<MTPDreplyKeyboardForceReply>());
 			MTPDreplyKeyboardForceReply &v(_replyKeyboardForceReply());
 			v.vflags.read(from, end);
 		} break;
 		case mtpc_replyKeyboardMarkup: _type = cons; {
-			if (!data) setData(new MTPDreplyKeyboardMarkup());
+			if (!data) setData(mtpNewData<MTPDreplyKeyboardMarkup>());
 			MTPDreplyKeyboardMarkup &v(_replyKeyboardMarkup());
 			v.vflags.read(from, end);
 			v.vrows.read(from, end);
 		} break;
 		case mtpc_replyInlineMarkup: _type = cons; {
-			if (!data) setData(new MTPDreplyInlineMarkup());
+			if (!data) setData(mtpNewData<MTPDreplyInlineMarkup>());
 			MTPDreplyInlineMarkup &v(_replyInlineMarkup());
 			v.vrows.read(from, end);
 		} break;
@@ -34017,7 +34017,7 @@ inline void MTPhelp_appChangelog::read(const mtpPrime *&from, const mtpPrime *en
 	switch (cons) {
 		case mtpc_help_appChangelogEmpty: _type = cons; break;
 		case mtpc_help_appChangelog: _type = cons; {
-			if (!data) setData(new MTPDhelp_appChangelog());
+			if (!data) setData(mtpNewData<MTPDhelp_appChangelog>());
 			MTPDhelp_appChangelog &v(_help_appChangelog());
 			v.vtext.read(from, end);
 		} break;
@@ -34113,82 +34113,82 @@ inline void MTPmessageEntity::read(const mtpPrime *&from, const mtpPrime *end, m
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_messageEntityUnknown: _type = cons; {
-			if (!data) setData(new MTPDmessageEntityUnknown());
+			if (!data) setData(mtpNewData<MTPDmessageEntityUnknown>());
 			MTPDmessageEntityUnknown &v(_messageEntityUnknown());
 			v.voffset.read(from, end);
 			v.vlength.read(from, end);
 		} break;
 		case mtpc_messageEntityMention: _type = cons; {
-			if (!data) setData(new MTPDmessageEntityMention());
+			if (!data) setData(mtpNewData<MTPDmessageEntityMention>());
 			MTPDmessageEntityMention &v(_messageEntityMention());
 			v.voffset.read(from, end);
 			v.vlength.read(from, end);
 		} break;
 		case mtpc_messageEntityHashtag: _type = cons; {
-			if (!data) setData(new MTPDmessageEntityHashtag());
+			if (!data) setData(mtpNewData<MTPDmessageEntityHashtag>());
 			MTPDmessageEntityHashtag &v(_messageEntityHashtag());
 			v.voffset.read(from, end);
 			v.vlength.read(from, end);
 		} break;
 		case mtpc_messageEntityBotCommand: _type = cons; {
-			if (!data) setData(new MTPDmessageEntityBotCommand());
+			if (!data) setData(mtpNewData<MTPDmessageEntityBotCommand>());
 			MTPDmessageEntityBotCommand &v(_messageEntityBotCommand());
 			v.voffset.read(from, end);
 			v.vlength.read(from, end);
 		} break;
 		case mtpc_messageEntityUrl: _type = cons; {
-			if (!data) setData(new MTPDmessageEntityUrl());
+			if (!data) setData(mtpNewData<MTPDmessageEntityUrl>());
 			MTPDmessageEntityUrl &v(_messageEntityUrl());
 			v.voffset.read(from, end);
 			v.vlength.read(from, end);
 		} break;
 		case mtpc_messageEntityEmail: _type = cons; {
-			if (!data) setData(new MTPDmessageEntityEmail());
+			if (!data) setData(mtpNewData<MTPDmessageEntityEmail>());
 			MTPDmessageEntityEmail &v(_messageEntityEmail());
 			v.voffset.read(from, end);
 			v.vlength.read(from, end);
 		} break;
 		case mtpc_messageEntityBold: _type = cons; {
-			if (!data) setData(new MTPDmessageEntityBold());
+			if (!data) setData(mtpNewData<MTPDmessageEntityBold>());
 			MTPDmessageEntityBold &v(_messageEntityBold());
 			v.voffset.read(from, end);
 			v.vlength.read(from, end);
 		} break;
 		case mtpc_messageEntityItalic: _type = cons; {
-			if (!data) setData(new MTPDmessageEntityItalic());
+			if (!data) setData(mtpNewData<MTPDmessageEntityItalic>());
 			MTPDmessageEntityItalic &v(_messageEntityItalic());
 			v.voffset.read(from, end);
 			v.vlength.read(from, end);
 		} break;
 		case mtpc_messageEntityCode: _type = cons; {
-			if (!data) setData(new MTPDmessageEntityCode());
+			if (!data) setData(mtpNewData<MTPDmessageEntityCode>());
 			MTPDmessageEntityCode &v(_messageEntityCode());
 			v.voffset.read(from, end);
 			v.vlength.read(from, end);
 		} break;
 		case mtpc_messageEntityPre: _type = cons; {
-			if (!data) setData(new MTPDmessageEntityPre());
+			if (!data) setData(mtpNewData<MTPDmessageEntityPre>());
 			MTPDmessageEntityPre &v(_messageEntityPre());
 			v.voffset.read(from, end);
 			v.vlength.read(from, end);
 			v.vlanguage.read(from, end);
 		} break;
 		case mtpc_messageEntityTextUrl: _type = cons; {
-			if (!data) setData(new MTPDmessageEntityTextUrl());
+			if (!data) setData(mtpNewData<MTPDmessageEntityTextUrl>());
 			MTPDmessageEntityTextUrl &v(_messageEntityTextUrl());
 			v.voffset.read(from, end);
 			v.vlength.read(from, end);
 			v.vurl.read(from, end);
 		} break;
 		case mtpc_messageEntityMentionName: _type = cons; {
-			if (!data) setData(new MTPDmessageEntityMentionName());
+			if (!data) setData(mtpNewData<MTPDmessageEntityMentionName>());
 			MTPDmessageEntityMentionName &v(_messageEntityMentionName());
 			v.voffset.read(from, end);
 			v.vlength.read(from, end);
 			v.vuser_id.read(from, end);
 		} break;
 		case mtpc_inputMessageEntityMentionName: _type = cons; {
-			if (!data) setData(new MTPDinputMessageEntityMentionName());
+			if (!data) setData(mtpNewData<MTPDinputMessageEntityMentionName>());
 			MTPDinputMessageEntityMentionName &v(_inputMessageEntityMentionName());
 			v.voffset.read(from, end);
 			v.vlength.read(from, end);
@@ -34372,7 +34372,7 @@ inline void MTPinputChannel::read(const mtpPrime *&from, const mtpPrime *end, mt
 	switch (cons) {
 		case mtpc_inputChannelEmpty: _type = cons; break;
 		case mtpc_inputChannel: _type = cons; {
-			if (!data) setData(new MTPDinputChannel());
+			if (!data) setData(mtpNewData<MTPDinputChannel>());
 			MTPDinputChannel &v(_inputChannel());
 			v.vchannel_id.read(from, end);
 			v.vaccess_hash.read(from, end);
@@ -34418,7 +34418,7 @@ inline mtpTypeId MTPcontacts_resolvedPeer::type() const {
 inline void MTPcontacts_resolvedPeer::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_contacts_resolvedPeer) throw mtpErrorUnexpected(cons, "MTPcontacts_resolvedPeer");
 
-	if (!data) setData(new MTPDcontacts_resolvedPeer());
+	if (!data) setData(mtpNewData<MTPDcontacts_resolvedPeer>());
 	MTPDcontacts_resolvedPeer &v(_contacts_resolvedPeer());
 	v.vpeer.read(from, end);
 	v.vchats.read(from, end);
@@ -34449,7 +34449,7 @@ inline mtpTypeId MTPmessageRange::type() const {
 inline void MTPmessageRange::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_messageRange) throw mtpErrorUnexpected(cons, "MTPmessageRange");
 
-	if (!data) setData(new MTPDmessageRange());
+	if (!data) setData(mtpNewData<MTPDmessageRange>());
 	MTPDmessageRange &v(_messageRange());
 	v.vmin_id.read(from, end);
 	v.vmax_id.read(from, end);
@@ -34490,14 +34490,14 @@ inline void MTPupdates_channelDifference::read(const mtpPrime *&from, const mtpP
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_updates_channelDifferenceEmpty: _type = cons; {
-			if (!data) setData(new MTPDupdates_channelDifferenceEmpty());
+			if (!data) setData(mtpNewData<MTPDupdates_channelDifferenceEmpty>());
 			MTPDupdates_channelDifferenceEmpty &v(_updates_channelDifferenceEmpty());
 			v.vflags.read(from, end);
 			v.vpts.read(from, end);
 			if (v.has_timeout()) { v.vtimeout.read(from, end); } else { v.vtimeout = MTPint(); }
 		} break;
 		case mtpc_updates_channelDifferenceTooLong: _type = cons; {
-			if (!data) setData(new MTPDupdates_channelDifferenceTooLong());
+			if (!data) setData(mtpNewData<MTPDupdates_channelDifferenceTooLong>());
 			MTPDupdates_channelDifferenceTooLong &v(_updates_channelDifferenceTooLong());
 			v.vflags.read(from, end);
 			v.vpts.read(from, end);
@@ -34511,7 +34511,7 @@ inline void MTPupdates_channelDifference::read(const mtpPrime *&from, const mtpP
 			v.vusers.read(from, end);
 		} break;
 		case mtpc_updates_channelDifference: _type = cons; {
-			if (!data) setData(new MTPDupdates_channelDifference());
+			if (!data) setData(mtpNewData<MTPDupdates_channelDifference>());
 			MTPDupdates_channelDifference &v(_updates_channelDifference());
 			v.vflags.read(from, end);
 			v.vpts.read(from, end);
@@ -34602,7 +34602,7 @@ inline void MTPchannelMessagesFilter::read(const mtpPrime *&from, const mtpPrime
 	switch (cons) {
 		case mtpc_channelMessagesFilterEmpty: _type = cons; break;
 		case mtpc_channelMessagesFilter: _type = cons; {
-			if (!data) setData(new MTPDchannelMessagesFilter());
+			if (!data) setData(mtpNewData<MTPDchannelMessagesFilter>());
 			MTPDchannelMessagesFilter &v(_channelMessagesFilter());
 			v.vflags.read(from, end);
 			v.vranges.read(from, end);
@@ -34673,41 +34673,41 @@ inline void MTPchannelParticipant::read(const mtpPrime *&from, const mtpPrime *e
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_channelParticipant: _type = cons; {
-			if (!data) setData(new MTPDchannelParticipant());
+			if (!data) setData(mtpNewData<MTPDchannelParticipant>());
 			MTPDchannelParticipant &v(_channelParticipant());
 			v.vuser_id.read(from, end);
 			v.vdate.read(from, end);
 		} break;
 		case mtpc_channelParticipantSelf: _type = cons; {
-			if (!data) setData(new MTPDchannelParticipantSelf());
+			if (!data) setData(mtpNewData<MTPDchannelParticipantSelf>());
 			MTPDchannelParticipantSelf &v(_channelParticipantSelf());
 			v.vuser_id.read(from, end);
 			v.vinviter_id.read(from, end);
 			v.vdate.read(from, end);
 		} break;
 		case mtpc_channelParticipantModerator: _type = cons; {
-			if (!data) setData(new MTPDchannelParticipantModerator());
+			if (!data) setData(mtpNewData<MTPDchannelParticipantModerator>());
 			MTPDchannelParticipantModerator &v(_channelParticipantModerator());
 			v.vuser_id.read(from, end);
 			v.vinviter_id.read(from, end);
 			v.vdate.read(from, end);
 		} break;
 		case mtpc_channelParticipantEditor: _type = cons; {
-			if (!data) setData(new MTPDchannelParticipantEditor());
+			if (!data) setData(mtpNewData<MTPDchannelParticipantEditor>());
 			MTPDchannelParticipantEditor &v(_channelParticipantEditor());
 			v.vuser_id.read(from, end);
 			v.vinviter_id.read(from, end);
 			v.vdate.read(from, end);
 		} break;
 		case mtpc_channelParticipantKicked: _type = cons; {
-			if (!data) setData(new MTPDchannelParticipantKicked());
+			if (!data) setData(mtpNewData<MTPDchannelParticipantKicked>());
 			MTPDchannelParticipantKicked &v(_channelParticipantKicked());
 			v.vuser_id.read(from, end);
 			v.vkicked_by.read(from, end);
 			v.vdate.read(from, end);
 		} break;
 		case mtpc_channelParticipantCreator: _type = cons; {
-			if (!data) setData(new MTPDchannelParticipantCreator());
+			if (!data) setData(mtpNewData<MTPDchannelParticipantCreator>());
 			MTPDchannelParticipantCreator &v(_channelParticipantCreator());
 			v.vuser_id.read(from, end);
 		} break;
@@ -34881,7 +34881,7 @@ inline mtpTypeId MTPchannels_channelParticipants::type() const {
 inline void MTPchannels_channelParticipants::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_channels_channelParticipants) throw mtpErrorUnexpected(cons, "MTPchannels_channelParticipants");
 
-	if (!data) setData(new MTPDchannels_channelParticipants());
+	if (!data) setData(mtpNewData<MTPDchannels_channelParticipants>());
 	MTPDchannels_channelParticipants &v(_channels_channelParticipants());
 	v.vcount.read(from, end);
 	v.vparticipants.read(from, end);
@@ -34912,7 +34912,7 @@ inline mtpTypeId MTPchannels_channelParticipant::type() const {
 inline void MTPchannels_channelParticipant::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_channels_channelParticipant) throw mtpErrorUnexpected(cons, "MTPchannels_channelParticipant");
 
-	if (!data) setData(new MTPDchannels_channelParticipant());
+	if (!data) setData(mtpNewData<MTPDchannels_channelParticipant>());
 	MTPDchannels_channelParticipant &v(_channels_channelParticipant());
 	v.vparticipant.read(from, end);
 	v.vusers.read(from, end);
@@ -34941,7 +34941,7 @@ inline mtpTypeId MTPhelp_termsOfService::type() const {
 inline void MTPhelp_termsOfService::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_help_termsOfService) throw mtpErrorUnexpected(cons, "MTPhelp_termsOfService");
 
-	if (!data) setData(new MTPDhelp_termsOfService());
+	if (!data) setData(mtpNewData<MTPDhelp_termsOfService>());
 	MTPDhelp_termsOfService &v(_help_termsOfService());
 	v.vtext.read(from, end);
 }
@@ -34976,7 +34976,7 @@ inline void MTPfoundGif::read(const mtpPrime *&from, const mtpPrime *end, mtpTyp
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_foundGif: _type = cons; {
-			if (!data) setData(new MTPDfoundGif());
+			if (!data) setData(mtpNewData<MTPDfoundGif>());
 			MTPDfoundGif &v(_foundGif());
 			v.vurl.read(from, end);
 			v.vthumb_url.read(from, end);
@@ -34986,7 +34986,7 @@ inline void MTPfoundGif::read(const mtpPrime *&from, const mtpPrime *end, mtpTyp
 			v.vh.read(from, end);
 		} break;
 		case mtpc_foundGifCached: _type = cons; {
-			if (!data) setData(new MTPDfoundGifCached());
+			if (!data) setData(mtpNewData<MTPDfoundGifCached>());
 			MTPDfoundGifCached &v(_foundGifCached());
 			v.vurl.read(from, end);
 			v.vphoto.read(from, end);
@@ -35045,7 +35045,7 @@ inline mtpTypeId MTPmessages_foundGifs::type() const {
 inline void MTPmessages_foundGifs::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_messages_foundGifs) throw mtpErrorUnexpected(cons, "MTPmessages_foundGifs");
 
-	if (!data) setData(new MTPDmessages_foundGifs());
+	if (!data) setData(mtpNewData<MTPDmessages_foundGifs>());
 	MTPDmessages_foundGifs &v(_messages_foundGifs());
 	v.vnext_offset.read(from, end);
 	v.vresults.read(from, end);
@@ -35079,7 +35079,7 @@ inline void MTPmessages_savedGifs::read(const mtpPrime *&from, const mtpPrime *e
 	switch (cons) {
 		case mtpc_messages_savedGifsNotModified: _type = cons; break;
 		case mtpc_messages_savedGifs: _type = cons; {
-			if (!data) setData(new MTPDmessages_savedGifs());
+			if (!data) setData(mtpNewData<MTPDmessages_savedGifs>());
 			MTPDmessages_savedGifs &v(_messages_savedGifs());
 			v.vhash.read(from, end);
 			v.vgifs.read(from, end);
@@ -35149,14 +35149,14 @@ inline void MTPinputBotInlineMessage::read(const mtpPrime *&from, const mtpPrime
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_inputBotInlineMessageMediaAuto: _type = cons; {
-			if (!data) setData(new MTPDinputBotInlineMessageMediaAuto());
+			if (!data) setData(mtpNewData<MTPDinputBotInlineMessageMediaAuto>());
 			MTPDinputBotInlineMessageMediaAuto &v(_inputBotInlineMessageMediaAuto());
 			v.vflags.read(from, end);
 			v.vcaption.read(from, end);
 			if (v.has_reply_markup()) { v.vreply_markup.read(from, end); } else { v.vreply_markup = MTPReplyMarkup(); }
 		} break;
 		case mtpc_inputBotInlineMessageText: _type = cons; {
-			if (!data) setData(new MTPDinputBotInlineMessageText());
+			if (!data) setData(mtpNewData<MTPDinputBotInlineMessageText>());
 			MTPDinputBotInlineMessageText &v(_inputBotInlineMessageText());
 			v.vflags.read(from, end);
 			v.vmessage.read(from, end);
@@ -35164,14 +35164,14 @@ inline void MTPinputBotInlineMessage::read(const mtpPrime *&from, const mtpPrime
 			if (v.has_reply_markup()) { v.vreply_markup.read(from, end); } else { v.vreply_markup = MTPReplyMarkup(); }
 		} break;
 		case mtpc_inputBotInlineMessageMediaGeo: _type = cons; {
-			if (!data) setData(new MTPDinputBotInlineMessageMediaGeo());
+			if (!data) setData(mtpNewData<MTPDinputBotInlineMessageMediaGeo>());
 			MTPDinputBotInlineMessageMediaGeo &v(_inputBotInlineMessageMediaGeo());
 			v.vflags.read(from, end);
 			v.vgeo_point.read(from, end);
 			if (v.has_reply_markup()) { v.vreply_markup.read(from, end); } else { v.vreply_markup = MTPReplyMarkup(); }
 		} break;
 		case mtpc_inputBotInlineMessageMediaVenue: _type = cons; {
-			if (!data) setData(new MTPDinputBotInlineMessageMediaVenue());
+			if (!data) setData(mtpNewData<MTPDinputBotInlineMessageMediaVenue>());
 			MTPDinputBotInlineMessageMediaVenue &v(_inputBotInlineMessageMediaVenue());
 			v.vflags.read(from, end);
 			v.vgeo_point.read(from, end);
@@ -35182,7 +35182,7 @@ inline void MTPinputBotInlineMessage::read(const mtpPrime *&from, const mtpPrime
 			if (v.has_reply_markup()) { v.vreply_markup.read(from, end); } else { v.vreply_markup = MTPReplyMarkup(); }
 		} break;
 		case mtpc_inputBotInlineMessageMediaContact: _type = cons; {
-			if (!data) setData(new MTPDinputBotInlineMessageMediaContact());
+			if (!data) setData(mtpNewData<MTPDinputBotInlineMessageMediaContact>());
 			MTPDinputBotInlineMessageMediaContact &v(_inputBotInlineMessageMediaContact());
 			v.vflags.read(from, end);
 			v.vphone_number.read(from, end);
@@ -35191,7 +35191,7 @@ inline void MTPinputBotInlineMessage::read(const mtpPrime *&from, const mtpPrime
 			if (v.has_reply_markup()) { v.vreply_markup.read(from, end); } else { v.vreply_markup = MTPReplyMarkup(); }
 		} break;
 		case mtpc_inputBotInlineMessageGame: _type = cons; {
-			if (!data) setData(new MTPDinputBotInlineMessageGame());
+			if (!data) setData(mtpNewData<MTPDinputBotInlineMessageGame>());
 			MTPDinputBotInlineMessageGame &v(_inputBotInlineMessageGame());
 			v.vflags.read(from, end);
 			if (v.has_reply_markup()) { v.vreply_markup.read(from, end); } else { v.vreply_markup = MTPReplyMarkup(); }
@@ -35322,7 +35322,7 @@ inline void MTPinputBotInlineResult::read(const mtpPrime *&from, const mtpPrime
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_inputBotInlineResult: _type = cons; {
-			if (!data) setData(new MTPDinputBotInlineResult());
+			if (!data) setData(mtpNewData<MTPDinputBotInlineResult>());
 			MTPDinputBotInlineResult &v(_inputBotInlineResult());
 			v.vflags.read(from, end);
 			v.vid.read(from, end);
@@ -35339,7 +35339,7 @@ inline void MTPinputBotInlineResult::read(const mtpPrime *&from, const mtpPrime
 			v.vsend_message.read(from, end);
 		} break;
 		case mtpc_inputBotInlineResultPhoto: _type = cons; {
-			if (!data) setData(new MTPDinputBotInlineResultPhoto());
+			if (!data) setData(mtpNewData<MTPDinputBotInlineResultPhoto>());
 			MTPDinputBotInlineResultPhoto &v(_inputBotInlineResultPhoto());
 			v.vid.read(from, end);
 			v.vtype.read(from, end);
@@ -35347,7 +35347,7 @@ inline void MTPinputBotInlineResult::read(const mtpPrime *&from, const mtpPrime
 			v.vsend_message.read(from, end);
 		} break;
 		case mtpc_inputBotInlineResultDocument: _type = cons; {
-			if (!data) setData(new MTPDinputBotInlineResultDocument());
+			if (!data) setData(mtpNewData<MTPDinputBotInlineResultDocument>());
 			MTPDinputBotInlineResultDocument &v(_inputBotInlineResultDocument());
 			v.vflags.read(from, end);
 			v.vid.read(from, end);
@@ -35358,7 +35358,7 @@ inline void MTPinputBotInlineResult::read(const mtpPrime *&from, const mtpPrime
 			v.vsend_message.read(from, end);
 		} break;
 		case mtpc_inputBotInlineResultGame: _type = cons; {
-			if (!data) setData(new MTPDinputBotInlineResultGame());
+			if (!data) setData(mtpNewData<MTPDinputBotInlineResultGame>());
 			MTPDinputBotInlineResultGame &v(_inputBotInlineResultGame());
 			v.vid.read(from, end);
 			v.vshort_name.read(from, end);
@@ -35475,14 +35475,14 @@ inline void MTPbotInlineMessage::read(const mtpPrime *&from, const mtpPrime *end
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_botInlineMessageMediaAuto: _type = cons; {
-			if (!data) setData(new MTPDbotInlineMessageMediaAuto());
+			if (!data) setData(mtpNewData<MTPDbotInlineMessageMediaAuto>());
 			MTPDbotInlineMessageMediaAuto &v(_botInlineMessageMediaAuto());
 			v.vflags.read(from, end);
 			v.vcaption.read(from, end);
 			if (v.has_reply_markup()) { v.vreply_markup.read(from, end); } else { v.vreply_markup = MTPReplyMarkup(); }
 		} break;
 		case mtpc_botInlineMessageText: _type = cons; {
-			if (!data) setData(new MTPDbotInlineMessageText());
+			if (!data) setData(mtpNewData<MTPDbotInlineMessageText>());
 			MTPDbotInlineMessageText &v(_botInlineMessageText());
 			v.vflags.read(from, end);
 			v.vmessage.read(from, end);
@@ -35490,14 +35490,14 @@ inline void MTPbotInlineMessage::read(const mtpPrime *&from, const mtpPrime *end
 			if (v.has_reply_markup()) { v.vreply_markup.read(from, end); } else { v.vreply_markup = MTPReplyMarkup(); }
 		} break;
 		case mtpc_botInlineMessageMediaGeo: _type = cons; {
-			if (!data) setData(new MTPDbotInlineMessageMediaGeo());
+			if (!data) setData(mtpNewData<MTPDbotInlineMessageMediaGeo>());
 			MTPDbotInlineMessageMediaGeo &v(_botInlineMessageMediaGeo());
 			v.vflags.read(from, end);
 			v.vgeo.read(from, end);
 			if (v.has_reply_markup()) { v.vreply_markup.read(from, end); } else { v.vreply_markup = MTPReplyMarkup(); }
 		} break;
 		case mtpc_botInlineMessageMediaVenue: _type = cons; {
-			if (!data) setData(new MTPDbotInlineMessageMediaVenue());
+			if (!data) setData(mtpNewData<MTPDbotInlineMessageMediaVenue>());
 			MTPDbotInlineMessageMediaVenue &v(_botInlineMessageMediaVenue());
 			v.vflags.read(from, end);
 			v.vgeo.read(from, end);
@@ -35508,7 +35508,7 @@ inline void MTPbotInlineMessage::read(const mtpPrime *&from, const mtpPrime *end
 			if (v.has_reply_markup()) { v.vreply_markup.read(from, end); } else { v.vreply_markup = MTPReplyMarkup(); }
 		} break;
 		case mtpc_botInlineMessageMediaContact: _type = cons; {
-			if (!data) setData(new MTPDbotInlineMessageMediaContact());
+			if (!data) setData(mtpNewData<MTPDbotInlineMessageMediaContact>());
 			MTPDbotInlineMessageMediaContact &v(_botInlineMessageMediaContact());
 			v.vflags.read(from, end);
 			v.vphone_number.read(from, end);
@@ -35622,7 +35622,7 @@ inline void MTPbotInlineResult::read(const mtpPrime *&from, const mtpPrime *end,
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_botInlineResult: _type = cons; {
-			if (!data) setData(new MTPDbotInlineResult());
+			if (!data) setData(mtpNewData<MTPDbotInlineResult>());
 			MTPDbotInlineResult &v(_botInlineResult());
 			v.vflags.read(from, end);
 			v.vid.read(from, end);
@@ -35639,7 +35639,7 @@ inline void MTPbotInlineResult::read(const mtpPrime *&from, const mtpPrime *end,
 			v.vsend_message.read(from, end);
 		} break;
 		case mtpc_botInlineMediaResult: _type = cons; {
-			if (!data) setData(new MTPDbotInlineMediaResult());
+			if (!data) setData(mtpNewData<MTPDbotInlineMediaResult>());
 			MTPDbotInlineMediaResult &v(_botInlineMediaResult());
 			v.vflags.read(from, end);
 			v.vid.read(from, end);
@@ -35717,7 +35717,7 @@ inline mtpTypeId MTPmessages_botResults::type() const {
 inline void MTPmessages_botResults::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_messages_botResults) throw mtpErrorUnexpected(cons, "MTPmessages_botResults");
 
-	if (!data) setData(new MTPDmessages_botResults());
+	if (!data) setData(mtpNewData<MTPDmessages_botResults>());
 	MTPDmessages_botResults &v(_messages_botResults());
 	v.vflags.read(from, end);
 	v.vquery_id.read(from, end);
@@ -35753,7 +35753,7 @@ inline mtpTypeId MTPexportedMessageLink::type() const {
 inline void MTPexportedMessageLink::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_exportedMessageLink) throw mtpErrorUnexpected(cons, "MTPexportedMessageLink");
 
-	if (!data) setData(new MTPDexportedMessageLink());
+	if (!data) setData(mtpNewData<MTPDexportedMessageLink>());
 	MTPDexportedMessageLink &v(_exportedMessageLink());
 	v.vlink.read(from, end);
 }
@@ -35780,7 +35780,7 @@ inline mtpTypeId MTPmessageFwdHeader::type() const {
 inline void MTPmessageFwdHeader::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_messageFwdHeader) throw mtpErrorUnexpected(cons, "MTPmessageFwdHeader");
 
-	if (!data) setData(new MTPDmessageFwdHeader());
+	if (!data) setData(mtpNewData<MTPDmessageFwdHeader>());
 	MTPDmessageFwdHeader &v(_messageFwdHeader());
 	v.vflags.read(from, end);
 	if (v.has_from_id()) { v.vfrom_id.read(from, end); } else { v.vfrom_id = MTPint(); }
@@ -35867,22 +35867,22 @@ inline void MTPauth_sentCodeType::read(const mtpPrime *&from, const mtpPrime *en
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_auth_sentCodeTypeApp: _type = cons; {
-			if (!data) setData(new MTPDauth_sentCodeTypeApp());
+			if (!data) setData(mtpNewData<MTPDauth_sentCodeTypeApp>());
 			MTPDauth_sentCodeTypeApp &v(_auth_sentCodeTypeApp());
 			v.vlength.read(from, end);
 		} break;
 		case mtpc_auth_sentCodeTypeSms: _type = cons; {
-			if (!data) setData(new MTPDauth_sentCodeTypeSms());
+			if (!data) setData(mtpNewData<MTPDauth_sentCodeTypeSms>());
 			MTPDauth_sentCodeTypeSms &v(_auth_sentCodeTypeSms());
 			v.vlength.read(from, end);
 		} break;
 		case mtpc_auth_sentCodeTypeCall: _type = cons; {
-			if (!data) setData(new MTPDauth_sentCodeTypeCall());
+			if (!data) setData(mtpNewData<MTPDauth_sentCodeTypeCall>());
 			MTPDauth_sentCodeTypeCall &v(_auth_sentCodeTypeCall());
 			v.vlength.read(from, end);
 		} break;
 		case mtpc_auth_sentCodeTypeFlashCall: _type = cons; {
-			if (!data) setData(new MTPDauth_sentCodeTypeFlashCall());
+			if (!data) setData(mtpNewData<MTPDauth_sentCodeTypeFlashCall>());
 			MTPDauth_sentCodeTypeFlashCall &v(_auth_sentCodeTypeFlashCall());
 			v.vpattern.read(from, end);
 		} break;
@@ -35952,7 +35952,7 @@ inline mtpTypeId MTPmessages_botCallbackAnswer::type() const {
 inline void MTPmessages_botCallbackAnswer::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_messages_botCallbackAnswer) throw mtpErrorUnexpected(cons, "MTPmessages_botCallbackAnswer");
 
-	if (!data) setData(new MTPDmessages_botCallbackAnswer());
+	if (!data) setData(mtpNewData<MTPDmessages_botCallbackAnswer>());
 	MTPDmessages_botCallbackAnswer &v(_messages_botCallbackAnswer());
 	v.vflags.read(from, end);
 	if (v.has_message()) { v.vmessage.read(from, end); } else { v.vmessage = MTPstring(); }
@@ -35984,7 +35984,7 @@ inline mtpTypeId MTPmessages_messageEditData::type() const {
 inline void MTPmessages_messageEditData::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_messages_messageEditData) throw mtpErrorUnexpected(cons, "MTPmessages_messageEditData");
 
-	if (!data) setData(new MTPDmessages_messageEditData());
+	if (!data) setData(mtpNewData<MTPDmessages_messageEditData>());
 	MTPDmessages_messageEditData &v(_messages_messageEditData());
 	v.vflags.read(from, end);
 }
@@ -36012,7 +36012,7 @@ inline mtpTypeId MTPinputBotInlineMessageID::type() const {
 inline void MTPinputBotInlineMessageID::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_inputBotInlineMessageID) throw mtpErrorUnexpected(cons, "MTPinputBotInlineMessageID");
 
-	if (!data) setData(new MTPDinputBotInlineMessageID());
+	if (!data) setData(mtpNewData<MTPDinputBotInlineMessageID>());
 	MTPDinputBotInlineMessageID &v(_inputBotInlineMessageID());
 	v.vdc_id.read(from, end);
 	v.vid.read(from, end);
@@ -36043,7 +36043,7 @@ inline mtpTypeId MTPinlineBotSwitchPM::type() const {
 inline void MTPinlineBotSwitchPM::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_inlineBotSwitchPM) throw mtpErrorUnexpected(cons, "MTPinlineBotSwitchPM");
 
-	if (!data) setData(new MTPDinlineBotSwitchPM());
+	if (!data) setData(mtpNewData<MTPDinlineBotSwitchPM>());
 	MTPDinlineBotSwitchPM &v(_inlineBotSwitchPM());
 	v.vtext.read(from, end);
 	v.vstart_param.read(from, end);
@@ -36072,7 +36072,7 @@ inline mtpTypeId MTPmessages_peerDialogs::type() const {
 inline void MTPmessages_peerDialogs::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_messages_peerDialogs) throw mtpErrorUnexpected(cons, "MTPmessages_peerDialogs");
 
-	if (!data) setData(new MTPDmessages_peerDialogs());
+	if (!data) setData(mtpNewData<MTPDmessages_peerDialogs>());
 	MTPDmessages_peerDialogs &v(_messages_peerDialogs());
 	v.vdialogs.read(from, end);
 	v.vmessages.read(from, end);
@@ -36107,7 +36107,7 @@ inline mtpTypeId MTPtopPeer::type() const {
 inline void MTPtopPeer::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_topPeer) throw mtpErrorUnexpected(cons, "MTPtopPeer");
 
-	if (!data) setData(new MTPDtopPeer());
+	if (!data) setData(mtpNewData<MTPDtopPeer>());
 	MTPDtopPeer &v(_topPeer());
 	v.vpeer.read(from, end);
 	v.vrating.read(from, end);
@@ -36181,7 +36181,7 @@ inline mtpTypeId MTPtopPeerCategoryPeers::type() const {
 inline void MTPtopPeerCategoryPeers::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_topPeerCategoryPeers) throw mtpErrorUnexpected(cons, "MTPtopPeerCategoryPeers");
 
-	if (!data) setData(new MTPDtopPeerCategoryPeers());
+	if (!data) setData(mtpNewData<MTPDtopPeerCategoryPeers>());
 	MTPDtopPeerCategoryPeers &v(_topPeerCategoryPeers());
 	v.vcategory.read(from, end);
 	v.vcount.read(from, end);
@@ -36217,7 +36217,7 @@ inline void MTPcontacts_topPeers::read(const mtpPrime *&from, const mtpPrime *en
 	switch (cons) {
 		case mtpc_contacts_topPeersNotModified: _type = cons; break;
 		case mtpc_contacts_topPeers: _type = cons; {
-			if (!data) setData(new MTPDcontacts_topPeers());
+			if (!data) setData(mtpNewData<MTPDcontacts_topPeers>());
 			MTPDcontacts_topPeers &v(_contacts_topPeers());
 			v.vcategories.read(from, end);
 			v.vchats.read(from, end);
@@ -36270,7 +36270,7 @@ inline void MTPdraftMessage::read(const mtpPrime *&from, const mtpPrime *end, mt
 	switch (cons) {
 		case mtpc_draftMessageEmpty: _type = cons; break;
 		case mtpc_draftMessage: _type = cons; {
-			if (!data) setData(new MTPDdraftMessage());
+			if (!data) setData(mtpNewData<MTPDdraftMessage>());
 			MTPDdraftMessage &v(_draftMessage());
 			v.vflags.read(from, end);
 			if (v.has_reply_to_msg_id()) { v.vreply_to_msg_id.read(from, end); } else { v.vreply_to_msg_id = MTPint(); }
@@ -36328,7 +36328,7 @@ inline void MTPmessages_featuredStickers::read(const mtpPrime *&from, const mtpP
 	switch (cons) {
 		case mtpc_messages_featuredStickersNotModified: _type = cons; break;
 		case mtpc_messages_featuredStickers: _type = cons; {
-			if (!data) setData(new MTPDmessages_featuredStickers());
+			if (!data) setData(mtpNewData<MTPDmessages_featuredStickers>());
 			MTPDmessages_featuredStickers &v(_messages_featuredStickers());
 			v.vhash.read(from, end);
 			v.vsets.read(from, end);
@@ -36381,7 +36381,7 @@ inline void MTPmessages_recentStickers::read(const mtpPrime *&from, const mtpPri
 	switch (cons) {
 		case mtpc_messages_recentStickersNotModified: _type = cons; break;
 		case mtpc_messages_recentStickers: _type = cons; {
-			if (!data) setData(new MTPDmessages_recentStickers());
+			if (!data) setData(mtpNewData<MTPDmessages_recentStickers>());
 			MTPDmessages_recentStickers &v(_messages_recentStickers());
 			v.vhash.read(from, end);
 			v.vstickers.read(from, end);
@@ -36427,7 +36427,7 @@ inline mtpTypeId MTPmessages_archivedStickers::type() const {
 inline void MTPmessages_archivedStickers::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_messages_archivedStickers) throw mtpErrorUnexpected(cons, "MTPmessages_archivedStickers");
 
-	if (!data) setData(new MTPDmessages_archivedStickers());
+	if (!data) setData(mtpNewData<MTPDmessages_archivedStickers>());
 	MTPDmessages_archivedStickers &v(_messages_archivedStickers());
 	v.vcount.read(from, end);
 	v.vsets.read(from, end);
@@ -36461,7 +36461,7 @@ inline void MTPmessages_stickerSetInstallResult::read(const mtpPrime *&from, con
 	switch (cons) {
 		case mtpc_messages_stickerSetInstallResultSuccess: _type = cons; break;
 		case mtpc_messages_stickerSetInstallResultArchive: _type = cons; {
-			if (!data) setData(new MTPDmessages_stickerSetInstallResultArchive());
+			if (!data) setData(mtpNewData<MTPDmessages_stickerSetInstallResultArchive>());
 			MTPDmessages_stickerSetInstallResultArchive &v(_messages_stickerSetInstallResultArchive());
 			v.vsets.read(from, end);
 		} break;
@@ -36513,13 +36513,13 @@ inline void MTPstickerSetCovered::read(const mtpPrime *&from, const mtpPrime *en
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_stickerSetCovered: _type = cons; {
-			if (!data) setData(new MTPDstickerSetCovered());
+			if (!data) setData(mtpNewData<MTPDstickerSetCovered>());
 			MTPDstickerSetCovered &v(_stickerSetCovered());
 			v.vset.read(from, end);
 			v.vcover.read(from, end);
 		} break;
 		case mtpc_stickerSetMultiCovered: _type = cons; {
-			if (!data) setData(new MTPDstickerSetMultiCovered());
+			if (!data) setData(mtpNewData<MTPDstickerSetMultiCovered>());
 			MTPDstickerSetMultiCovered &v(_stickerSetMultiCovered());
 			v.vset.read(from, end);
 			v.vcovers.read(from, end);
@@ -36572,7 +36572,7 @@ inline mtpTypeId MTPmaskCoords::type() const {
 inline void MTPmaskCoords::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_maskCoords) throw mtpErrorUnexpected(cons, "MTPmaskCoords");
 
-	if (!data) setData(new MTPDmaskCoords());
+	if (!data) setData(mtpNewData<MTPDmaskCoords>());
 	MTPDmaskCoords &v(_maskCoords());
 	v.vn.read(from, end);
 	v.vx.read(from, end);
@@ -36613,12 +36613,12 @@ inline void MTPinputStickeredMedia::read(const mtpPrime *&from, const mtpPrime *
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_inputStickeredMediaPhoto: _type = cons; {
-			if (!data) setData(new MTPDinputStickeredMediaPhoto());
+			if (!data) setData(mtpNewData<MTPDinputStickeredMediaPhoto>());
 			MTPDinputStickeredMediaPhoto &v(_inputStickeredMediaPhoto());
 			v.vid.read(from, end);
 		} break;
 		case mtpc_inputStickeredMediaDocument: _type = cons; {
-			if (!data) setData(new MTPDinputStickeredMediaDocument());
+			if (!data) setData(mtpNewData<MTPDinputStickeredMediaDocument>());
 			MTPDinputStickeredMediaDocument &v(_inputStickeredMediaDocument());
 			v.vid.read(from, end);
 		} break;
@@ -36668,7 +36668,7 @@ inline mtpTypeId MTPgame::type() const {
 inline void MTPgame::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_game) throw mtpErrorUnexpected(cons, "MTPgame");
 
-	if (!data) setData(new MTPDgame());
+	if (!data) setData(mtpNewData<MTPDgame>());
 	MTPDgame &v(_game());
 	v.vflags.read(from, end);
 	v.vid.read(from, end);
@@ -36718,13 +36718,13 @@ inline void MTPinputGame::read(const mtpPrime *&from, const mtpPrime *end, mtpTy
 	if (cons != _type) setData(0);
 	switch (cons) {
 		case mtpc_inputGameID: _type = cons; {
-			if (!data) setData(new MTPDinputGameID());
+			if (!data) setData(mtpNewData<MTPDinputGameID>());
 			MTPDinputGameID &v(_inputGameID());
 			v.vid.read(from, end);
 			v.vaccess_hash.read(from, end);
 		} break;
 		case mtpc_inputGameShortName: _type = cons; {
-			if (!data) setData(new MTPDinputGameShortName());
+			if (!data) setData(mtpNewData<MTPDinputGameShortName>());
 			MTPDinputGameShortName &v(_inputGameShortName());
 			v.vbot_id.read(from, end);
 			v.vshort_name.read(from, end);
@@ -36777,7 +36777,7 @@ inline mtpTypeId MTPhighScore::type() const {
 inline void MTPhighScore::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_highScore) throw mtpErrorUnexpected(cons, "MTPhighScore");
 
-	if (!data) setData(new MTPDhighScore());
+	if (!data) setData(mtpNewData<MTPDhighScore>());
 	MTPDhighScore &v(_highScore());
 	v.vpos.read(from, end);
 	v.vuser_id.read(from, end);
@@ -36808,7 +36808,7 @@ inline mtpTypeId MTPmessages_highScores::type() const {
 inline void MTPmessages_highScores::read(const mtpPrime *&from, const mtpPrime *end, mtpTypeId cons) {
 	if (cons != mtpc_messages_highScores) throw mtpErrorUnexpected(cons, "MTPmessages_highScores");
 
-	if (!data) setData(new MTPDmessages_highScores());
+	if (!data) setData(mtpNewData<MTPDmessages_highScores>());
 	MTPDmessages_highScores &v(_messages_highScores());
 	v.vscores.read(from, end);
 	v.vusers.read(from, end);
@@ -0,0 +1,173 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#include "stdafx.h"
+
+#include "mtproto/send_scheduler.h"
+
+namespace MTP {
+namespace internal {
+namespace {
+
+constexpr uint32 kPacketBudget = 16384; // mtpPrime, 64 KB of not interactive requests in one packet
+constexpr uint32 kPriorityWeights[mtpRequestPrioritiesCount] = { 0, 4, 1 }; // shares of the packet budget
+constexpr uint64 kMaxFlushDelays[mtpRequestPrioritiesCount] = { 0, 100, 1000 }; // ms
+
+constexpr int kLatencyBucketsCount = 10;
+constexpr uint64 kLatencyBuckets[kLatencyBucketsCount - 1] = { 1, 5, 10, 25, 50, 100, 250, 500, 1000 }; // ms, upper bounds
+
+struct LatencyHistogram {
+	uint64 counts[kLatencyBucketsCount] = { 0 };
+	uint64 total = 0;
+	uint64 max = 0;
+};
+LatencyHistogram latencies[mtpRequestPrioritiesCount];
+QMutex latenciesLock;
+
+void addLatency(mtpRequestPriority priority, uint64 latency) {
+	int bucket = 0;
+	while (bucket < kLatencyBucketsCount - 1 && latency >= kLatencyBuckets[bucket]) {
+		++bucket;
+	}
+
+	QMutexLocker lock(&latenciesLock);
+	LatencyHistogram &histogram(latencies[int(priority)]);
+	++histogram.counts[bucket];
+	histogram.total += latency;
+	accumulate_max(histogram.max, latency);
+}
+
+} // namespace
+
+int64 SendScheduler::take(mtpPreRequestMap &toSend, QVector<mtpRequest> &result, uint64 ms) {
+	int count = toSend.size();
+	QVector<mtpRequest> requests; // in the requestId order
+	QVector<int> classes; // priority class, can be raised by a request waiting for this one
+	QVector<bool> taken;
+	QHash<mtpRequestId, int> indices;
+	requests.reserve(count);
+	classes.reserve(count);
+	taken.reserve(count);
+
+	uint32 used[mtpRequestPrioritiesCount] = { 0 }, allowance[mtpRequestPrioritiesCount] = { 0 };
+	for (mtpPreRequestMap::const_iterator i = toSend.cbegin(), e = toSend.cend(); i != e; ++i) {
+		indices.insert(i.key(), requests.size());
+		requests.push_back(i.value());
+		classes.push_back(int(i.value()->priority));
+		taken.push_back(false);
+		used[classes.back()] += mtpRequestData::messageSize(i.value());
+	}
+
+	uint32 weights = 0, competing = 0, budget = kPacketBudget;
+	for (int c = 1; c < mtpRequestPrioritiesCount; ++c) {
+		if (used[c]) {
+			weights += kPriorityWeights[c];
+			++competing;
+		}
+	}
+	for (int c = 1; c < mtpRequestPrioritiesCount; ++c) {
+		if (used[c]) allowance[c] = (competing > 1) ? (budget * kPriorityWeights[c] / weights) : used[c];
+	}
+	memset(used, 0, sizeof(used));
+
+	for (int c = 0; c < mtpRequestPrioritiesCount; ++c) {
+		for (int i = 0; i < count; ++i) {
+			if (classes[i] != c) continue;
+
+			// the first request of each class is always taken: a file part is
+			// larger than the whole background share, it goes after the others
+			const mtpRequest &request(requests[i]);
+			uint32 size = mtpRequestData::messageSize(request);
+			bool overdue = (ms >= request->msQueued + kMaxFlushDelays[c]);
+			if (overdue || !used[c] || used[c] + size <= allowance[c]) {
+				taken[i] = true;
+				used[c] += size;
+			}
+		}
+		if (c + 1 < mtpRequestPrioritiesCount && allowance[c] > used[c]) {
+			allowance[c + 1] += allowance[c] - used[c]; // unused share goes to the next class
+		}
+	}
+
+	// a request sent with invokeAfterMsg needs the one it waits for to be sent before it
+	for (bool changed = true; changed;) {
+		changed = false;
+		for (int i = 0; i < count; ++i) {
+			if (!taken[i] || !requests[i]->after) continue;
+
+			QHash<mtpRequestId, int>::const_iterator j = indices.constFind(requests[i]->after->requestId);
+			if (j == indices.cend()) continue;
+
+			int after = j.value();
+			if (!taken[after] || classes[after] > classes[i]) {
+				taken[after] = true;
+				classes[after] = qMin(classes[after], classes[i]);
+				changed = true;
+			}
+		}
+	}
+
+	int64 sendMoreIn = -1;
+	result.reserve(result.size() + count);
+	for (int c = 0; c < mtpRequestPrioritiesCount; ++c) {
+		for (int i = 0; i < count; ++i) {
+			if (classes[i] != c) continue;
+
+			const mtpRequest &request(requests[i]);
+			if (!taken[i]) { // will be overdue at msQueued + delay, the budget is shared again before
+				uint64 overdueAt = request->msQueued + kMaxFlushDelays[c];
+				int64 delay = (overdueAt > ms) ? int64(overdueAt - ms) : 0;
+				if (sendMoreIn < 0 || delay < sendMoreIn) {
+					sendMoreIn = delay;
+				}
+				continue;
+			}
+			result.push_back(request);
+			toSend.remove(request->requestId);
+		}
+	}
+	return sendMoreIn;
+}
+
+void SendScheduler::responseReceived(const mtpRequest &request, uint64 ms) {
+	if (!request->msQueued) return;
+
+	addLatency(request->priority, (ms > request->msQueued) ? (ms - request->msQueued) : 0);
+}
+
+void SendScheduler::logStats() {
+	QMutexLocker lock(&latenciesLock);
+	for (int c = 0; c < mtpRequestPrioritiesCount; ++c) {
+		const LatencyHistogram &histogram(latencies[c]);
+		uint64 count = 0;
+		QStringList buckets;
+		for (int bucket = 0; bucket < kLatencyBucketsCount; ++bucket) {
+			count += histogram.counts[bucket];
+			QString bound = (bucket < kLatencyBucketsCount - 1) ? QString("<%1").arg(kLatencyBuckets[bucket]) : QString(">=%1").arg(kLatencyBuckets[bucket - 1]);
+			buckets.push_back(QString("%1: %2").arg(bound).arg(histogram.counts[bucket]));
+		}
+		if (!count) continue;
+
+		DEBUG_LOG(("MTP Info: response latency of priority %1 requests, count %2, average %3ms, max %4ms, histogram %5").arg(c).arg(count).arg(histogram.total / count).arg(histogram.max).arg(buckets.join(", ")));
+	}
+}
+
+} // namespace internal
+} // namespace MTP
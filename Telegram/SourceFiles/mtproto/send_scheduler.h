@@ -0,0 +1,54 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+#include "mtproto/core_types.h"
+
+namespace MTP {
+namespace internal {
+
+// Chooses the requests from the session toSend map for the next packet.
+//
+// Interactive requests are always sent. The rest of the packet budget is
+// shared by the normal and background requests according to their weights,
+// so that bulk file parts don't delay small requests in the same packet.
+// Each class sends at least one request in every packet, placed after the
+// requests of the classes before it, so a part larger than its share is not
+// held back. The requests that did not fit are sent in the following
+// packets, but no request is held back longer than the flush delay of its
+// priority class.
+// A single priority class has no one to share the budget with, so it is
+// not limited by it.
+class SendScheduler {
+public:
+	// moves the requests to be sent from toSend to result, in the order they
+	// should be placed in a container, returns the delay in ms after which
+	// the requests that were left should be sent or -1 if none were left
+	static int64 take(mtpPreRequestMap &toSend, QVector<mtpRequest> &result, uint64 ms);
+
+	// request latency from the first queueing until the response
+	static void responseReceived(const mtpRequest &request, uint64 ms);
+	static void logStats(); // response latency histograms by priority class
+
+};
+
+} // namespace internal
+} // namespace MTP
@@ -22,33 +22,141 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 
 #include "mtproto/session.h"
 
+#include "localstorage.h"
+
 namespace MTP {
 namespace internal {
 
+void SessionData::pushReceived(mtpRequestId requestId, const mtpResponse &response) {
+#ifdef TDESKTOP_MTPROTO_LOCKED_RECEIVE
+	QWriteLocker locker(&haveReceivedLock);
+	haveReceived.insert(requestId, response);
+#else // TDESKTOP_MTPROTO_LOCKED_RECEIVE
+	forgetPoppedReceived();
+	_receivedQueuedIndices.insert(requestId, _receivedQueuedFirst + uint32(_receivedQueued.size()));
+	_receivedQueued.push_back(requestId);
+
+	ReceivedResponse received;
+	received.requestId = requestId;
+	received.response = response;
+	haveReceived.push(received);
+	_receivedPushed = true;
+#endif // TDESKTOP_MTPROTO_LOCKED_RECEIVE
+}
+
+void SessionData::pushReceivedUpdate(const mtpResponse &response) {
+#ifdef TDESKTOP_MTPROTO_LOCKED_RECEIVE
+	QWriteLocker locker(&haveReceivedLock);
+	haveReceived.insert(nextFakeRequestId(), response);
+#else // TDESKTOP_MTPROTO_LOCKED_RECEIVE
+	ReceivedResponse received;
+	received.requestId = nextFakeRequestId();
+	received.response = response;
+	haveReceivedUpdates.push(received);
+	_receivedPushed = true;
+#endif // TDESKTOP_MTPROTO_LOCKED_RECEIVE
+}
+
+bool SessionData::needToReceive() {
+#ifdef TDESKTOP_MTPROTO_LOCKED_RECEIVE
+	QReadLocker locker(&haveReceivedLock);
+	return !haveReceived.isEmpty();
+#else // TDESKTOP_MTPROTO_LOCKED_RECEIVE
+	bool result = _receivedPushed;
+	_receivedPushed = false;
+	return result;
+#endif // TDESKTOP_MTPROTO_LOCKED_RECEIVE
+}
+
+bool SessionData::popReceived(mtpRequestId &requestId, mtpResponse &response) {
+#ifdef TDESKTOP_MTPROTO_LOCKED_RECEIVE
+	QWriteLocker locker(&haveReceivedLock);
+	mtpResponseMap::iterator i = haveReceived.begin();
+	if (i == haveReceived.end()) return false;
+
+	requestId = i.key();
+	response = i.value();
+	haveReceived.erase(i);
+	return true;
+#else // TDESKTOP_MTPROTO_LOCKED_RECEIVE
+	// updates go before the rpc results, like the fake negative
+	// request ids of updates were first in the old locked map
+	ReceivedResponse received;
+	if (!haveReceivedUpdates.tryPop(received)) {
+		if (!haveReceived.tryPop(received)) return false;
+
+		_receivedPoppedCount.fetchAndAddRelease(1);
+	}
+	requestId = received.requestId;
+	response = received.response;
+	return true;
+#endif // TDESKTOP_MTPROTO_LOCKED_RECEIVE
+}
+
+mtpRequestId SessionData::nextFakeRequestId() {
+#ifdef TDESKTOP_MTPROTO_LOCKED_RECEIVE
+	if (haveReceived.isEmpty() || haveReceived.cbegin().key() > 0) { // must be locked by haveReceivedLock
+		_fakeRequestId = -2000000000;
+	} else {
+		++_fakeRequestId;
+	}
+#else // TDESKTOP_MTPROTO_LOCKED_RECEIVE
+	if (++_fakeRequestId >= 0) {
+		_fakeRequestId = -2000000000;
+	}
+#endif // TDESKTOP_MTPROTO_LOCKED_RECEIVE
+	return _fakeRequestId;
+}
+
+#ifndef TDESKTOP_MTPROTO_LOCKED_RECEIVE
+void SessionData::forgetPoppedReceived() {
+	uint32 popped = uint32(_receivedPoppedCount.loadAcquire());
+	while (!_receivedQueued.isEmpty() && int32(_receivedQueuedFirst - popped) < 0) {
+		auto i = _receivedQueuedIndices.find(_receivedQueued.front());
+		if (i != _receivedQueuedIndices.end() && i.value() == _receivedQueuedFirst) {
+			_receivedQueuedIndices.erase(i);
+		}
+		_receivedQueued.pop_front();
+		++_receivedQueuedFirst;
+	}
+}
+#endif // !TDESKTOP_MTPROTO_LOCKED_RECEIVE
+
+bool SessionData::isReceivedQueued(mtpRequestId requestId) const {
+#ifdef TDESKTOP_MTPROTO_LOCKED_RECEIVE
+	return haveReceived.contains(requestId); // must be locked by haveReceivedLock
+#else // TDESKTOP_MTPROTO_LOCKED_RECEIVE
+	return _receivedQueuedIndices.contains(requestId); // must be called after forgetPoppedReceived()
+#endif // TDESKTOP_MTPROTO_LOCKED_RECEIVE
+}
+
 void SessionData::clear() {
 	RPCCallbackClears clearCallbacks;
 	{
-		QReadLocker locker1(haveSentMutex()), locker2(toResendMutex()), locker3(haveReceivedMutex()), locker4(wereAckedMutex());
-		mtpResponseMap::const_iterator end = haveReceived.cend();
+		QReadLocker locker1(haveSentMutex()), locker2(toResendMutex()), locker3(wereAckedMutex());
+#ifdef TDESKTOP_MTPROTO_LOCKED_RECEIVE
+		QReadLocker locker4(&haveReceivedLock);
+#else // TDESKTOP_MTPROTO_LOCKED_RECEIVE
+		forgetPoppedReceived();
+#endif // TDESKTOP_MTPROTO_LOCKED_RECEIVE
 		clearCallbacks.reserve(haveSent.size() + wereAcked.size());
 		for (mtpRequestMap::const_iterator i = haveSent.cbegin(), e = haveSent.cend(); i != e; ++i) {
 			mtpRequestId requestId = i.value()->requestId;
-			if (haveReceived.find(requestId) == end) {
+			if (!isReceivedQueued(requestId)) {
 				clearCallbacks.push_back(requestId);
 			}
 		}
 		for (mtpRequestIdsMap::const_iterator i = toResend.cbegin(), e = toResend.cend(); i != e; ++i) {
 			mtpRequestId requestId = i.value();
-			if (haveReceived.find(requestId) == end) {
+			if (!isReceivedQueued(requestId)) {
 				clearCallbacks.push_back(requestId);
 			}
 		}
-		for (mtpRequestIdsMap::const_iterator i = wereAcked.cbegin(), e = wereAcked.cend(); i != e; ++i) {
-			mtpRequestId requestId = i.value();
-			if (haveReceived.find(requestId) == end) {
+		wereAcked.enumerate([this, &clearCallbacks](mtpMsgId msgId, mtpRequestId requestId) {
+			if (!isReceivedQueued(requestId)) {
 				clearCallbacks.push_back(requestId);
 			}
-		}
+		});
 	}
 	{
 		QWriteLocker locker(haveSentMutex());
@@ -62,10 +170,7 @@ void SessionData::clear() {
 		QWriteLocker locker(wereAckedMutex());
 		wereAcked.clear();
 	}
-	{
-		QWriteLocker locker(receivedIdsMutex());
-		receivedIds.clear();
-	}
+	receivedIds.clear();
 	clearCallbacksDelayed(clearCallbacks);
 }
 
@@ -79,7 +184,8 @@ Session::Session(int32 requestedDcId) : QObject()
 , dc(0)
 , msSendCall(0)
 , msWait(0)
-, _ping(false) {
+, _ping(false)
+, _parser(ResponseParser::create()) {
 	if (_killed) {
 		DEBUG_LOG(("Session Error: can't start a killed session"));
 		return;
@@ -95,6 +201,7 @@ Session::Session(int32 requestedDcId) : QObject()
 	timeouter.start(1000);
 
 	connect(&sender, SIGNAL(timeout()), this, SLOT(needToResumeAndSend()));
+	connect(_parser.data(), SIGNAL(parsed()), this, SLOT(tryToReceive()));
 
 	_connection = new Connection();
 	dcWithShift = _connection->prepare(&data, requestedDcId);
@@ -310,6 +417,16 @@ void Session::onResetDone() {
 	onSessionReset(dcWithShift);
 }
 
+void Session::onServerSaltsReceived() {
+	if (dc) dc->serverSaltsWrite();
+}
+
+void Session::onEndpointsStatsChanged() {
+	if (takeDcEndpointsChanged()) { // many sessions may report at once, the write is delayed anyway
+		Local::writeSettingsDelayed();
+	}
+}
+
 void Session::cancel(mtpRequestId requestId, mtpMsgId msgId) {
 	if (requestId) {
 		QWriteLocker locker(data.toSendMutex());
@@ -450,6 +567,9 @@ void Session::resendAll() {
 void Session::sendPrepared(const mtpRequest &request, uint64 msCanWait, bool newRequest) { // returns true, if emit of needToSend() is needed
 	{
 		QWriteLocker locker(data.toSendMutex());
+		if (!request->msQueued) { // resent requests keep the time they were first queued
+			request->msQueued = getms(true);
+		}
 		data.toSendMap().insert(request->requestId, request);
 
 		if (newRequest) {
@@ -514,29 +634,13 @@ void Session::tryToReceive() {
 		_needToReceive = true;
 		return;
 	}
-	int32 cnt = 0;
-	while (true) {
-		mtpRequestId requestId;
-		mtpResponse response;
-		{
-			QWriteLocker locker(data.haveReceivedMutex());
-			mtpResponseMap &responses(data.haveReceivedMap());
-			mtpResponseMap::iterator i = responses.begin();
-			if (i == responses.end()) return;
-
-			requestId = i.key();
-			response = i.value();
-			responses.erase(i);
-		}
-		if (requestId <= 0) {
-			if (dcWithShift == bareDcId(dcWithShift)) { // call globalCallback only in main session
-				globalCallback(response.constData(), response.constData() + response.size());
-			}
-		} else {
-			execCallback(requestId, response.constData(), response.constData() + response.size());
-		}
-		++cnt;
+	bool global = (dcWithShift == bareDcId(dcWithShift)); // call globalCallback only in main session
+	mtpRequestId requestId;
+	mtpResponse response;
+	while (data.popReceived(requestId, response)) {
+		_parser->push(requestId, response, global);
 	}
+	_parser->deliver();
 }
 
 Session::~Session() {
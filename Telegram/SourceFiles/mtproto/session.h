@@ -22,8 +22,11 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 
 #include "mtproto/connection.h"
 #include "mtproto/dcenter.h"
+#include "mtproto/msg_ids_window.h"
 #include "mtproto/rpc_sender.h"
+#include "mtproto/response_parser.h"
 #include "core/single_timer.h"
+#include "core/spsc_queue.h"
 
 namespace MTP {
 namespace internal {
@@ -37,6 +40,10 @@ public:
 	, _salt(0)
 	, _messagesSent(0)
 	, _fakeRequestId(-2000000000)
+#ifndef TDESKTOP_MTPROTO_LOCKED_RECEIVE
+	, _receivedQueuedFirst(0)
+	, _receivedPushed(false)
+#endif // !TDESKTOP_MTPROTO_LOCKED_RECEIVE
 	, _owner(creator)
 	, _keyChecked(false)
 	, _layerInited(false) {
@@ -114,12 +121,6 @@ public:
 	QReadWriteLock *wereAckedMutex() const {
 		return &wereAckedLock;
 	}
-	QReadWriteLock *receivedIdsMutex() const {
-		return &receivedIdsLock;
-	}
-	QReadWriteLock *haveReceivedMutex() const {
-		return &haveReceivedLock;
-	}
 	QReadWriteLock *stateRequestMutex() const {
 		return &stateRequestLock;
 	}
@@ -142,24 +143,18 @@ public:
 	const mtpRequestIdsMap &toResendMap() const {
 		return toResend;
 	}
-	mtpMsgIdsMap &receivedIdsSet() {
+	ReceivedMsgIds &receivedIdsSet() { // connection thread
 		return receivedIds;
 	}
-	const mtpMsgIdsMap &receivedIdsSet() const {
+	const ReceivedMsgIds &receivedIdsSet() const { // connection thread
 		return receivedIds;
 	}
-	mtpRequestIdsMap &wereAckedMap() {
+	AckedMsgIds &wereAckedMap() {
 		return wereAcked;
 	}
-	const mtpRequestIdsMap &wereAckedMap() const {
+	const AckedMsgIds &wereAckedMap() const {
 		return wereAcked;
 	}
-	mtpResponseMap &haveReceivedMap() {
-		return haveReceived;
-	}
-	const mtpResponseMap &haveReceivedMap() const {
-		return haveReceived;
-	}
 	mtpMsgIdsSet &stateRequestMap() {
 		return stateRequest;
 	}
@@ -167,14 +162,17 @@ public:
 		return stateRequest;
 	}
 
-	mtpRequestId nextFakeRequestId() { // must be locked by haveReceivedMutex()
-		if (haveReceived.isEmpty() || haveReceived.cbegin().key() > 0) {
-			_fakeRequestId = -2000000000;
-		} else {
-			++_fakeRequestId;
-		}
-		return _fakeRequestId;
-	}
+	// received responses are passed from the connection thread to the main thread
+	// through a lock-free single producer / single consumer queue, the old
+	// locked map is available with TDESKTOP_MTPROTO_LOCKED_RECEIVE defined
+
+	// connection thread
+	void pushReceived(mtpRequestId requestId, const mtpResponse &response);
+	void pushReceivedUpdate(const mtpResponse &response); // with a fake request id
+	bool needToReceive(); // were some responses pushed, that are not processed yet
+
+	// main thread
+	bool popReceived(mtpRequestId &requestId, mtpResponse &response);
 
 	Session *owner() {
 		return _owner;
@@ -193,6 +191,9 @@ public:
 	void clear();
 
 private:
+	mtpRequestId nextFakeRequestId();
+	bool isReceivedQueued(mtpRequestId requestId) const; // connection thread
+
 	uint64 _session, _salt;
 
 	uint32 _messagesSent;
@@ -206,19 +207,46 @@ private:
 	mtpPreRequestMap toSend; // map of request_id -> request, that is waiting to be sent
 	mtpRequestMap haveSent; // map of msg_id -> request, that was sent, msDate = 0 for msgs_state_req (no resend / state req), msDate = 0, seqNo = 0 for containers
 	mtpRequestIdsMap toResend; // map of msg_id -> request_id, that request_id -> request lies in toSend and is waiting to be resent
-	mtpMsgIdsMap receivedIds; // set of received msg_id's, for checking new msg_ids
-	mtpRequestIdsMap wereAcked; // map of msg_id -> request_id, this msg_ids already were acked or do not need ack
+	ReceivedMsgIds receivedIds; // set of received msg_id's, for checking new msg_ids
+	AckedMsgIds wereAcked; // map of msg_id -> request_id, this msg_ids already were acked or do not need ack
+#ifdef TDESKTOP_MTPROTO_LOCKED_RECEIVE
 	mtpResponseMap haveReceived; // map of request_id -> response, that should be processed in other thread
+#else // TDESKTOP_MTPROTO_LOCKED_RECEIVE
+	struct ReceivedResponse {
+		mtpRequestId requestId = 0;
+		mtpResponse response;
+	};
+	SingleProducerQueue<ReceivedResponse> haveReceived; // rpc results that should be processed in other thread
+	SingleProducerQueue<ReceivedResponse> haveReceivedUpdates; // updates, processed before the rpc results
+
+	// owned by the connection thread: request ids of the pushed rpc results in push order,
+	// the first of them has index _receivedQueuedFirst, ones with index below
+	// _receivedPoppedCount were already taken by the main thread, _receivedQueuedIndices
+	// maps a still queued request id to the index of its last push for the lookups
+	void forgetPoppedReceived();
+	QList<mtpRequestId> _receivedQueued;
+	QHash<mtpRequestId, uint32> _receivedQueuedIndices;
+	uint32 _receivedQueuedFirst;
+	bool _receivedPushed;
+	QAtomicInt _receivedPoppedCount;
+#endif // TDESKTOP_MTPROTO_LOCKED_RECEIVE
 	mtpMsgIdsSet stateRequest; // set of msg_id's, whose state should be requested
 
-	// mutexes
+	// mutexes, receivedIds has none: it is used only by the connection thread, and a new
+	// connection takes over only after ConnectionPrivate::stop() of the old one returned
+	//
+	// toSend, haveSent, toResend, wereAcked and stateRequest stay locked: unlike the
+	// received responses they are not a one way handoff, the main thread adds, cancels
+	// and resends requests in them while the connection thread moves the same entries
+	// between them on sends, acks and state answers, so a queue would not replace the lock
 	mutable QReadWriteLock lock;
 	mutable QReadWriteLock toSendLock;
 	mutable QReadWriteLock haveSentLock;
 	mutable QReadWriteLock toResendLock;
-	mutable QReadWriteLock receivedIdsLock;
 	mutable QReadWriteLock wereAckedLock;
+#ifdef TDESKTOP_MTPROTO_LOCKED_RECEIVE
 	mutable QReadWriteLock haveReceivedLock;
+#endif // TDESKTOP_MTPROTO_LOCKED_RECEIVE
 	mutable QReadWriteLock stateRequestLock;
 
 };
@@ -243,7 +271,7 @@ public:
 	void notifyLayerInited(bool wasInited);
 
 	template <typename TRequest>
-	mtpRequestId send(const TRequest &request, RPCResponseHandler callbacks = RPCResponseHandler(), uint64 msCanWait = 0, bool needsLayer = false, bool toMainDC = false, mtpRequestId after = 0); // send mtp request
+	mtpRequestId send(const TRequest &request, RPCResponseHandler callbacks = RPCResponseHandler(), uint64 msCanWait = 0, bool needsLayer = false, bool toMainDC = false, mtpRequestId after = 0, mtpRequestPriority priority = mtpRequestPriority::Normal); // send mtp request
 
 	void ping();
 	void cancel(mtpRequestId requestId, mtpMsgId msgId);
@@ -275,6 +303,8 @@ public slots:
 	void checkRequestsByTimer();
 	void onConnectionStateChange(qint32 newState);
 	void onResetDone();
+	void onServerSaltsReceived();
+	void onEndpointsStatsChanged();
 
 	void sendAnything(quint64 msCanWait = 0);
 	void sendPong(quint64 msgId, quint64 pingId);
@@ -300,6 +330,8 @@ private:
 	QTimer timeouter;
 	SingleTimer sender;
 
+	QSharedPointer<ResponseParser> _parser;
+
 };
 
 inline QReadWriteLock *SessionData::keyMutex() const {
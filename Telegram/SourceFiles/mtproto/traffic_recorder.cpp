@@ -0,0 +1,353 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#include "stdafx.h"
+
+#include "mtproto/traffic_recorder.h"
+
+#include "mtproto/facade.h"
+
+namespace MTP {
+namespace {
+
+constexpr quint32 kMagic = 0x5254544d; // "MTTR"
+constexpr quint32 kVersion = 1;
+constexpr int kFilesCount = 4;
+constexpr int kHeaderSize = 4 * sizeof(quint32);
+constexpr int kRecordHeaderSize = 3 * sizeof(quint32) + sizeof(qint64);
+constexpr int kFlushSize = 64 * 1024; // the writer is woken up earlier when that much is buffered
+constexpr unsigned long kFlushDelay = 1000; // ms, the records are written not later than after that
+
+class Writer;
+
+// The connection threads only append to the buffer under RecorderMutex,
+// the files are written by the writer thread with the mutex unlocked.
+struct Recorder {
+	QString folder;
+	int64 fileSize = 0;
+
+	// guarded by RecorderMutex
+	QByteArray buffer;
+	QWaitCondition wakeWriter;
+	bool finishing = false;
+
+	// used by the writer thread only
+	QFile file;
+	int index = -1;
+	quint32 sequence = 0;
+	int64 written = 0;
+	QByteArray writing;
+
+	Writer *writer = nullptr;
+};
+QAtomicInt Started;
+QMutex RecorderMutex;
+Recorder *Instance = nullptr;
+
+QString capturePath(const QString &folder, int index) {
+	return folder + qsl("/capture%1.mtp").arg(index);
+}
+
+bool readHeader(QFile &file, quint32 *sequence) {
+	quint32 header[4] = { 0 };
+	if (file.read(reinterpret_cast<char*>(header), sizeof(header)) != sizeof(header)) {
+		return false;
+	}
+	if (header[0] != kMagic || header[1] != kVersion) {
+		return false;
+	}
+	*sequence = header[2];
+	return true;
+}
+
+void openNext(Recorder &recorder) {
+	recorder.file.close();
+	recorder.index = (recorder.index + 1) % kFilesCount;
+	++recorder.sequence;
+	recorder.written = 0;
+
+	recorder.file.setFileName(capturePath(recorder.folder, recorder.index));
+	if (!recorder.file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		LOG(("MTP Error: could not open traffic capture file '%1'").arg(recorder.file.fileName()));
+		return;
+	}
+	quint32 header[4] = { kMagic, kVersion, recorder.sequence, 0 };
+	recorder.file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	recorder.written = sizeof(header);
+}
+
+void write(Recorder &recorder) {
+	if (recorder.writing.isEmpty()) return;
+
+	if (recorder.written > kHeaderSize && recorder.written + recorder.writing.size() > recorder.fileSize) {
+		openNext(recorder);
+	}
+	if (recorder.file.isOpen()) {
+		recorder.file.write(recorder.writing);
+		recorder.file.flush();
+		recorder.written += recorder.writing.size();
+	}
+	recorder.writing.resize(0); // keeps the reserved capacity
+}
+
+class Writer : public QThread {
+public:
+	Writer(Recorder &recorder) : _recorder(recorder) {
+	}
+
+protected:
+	void run() override {
+		QMutexLocker lock(&RecorderMutex);
+		while (true) {
+			if (_recorder.buffer.size() < kFlushSize && !_recorder.finishing) {
+				_recorder.wakeWriter.wait(&RecorderMutex, kFlushDelay);
+			}
+			auto finishing = _recorder.finishing;
+			qSwap(_recorder.buffer, _recorder.writing); // both keep their reserved capacity
+
+			lock.unlock();
+			write(_recorder);
+			if (finishing) {
+				return;
+			}
+			lock.relock();
+		}
+	}
+
+private:
+	Recorder &_recorder;
+
+};
+
+const mtpTypeId ReplayTypes[] = {
+	mtpc_updates,
+	mtpc_updatesCombined,
+	mtpc_updateShort,
+	mtpc_updateShortMessage,
+	mtpc_updateShortChatMessage,
+};
+
+// message starts from msg_id, the updates are looked for in the containers as well
+int saveReplay(QFile &file, const mtpPrime *message, const mtpPrime *end) {
+	if (end - message < 5) return 0;
+
+	auto length = message[3];
+	auto body = message + 4;
+	if ((length & 0x03) || length < 4 || length / 4 > end - body) return 0;
+
+	auto bodyEnd = body + length / 4;
+	auto type = mtpTypeId(body[0]);
+	if (type == mtpc_msg_container) {
+		if (bodyEnd - body < 2) return 0;
+
+		auto result = 0;
+		auto inner = body + 2;
+		for (auto i = 0, count = body[1]; i < count && inner < bodyEnd; ++i) {
+			result += saveReplay(file, inner, bodyEnd);
+			if (bodyEnd - inner < 4) break;
+			inner += 4 + (inner[3] >> 2);
+		}
+		return result;
+	}
+	for (auto replayType : ReplayTypes) {
+		if (type == replayType) {
+			quint32 size = length;
+			file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+			file.write(reinterpret_cast<const char*>(body), size);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+} // namespace
+
+void TrafficRecorder::start(const QString &folder, int64 maxSize) {
+	QMutexLocker lock(&RecorderMutex);
+	if (Instance) return;
+
+	QDir().mkpath(folder);
+
+	Instance = new Recorder();
+	Instance->folder = folder;
+	Instance->fileSize = qMax(maxSize / kFilesCount, int64(kFlushSize));
+	Instance->buffer.reserve(kFlushSize + kFlushSize / 2);
+	Instance->writing.reserve(kFlushSize + kFlushSize / 2);
+
+	// continue after the latest capture, so that it is overwritten last
+	for (int i = 0; i < kFilesCount; ++i) {
+		QFile file(capturePath(folder, i));
+		quint32 sequence = 0;
+		if (file.open(QIODevice::ReadOnly) && readHeader(file, &sequence) && sequence >= Instance->sequence) {
+			Instance->sequence = sequence;
+			Instance->index = i;
+		}
+	}
+	openNext(*Instance);
+
+	DEBUG_LOG(("MTP Info: recording traffic to '%1', %2 files of %3 bytes").arg(Instance->file.fileName()).arg(kFilesCount).arg(Instance->fileSize));
+	Instance->writer = new Writer(*Instance);
+	Instance->writer->start(QThread::LowPriority);
+	Started.store(1);
+}
+
+bool TrafficRecorder::started() {
+	return Started.load() != 0;
+}
+
+void TrafficRecorder::record(ShiftedDcId dcId, Direction direction, const mtpPrime *from, const mtpPrime *end) {
+	if (!started() || end <= from) return;
+
+	quint32 header[3] = { quint32((end - from) * sizeof(mtpPrime)), quint32(dcId), quint32(direction) };
+	qint64 ms = QDateTime::currentMSecsSinceEpoch();
+
+	QMutexLocker lock(&RecorderMutex);
+	if (!Instance) return;
+
+	auto &buffer = Instance->buffer;
+	buffer.append(reinterpret_cast<const char*>(header), sizeof(header));
+	buffer.append(reinterpret_cast<const char*>(&ms), sizeof(ms));
+	buffer.append(reinterpret_cast<const char*>(from), header[0]);
+	if (buffer.size() >= kFlushSize) {
+		Instance->wakeWriter.wakeOne();
+	}
+}
+
+void TrafficRecorder::finish() {
+	Started.store(0);
+
+	Recorder *recorder = nullptr;
+	{
+		QMutexLocker lock(&RecorderMutex);
+		if (!Instance) return;
+
+		recorder = Instance;
+		Instance = nullptr;
+		recorder->finishing = true;
+		recorder->wakeWriter.wakeOne();
+	}
+
+	recorder->writer->wait(); // writes the rest of the buffer before finishing
+	delete recorder->writer;
+	delete recorder;
+}
+
+int TrafficRecorder::dump(const QString &path, const QString &filter, const QString &replayPath) {
+	QTextStream out(stdout);
+
+	QStringList paths;
+	if (QFileInfo(path).isDir()) {
+		for (int i = 0; i < kFilesCount; ++i) {
+			paths.push_back(capturePath(path, i));
+		}
+	} else {
+		paths.push_back(path);
+	}
+
+	QMap<quint32, QString> captures; // by sequence number
+	for_const (auto &fileName, paths) {
+		QFile file(fileName);
+		quint32 sequence = 0;
+		if (file.open(QIODevice::ReadOnly) && readHeader(file, &sequence)) {
+			captures.insert(sequence, fileName);
+		}
+	}
+	if (captures.isEmpty()) {
+		out << "No traffic captures found in '" << path << "'\n";
+		return 1;
+	}
+
+	auto in = false, outgoing = false;
+	QSet<int> dcs;
+	QStringList words;
+	for_const (auto &term, filter.split(',', QString::SkipEmptyParts)) {
+		auto trimmed = term.trimmed();
+		if (trimmed == qstr("in")) {
+			in = true;
+		} else if (trimmed == qstr("out")) {
+			outgoing = true;
+		} else if (trimmed.startsWith(qstr("dc")) && trimmed.mid(2).toInt() > 0) {
+			dcs.insert(trimmed.mid(2).toInt());
+		} else if (!trimmed.isEmpty()) {
+			words.push_back(trimmed);
+		}
+	}
+	if (!in && !outgoing) {
+		in = outgoing = true;
+	}
+
+	QFile replay(replayPath);
+	if (!replayPath.isEmpty() && !replay.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		out << "Could not open replay file '" << replayPath << "'\n";
+		return 1;
+	}
+
+	auto total = 0, printed = 0, replayed = 0;
+	for_const (auto &fileName, captures) {
+		QFile file(fileName);
+		if (!file.open(QIODevice::ReadOnly)) continue;
+
+		auto data = file.readAll();
+		for (int position = kHeaderSize; position + kRecordHeaderSize <= data.size();) {
+			auto header = reinterpret_cast<const quint32*>(data.constData() + position);
+			auto size = header[0];
+			auto dcId = ShiftedDcId(header[1]);
+			auto direction = Direction(header[2]);
+			auto ms = *reinterpret_cast<const qint64*>(data.constData() + position + 3 * sizeof(quint32));
+			if ((size & 0x03) || position + kRecordHeaderSize + int(size) > data.size()) {
+				break; // the tail was not written completely
+			}
+			auto from = reinterpret_cast<const mtpPrime*>(data.constData() + position + kRecordHeaderSize);
+			auto end = from + (size >> 2);
+			position += kRecordHeaderSize + size;
+			++total;
+
+			if (replay.isOpen() && direction == Direction::Received) {
+				replayed += saveReplay(replay, from, end);
+			}
+			if (direction == Direction::Received ? !in : !outgoing) continue;
+			if (!dcs.isEmpty() && !dcs.contains(bareDcId(dcId))) continue;
+
+			auto text = mtpTextSerialize(from, end);
+			if (!words.isEmpty()) {
+				auto found = false;
+				for_const (auto &word, words) {
+					if (text.contains(word)) {
+						found = true;
+						break;
+					}
+				}
+				if (!found) continue;
+			}
+
+			auto time = QDateTime::fromMSecsSinceEpoch(ms).toString(qsl("yyyy-MM-dd hh:mm:ss.zzz"));
+			out << time << " dc " << dcId << ((direction == Direction::Received) ? " recv: " : " send: ") << text << "\n";
+			++printed;
+		}
+	}
+	out << printed << " of " << total << " messages printed";
+	if (replay.isOpen()) {
+		out << ", " << replayed << " updates saved to '" << replayPath << "'";
+	}
+	out << "\n";
+	return 0;
+}
+
+} // namespace MTP
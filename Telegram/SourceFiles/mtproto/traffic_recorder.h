@@ -0,0 +1,57 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+#include "mtproto/core_types.h"
+
+namespace MTP {
+
+// Appends the decrypted messages with their timestamps to a ring of
+// capture files in a compact binary form, cheap enough to be left on
+// permanently, instead of printing them with mtpTextSerialize(). The
+// records are only buffered by the caller, a writer thread saves them.
+//
+// Each capture file starts with a header of four uint32: magic,
+// version, sequence number and zero. Then records follow, each with
+// uint32 length in bytes, int32 shifted dc id, uint32 direction and
+// int64 milliseconds since epoch, then the message itself starting
+// from msg_id, as mtpTextSerialize() expects it.
+class TrafficRecorder {
+public:
+	enum class Direction {
+		Sent = 1,
+		Received = 2,
+	};
+
+	static void start(const QString &folder, int64 maxSize); // maxSize is shared by all the files of the ring
+	static bool started();
+	static void record(ShiftedDcId dcId, Direction direction, const mtpPrime *from, const mtpPrime *end);
+	static void finish();
+
+	// Offline decoder for the -mtpdump launch mode: prints the messages of
+	// a capture file or of all the captures in a folder. The filter is a comma
+	// separated list of "in", "out", "dc{id}" and the words to look for in the
+	// printed messages. The received updates can be saved to a FakeDc replay file.
+	static int dump(const QString &path, const QString &filter, const QString &replayPath);
+
+};
+
+} // namespace MTP
@@ -0,0 +1,138 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#include "stdafx.h"
+
+#include "mtproto/warm_sessions.h"
+
+#include "mtproto/facade.h"
+
+namespace MTP {
+namespace internal {
+namespace {
+
+constexpr uint64 kPingInterval = MTPPingSendAfterAuto * 1000ULL; // the server drops the idle connections later than that
+constexpr uint64 kKeepTimeout = 600000; // stop the idle session after 10 minutes without downloads
+constexpr int kSessionMemory = 256; // estimated KB used by one connected session with its socket buffers
+
+struct FirstByteStats {
+	uint64 count = 0;
+	uint64 total = 0;
+	uint64 max = 0;
+};
+FirstByteStats ColdFirstBytes, WarmFirstBytes;
+
+} // namespace
+
+WarmSessions::WarmSessions() {
+	connect(&_pingTimer, SIGNAL(timeout()), this, SLOT(onPingTimer()));
+}
+
+int WarmSessions::limit() {
+	return qMax(qMin(cWarmSessionsMax(), cWarmSessionsMemory() / kSessionMemory), 0);
+}
+
+void WarmSessions::used(DcId dcId) {
+	if (!limit()) return;
+
+	auto &dc = _dcs[dcId];
+	dc.lastUsed = getms(true);
+	dc.idle = false;
+	trim();
+}
+
+bool WarmSessions::idle(DcId dcId) {
+	auto i = _dcs.find(dcId);
+	if (i == _dcs.end()) return false;
+
+	i->lastUsed = getms(true);
+	i->idle = true;
+	if (!_pingTimer.isActive()) {
+		_pingTimer.start(kPingInterval);
+	}
+	DEBUG_LOG(("MTP Info: keeping download session of dc %1 warm, warm dcs %2").arg(dcId).arg(_dcs.size()));
+	return true;
+}
+
+void WarmSessions::onPingTimer() {
+	auto ms = getms(true);
+	auto pinged = false;
+	for (auto i = _dcs.begin(); i != _dcs.end();) {
+		if (!i->idle) {
+			++i;
+		} else if (i->lastUsed + kKeepTimeout <= ms) {
+			DEBUG_LOG(("MTP Info: download session of dc %1 cooled down").arg(i.key()));
+			stopSession(dldDcId(i.key(), 0));
+			i = _dcs.erase(i);
+		} else {
+			if (auto session = getSession(dldDcId(i.key(), 0))) {
+				session->ping();
+			}
+			pinged = true;
+			++i;
+		}
+	}
+	if (pinged) {
+		_pingTimer.start(kPingInterval);
+	}
+}
+
+void WarmSessions::trim() {
+	auto max = limit();
+	while (_dcs.size() > max) {
+		// drop the least recently used idle dc, or any if all of them are busy
+		auto oldest = _dcs.end();
+		for (auto i = _dcs.begin(), e = _dcs.end(); i != e; ++i) {
+			if (oldest == e || (i->idle && !oldest->idle) || (i->idle == oldest->idle && i->lastUsed < oldest->lastUsed)) {
+				oldest = i;
+			}
+		}
+		forget(oldest.key(), oldest->idle);
+	}
+}
+
+void WarmSessions::forget(DcId dcId, bool stop) {
+	DEBUG_LOG(("MTP Info: download session of dc %1 is not kept warm anymore, budget %2").arg(dcId).arg(limit()));
+	_dcs.remove(dcId);
+	if (stop) {
+		stopSession(dldDcId(dcId, 0));
+	}
+}
+
+void WarmSessions::firstByte(DcId dcId, uint64 ms, bool cold) {
+	auto &stats = cold ? ColdFirstBytes : WarmFirstBytes;
+	++stats.count;
+	stats.total += ms;
+	accumulate_max(stats.max, ms);
+
+	DEBUG_LOG(("MTP Info: first byte from dc %1 in %2ms (%3), average %4ms over %5 %3 opens").arg(dcId).arg(ms).arg(cold ? "cold" : "warm").arg(stats.total / stats.count).arg(stats.count));
+}
+
+void WarmSessions::logStats() {
+	if (ColdFirstBytes.count) {
+		DEBUG_LOG(("MTP Info: time to first byte for cold file opens, count %1, average %2ms, max %3ms").arg(ColdFirstBytes.count).arg(ColdFirstBytes.total / ColdFirstBytes.count).arg(ColdFirstBytes.max));
+	}
+	if (WarmFirstBytes.count) {
+		DEBUG_LOG(("MTP Info: time to first byte for warm file opens, count %1, average %2ms, max %3ms").arg(WarmFirstBytes.count).arg(WarmFirstBytes.total / WarmFirstBytes.count).arg(WarmFirstBytes.max));
+	}
+}
+
+} // namespace internal
+} // namespace MTP
@@ -0,0 +1,67 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop version of Telegram messaging app, see https://telegram.org
+
+Telegram Desktop is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+It is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+In addition, as a special exception, the copyright holders give permission
+to link the code of portions of this program with the OpenSSL library.
+
+Full license: https://github.com/telegramdesktop/tdesktop/blob/master/LICENSE
+Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
+*/
+#pragma once
+
+#include "mtproto/core_types.h"
+#include "core/single_timer.h"
+
+namespace MTP {
+namespace internal {
+
+// Keeps the first download session of the dcs we have recently downloaded
+// from connected when the downloads there stop. It is pinged while idle,
+// so that the next file from that dc doesn't wait for the connect, the auth
+// import and initConnection. The least recently used dcs are dropped when
+// the sockets or the memory budget is exceeded and after a while without
+// any downloads.
+class WarmSessions : public QObject {
+	Q_OBJECT
+
+public:
+	WarmSessions();
+
+	void used(DcId dcId); // the downloads in that dc are running
+	bool idle(DcId dcId); // the downloads have stopped, returns true if the session should be kept
+
+	static int limit(); // the sessions count allowed by the budgets, 0 - disabled
+
+	// time to the first byte of a file, cold - the download session was not connected
+	static void firstByte(DcId dcId, uint64 ms, bool cold);
+	static void logStats();
+
+public slots:
+	void onPingTimer();
+
+private:
+	void trim();
+	void forget(DcId dcId, bool stop);
+
+	struct Dc {
+		uint64 lastUsed = 0;
+		bool idle = false;
+	};
+	QMap<DcId, Dc> _dcs;
+	SingleTimer _pingTimer;
+
+};
+
+} // namespace internal
+} // namespace MTP
@@ -191,6 +191,7 @@ void Photo::paint(Painter &p, const QRect &clip, TextSelection selection, const
 	bool good = _data->loaded(), selected = (selection == FullSelection);
 	if (!good) {
 		_data->medium->automaticLoad(_parent);
+		_data->markVisible();
 		good = _data->medium->loaded();
 	}
 	if ((good && !_goodLoaded) || _pix.width() != _width * cIntRetinaFactor()) {
@@ -258,6 +259,7 @@ void Video::paint(Painter &p, const QRect &clip, TextSelection selection, const
 	bool selected = (selection == FullSelection), thumbLoaded = _data->thumb->loaded();
 
 	_data->automaticLoad(_parent);
+	_data->markVisible();
 	bool loaded = _data->loaded(), displayLoading = _data->displayLoading();
 	if (displayLoading) {
 		ensureRadial();
@@ -422,6 +424,7 @@ void Voice::paint(Painter &p, const QRect &clip, TextSelection selection, const
 	bool selected = (selection == FullSelection);
 
 	_data->automaticLoad(_parent);
+	_data->markVisible();
 	bool loaded = _data->loaded(), displayLoading = _data->displayLoading();
 
 	if (displayLoading) {
@@ -635,6 +638,7 @@ void Document::paint(Painter &p, const QRect &clip, TextSelection selection, con
 	bool selected = (selection == FullSelection);
 
 	_data->automaticLoad(_parent);
+	_data->markVisible();
 	bool loaded = _data->loaded() || Local::willStickerImageLoad(_data->mediaKey()), displayLoading = _data->displayLoading();
 
 	if (displayLoading) {
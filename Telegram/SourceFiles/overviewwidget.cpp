@@ -175,7 +175,7 @@ void OverviewInner::searchReceived(SearchRequestType type, const MTPmessages_Mes
 		if (type == SearchFromStart) {
 			SearchQueries::iterator i = _searchQueries.find(req);
 			if (i != _searchQueries.cend()) {
-				_searchCache[i.value()] = result;
+				_searchCache[i.value()] = mtpEscape(result);
 				_searchQueries.erase(i);
 			}
 		}
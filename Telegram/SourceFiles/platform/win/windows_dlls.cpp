@@ -54,12 +54,14 @@ f_RoGetActivationFactory RoGetActivationFactory;
 f_WindowsCreateStringReference WindowsCreateStringReference;
 f_WindowsDeleteString WindowsDeleteString;
 f_PropVariantToString PropVariantToString;
+f_GetProcessMemoryInfo GetProcessMemoryInfo;
 
 HINSTANCE LibUxTheme;
 HINSTANCE LibShell32;
 HINSTANCE LibWtsApi32;
 HINSTANCE LibPropSys;
 HINSTANCE LibComBase;
+HINSTANCE LibPsApi;
 
 void start() {
 	init();
@@ -75,6 +77,9 @@ void start() {
 	LibUxTheme = LoadLibrary(L"UXTHEME.DLL");
 	load(LibUxTheme, "SetWindowTheme", SetWindowTheme);
 
+	LibPsApi = LoadLibrary(L"PSAPI.DLL");
+	load(LibPsApi, "GetProcessMemoryInfo", GetProcessMemoryInfo);
+
 	auto version = QSysInfo::windowsVersion();
 	if (version >= QSysInfo::WV_VISTA) {
 		LibWtsApi32 = LoadLibrary(L"WTSAPI32.DLL");
@@ -23,6 +23,7 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 #include <windows.h>
 #include <shlobj.h>
 #include <roapi.h>
+#include <psapi.h>
 
 namespace Platform {
 namespace Dlls {
@@ -79,6 +80,11 @@ extern f_WTSUnRegisterSessionNotification WTSUnRegisterSessionNotification;
 typedef HRESULT (FAR STDAPICALLTYPE *f_PropVariantToString)(_In_ REFPROPVARIANT propvar, _Out_writes_(cch) PWSTR psz, _In_ UINT cch);
 extern f_PropVariantToString PropVariantToString;
 
+// PSAPI.DLL
+
+typedef BOOL (FAR STDAPICALLTYPE *f_GetProcessMemoryInfo)(HANDLE Process, PPROCESS_MEMORY_COUNTERS ppsmemCounters, DWORD cb);
+extern f_GetProcessMemoryInfo GetProcessMemoryInfo;
+
 // COMBASE.DLL
 
 typedef HRESULT (FAR STDAPICALLTYPE *f_RoGetActivationFactory)(_In_ HSTRING activatableClassId, _In_ REFIID iid, _COM_Outptr_ void ** factory);
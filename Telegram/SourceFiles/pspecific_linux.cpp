@@ -27,6 +27,7 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/resource.h>
 #include <cstdlib>
 #include <unistd.h>
 #include <dirent.h>
@@ -293,6 +294,12 @@ uint64 psIdleTime() {
 	return getms(true) - _lastUserAction;
 }
 
+uint64 psPeakMemoryUsage() {
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+	return uint64(usage.ru_maxrss) * 1024; // kilobytes on Linux
+}
+
 void psActivateProcess(uint64 pid) {
 //	objc_activateProgram();
 }
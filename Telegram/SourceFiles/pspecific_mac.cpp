@@ -28,6 +28,7 @@ Copyright (c) 2014-2016 John Preston, https://desktop.telegram.org
 #include "history/history_location_manager.h"
 
 #include <execinfo.h>
+#include <sys/resource.h>
 
 namespace {
     QStringList _initLogs;
@@ -302,6 +303,12 @@ uint64 psIdleTime() {
 	return objc_idleTime(idleTime) ? idleTime : (getms(true) - _lastUserAction);
 }
 
+uint64 psPeakMemoryUsage() {
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+	return uint64(usage.ru_maxrss); // bytes on OS X
+}
+
 QStringList psInitLogs() {
     return _initLogs;
 }
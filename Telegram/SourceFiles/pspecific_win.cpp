@@ -176,6 +176,15 @@ uint64 psIdleTime() {
 	return GetLastInputInfo(&lii) ? (GetTickCount() - lii.dwTime) : (getms(true) - _lastUserAction);
 }
 
+uint64 psPeakMemoryUsage() {
+	if (!Dlls::GetProcessMemoryInfo) return 0;
+
+	PROCESS_MEMORY_COUNTERS counters;
+	counters.cb = sizeof(PROCESS_MEMORY_COUNTERS);
+	if (!Dlls::GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(PROCESS_MEMORY_COUNTERS))) return 0;
+	return uint64(counters.PeakWorkingSetSize);
+}
+
 QStringList psInitLogs() {
     return _initLogs;
 }
@@ -37,6 +37,7 @@ void psDeleteDir(const QString &dir);
 void psUserActionDone();
 bool psIdleSupported();
 uint64 psIdleTime();
+uint64 psPeakMemoryUsage(); // peak resident set size in bytes, 0 if unknown
 
 QStringList psInitLogs();
 void psClearInitLogs();
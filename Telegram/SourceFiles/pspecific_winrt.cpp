@@ -1642,6 +1642,10 @@ uint64 psIdleTime() {
 	return (getms(true) - _lastUserAction);
 }
 
+uint64 psPeakMemoryUsage() {
+	return 0;
+}
+
 bool psSkipAudioNotify() {
 	//QUERY_USER_NOTIFICATION_STATE state;
 	//if (useShellapi && SUCCEEDED(shQueryUserNotificationState(&state))) {
@@ -125,6 +125,7 @@ void psDeleteDir(const QString &dir);
 void psUserActionDone();
 bool psIdleSupported();
 uint64 psIdleTime();
+uint64 psPeakMemoryUsage(); // peak resident set size in bytes, 0 if unknown
 
 bool psSkipAudioNotify();
 bool psSkipDesktopNotify();
@@ -37,6 +37,18 @@ QByteArray gBetaPrivateKey;
 bool gTestMode = false;
 bool gDebug = false;
 bool gManyInstance = false;
+int32 gFileSessionsMax = MTPFileSessionsMaxCount;
+int32 gWarmSessionsMax = MTPWarmSessionsCount;
+int32 gWarmSessionsMemory = MTPWarmSessionsMemory;
+int32 gMaxDownloadRate = 0;
+int32 gMaxUploadRate = 0;
+int32 gInteractiveReserve = MTPInteractiveReserve;
+int32 gMtpRecordSize = 0;
+QString gMtpDumpPath, gMtpDumpFilter, gMtpDumpReplay;
+#ifdef TDESKTOP_FAKE_DC
+int32 gFakeDcPort = 0;
+QString gBenchmark;
+#endif // TDESKTOP_FAKE_DC
 QString gKeyFile;
 QString gWorkingDir, gExeDir, gExeName;
 
@@ -191,6 +203,33 @@ void settingsParseArgs(int argc, char *argv[]) {
 			gDebug = true;
 		} else if (qstr("-many") == argv[i]) {
 			gManyInstance = true;
+		} else if (qstr("-filesessions") == argv[i] && i + 1 < argc) {
+			gFileSessionsMax = snap(fromUtf8Safe(argv[++i]).toInt(), 1, int(MTPFileSessionsMaxCount));
+		} else if (qstr("-warmsessions") == argv[i] && i + 1 < argc) {
+			gWarmSessionsMax = snap(fromUtf8Safe(argv[++i]).toInt(), 0, 16);
+		} else if (qstr("-warmmemory") == argv[i] && i + 1 < argc) {
+			gWarmSessionsMemory = qMax(fromUtf8Safe(argv[++i]).toInt(), 0);
+		} else if (qstr("-maxdownload") == argv[i] && i + 1 < argc) {
+			gMaxDownloadRate = qMax(fromUtf8Safe(argv[++i]).toInt(), 0);
+		} else if (qstr("-maxupload") == argv[i] && i + 1 < argc) {
+			gMaxUploadRate = qMax(fromUtf8Safe(argv[++i]).toInt(), 0);
+		} else if (qstr("-interactivereserve") == argv[i] && i + 1 < argc) {
+			gInteractiveReserve = snap(fromUtf8Safe(argv[++i]).toInt(), 0, 90);
+		} else if (qstr("-mtprecord") == argv[i] && i + 1 < argc) {
+			gMtpRecordSize = snap(fromUtf8Safe(argv[++i]).toInt(), 0, 4096);
+		} else if (qstr("-mtpdump") == argv[i] && i + 1 < argc) {
+			gLaunchMode = LaunchModeMtpDump;
+			gMtpDumpPath = fromUtf8Safe(argv[++i]);
+		} else if (qstr("-mtpfilter") == argv[i] && i + 1 < argc) {
+			gMtpDumpFilter = fromUtf8Safe(argv[++i]);
+		} else if (qstr("-mtpreplay") == argv[i] && i + 1 < argc) {
+			gMtpDumpReplay = fromUtf8Safe(argv[++i]);
+#ifdef TDESKTOP_FAKE_DC
+		} else if (qstr("-fakedc") == argv[i] && i + 1 < argc) {
+			gFakeDcPort = snap(fromUtf8Safe(argv[++i]).toInt(), 0, 65535);
+		} else if (qstr("-benchmark") == argv[i] && i + 1 < argc) {
+			gBenchmark = fromUtf8Safe(argv[++i]);
+#endif // TDESKTOP_FAKE_DC
 		} else if (qstr("-key") == argv[i] && i + 1 < argc) {
 			gKeyFile = fromUtf8Safe(argv[++i]);
 		} else if (qstr("-autostart") == argv[i]) {
@@ -221,6 +260,11 @@ void settingsParseArgs(int argc, char *argv[]) {
 			gStartUrl = fromUtf8Safe(argv[++i]).mid(0, 8192);
 		}
 	}
+#ifdef TDESKTOP_FAKE_DC
+	if (gFakeDcPort && gKeyFile.isEmpty()) {
+		gKeyFile = qsl("fakedc"); // never mix the fake dc auth keys with the real ones
+	}
+#endif // TDESKTOP_FAKE_DC
 }
 
 RecentEmojiPack &cGetRecentEmojis() {
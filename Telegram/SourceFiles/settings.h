@@ -75,6 +75,7 @@ enum LaunchMode {
 	LaunchModeFixPrevious,
 	LaunchModeCleanup,
 	LaunchModeShowCrash,
+	LaunchModeMtpDump,
 };
 DeclareReadSetting(LaunchMode, LaunchMode);
 DeclareSetting(QString, WorkingDir);
@@ -113,6 +114,20 @@ DeclareSetting(bool, NoStartUpdate);
 DeclareSetting(bool, StartToSettings);
 DeclareSetting(bool, ReplaceEmojis);
 DeclareReadSetting(bool, ManyInstance);
+DeclareSetting(int32, FileSessionsMax); // ceiling for the upload and download sessions count of one dc
+DeclareSetting(int32, WarmSessionsMax); // download sessions kept connected after the downloads stop, 0 - disabled
+DeclareSetting(int32, WarmSessionsMemory); // KB allowed for them
+DeclareSetting(int32, MaxDownloadRate); // KB per second for all the downloads, 0 - no cap, see mtproto/bandwidth_governor.h
+DeclareSetting(int32, MaxUploadRate); // KB per second for all the uploads, 0 - no cap
+DeclareSetting(int32, InteractiveReserve); // percent of the cap (or of the measured throughput without a cap) left to the chats while they are active
+DeclareReadSetting(int32, MtpRecordSize); // MB for the binary traffic capture files, 0 - not recording, see mtproto/traffic_recorder.h
+DeclareReadSetting(QString, MtpDumpPath); // capture file or folder printed in the -mtpdump launch mode
+DeclareReadSetting(QString, MtpDumpFilter);
+DeclareReadSetting(QString, MtpDumpReplay); // FakeDc replay file to save the received updates to
+#ifdef TDESKTOP_FAKE_DC
+DeclareReadSetting(int32, FakeDcPort); // all dcs are the local FakeDc server on this port, see _other/fakedc.h
+DeclareReadSetting(QString, Benchmark); // comma separated MTP::Benchmark scenarios to run after start
+#endif // TDESKTOP_FAKE_DC
 
 DeclareSetting(QByteArray, LocalSalt);
 DeclareSetting(DBIScale, RealScale);
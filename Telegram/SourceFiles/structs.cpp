@@ -650,7 +650,7 @@ bool PtsWaiter::updated(ChannelData *channel, int32 pts, int32 count, const MTPU
 	} else if (check(channel, pts, count)) {
 		return true;
 	}
-	_updatesQueue.insert(ptsKey(SkippedUpdates), updates);
+	_updatesQueue.insert(ptsKey(SkippedUpdates), mtpEscape(updates)); // may wait long, don't pin the response arena
 	return false;
 }
 
@@ -662,7 +662,7 @@ bool PtsWaiter::updated(ChannelData *channel, int32 pts, int32 count, const MTPU
 	} else if (check(channel, pts, count)) {
 		return true;
 	}
-	_updateQueue.insert(ptsKey(SkippedUpdate), update);
+	_updateQueue.insert(ptsKey(SkippedUpdate), mtpEscape(update));
 	return false;
 }
 
@@ -704,6 +704,12 @@ void PhotoData::automaticLoadSettingsChanged() {
 	full->automaticLoadSettingsChanged();
 }
 
+void PhotoData::markVisible() {
+	thumb->markVisible();
+	medium->markVisible();
+	full->markVisible();
+}
+
 void PhotoData::download() {
 	full->loadEvenCancelled();
 	notifyLayoutChanged();
@@ -1064,7 +1070,20 @@ void DocumentOpenClickHandler::doOpen(DocumentData *data, HistoryItem *context,
 		if (filename.isEmpty()) return;
 	}
 
-	data->save(filename, action, msgId);
+	// The song or video loaded to a file starts playing right away, the action
+	// on load would toggle the playback when the loading is finished.
+	auto playWhileLoading = (playMusic || playVideo) && !filename.isEmpty() && data->size > 0;
+	data->save(filename, playWhileLoading ? ActionOnLoadNone : action, msgId);
+	if (playWhileLoading && (data->streamingSource() || data->loaded())) {
+		if (playMusic) {
+			AudioMsgId song(data, msgId);
+			audioPlayer()->play(song);
+			audioPlayer()->notify(song);
+		} else {
+			App::wnd()->showDocument(data, context);
+			if (App::main()) App::main()->mediaMarkRead(data);
+		}
+	}
 }
 
 void DocumentOpenClickHandler::onClickImpl() const {
@@ -1274,6 +1293,13 @@ void DocumentData::automaticLoadSettingsChanged() {
 	_loader = 0;
 }
 
+void DocumentData::markVisible() {
+	thumb->markVisible();
+	if (loading()) {
+		_loader->markVisible();
+	}
+}
+
 void DocumentData::performActionOnLoad() {
 	if (_actionOnLoad == ActionOnLoadNone) return;
 
@@ -1379,6 +1405,13 @@ QString DocumentData::loadingFilePath() const {
 	return loading() ? _loader->fileName() : QString();
 }
 
+Media::StreamingSourcePtr DocumentData::streamingSource() const {
+	if (auto loader = loading() ? _loader->mtpLoader() : nullptr) {
+		return loader->streamingSource();
+	}
+	return Media::StreamingSourcePtr();
+}
+
 bool DocumentData::displayLoading() const {
 	return loading() ? (!_loader->loadingLocal() || !_loader->autoLoading()) : uploading();
 }
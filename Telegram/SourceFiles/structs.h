@@ -936,6 +936,7 @@ public:
 
 	void automaticLoad(const HistoryItem *item);
 	void automaticLoadSettingsChanged();
+	void markVisible(); // displayed in the visible area, load first
 
 	void download();
 	bool loaded() const;
@@ -1076,6 +1077,7 @@ public:
 
 	void automaticLoad(const HistoryItem *item); // auto load sticker or video
 	void automaticLoadSettingsChanged();
+	void markVisible(); // displayed in the visible area, load first
 
 	enum FilePathResolveType {
 		FilePathResolveCached,
@@ -1086,6 +1088,7 @@ public:
 	bool loaded(FilePathResolveType type = FilePathResolveCached) const;
 	bool loading() const;
 	QString loadingFilePath() const;
+	Media::StreamingSourcePtr streamingSource() const; // to play the file while it is loading
 	bool displayLoading() const;
 	void save(const QString &toFile, ActionOnLoad action = ActionOnLoadNone, const FullMsgId &actionMsgId = FullMsgId(), LoadFromCloudSetting fromCloud = LoadFromCloudOrLocal, bool autoLoading = false);
 	void cancel();
@@ -789,6 +789,12 @@ void RemoteImage::automaticLoadSettingsChanged() {
 	_loader = 0;
 }
 
+void RemoteImage::markVisible() {
+	if (amLoading()) {
+		_loader->markVisible();
+	}
+}
+
 void RemoteImage::load(bool loadFirst, bool prior) {
 	if (loaded()) return;
 
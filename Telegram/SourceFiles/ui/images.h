@@ -139,6 +139,8 @@ public:
 	}
 	virtual void automaticLoadSettingsChanged() {
 	}
+	virtual void markVisible() { // displayed in the visible area, load first
+	}
 
 	virtual bool loaded() const {
 		return true;
@@ -260,6 +262,7 @@ public:
 
 	void automaticLoad(const HistoryItem *item); // auto load photo
 	void automaticLoadSettingsChanged();
+	void markVisible() override;
 
 	bool loaded() const;
 	bool loading() const {
@@ -58,6 +58,7 @@
         'pt-BR',
       ],
       'travis_defines%': '',
+      'fake_dc%': '',
     },
     'includes': [
       'common_executable.gypi',
@@ -220,6 +221,7 @@
       '<(src_loc)/core/runtime_composer.h',
       '<(src_loc)/core/single_timer.cpp',
       '<(src_loc)/core/single_timer.h',
+      '<(src_loc)/core/spsc_queue.h',
       '<(src_loc)/core/stl_subset.h',
       '<(src_loc)/core/type_traits.h',
       '<(src_loc)/core/utils.cpp',
@@ -312,10 +314,16 @@
       '<(src_loc)/media/media_clip_qtgif.h',
       '<(src_loc)/media/media_clip_reader.cpp',
       '<(src_loc)/media/media_clip_reader.h',
+      '<(src_loc)/media/media_streaming.cpp',
+      '<(src_loc)/media/media_streaming.h',
       '<(src_loc)/mtproto/facade.cpp',
       '<(src_loc)/mtproto/facade.h',
       '<(src_loc)/mtproto/auth_key.cpp',
       '<(src_loc)/mtproto/auth_key.h',
+      '<(src_loc)/mtproto/bandwidth_governor.cpp',
+      '<(src_loc)/mtproto/bandwidth_governor.h',
+      '<(src_loc)/mtproto/benchmark.cpp',
+      '<(src_loc)/mtproto/benchmark.h',
       '<(src_loc)/mtproto/connection.cpp',
       '<(src_loc)/mtproto/connection.h',
       '<(src_loc)/mtproto/connection_abstract.cpp',
@@ -328,18 +336,35 @@
       '<(src_loc)/mtproto/connection_tcp.h',
       '<(src_loc)/mtproto/core_types.cpp',
       '<(src_loc)/mtproto/core_types.h',
+      '<(src_loc)/mtproto/dc_endpoints.cpp',
+      '<(src_loc)/mtproto/dc_endpoints.h',
       '<(src_loc)/mtproto/dcenter.cpp',
       '<(src_loc)/mtproto/dcenter.h',
       '<(src_loc)/mtproto/file_download.cpp',
       '<(src_loc)/mtproto/file_download.h',
+      '<(src_loc)/mtproto/file_sessions.cpp',
+      '<(src_loc)/mtproto/file_sessions.h',
+      '<(src_loc)/mtproto/gzip_inflater.cpp',
+      '<(src_loc)/mtproto/gzip_inflater.h',
+      '<(src_loc)/mtproto/msg_ids_window.h',
+      '<(src_loc)/mtproto/request_registry.cpp',
+      '<(src_loc)/mtproto/request_registry.h',
+      '<(src_loc)/mtproto/response_parser.cpp',
+      '<(src_loc)/mtproto/response_parser.h',
       '<(src_loc)/mtproto/rsa_public_key.cpp',
       '<(src_loc)/mtproto/rsa_public_key.h',
       '<(src_loc)/mtproto/rpc_sender.cpp',
       '<(src_loc)/mtproto/rpc_sender.h',
       '<(src_loc)/mtproto/scheme_auto.cpp',
       '<(src_loc)/mtproto/scheme_auto.h',
+      '<(src_loc)/mtproto/send_scheduler.cpp',
+      '<(src_loc)/mtproto/send_scheduler.h',
       '<(src_loc)/mtproto/session.cpp',
       '<(src_loc)/mtproto/session.h',
+      '<(src_loc)/mtproto/traffic_recorder.cpp',
+      '<(src_loc)/mtproto/traffic_recorder.h',
+      '<(src_loc)/mtproto/warm_sessions.cpp',
+      '<(src_loc)/mtproto/warm_sessions.h',
       '<(src_loc)/overview/overview_layout.cpp',
       '<(src_loc)/overview/overview_layout.h',
       '<(src_loc)/pspecific_win.cpp',
@@ -554,6 +579,16 @@
       '<(sp_media_key_tap_loc)/SPInvocationGrabbing/NSObject+SPInvocationGrabbing.h',
     ],
     'conditions': [
+      [ '"<(fake_dc)" == "1"', {
+        'defines': [
+          'TDESKTOP_FAKE_DC',
+        ],
+      }, {
+        'sources!': [
+          '<(src_loc)/mtproto/benchmark.cpp',
+          '<(src_loc)/mtproto/benchmark.h',
+        ],
+      }],
       [ '"<(official_build_target)" != ""', {
         'defines': [
           'CUSTOM_API_ID',
@@ -162,5 +162,100 @@
         ],
       },
     },
+  }, {
+    'target_name': 'FakeDc',
+    'variables': {
+      'libs_loc': '../../../Libraries',
+      'src_loc': '../SourceFiles',
+      'mac_target': '10.10',
+    },
+    'includes': [
+      'common_executable.gypi',
+      'qt.gypi',
+    ],
+    'conditions': [
+      [ 'build_win', {
+        'libraries': [
+          'libeay32',
+          'ssleay32',
+          'Crypt32',
+          'zlibstat',
+        ],
+      }],
+      [ 'build_linux', {
+        'libraries': [
+          'ssl',
+          'crypto',
+          'z',
+        ],
+      }],
+      [ 'build_mac', {
+        'include_dirs': [
+          '<(libs_loc)/openssl-xcode/include'
+        ],
+        'library_dirs': [
+          '<(libs_loc)/openssl-xcode',
+        ],
+        'xcode_settings': {
+          'OTHER_LDFLAGS': [
+            '-lssl',
+            '-lcrypto',
+            '-lz',
+          ],
+        },
+      }],
+    ],
+    'include_dirs': [
+      '<(src_loc)',
+      '<(libs_loc)/zlib-1.2.8',
+    ],
+    'sources': [
+      '<(src_loc)/_other/fakedc.cpp',
+      '<(src_loc)/_other/fakedc.h',
+    ],
+    'configurations': {
+      'Debug': {
+        'conditions': [
+          [ 'build_win', {
+            'include_dirs': [
+              '<(libs_loc)/openssl_debug/Debug/include',
+            ],
+            'library_dirs': [
+              '<(libs_loc)/openssl_debug/Debug/lib',
+              '<(libs_loc)/zlib-1.2.8/contrib/vstudio/vc11/x86/ZlibStatDebug',
+            ],
+          }, {
+            'include_dirs': [
+              '/usr/local/include',
+              '<(libs_loc)/openssl-xcode/include'
+            ],
+            'library_dirs': [
+              '/usr/local/lib',
+            ],
+          }]
+        ],
+      },
+      'Release': {
+        'conditions': [
+          [ 'build_win', {
+            'include_dirs': [
+              '<(libs_loc)/openssl/Release/include',
+            ],
+            'library_dirs': [
+              '<(libs_loc)/openssl/Release/lib',
+              '<(libs_loc)/zlib-1.2.8/contrib/vstudio/vc11/x86/ZlibStatRelease',
+            ],
+          }, {
+            'include_dirs': [
+              '/usr/local/include',
+              '<(libs_loc)/openssl-xcode/include'
+            ],
+            'library_dirs': [
+              '/usr/local/lib',
+            ],
+          }]
+        ],
+      },
+    },
   }],
 }